@@ -20,6 +20,8 @@
  *
  */
 
+#include "common/atomic.h"
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -39,10 +41,17 @@ namespace Audio {
 
 /**
  * Channel used by the default Mixer implementation.
+ *
+ * A channel is shared between the engine side and the mixing side of
+ * MixerImpl: the volume, balance and pause settings as requested by the
+ * engine are owned by the engine side, whereas the effective volumes and
+ * pause state used while mixing, the stream and the timing information are
+ * owned by the mixing side. See MixerImpl for how changes travel between
+ * the two.
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, ResamplerType resampler);
 	~Channel();
 
 	/**
@@ -58,8 +67,20 @@ public:
 
 	/**
 	 * Queries whether the channel is still playing or not.
+	 * Mixing side only.
+	 */
+	bool isFinished() const { return _stopRequested || _stream->endOfStream(); }
+
+	/**
+	 * Makes isFinished() return true, so that the mixing side hands the
+	 * channel back to the engine side. Mixing side only.
+	 */
+	void requestStop() { _stopRequested = true; }
+
+	/**
+	 * Queries whether requestStop() was called. Mixing side only.
 	 */
-	bool isFinished() const { return _stream->endOfStream(); }
+	bool isStopRequested() const { return _stopRequested; }
 
 	/**
 	 * Queries whether the channel is a permanent channel.
@@ -75,6 +96,8 @@ public:
 
 	/**
 	 * Pauses or unpaused the channel in a recursive fashion.
+	 * This only updates the engine side state, the caller is
+	 * responsible for passing isPaused() on to the mixing side.
 	 *
 	 * @param paused true, when the channel should be paused.
 	 *               false when it should be unpaused.
@@ -115,10 +138,26 @@ public:
 	int8 getBalance();
 
 	/**
-	 * Notifies the channel that the global sound type
-	 * volume settings changed.
+	 * Computes the effective volume for the left and right channel from
+	 * the channel volume/balance and the global sound type settings.
+	 */
+	void calcMixVolumes(st_volume_t &volL, st_volume_t &volR) const;
+
+	/**
+	 * Sets the effective volumes used while mixing. Mixing side only
+	 * (or before the channel is handed over to the mixing side).
 	 */
-	void notifyGlobalVolChange() { updateChannelVolumes(); }
+	void setMixVolumes(st_volume_t volL, st_volume_t volR) { _volL = volL; _volR = volR; }
+
+	/**
+	 * Sets whether the mixing side should skip this channel.
+	 */
+	void setMixPaused(bool paused) { _mixPaused = paused; }
+
+	/**
+	 * Queries whether the mixing side should skip this channel.
+	 */
+	bool isMixPaused() const { return _mixPaused; }
 
 	/**
 	 * Queries how long the channel has been playing.
@@ -152,16 +191,23 @@ private:
 	byte _volume;
 	int8 _balance;
 
-	void updateChannelVolumes();
 	st_volume_t _volL, _volR;
+	bool _mixPaused;
+	bool _stopRequested;
 
 	Mixer *_mixer;
 
+	// Written by the mixing side, read by getElapsedTime(). _timingSeq is
+	// odd while an update is in progress.
+	volatile uint32 _timingSeq;
 	uint32 _samplesConsumed;
 	uint32 _samplesDecoded;
 	uint32 _mixerTimeStamp;
+	uint32 _pauseTimeAtMix;
+
+	// Written by the engine side. _pauseTime is the total time spent paused.
 	uint32 _pauseStartTime;
-	uint32 _pauseTime;
+	volatile uint32 _pauseTime;
 
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
@@ -171,17 +217,44 @@ private:
 #pragma mark --- Mixer ---
 #pragma mark -
 
+// The mixer whose mixCallback() the current thread is running, see
+// MixerImpl::isMixingThread(). Without thread local storage, calls which
+// other threads make while the audio thread is mixing are mistaken for
+// calls from the mixing side.
+#if defined(__GNUC__)
+static __thread const MixerImpl *s_mixingMixer = 0;
+#elif defined(_MSC_VER)
+static __declspec(thread) const MixerImpl *s_mixingMixer = 0;
+#else
+static const MixerImpl *volatile s_mixingMixer = 0;
+#endif
+
 
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _syst(system), _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _syst(system), _mutex(), _sampleRate(sampleRate), _resamplerType(kResamplerLinear), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _mixState(kMixStateIdle), _mixingIndex(-1), _applyingDeferredCalls(false) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = 0;
+		_mixChannels[i] = 0;
+	}
+
+	if (ConfMan.hasKey("resampler")) {
+		const Common::String resampler = ConfMan.get("resampler");
+		if (resampler == "sinc")
+			_resamplerType = kResamplerSinc;
+		else if (resampler == "sinc_float")
+			_resamplerType = kResamplerSincFloat;
+		else if (resampler != "linear")
+			warning("Unknown resampler '%s', using linear", resampler.c_str());
+	}
 }
 
 MixerImpl::~MixerImpl() {
+	// The mixing side only ever references channels which are still in
+	// _channels, so this frees everything.
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
 }
@@ -217,6 +290,172 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	// The mixing side does not know about the channel yet, so we may still
+	// set up its mixing state directly.
+	st_volume_t volL, volR;
+	chan->calcMixVolumes(volL, volR);
+	chan->setMixVolumes(volL, volR);
+	chan->setMixPaused(chan->isPaused());
+
+	MixerCommand cmd;
+	cmd.type = MixerCommand::kInsert;
+	cmd.index = index;
+	cmd.chan = chan;
+	postCommand(cmd);
+}
+
+void MixerImpl::removeChannel(int index) {
+	Channel *chan = _channels[index];
+	assert(chan);
+	_channels[index] = 0;
+
+	MixerCommand cmd;
+	cmd.type = MixerCommand::kRemove;
+	cmd.index = index;
+	cmd.chan = chan;
+	postCommand(cmd);
+
+	// Callers rely on the stream being gone (or at least no longer used)
+	// once a stop method returns, so free the channel right away.
+	waitForChannelRelease(index);
+	delete chan;
+}
+
+void MixerImpl::reapFinishedChannels() {
+	uint32 handleVal;
+	while (_finishedChannels.pop(handleVal)) {
+		// The channel might have been stopped by the engine in the meantime
+		const int index = handleVal % NUM_CHANNELS;
+		if (_channels[index] && _channels[index]->getHandle()._val == handleVal) {
+			delete _channels[index];
+			_channels[index] = 0;
+		}
+	}
+
+	applyDeferredCalls();
+}
+
+void MixerImpl::applyDeferredCalls() {
+	// The calls below come back here
+	if (_applyingDeferredCalls)
+		return;
+	_applyingDeferredCalls = true;
+
+	DeferredCall call;
+	while (_deferredCalls.pop(call)) {
+		SoundHandle handle;
+		handle._val = call.arg;
+
+		switch (call.type) {
+		case DeferredCall::kPauseAll:
+			pauseAll(call.value != 0);
+			break;
+		case DeferredCall::kPauseID:
+			pauseID(call.arg, call.value != 0);
+			break;
+		case DeferredCall::kPauseHandle:
+			pauseHandle(handle, call.value != 0);
+			break;
+		case DeferredCall::kSetChannelVolume:
+			setChannelVolume(handle, call.value);
+			break;
+		case DeferredCall::kSetChannelBalance:
+			setChannelBalance(handle, call.value);
+			break;
+		case DeferredCall::kMuteSoundType:
+			muteSoundType((SoundType)call.arg, call.value != 0);
+			break;
+		case DeferredCall::kSetVolumeForSoundType:
+			setVolumeForSoundType((SoundType)call.arg, call.value);
+			break;
+		}
+	}
+
+	_applyingDeferredCalls = false;
+}
+
+void MixerImpl::deferCall(DeferredCall::Type type, uint32 arg, int value) {
+	DeferredCall call;
+	call.type = type;
+	call.arg = arg;
+	call.value = value;
+	if (!_deferredCalls.push(call))
+		warning("MixerImpl: Too many mixer calls from within audio streams, dropping one");
+}
+
+void MixerImpl::postCommand(const MixerCommand &cmd) {
+	while (!_commands.push(cmd)) {
+		// The mixing side did not pick up any commands for a long time,
+		// e.g. because the backend suspended audio output. Take over its
+		// part and apply the backlog ourselves. Should mixCallback() get
+		// called meanwhile, it outputs silence instead of waiting for us.
+		while (!Common::atomicCompareAndSwap(_mixState, kMixStateIdle, kMixStateEngine))
+			_syst->delayMillis(1);
+		processCommands();
+		Common::atomicStore(_mixState, (int32)kMixStateIdle);
+	}
+}
+
+void MixerImpl::postChannelVolume(int index) {
+	Channel *chan = _channels[index];
+
+	MixerCommand cmd;
+	cmd.type = MixerCommand::kSetVolume;
+	cmd.index = index;
+	cmd.chan = chan;
+	chan->calcMixVolumes(cmd.volL, cmd.volR);
+	postCommand(cmd);
+}
+
+void MixerImpl::waitForChannelRelease(int index) {
+	// The removal has been posted already. mixCallback() announces each slot
+	// in _mixingIndex before it checks for new commands, so if it is not
+	// working on this slot right now, it will see the removal before it
+	// ever looks at the slot again. The mixing side never waits for the
+	// engine side, so this cannot deadlock.
+	while (Common::atomicLoad(_mixingIndex) == index)
+		_syst->delayMillis(1);
+}
+
+bool MixerImpl::isMixingThread() const {
+	return s_mixingMixer == this;
+}
+
+Channel *MixerImpl::findMixChannel(SoundHandle handle) {
+	// We are the consumer of the command queue while mixing, so pick up
+	// what the engine side changed in the meantime
+	processCommands();
+
+	Channel *chan = _mixChannels[handle._val % NUM_CHANNELS];
+	if (chan && chan->getHandle()._val == handle._val && !chan->isStopRequested())
+		return chan;
+	return 0;
+}
+
+void MixerImpl::processCommands() {
+	MixerCommand cmd;
+	while (_commands.pop(cmd)) {
+		// Commands may refer to channels which the mixing side already
+		// reported as finished; those must not be touched anymore.
+		switch (cmd.type) {
+		case MixerCommand::kInsert:
+			_mixChannels[cmd.index] = cmd.chan;
+			break;
+		case MixerCommand::kRemove:
+			if (_mixChannels[cmd.index] == cmd.chan)
+				_mixChannels[cmd.index] = 0;
+			break;
+		case MixerCommand::kSetVolume:
+			if (_mixChannels[cmd.index] == cmd.chan)
+				cmd.chan->setMixVolumes(cmd.volL, cmd.volR);
+			break;
+		case MixerCommand::kSetPaused:
+			if (_mixChannels[cmd.index] == cmd.chan)
+				cmd.chan->setMixPaused(cmd.paused);
+			break;
+		}
+	}
 }
 
 void MixerImpl::playStream(
@@ -227,6 +466,15 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
+	if (isMixingThread()) {
+		// The new channel needs a slot on the engine side, which would mean
+		// waiting for the engine
+		warning("MixerImpl::playStream called from within an audio stream, ignoring");
+		if (stream && autofreeStream == DisposeAfterUse::YES)
+			delete stream;
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	if (stream == 0) {
@@ -237,6 +485,8 @@ void MixerImpl::playStream(
 
 	assert(_mixerReady);
 
+	reapFinishedChannels();
+
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
@@ -258,7 +508,7 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _resamplerType);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
@@ -267,8 +517,6 @@ void MixerImpl::playStream(
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
-
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
@@ -280,63 +528,118 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	//  zero the buf
 	memset(buf, 0, 2 * len * sizeof(int16));
 
+	// Never wait for the engine side. It only ever claims the command queue
+	// when that overflowed, in which case we simply output silence once.
+	if (!Common::atomicCompareAndSwap(_mixState, kMixStateIdle, kMixStateMixing))
+		return 0;
+
+	// Streams may call back into the mixer from their readBuffer()
+	s_mixingMixer = this;
+
 	// mix all channels
 	int res = 0, tmp;
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
-
-				if (tmp > res)
-					res = tmp;
-			}
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		// Announce the slot before picking up commands, see waitForChannelRelease()
+		Common::atomicStore(_mixingIndex, (int32)i);
+		processCommands();
+
+		Channel *chan = _mixChannels[i];
+		if (!chan)
+			continue;
+
+		if (chan->isFinished()) {
+			// Hand the channel back to the engine side, which frees it. If the
+			// queue is full, try again next time.
+			if (_finishedChannels.push(chan->getHandle()._val))
+				_mixChannels[i] = 0;
+		} else if (!chan->isMixPaused()) {
+			tmp = chan->mix(buf, len);
+
+			if (tmp > res)
+				res = tmp;
 		}
+	}
+
+	s_mixingMixer = 0;
+
+	Common::atomicStore(_mixingIndex, (int32)-1);
+	Common::atomicStore(_mixState, (int32)kMixStateIdle);
 
 	return res;
 }
 
 void MixerImpl::stopAll() {
+	if (isMixingThread()) {
+		processCommands();
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_mixChannels[i] && !_mixChannels[i]->isPermanent())
+				_mixChannels[i]->requestStop();
+		}
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && !_channels[i]->isPermanent())
+			removeChannel(i);
 	}
 }
 
 void MixerImpl::stopID(int id) {
+	if (isMixingThread()) {
+		processCommands();
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_mixChannels[i] && _mixChannels[i]->getId() == id)
+				_mixChannels[i]->requestStop();
+		}
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && _channels[i]->getId() == id)
+			removeChannel(i);
 	}
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
+	if (isMixingThread()) {
+		// The engine side frees the channel once mixCallback() reports it
+		// as finished
+		Channel *chan = findMixChannel(handle);
+		if (chan)
+			chan->requestStop();
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 
 	// Simply ignore stop requests for handles of sounds that already terminated
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+	removeChannel(index);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= type && type < ARRAYSIZE(_soundTypeSettings));
+
+	if (isMixingThread()) {
+		deferCall(DeferredCall::kMuteSoundType, type, mute);
+		return;
+	}
+
+	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 	_soundTypeSettings[type].mute = mute;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
+			postChannelVolume(i);
 	}
 }
 
@@ -346,16 +649,30 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
+	if (isMixingThread()) {
+		deferCall(DeferredCall::kSetChannelVolume, handle._val, volume);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
 	_channels[index]->setVolume(volume);
+	postChannelVolume(index);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
+	if (isMixingThread()) {
+		Channel *chan = findMixChannel(handle);
+		return chan ? chan->getVolume() : 0;
+	}
+
+	Common::StackLock lock(_mutex);
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -364,16 +681,30 @@ byte MixerImpl::getChannelVolume(SoundHandle handle) {
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
+	if (isMixingThread()) {
+		deferCall(DeferredCall::kSetChannelBalance, handle._val, balance);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
 	_channels[index]->setBalance(balance);
+	postChannelVolume(index);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
+	if (isMixingThread()) {
+		Channel *chan = findMixChannel(handle);
+		return chan ? chan->getBalance() : 0;
+	}
+
+	Common::StackLock lock(_mutex);
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -386,7 +717,13 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
+	if (isMixingThread()) {
+		Channel *chan = findMixChannel(handle);
+		return chan ? chan->getElapsedTime() : Timestamp(0, _sampleRate);
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
@@ -396,26 +733,46 @@ Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 }
 
 void MixerImpl::pauseAll(bool paused) {
+	if (isMixingThread()) {
+		deferCall(DeferredCall::kPauseAll, 0, paused);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0) {
 			_channels[i]->pause(paused);
+			postChannelPaused(i);
 		}
 	}
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
+	if (isMixingThread()) {
+		deferCall(DeferredCall::kPauseID, id, paused);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
 			_channels[i]->pause(paused);
+			postChannelPaused(i);
 			return;
 		}
 	}
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
+	if (isMixingThread()) {
+		deferCall(DeferredCall::kPauseHandle, handle._val, paused);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 
 	// Simply ignore (un)pause requests for sounds that already terminated
 	const int index = handle._val % NUM_CHANNELS;
@@ -423,10 +780,31 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 		return;
 
 	_channels[index]->pause(paused);
+	postChannelPaused(index);
+}
+
+void MixerImpl::postChannelPaused(int index) {
+	Channel *chan = _channels[index];
+
+	MixerCommand cmd;
+	cmd.type = MixerCommand::kSetPaused;
+	cmd.index = index;
+	cmd.chan = chan;
+	cmd.paused = chan->isPaused();
+	postCommand(cmd);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
+	if (isMixingThread()) {
+		processCommands();
+		for (int i = 0; i != NUM_CHANNELS; i++)
+			if (_mixChannels[i] && !_mixChannels[i]->isStopRequested() && _mixChannels[i]->getId() == id)
+				return true;
+		return false;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getId() == id)
 			return true;
@@ -434,7 +812,13 @@ bool MixerImpl::isSoundIDActive(int id) {
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
+	if (isMixingThread()) {
+		const Channel *chan = findMixChannel(handle);
+		return chan ? chan->getId() : 0;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 	const int index = handle._val % NUM_CHANNELS;
 	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
 		return _channels[index]->getId();
@@ -442,13 +826,26 @@ int MixerImpl::getSoundID(SoundHandle handle) {
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
+	if (isMixingThread())
+		return findMixChannel(handle) != 0;
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 	const int index = handle._val % NUM_CHANNELS;
 	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
+	if (isMixingThread()) {
+		processCommands();
+		for (int i = 0; i != NUM_CHANNELS; i++)
+			if (_mixChannels[i] && !_mixChannels[i]->isStopRequested() && _mixChannels[i]->getType() == type)
+				return true;
+		return false;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getType() == type)
 			return true;
@@ -467,12 +864,18 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
+	if (isMixingThread()) {
+		deferCall(DeferredCall::kSetVolumeForSoundType, type, volume);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
+	reapFinishedChannels();
 	_soundTypeSettings[type].volume = volume;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
+			postChannelVolume(i);
 	}
 }
 
@@ -488,16 +891,18 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+                 ResamplerType resampler)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
-      _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
+      _balance(0), _pauseLevel(0), _volL(0), _volR(0), _mixPaused(false), _stopRequested(false), _timingSeq(0),
+      _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0), _pauseTimeAtMix(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0),
       _stream(stream, autofreeStream) {
 	assert(mixer);
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, resampler);
 }
 
 Channel::~Channel() {
@@ -506,7 +911,6 @@ Channel::~Channel() {
 
 void Channel::setVolume(const byte volume) {
 	_volume = volume;
-	updateChannelVolumes();
 }
 
 byte Channel::getVolume() {
@@ -515,14 +919,13 @@ byte Channel::getVolume() {
 
 void Channel::setBalance(const int8 balance) {
 	_balance = balance;
-	updateChannelVolumes();
 }
 
 int8 Channel::getBalance() {
 	return _balance;
 }
 
-void Channel::updateChannelVolumes() {
+void Channel::calcMixVolumes(st_volume_t &volL, st_volume_t &volR) const {
 	// From the channel balance/volume and the global volume, we compute
 	// the effective volume for the left and right channel. Note the
 	// slightly odd divisor: the 255 reflects the fact that the maximal
@@ -535,17 +938,17 @@ void Channel::updateChannelVolumes() {
 		int vol = _mixer->getVolumeForSoundType(_type) * _volume;
 
 		if (_balance == 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = vol / Mixer::kMaxChannelVolume;
+			volL = vol / Mixer::kMaxChannelVolume;
+			volR = vol / Mixer::kMaxChannelVolume;
 		} else if (_balance < 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+			volL = vol / Mixer::kMaxChannelVolume;
+			volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
 		} else {
-			_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-			_volR = vol / Mixer::kMaxChannelVolume;
+			volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+			volR = vol / Mixer::kMaxChannelVolume;
 		}
 	} else {
-		_volL = _volR = 0;
+		volL = volR = 0;
 	}
 }
 
@@ -561,7 +964,7 @@ void Channel::pause(bool paused) {
 		_pauseLevel--;
 
 		if (!_pauseLevel) {
-			_pauseTime = (g_system->getMillis() - _pauseStartTime);
+			_pauseTime = _pauseTime + (g_system->getMillis() - _pauseStartTime);
 			_pauseStartTime = 0;
 		}
 	}
@@ -573,17 +976,30 @@ Timestamp Channel::getElapsedTime() {
 
 	Audio::Timestamp ts(0, rate);
 
-	if (_mixerTimeStamp == 0)
+	// Take a consistent snapshot of the timing information the mixing side
+	// updates in mix().
+	uint32 seq, samplesConsumed, mixerTimeStamp, pauseTimeAtMix;
+	do {
+		seq = Common::atomicLoad(_timingSeq);
+		samplesConsumed = _samplesConsumed;
+		mixerTimeStamp = _mixerTimeStamp;
+		pauseTimeAtMix = _pauseTimeAtMix;
+	} while ((seq & 1) || seq != Common::atomicLoad(_timingSeq));
+
+	if (mixerTimeStamp == 0)
 		return ts;
 
+	// Only pauses which ended after the last mix() call matter here
+	const uint32 pauseTime = _pauseTime - pauseTimeAtMix;
+
 	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
+		delta = _pauseStartTime - mixerTimeStamp - pauseTime;
 	else
-		delta = g_system->getMillis() - _mixerTimeStamp - _pauseTime;
+		delta = g_system->getMillis() - mixerTimeStamp - pauseTime;
 
 	// Convert the number of samples into a time duration.
 
-	ts = ts.addFrames(_samplesConsumed);
+	ts = ts.addFrames(samplesConsumed);
 	ts = ts.addMsecs(delta);
 
 	// In theory it would seem like a good idea to limit the approximation
@@ -604,9 +1020,13 @@ int Channel::mix(int16 *data, uint len) {
 		// TODO: call drain method
 	} else {
 		assert(_converter);
+
+		Common::atomicStore(_timingSeq, _timingSeq + 1);
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis();
-		_pauseTime = 0;
+		_pauseTimeAtMix = _pauseTime;
+		Common::atomicStore(_timingSeq, _timingSeq + 1);
+
 		res = _converter->flow(*_stream, data, len, _volL, _volR);
 		_samplesDecoded += res;
 	}
@@ -25,7 +25,9 @@
 
 #include "common/scummsys.h"
 #include "common/mutex.h"
+#include "common/spsc-queue.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -46,18 +48,68 @@ namespace Audio {
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
  *
+ * Threading: the public methods are called by the engine (and timer)
+ * threads and serialize among themselves via _mutex. mixCallback() never
+ * takes that mutex, so the audio thread cannot be held up by the engine.
+ * Instead, the engine side owns _channels and posts every change to the
+ * set of mixed channels (insertion, removal, volume, pause state) into a
+ * lock-free command queue, which the audio thread applies to its own copy
+ * of the channel table, _mixChannels, while mixing. Channels which ran out
+ * of data are handed back to the engine side through a second queue and
+ * freed there.
+ *
+ * Streams may call back into the mixer from within their readBuffer(),
+ * e.g. emulated MIDI drivers which run the music timer procs from there.
+ * isMixingThread() tells such calls apart from calls by other threads, and
+ * they never take _mutex either. Queries are answered from _mixChannels, and
+ * stopped channels are marked as finished, so they are handed back to the
+ * engine side like channels which ran out of data. All other changes are
+ * queued in _deferredCalls and made by the engine side the next time it
+ * takes _mutex. Starting new sounds from within a stream is not supported.
+ *
  * @see OSystem::getMixer()
  */
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		COMMAND_QUEUE_SIZE = 128
+	};
+
+	/**
+	 * States of the mixing side of the command queue, see _mixState.
+	 */
+	enum {
+		kMixStateIdle = 0,
+		kMixStateMixing = 1,	///< mixCallback() is running
+		kMixStateEngine = 2		///< an engine thread is draining the command queue
+	};
+
+	/**
+	 * A change to a channel, posted by the engine side and applied by the
+	 * audio thread.
+	 */
+	struct MixerCommand {
+		enum Type {
+			kInsert,
+			kRemove,
+			kSetVolume,
+			kSetPaused
+		};
+
+		Type type;
+		int index;
+		Channel *chan;
+		st_volume_t volL, volR;
+		bool paused;
 	};
 
 	OSystem *_syst;
 	Common::Mutex _mutex;
 
 	const uint _sampleRate;
+	/** Resampling algorithm for new channels, from the "resampler" config key. */
+	ResamplerType _resamplerType;
 	bool _mixerReady;
 	uint32 _handleSeed;
 
@@ -69,8 +121,50 @@ private:
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
+
+	/** Engine side view of the channels. Guarded by _mutex. */
 	Channel *_channels[NUM_CHANNELS];
 
+	/** Audio side view of the channels. Only touched by the mixing side. */
+	Channel *_mixChannels[NUM_CHANNELS];
+
+	/** Channel changes, from the engine side to the mixing side. */
+	Common::SPSCQueue<MixerCommand, COMMAND_QUEUE_SIZE> _commands;
+
+	/** Handles of channels which have finished playing, from the mixing side to the engine side. */
+	Common::SPSCQueue<uint32, 2 * NUM_CHANNELS + 1> _finishedChannels;
+
+	/** Who currently acts as consumer of _commands (kMixStateIdle/Mixing/Engine). */
+	volatile int32 _mixState;
+
+	/** Index of the slot mixCallback() is currently working on, or -1. */
+	volatile int32 _mixingIndex;
+
+	/**
+	 * A call to one of the public methods which a stream made from within
+	 * mixCallback(), to be made by the engine side.
+	 */
+	struct DeferredCall {
+		enum Type {
+			kPauseAll,
+			kPauseID,
+			kPauseHandle,
+			kSetChannelVolume,
+			kSetChannelBalance,
+			kMuteSoundType,
+			kSetVolumeForSoundType
+		};
+
+		Type type;
+		uint32 arg;		///< Sound id, handle value or sound type
+		int value;
+	};
+
+	/** Calls from within streams, from the mixing side to the engine side. */
+	Common::SPSCQueue<DeferredCall, 32> _deferredCalls;
+
+	/** Set while applyDeferredCalls() runs. Guarded by _mutex. */
+	bool _applyingDeferredCalls;
 
 public:
 
@@ -122,6 +216,70 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/**
+	 * Stop and free the channel in the given slot. Engine side, the caller
+	 * must hold _mutex.
+	 */
+	void removeChannel(int index);
+
+	/**
+	 * Free all channels the audio thread reported as finished, and make the
+	 * calls it deferred. Engine side, the caller must hold _mutex.
+	 */
+	void reapFinishedChannels();
+
+	/**
+	 * Make the calls streams deferred, see DeferredCall. Engine side, the
+	 * caller must hold _mutex.
+	 */
+	void applyDeferredCalls();
+
+	/**
+	 * Queue a call for the engine side. Mixing side only.
+	 */
+	void deferCall(DeferredCall::Type type, uint32 arg, int value);
+
+	/**
+	 * Queue a command for the mixing side. Engine side, the caller must hold
+	 * _mutex.
+	 */
+	void postCommand(const MixerCommand &cmd);
+
+	/**
+	 * Queue the current volume of the channel in the given slot for the
+	 * mixing side.
+	 */
+	void postChannelVolume(int index);
+
+	/**
+	 * Queue the current pause state of the channel in the given slot for
+	 * the mixing side.
+	 */
+	void postChannelPaused(int index);
+
+	/**
+	 * Block until the mixing side is guaranteed not to be accessing the
+	 * channel in the given slot anymore, after its removal has been posted.
+	 * Engine side only.
+	 */
+	void waitForChannelRelease(int index);
+
+	/**
+	 * Check whether the caller runs inside mixCallback(), i.e. it is a
+	 * stream calling back into the mixer. Never blocks.
+	 */
+	bool isMixingThread() const;
+
+	/**
+	 * Look up a channel which is playing, on the mixing side.
+	 */
+	Channel *findMixChannel(SoundHandle handle);
+
+	/**
+	 * Apply all pending commands to _mixChannels. Mixing side only.
+	 */
+	void processCommands();
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
@@ -31,10 +31,27 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "common/atomic.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#if !defined(OUTPUT_UNSIGNED_AUDIO)
+	#if defined(__SSE2__)
+		#define RATE_USE_SSE2
+		#include <emmintrin.h>
+	#endif
+	#if defined(RATE_USE_SSE2) && defined(__GNUC__) && (__GNUC__ >= 5) && (defined(__x86_64__) || defined(__i386__))
+		// Compiled for the target attribute and picked at runtime
+		#define RATE_USE_AVX2
+		#include <immintrin.h>
+	#endif
+	#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+		#define RATE_USE_NEON
+		#include <arm_neon.h>
+	#endif
+#endif
+
 namespace Audio {
 
 
@@ -46,6 +63,285 @@ namespace Audio {
  */
 #define INTERMEDIATE_BUFFER_SIZE 512
 
+/**
+ * The number of sample pairs the Simple and Linear converters resample in
+ * one go, before handing them to the mixing kernels.
+ */
+#define MIX_BLOCK_SIZE 256
+
+
+#pragma mark -
+#pragma mark --- Mixing kernels ---
+#pragma mark -
+
+/**
+ * The innermost loop of every converter: scale samples by the channel
+ * volumes and add them, clamped, to the stereo output buffer. These come
+ * in a plain C++ version and, where available, SIMD versions, which all
+ * produce exactly the same output.
+ *
+ * mixMono:          obuf[2n] += in[n] * vol_l,   obuf[2n + 1] += in[n] * vol_r
+ * mixStereo:        obuf[2n] += in[2n] * vol_l,  obuf[2n + 1] += in[2n + 1] * vol_r
+ * mixStereoReverse: obuf[2n] += in[2n + 1] * vol_r, obuf[2n + 1] += in[2n] * vol_l
+ *
+ * count is the number of sample pairs written to obuf.
+ */
+struct MixKernels {
+	const char *name;
+	void (*mixMono)(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r);
+	void (*mixStereo)(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r);
+	void (*mixStereoReverse)(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r);
+};
+
+static void mixMonoC(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; count > 0; --count) {
+		const st_sample_t out = *in++;
+		clampedAdd(obuf[0], (out * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(obuf[1], (out * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		obuf += 2;
+	}
+}
+
+static void mixStereoC(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; count > 0; --count) {
+		clampedAdd(obuf[0], (in[0] * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(obuf[1], (in[1] * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		in += 2;
+		obuf += 2;
+	}
+}
+
+static void mixStereoReverseC(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; count > 0; --count) {
+		clampedAdd(obuf[1], (in[0] * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(obuf[0], (in[1] * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		in += 2;
+		obuf += 2;
+	}
+}
+
+static const MixKernels s_mixKernelsC = {
+	"c", mixMonoC, mixStereoC, mixStereoReverseC
+};
+
+// The SIMD versions below rely on the volumes never exceeding
+// kMaxMixerVolume (256): the products then fit into 32 bits, the scaled
+// samples fit into 16 bits and a saturating 16 bit add is identical to
+// clampedAdd(). The division by kMaxMixerVolume rounds towards zero, so
+// negative products are biased by 255 before the arithmetic shift.
+
+#ifdef RATE_USE_SSE2
+
+static inline __m128i scaleSSE2(__m128i in, __m128i vol) {
+	const __m128i lo = _mm_mullo_epi16(in, vol);
+	const __m128i hi = _mm_mulhi_epi16(in, vol);
+	const __m128i bias = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias)), 8);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias)), 8);
+	return _mm_packs_epi32(p0, p1);
+}
+
+static inline void mixBlockSSE2(st_sample_t *obuf, __m128i in, __m128i vol) {
+	const __m128i out = _mm_loadu_si128((const __m128i *)obuf);
+	_mm_storeu_si128((__m128i *)obuf, _mm_adds_epi16(out, scaleSSE2(in, vol)));
+}
+
+static void mixMonoSSE2(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m128i vol = _mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+	for (; count >= 8; count -= 8) {
+		const __m128i samples = _mm_loadu_si128((const __m128i *)in);
+		mixBlockSSE2(obuf, _mm_unpacklo_epi16(samples, samples), vol);
+		mixBlockSSE2(obuf + 8, _mm_unpackhi_epi16(samples, samples), vol);
+		in += 8;
+		obuf += 16;
+	}
+	mixMonoC(obuf, in, count, vol_l, vol_r);
+}
+
+static void mixStereoSSE2(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m128i vol = _mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+	for (; count >= 4; count -= 4) {
+		mixBlockSSE2(obuf, _mm_loadu_si128((const __m128i *)in), vol);
+		in += 8;
+		obuf += 8;
+	}
+	mixStereoC(obuf, in, count, vol_l, vol_r);
+}
+
+static void mixStereoReverseSSE2(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m128i vol = _mm_set_epi16(vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r);
+	for (; count >= 4; count -= 4) {
+		__m128i samples = _mm_loadu_si128((const __m128i *)in);
+		samples = _mm_shufflehi_epi16(_mm_shufflelo_epi16(samples, 0xB1), 0xB1);
+		mixBlockSSE2(obuf, samples, vol);
+		in += 8;
+		obuf += 8;
+	}
+	mixStereoReverseC(obuf, in, count, vol_l, vol_r);
+}
+
+static const MixKernels s_mixKernelsSSE2 = {
+	"sse2", mixMonoSSE2, mixStereoSSE2, mixStereoReverseSSE2
+};
+
+#endif // RATE_USE_SSE2
+
+#ifdef RATE_USE_AVX2
+
+#define RATE_AVX2_TARGET __attribute__((target("avx2")))
+
+static inline RATE_AVX2_TARGET __m256i scaleAVX2(__m256i in, __m256i vol) {
+	// unpack and pack both work per 128 bit lane, so the order is preserved
+	const __m256i lo = _mm256_mullo_epi16(in, vol);
+	const __m256i hi = _mm256_mulhi_epi16(in, vol);
+	const __m256i bias = _mm256_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+	__m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+	__m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+	p0 = _mm256_srai_epi32(_mm256_add_epi32(p0, _mm256_and_si256(_mm256_srai_epi32(p0, 31), bias)), 8);
+	p1 = _mm256_srai_epi32(_mm256_add_epi32(p1, _mm256_and_si256(_mm256_srai_epi32(p1, 31), bias)), 8);
+	return _mm256_packs_epi32(p0, p1);
+}
+
+static inline RATE_AVX2_TARGET void mixBlockAVX2(st_sample_t *obuf, __m256i in, __m256i vol) {
+	const __m256i out = _mm256_loadu_si256((const __m256i *)obuf);
+	_mm256_storeu_si256((__m256i *)obuf, _mm256_adds_epi16(out, scaleAVX2(in, vol)));
+}
+
+static RATE_AVX2_TARGET void mixMonoAVX2(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m256i vol = _mm256_set1_epi32((vol_r << 16) | vol_l);
+	for (; count >= 16; count -= 16) {
+		const __m256i samples = _mm256_loadu_si256((const __m256i *)in);
+		// Duplicate each sample: lane crossing is needed to keep the order
+		const __m256i ordered = _mm256_permute4x64_epi64(samples, 0xD8);
+		mixBlockAVX2(obuf, _mm256_unpacklo_epi16(ordered, ordered), vol);
+		mixBlockAVX2(obuf + 16, _mm256_unpackhi_epi16(ordered, ordered), vol);
+		in += 16;
+		obuf += 32;
+	}
+	mixMonoSSE2(obuf, in, count, vol_l, vol_r);
+}
+
+static RATE_AVX2_TARGET void mixStereoAVX2(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m256i vol = _mm256_set1_epi32((vol_r << 16) | vol_l);
+	for (; count >= 8; count -= 8) {
+		mixBlockAVX2(obuf, _mm256_loadu_si256((const __m256i *)in), vol);
+		in += 16;
+		obuf += 16;
+	}
+	mixStereoSSE2(obuf, in, count, vol_l, vol_r);
+}
+
+static RATE_AVX2_TARGET void mixStereoReverseAVX2(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m256i vol = _mm256_set1_epi32((vol_l << 16) | vol_r);
+	for (; count >= 8; count -= 8) {
+		__m256i samples = _mm256_loadu_si256((const __m256i *)in);
+		samples = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(samples, 0xB1), 0xB1);
+		mixBlockAVX2(obuf, samples, vol);
+		in += 16;
+		obuf += 16;
+	}
+	mixStereoReverseSSE2(obuf, in, count, vol_l, vol_r);
+}
+
+static const MixKernels s_mixKernelsAVX2 = {
+	"avx2", mixMonoAVX2, mixStereoAVX2, mixStereoReverseAVX2
+};
+
+#undef RATE_AVX2_TARGET
+
+#endif // RATE_USE_AVX2
+
+#ifdef RATE_USE_NEON
+
+static inline int16x4_t scaleNEON(int16x4_t in, int16x4_t vol) {
+	int32x4_t p = vmull_s16(in, vol);
+	p = vaddq_s32(p, vandq_s32(vshrq_n_s32(p, 31), vdupq_n_s32(Audio::Mixer::kMaxMixerVolume - 1)));
+	return vqmovn_s32(vshrq_n_s32(p, 8));
+}
+
+static inline void mixBlockNEON(st_sample_t *obuf, int16x8_t in, int16x4_t vol) {
+	const int16x8_t scaled = vcombine_s16(scaleNEON(vget_low_s16(in), vol), scaleNEON(vget_high_s16(in), vol));
+	vst1q_s16(obuf, vqaddq_s16(vld1q_s16(obuf), scaled));
+}
+
+static void mixMonoNEON(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	const int16_t volArray[4] = { (int16_t)vol_l, (int16_t)vol_r, (int16_t)vol_l, (int16_t)vol_r };
+	const int16x4_t vol = vld1_s16(volArray);
+	for (; count >= 8; count -= 8) {
+		const int16x8x2_t samples = vzipq_s16(vld1q_s16(in), vld1q_s16(in));
+		mixBlockNEON(obuf, samples.val[0], vol);
+		mixBlockNEON(obuf + 8, samples.val[1], vol);
+		in += 8;
+		obuf += 16;
+	}
+	mixMonoC(obuf, in, count, vol_l, vol_r);
+}
+
+static void mixStereoNEON(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	const int16_t volArray[4] = { (int16_t)vol_l, (int16_t)vol_r, (int16_t)vol_l, (int16_t)vol_r };
+	const int16x4_t vol = vld1_s16(volArray);
+	for (; count >= 4; count -= 4) {
+		mixBlockNEON(obuf, vld1q_s16(in), vol);
+		in += 8;
+		obuf += 8;
+	}
+	mixStereoC(obuf, in, count, vol_l, vol_r);
+}
+
+static void mixStereoReverseNEON(st_sample_t *obuf, const st_sample_t *in, uint count, st_volume_t vol_l, st_volume_t vol_r) {
+	const int16_t volArray[4] = { (int16_t)vol_r, (int16_t)vol_l, (int16_t)vol_r, (int16_t)vol_l };
+	const int16x4_t vol = vld1_s16(volArray);
+	for (; count >= 4; count -= 4) {
+		mixBlockNEON(obuf, vrev32q_s16(vld1q_s16(in)), vol);
+		in += 8;
+		obuf += 8;
+	}
+	mixStereoReverseC(obuf, in, count, vol_l, vol_r);
+}
+
+static const MixKernels s_mixKernelsNEON = {
+	"neon", mixMonoNEON, mixStereoNEON, mixStereoReverseNEON
+};
+
+#endif // RATE_USE_NEON
+
+static bool s_allowSIMD = true;
+
+/**
+ * Pick the fastest set of mixing kernels the CPU we run on supports.
+ */
+static const MixKernels *getMixKernels() {
+	if (!s_allowSIMD)
+		return &s_mixKernelsC;
+
+#ifdef RATE_USE_AVX2
+	if (__builtin_cpu_supports("avx2"))
+		return &s_mixKernelsAVX2;
+#endif
+#ifdef RATE_USE_SSE2
+	return &s_mixKernelsSSE2;
+#elif defined(RATE_USE_NEON)
+	return &s_mixKernelsNEON;
+#else
+	return &s_mixKernelsC;
+#endif
+}
+
+void setRateConverterSIMD(bool enable) {
+	s_allowSIMD = enable;
+}
+
+const char *getRateConverterKernelName() {
+	return getMixKernels()->name;
+}
+
+
+#pragma mark -
+#pragma mark --- Rate converters ---
+#pragma mark -
+
 
 /**
  * Audio rate converter based on simple resampling. Used when no
@@ -67,6 +363,8 @@ protected:
 	/** fractional position increment in the output stream */
 	long opos_inc;
 
+	const MixKernels *_kernels;
+
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
@@ -95,6 +393,8 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
 	opos_inc = inrate / outrate;
 
 	inLen = 0;
+
+	_kernels = getMixKernels();
 }
 
 /*
@@ -104,42 +404,59 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
 template<bool stereo, bool reverseStereo>
 int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 	st_sample_t *ostart, *oend;
+	// Resampled data in output channel order, mono data is kept mono
+	st_sample_t block[MIX_BLOCK_SIZE * (stereo ? 2 : 1)];
+	bool endOfInput = false;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
+	while (obuf < oend && !endOfInput) {
+		st_sample_t *bptr = block;
+		st_sample_t *bend = block + MIN<st_size_t>((oend - obuf) / 2, MIX_BLOCK_SIZE) * (stereo ? 2 : 1);
+
+		while (bptr < bend) {
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			if (endOfInput)
+				break;
 
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
+			if (stereo) {
+				bptr[reverseStereo    ] = *inPtr++;
+				bptr[reverseStereo ^ 1] = *inPtr++;
+				bptr += 2;
+			} else {
+				*bptr++ = *inPtr++;
 			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
-
-		// Increment output position
-		opos += opos_inc;
-
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			// Increment output position
+			opos += opos_inc;
+		}
 
-		obuf += 2;
+		const uint count = (bptr - block) / (stereo ? 2 : 1);
+		if (!stereo)
+			_kernels->mixMono(obuf, block, count, vol_l, vol_r);
+		else if (reverseStereo)
+			_kernels->mixStereo(obuf, block, count, vol_r, vol_l);
+		else
+			_kernels->mixStereo(obuf, block, count, vol_l, vol_r);
+		obuf += count * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -173,6 +490,8 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	const MixKernels *_kernels;
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
@@ -204,6 +523,8 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
 	icur0 = icur1 = 0;
 
 	inLen = 0;
+
+	_kernels = getMixKernels();
 }
 
 /*
@@ -213,52 +534,67 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
 template<bool stereo, bool reverseStereo>
 int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 	st_sample_t *ostart, *oend;
+	// Interpolated data in output channel order, mono data is kept mono
+	st_sample_t block[MIX_BLOCK_SIZE * (stereo ? 2 : 1)];
+	bool endOfInput = false;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+	while (obuf < oend && !endOfInput) {
+		st_sample_t *bptr = block;
+		st_sample_t *bend = block + MIN<st_size_t>((oend - obuf) / 2, MIX_BLOCK_SIZE) * (stereo ? 2 : 1);
+
+		while (bptr < bend) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE;
 			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+
+			if (endOfInput)
+				break;
+
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the block.
+			while (opos < (frac_t)FRAC_ONE && bptr < bend) {
+				// interpolate
+				if (stereo) {
+					bptr[reverseStereo    ] = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF) >> FRAC_BITS));
+					bptr[reverseStereo ^ 1] = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF) >> FRAC_BITS));
+					bptr += 2;
+				} else {
+					*bptr++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF) >> FRAC_BITS));
+				}
+
+				// Increment output position
+				opos += opos_inc;
 			}
-			opos -= FRAC_ONE;
 		}
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF) >> FRAC_BITS));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF) >> FRAC_BITS)) :
-						  out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-
-			// Increment output position
-			opos += opos_inc;
-		}
+		const uint count = (bptr - block) / (stereo ? 2 : 1);
+		if (!stereo)
+			_kernels->mixMono(obuf, block, count, vol_l, vol_r);
+		else if (reverseStereo)
+			_kernels->mixStereo(obuf, block, count, vol_r, vol_l);
+		else
+			_kernels->mixStereo(obuf, block, count, vol_l, vol_r);
+		obuf += count * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -274,8 +610,9 @@ template<bool stereo, bool reverseStereo>
 class CopyRateConverter : public RateConverter {
 	st_sample_t *_buffer;
 	st_size_t _bufferSize;
+	const MixKernels *_kernels;
 public:
-	CopyRateConverter() : _buffer(0), _bufferSize(0) {}
+	CopyRateConverter() : _buffer(0), _bufferSize(0), _kernels(getMixKernels()) {}
 	~CopyRateConverter() {
 		free(_buffer);
 	}
@@ -283,11 +620,6 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
-		st_size_t len;
-
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -302,38 +634,438 @@ public:
 			error("[CopyRateConverter::flow] Cannot allocate memory for temp buffer");
 
 		// Read up to 'osamp' samples into our temporary buffer
-		len = input.readBuffer(_buffer, osamp);
+		const int len = input.readBuffer(_buffer, osamp);
+		if (len <= 0)
+			return 0;
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
+		const uint count = len / (stereo ? 2 : 1);
+		if (!stereo)
+			_kernels->mixMono(obuf, _buffer, count, vol_l, vol_r);
+		else if (reverseStereo)
+			_kernels->mixStereoReverse(obuf, _buffer, count, vol_l, vol_r);
+		else
+			_kernels->mixStereo(obuf, _buffer, count, vol_l, vol_r);
+		return count;
+	}
+
+	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+
+#pragma mark -
+#pragma mark --- Windowed sinc resampler ---
+#pragma mark -
+
+/**
+ * The sinc filter is tabulated for this many fractional positions (phases)
+ * between two input samples. The coefficients for positions in between two
+ * phases are interpolated linearly.
+ */
+#define SINC_PHASE_BITS 8
+#define SINC_PHASES (1 << SINC_PHASE_BITS)
+
+/** Number of filter taps when upsampling; downsampling needs more. */
+#define SINC_BASE_TAPS 32
+#define SINC_MAX_TAPS 128
+
+/** Scale of the fixed point coefficients. */
+#define SINC_COEF_BITS 14
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+/** Kaiser window parameter, trading transition width for stop band attenuation. */
+#define SINC_KAISER_BETA 8.0
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+/**
+ * Tabulated windowed sinc filter. Coefficients are stored per phase, for
+ * phase 0 up to and including SINC_PHASES, with taps coefficients each.
+ */
+struct SincFilterBank {
+	int taps;
+	int cutoff;				///< in 1/10000 of the input sample rate
+	int16 *fixedCoefs;
+	float *floatCoefs;
+};
 
-			obuf += 2;
+static double besselI0(double x) {
+	// Power series, converges quickly for the arguments used here
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; ++k) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+static SincFilterBank *createSincFilterBank(int taps, int cutoff) {
+	SincFilterBank *bank = new SincFilterBank;
+	bank->taps = taps;
+	bank->cutoff = cutoff;
+	bank->fixedCoefs = new int16[(SINC_PHASES + 1) * taps];
+	bank->floatCoefs = new float[(SINC_PHASES + 1) * taps];
+
+	const double fc = cutoff / 10000.0;
+	const double halfWidth = taps / 2;
+	const double windowScale = 1.0 / besselI0(SINC_KAISER_BETA);
+	double coefs[SINC_MAX_TAPS];
+
+	for (int phase = 0; phase <= SINC_PHASES; ++phase) {
+		double sum = 0;
+		for (int k = 0; k < taps; ++k) {
+			// Distance of this tap from the interpolated position, in input samples
+			const double t = halfWidth - 1 + (double)phase / SINC_PHASES - k;
+			const double u = t / halfWidth;
+			const double x = 2 * fc * t;
+
+			double c = (x == 0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+			c *= (u <= -1 || u >= 1) ? 0.0 : besselI0(SINC_KAISER_BETA * sqrt(1 - u * u)) * windowScale;
+			coefs[k] = c;
+			sum += c;
+		}
+
+		// Normalize every phase to unity gain, so that a constant signal
+		// comes out unchanged. The rounding error of the fixed point
+		// coefficients is put on the center tap.
+		int fixedSum = 0;
+		for (int k = 0; k < taps; ++k) {
+			const double c = coefs[k] / sum;
+			bank->floatCoefs[phase * taps + k] = (float)c;
+			bank->fixedCoefs[phase * taps + k] = (int16)floor(c * (1 << SINC_COEF_BITS) + 0.5);
+			fixedSum += bank->fixedCoefs[phase * taps + k];
 		}
-		return (obuf - ostart) / 2;
+		bank->fixedCoefs[phase * taps + taps / 2 - 1 + (phase + SINC_PHASES / 2) / SINC_PHASES] += (1 << SINC_COEF_BITS) - fixedSum;
 	}
 
-	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+	return bank;
+}
+
+static void destroySincFilterBank(SincFilterBank *bank) {
+	delete[] bank->fixedCoefs;
+	delete[] bank->floatCoefs;
+	delete bank;
+}
+
+/**
+ * Filter banks are shared by all converters using the same filter and live
+ * until the program exits. Rate converters are created from different
+ * threads, so slots are claimed atomically.
+ */
+static SincFilterBank *volatile s_sincFilterBanks[8];
+
+static const SincFilterBank *getSincFilterBank(int taps, int cutoff, bool &owned) {
+	owned = false;
+
+	for (int i = 0; i < ARRAYSIZE(s_sincFilterBanks); ++i) {
+		SincFilterBank *bank = Common::atomicLoad(s_sincFilterBanks[i]);
+		if (!bank) {
+			bank = createSincFilterBank(taps, cutoff);
+			if (Common::atomicCompareAndSwap(s_sincFilterBanks[i], (SincFilterBank *)0, bank))
+				return bank;
+
+			// Another thread claimed the slot first
+			destroySincFilterBank(bank);
+			bank = Common::atomicLoad(s_sincFilterBanks[i]);
+		}
+
+		if (bank->taps == taps && bank->cutoff == cutoff)
+			return bank;
+	}
+
+	// All slots taken by other filters, use a private one
+	owned = true;
+	return createSincFilterBank(taps, cutoff);
+}
+
+// Dot products of filter coefficients and samples; taps is always a
+// multiple of 8.
+
+static int32 sincDotFixed(const int16 *coefs, const int16 *samples, int taps) {
+#if defined(RATE_USE_SSE2)
+	__m128i sum = _mm_setzero_si128();
+	for (int k = 0; k < taps; k += 8) {
+		const __m128i c = _mm_loadu_si128((const __m128i *)(coefs + k));
+		const __m128i x = _mm_loadu_si128((const __m128i *)(samples + k));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(c, x));
+	}
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+	return _mm_cvtsi128_si32(sum);
+#elif defined(RATE_USE_NEON)
+	int32x4_t sum = vdupq_n_s32(0);
+	for (int k = 0; k < taps; k += 8) {
+		const int16x8_t c = vld1q_s16(coefs + k);
+		const int16x8_t x = vld1q_s16(samples + k);
+		sum = vmlal_s16(sum, vget_low_s16(c), vget_low_s16(x));
+		sum = vmlal_s16(sum, vget_high_s16(c), vget_high_s16(x));
+	}
+	const int32x2_t half = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	return vget_lane_s32(vpadd_s32(half, half), 0);
+#else
+	int32 sum = 0;
+	for (int k = 0; k < taps; ++k)
+		sum += coefs[k] * samples[k];
+	return sum;
+#endif
+}
+
+static float sincDotFloat(const float *coefs, const float *samples, int taps) {
+#if defined(RATE_USE_SSE2)
+	__m128 sum0 = _mm_setzero_ps();
+	__m128 sum1 = _mm_setzero_ps();
+	for (int k = 0; k < taps; k += 8) {
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coefs + k), _mm_loadu_ps(samples + k)));
+		sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(coefs + k + 4), _mm_loadu_ps(samples + k + 4)));
+	}
+	sum0 = _mm_add_ps(sum0, sum1);
+	sum0 = _mm_add_ps(sum0, _mm_movehl_ps(sum0, sum0));
+	sum0 = _mm_add_ss(sum0, _mm_shuffle_ps(sum0, sum0, 0x55));
+	return _mm_cvtss_f32(sum0);
+#elif defined(RATE_USE_NEON)
+	float32x4_t sum = vdupq_n_f32(0);
+	for (int k = 0; k < taps; k += 8) {
+		sum = vmlaq_f32(sum, vld1q_f32(coefs + k), vld1q_f32(samples + k));
+		sum = vmlaq_f32(sum, vld1q_f32(coefs + k + 4), vld1q_f32(samples + k + 4));
+	}
+	const float32x2_t half = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+	return vget_lane_f32(vpadd_f32(half, half), 0);
+#else
+	float sum = 0;
+	for (int k = 0; k < taps; ++k)
+		sum += coefs[k] * samples[k];
+	return sum;
+#endif
+}
+
+/**
+ * Arithmetic of the sinc resampler, in a fixed point (int16) and a floating
+ * point (float) flavor.
+ */
+template<typename T>
+struct SincArithmetic;
+
+template<>
+struct SincArithmetic<int16> {
+	typedef int32 Sum;
+
+	static const int16 *getCoefs(const SincFilterBank *bank) { return bank->fixedCoefs; }
+	static int16 fromSample(st_sample_t sample) { return sample; }
+	static Sum dot(const int16 *coefs, const int16 *samples, int taps) { return sincDotFixed(coefs, samples, taps); }
+
+	static st_sample_t interpolate(Sum y0, Sum y1, uint frac) {
+		// Drop all but 4 fractional bits first, so the product cannot overflow
+		const int a = y0 >> (SINC_COEF_BITS - 4);
+		const int b = y1 >> (SINC_COEF_BITS - 4);
+		const int y = (a + (((b - a) * (int)frac) >> (FRAC_BITS - SINC_PHASE_BITS)) + 8) >> 4;
+		return (st_sample_t)CLIP<int>(y, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+};
+
+template<>
+struct SincArithmetic<float> {
+	typedef float Sum;
+
+	static const float *getCoefs(const SincFilterBank *bank) { return bank->floatCoefs; }
+	static float fromSample(st_sample_t sample) { return sample; }
+	static Sum dot(const float *coefs, const float *samples, int taps) { return sincDotFloat(coefs, samples, taps); }
+
+	static st_sample_t interpolate(Sum y0, Sum y1, uint frac) {
+		const float y = y0 + (y1 - y0) * (frac * (1.0f / (1 << (FRAC_BITS - SINC_PHASE_BITS))));
+		return (st_sample_t)CLIP<int>((int)floor(y + 0.5f), ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+};
+
+/**
+ * Audio rate converter based on a windowed sinc (polyphase FIR) filter.
+ * Much better quality than the other converters, at a higher, but bounded
+ * cost: every output sample takes two dot products over the filter taps
+ * (SINC_BASE_TAPS when upsampling, proportionally more when downsampling).
+ *
+ * The input is kept in per channel history buffers, converted to the type
+ * T used for the arithmetic (int16 or float).
+ */
+template<bool stereo, bool reverseStereo, typename T>
+class SincRateConverter : public RateConverter {
+protected:
+	typedef SincArithmetic<T> Arithmetic;
+
+	enum {
+		HISTORY_SIZE = SINC_MAX_TAPS + INTERMEDIATE_BUFFER_SIZE
+	};
+
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE * (stereo ? 2 : 1)];
+
+	/** input history, one buffer per channel */
+	T _history[stereo ? 2 : 1][HISTORY_SIZE];
+	/** number of valid frames in the history */
+	int _historyLen;
+	/** position of the first filter tap for the next output frame */
+	int _pos;
+
+	/** fractional position of the output stream in input stream unit */
+	frac_t _frac;
+	/** fractional position increment in the output stream */
+	frac_t _fracInc;
+
+	const SincFilterBank *_bank;
+	bool _ownsBank;
+	const T *_coefs;
+	int _taps;
+
+	const MixKernels *_kernels;
+
+	bool refill(AudioStream &input);
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate);
+	~SincRateConverter();
+
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
 };
 
+template<bool stereo, bool reverseStereo, typename T>
+SincRateConverter<stereo, reverseStereo, T>::SincRateConverter(st_rate_t inrate, st_rate_t outrate) {
+	if (inrate >= 65536 || outrate >= 65536) {
+		error("rate effect can only handle rates < 65536");
+	}
+
+	// When downsampling, the cutoff moves down to the output Nyquist
+	// frequency and the filter gets longer to keep the transition band
+	// equally steep.
+	const double ratio = MIN<double>(1.0, (double)outrate / inrate);
+	_taps = MIN<int>(((int)ceil(SINC_BASE_TAPS / ratio) + 7) & ~7, SINC_MAX_TAPS);
+	const int cutoff = (int)(4500 * ratio);
+
+	_bank = getSincFilterBank(_taps, cutoff, _ownsBank);
+	_coefs = Arithmetic::getCoefs(_bank);
+
+	_fracInc = (inrate << FRAC_BITS) / outrate;
+	_frac = 0;
+
+	// Start with silence in front of the first input sample, such that the
+	// first output sample is centered on it.
+	_historyLen = _taps / 2 - 1;
+	_pos = 0;
+	for (int ch = 0; ch < (stereo ? 2 : 1); ++ch) {
+		for (int i = 0; i < _historyLen; ++i)
+			_history[ch][i] = 0;
+	}
+
+	_kernels = getMixKernels();
+}
+
+template<bool stereo, bool reverseStereo, typename T>
+SincRateConverter<stereo, reverseStereo, T>::~SincRateConverter() {
+	if (_ownsBank)
+		destroySincFilterBank(const_cast<SincFilterBank *>(_bank));
+}
+
+/*
+ * Append input to the history, after discarding frames no longer needed.
+ * Returns false if the input stream has no more data.
+ */
+template<bool stereo, bool reverseStereo, typename T>
+bool SincRateConverter<stereo, reverseStereo, T>::refill(AudioStream &input) {
+	const int keep = _historyLen - _pos;
+	for (int ch = 0; ch < (stereo ? 2 : 1); ++ch)
+		memmove(_history[ch], _history[ch] + _pos, keep * sizeof(T));
+	_historyLen = keep;
+	_pos = 0;
+
+	const int frames = MIN<int>(HISTORY_SIZE - _historyLen, INTERMEDIATE_BUFFER_SIZE);
+	const int len = input.readBuffer(inBuf, frames * (stereo ? 2 : 1));
+	if (len <= 0)
+		return false;
+
+	const st_sample_t *inPtr = inBuf;
+	T *left = _history[0] + _historyLen;
+	T *right = _history[stereo ? 1 : 0] + _historyLen;
+	const int readFrames = len / (stereo ? 2 : 1);
+	for (int i = 0; i < readFrames; ++i) {
+		*left++ = Arithmetic::fromSample(*inPtr++);
+		if (stereo)
+			*right++ = Arithmetic::fromSample(*inPtr++);
+	}
+	_historyLen += readFrames;
+	return true;
+}
+
+template<bool stereo, bool reverseStereo, typename T>
+int SincRateConverter<stereo, reverseStereo, T>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t *ostart, *oend;
+	// Resampled data in output channel order, mono data is kept mono
+	st_sample_t block[MIX_BLOCK_SIZE * (stereo ? 2 : 1)];
+	bool endOfInput = false;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	while (obuf < oend && !endOfInput) {
+		st_sample_t *bptr = block;
+		st_sample_t *bend = block + MIN<st_size_t>((oend - obuf) / 2, MIX_BLOCK_SIZE) * (stereo ? 2 : 1);
+
+		while (bptr < bend) {
+			// Make sure all taps are covered by the history
+			while (_pos + _taps > _historyLen) {
+				if (!refill(input)) {
+					endOfInput = true;
+					break;
+				}
+			}
+
+			if (endOfInput)
+				break;
+
+			const uint phase = _frac >> (FRAC_BITS - SINC_PHASE_BITS);
+			const uint phaseFrac = _frac & ((1 << (FRAC_BITS - SINC_PHASE_BITS)) - 1);
+			const T *coefs0 = _coefs + phase * _taps;
+			const T *coefs1 = coefs0 + _taps;
+
+			const T *left = _history[0] + _pos;
+			const st_sample_t out0 = Arithmetic::interpolate(Arithmetic::dot(coefs0, left, _taps), Arithmetic::dot(coefs1, left, _taps), phaseFrac);
+
+			if (stereo) {
+				const T *right = _history[1] + _pos;
+				const st_sample_t out1 = Arithmetic::interpolate(Arithmetic::dot(coefs0, right, _taps), Arithmetic::dot(coefs1, right, _taps), phaseFrac);
+				bptr[reverseStereo    ] = out0;
+				bptr[reverseStereo ^ 1] = out1;
+				bptr += 2;
+			} else {
+				*bptr++ = out0;
+			}
+
+			// Increment output position
+			_frac += _fracInc;
+			_pos += _frac >> FRAC_BITS;
+			_frac &= FRAC_LO_MASK;
+		}
+
+		const uint count = (bptr - block) / (stereo ? 2 : 1);
+		if (!stereo)
+			_kernels->mixMono(obuf, block, count, vol_l, vol_r);
+		else if (reverseStereo)
+			_kernels->mixStereo(obuf, block, count, vol_r, vol_l);
+		else
+			_kernels->mixStereo(obuf, block, count, vol_l, vol_r);
+		obuf += count * 2;
+	}
+	return (obuf - ostart) / 2;
+}
+
 
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, ResamplerType type) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0) {
+		if (type == kResamplerSinc) {
+			return new SincRateConverter<stereo, reverseStereo, int16>(inrate, outrate);
+		} else if (type == kResamplerSincFloat) {
+			return new SincRateConverter<stereo, reverseStereo, float>(inrate, outrate);
+		} else if ((inrate % outrate) == 0) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -346,14 +1078,14 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplerType type) {
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, type);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, type);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, type);
 }
 
 } // End of namespace Audio
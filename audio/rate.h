@@ -78,7 +78,33 @@ public:
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+/**
+ * Resampling algorithms a RateConverter can use.
+ */
+enum ResamplerType {
+	kResamplerLinear,		///< Nearest sample or linear interpolation; fast, but aliases
+	kResamplerSinc,			///< Windowed sinc filter, fixed point arithmetic
+	kResamplerSincFloat		///< Windowed sinc filter, floating point arithmetic
+};
+
+/**
+ * Create a RateConverter converting from inrate to outrate. The type is only
+ * a preference; no resampling is done at all if the rates are equal.
+ */
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, ResamplerType type = kResamplerLinear);
+
+/**
+ * Allow or forbid the use of SIMD code (SSE2, AVX2, NEON) in rate converters
+ * created from now on. SIMD code is used by default whenever the CPU
+ * supports it; this is only meant for testing and benchmarking.
+ */
+void setRateConverterSIMD(bool enable);
+
+/**
+ * Returns a short name for the sample mixing code newly created rate
+ * converters use, e.g. "c" or "sse2".
+ */
+const char *getRateConverterKernelName();
 
 } // End of namespace Audio
 
@@ -436,7 +436,8 @@ public:
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplerType type) {
+	// Only the converters with hand written ARM code are available
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0) {
 			if (stereo) {
@@ -466,4 +467,12 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stere
 	}
 }
 
+void setRateConverterSIMD(bool enable) {
+	// The hand written ARM code is always used
+}
+
+const char *getRateConverterKernelName() {
+	return "arm-asm";
+}
+
 } // End of namespace Audio
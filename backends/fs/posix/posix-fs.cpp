@@ -30,6 +30,7 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
 
 #include "backends/fs/posix/posix-fs.h"
+#include "backends/fs/posix/posix-mmapstream.h"
 #include "backends/fs/stdiostream.h"
 #include "common/algorithm.h"
 
@@ -246,6 +247,16 @@ Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
 	return StdioStream::makeFromPath(getPath(), false);
 }
 
+Common::SeekableReadStream *POSIXFilesystemNode::createDataReadStream() {
+	// Prefer mapping the file, so that reading from it does not need to go
+	// through the stdio buffer
+	Common::SeekableReadStream *stream = PosixMmapStream::makeFromPath(getPath());
+	if (stream)
+		return stream;
+
+	return createReadStream();
+}
+
 Common::WriteStream *POSIXFilesystemNode::createWriteStream() {
 	return StdioStream::makeFromPath(getPath(), true);
 }
@@ -71,6 +71,7 @@ public:
 	virtual AbstractFSNode *getParent() const;
 
 	virtual Common::SeekableReadStream *createReadStream();
+	virtual Common::SeekableReadStream *createDataReadStream();
 	virtual Common::WriteStream *createWriteStream();
 
 private:
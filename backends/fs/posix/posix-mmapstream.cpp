@@ -0,0 +1,131 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if defined(POSIX) || defined(PLAYSTATION3)
+
+// Re-enable some forbidden symbols to avoid clashes with stat.h and unistd.h
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_mkdir
+#define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
+
+#include "backends/fs/posix/posix-mmapstream.h"
+
+#include <unistd.h>
+
+#if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#define POSIX_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+enum {
+	/**
+	 * Files smaller than this are read through stdio: the few small reads
+	 * done on them are cheaper than setting up a mapping.
+	 */
+	MMAP_MIN_FILE_SIZE = 64 * 1024,
+
+	/**
+	 * Files larger than this (e.g. CD images) are read through stdio, to
+	 * avoid using up the address space of 32 bit systems.
+	 */
+	MMAP_MAX_FILE_SIZE = 256 * 1024 * 1024
+};
+
+PosixMmapStream::PosixMmapStream(const byte *data, uint32 size)
+	: _data(data), _size(size), _pos(0), _eos(false) {
+	assert(data);
+}
+
+PosixMmapStream::~PosixMmapStream() {
+#ifdef POSIX_HAS_MMAP
+	munmap(const_cast<byte *>(_data), _size);
+#endif
+}
+
+bool PosixMmapStream::seek(int32 offs, int whence) {
+	switch (whence) {
+	case SEEK_END:
+		offs += _size;
+		break;
+	case SEEK_CUR:
+		offs += _pos;
+		break;
+	}
+
+	// Like with fseek, seeking beyond the end is fine, reading there is not
+	if (offs < 0)
+		return false;
+
+	_pos = offs;
+	_eos = false;
+	return true;
+}
+
+uint32 PosixMmapStream::read(void *dataPtr, uint32 dataSize) {
+	const uint32 available = (_pos < (int32)_size) ? _size - _pos : 0;
+	if (dataSize > available) {
+		dataSize = available;
+		_eos = true;
+	}
+
+	memcpy(dataPtr, _data + _pos, dataSize);
+	_pos += dataSize;
+
+	return dataSize;
+}
+
+const byte *PosixMmapStream::readInPlace(uint32 size) {
+	if (_pos > (int32)_size || size > _size - _pos)
+		return 0;
+
+	const byte *data = _data + _pos;
+	_pos += size;
+
+	return data;
+}
+
+PosixMmapStream *PosixMmapStream::makeFromPath(const Common::String &path) {
+#ifdef POSIX_HAS_MMAP
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return 0;
+
+	struct stat st;
+	void *data = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+	    st.st_size >= MMAP_MIN_FILE_SIZE && st.st_size <= MMAP_MAX_FILE_SIZE) {
+		data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+
+	// The mapping stays valid after closing the file
+	close(fd);
+
+	if (data != MAP_FAILED)
+		return new PosixMmapStream((const byte *)data, st.st_size);
+#endif
+	return 0;
+}
+
+#endif
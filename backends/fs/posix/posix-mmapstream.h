@@ -0,0 +1,73 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_MMAPSTREAM_H
+#define BACKENDS_FS_POSIX_MMAPSTREAM_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+#include "common/stream.h"
+#include "common/str.h"
+
+/**
+ * Read stream on a file which is mapped into memory as a whole, via mmap().
+ *
+ * Compared to StdioStream, reads do not go through the stdio buffer, and
+ * the file contents are available through getData() and readInPlace()
+ * without any copying. The file must not be truncated while it is mapped,
+ * reads would fault otherwise. So this is only used for game data files,
+ * which are never written to, see POSIXFilesystemNode::createDataReadStream().
+ */
+class PosixMmapStream : public Common::SeekableReadStream, public Common::NonCopyable {
+protected:
+	const byte *_data;
+	uint32 _size;
+	int32 _pos;
+	bool _eos;
+
+	PosixMmapStream(const byte *data, uint32 size);
+
+public:
+	/**
+	 * Given a path, map the file at that path and wrap it in a
+	 * PosixMmapStream instance. Returns 0 if mapping is not supported on
+	 * this system, fails, or does not pay off for the size of the file (in
+	 * which case the caller should fall back to StdioStream).
+	 */
+	static PosixMmapStream *makeFromPath(const Common::String &path);
+
+	virtual ~PosixMmapStream();
+
+	/** Return the contents of the file. */
+	const byte *getData() const { return _data; }
+
+	virtual bool eos() const { return _eos; }
+	virtual void clearErr() { _eos = false; }
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offs, int whence = SEEK_SET);
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+	virtual const byte *readInPlace(uint32 size);
+};
+
+#endif
@@ -192,6 +192,8 @@ void registerDefaults() {
 	ConfMan.registerDefault("mt32_device", "null");
 	ConfMan.registerDefault("gm_device", "null");
 
+	ConfMan.registerDefault("resampler", "linear");
+
 	ConfMan.registerDefault("cdrom", 0);
 
 	ConfMan.registerDefault("enable_unsupported_game_warning", true);
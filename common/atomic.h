@@ -0,0 +1,157 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedCompareExchange)
+#pragma intrinsic(_InterlockedCompareExchangePointer)
+#pragma intrinsic(_InterlockedExchangeAdd)
+#endif
+
+namespace Common {
+
+/**
+ * Minimal set of atomic primitives, for the few places where two threads
+ * exchange data without going through a Common::Mutex (e.g. the audio
+ * thread, which must never block on the engine thread).
+ *
+ * All operations act as full memory barriers. On compilers for which we
+ * know no barrier primitive, they degrade to plain volatile accesses,
+ * which is sufficient on the single core targets such compilers are
+ * used for.
+ */
+
+/**
+ * Issue a full memory barrier: no load or store may be reordered across it,
+ * neither by the compiler nor by the CPU.
+ */
+inline void memoryBarrier() {
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+	__sync_synchronize();
+#elif defined(_MSC_VER)
+	long barrier = 0;
+	_InterlockedCompareExchange(&barrier, 0, 0);
+#endif
+}
+
+/**
+ * Tell the CPU that the caller is busy-waiting, e.g. in a spin lock. This
+ * frees resources for a hyper-thread sibling and saves power. It does not
+ * give up the time slice.
+ */
+inline void cpuRelax() {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	__asm__ __volatile__("pause");
+#elif defined(__GNUC__) && (defined(__aarch64__) || (defined(__ARM_ARCH) && __ARM_ARCH >= 7))
+	__asm__ __volatile__("yield");
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	_mm_pause();
+#endif
+}
+
+/**
+ * Read a variable shared with another thread. Loads and stores issued after
+ * this call are guaranteed to observe memory at least as new as the value
+ * read.
+ */
+template<typename T>
+inline T atomicLoad(const volatile T &var) {
+	memoryBarrier();
+	const T value = var;
+	memoryBarrier();
+	return value;
+}
+
+/**
+ * Write a variable shared with another thread. All loads and stores issued
+ * before this call are completed before the new value becomes visible.
+ */
+template<typename T>
+inline void atomicStore(volatile T &var, T value) {
+	memoryBarrier();
+	var = value;
+	memoryBarrier();
+}
+
+/**
+ * Atomically replace the value of var by newValue, if and only if it
+ * currently equals oldValue.
+ *
+ * @return true if the value was replaced
+ */
+inline bool atomicCompareAndSwap(volatile int32 &var, int32 oldValue, int32 newValue) {
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+	return __sync_bool_compare_and_swap(&var, oldValue, newValue);
+#elif defined(_MSC_VER)
+	return _InterlockedCompareExchange((volatile long *)&var, newValue, oldValue) == oldValue;
+#else
+	if (var != oldValue)
+		return false;
+	var = newValue;
+	return true;
+#endif
+}
+
+/**
+ * Atomically add delta to var.
+ *
+ * @return the new value of var
+ */
+inline int32 atomicAdd(volatile int32 &var, int32 delta) {
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+	return __sync_add_and_fetch(&var, delta);
+#elif defined(_MSC_VER)
+	return _InterlockedExchangeAdd((volatile long *)&var, delta) + delta;
+#else
+	var += delta;
+	return var;
+#endif
+}
+
+/**
+ * Atomically replace the pointer var by newValue, if and only if it
+ * currently equals oldValue.
+ *
+ * @return true if the pointer was replaced
+ */
+template<class T>
+inline bool atomicCompareAndSwap(T *volatile &var, T *oldValue, T *newValue) {
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+	return __sync_bool_compare_and_swap(&var, oldValue, newValue);
+#elif defined(_MSC_VER)
+	return _InterlockedCompareExchangePointer((void *volatile *)&var, newValue, oldValue) == oldValue;
+#else
+	if (var != oldValue)
+		return false;
+	var = newValue;
+	return true;
+#endif
+}
+
+} // End of namespace Common
+
+#endif
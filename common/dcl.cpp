@@ -21,7 +21,7 @@
  */
 
 #include "common/dcl.h"
-#include "common/debug.h"
+#include "common/endian.h"
 #include "common/memstream.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
@@ -30,9 +30,28 @@ namespace Common {
 
 class DecompressorDCL {
 public:
+	DecompressorDCL() : _srcData(0) {}
+	~DecompressorDCL() { delete[] _srcData; }
+
 	bool unpack(ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
+	enum {
+		kLookupBits = 8
+	};
+
+	/**
+	 * Result of walking a Huffman tree along the next kLookupBits bits:
+	 * either a leaf is reached after 'length' bits, or (if length is
+	 * kLookupBits) decoding has to continue bit by bit at tree position
+	 * 'value'.
+	 */
+	struct LookupEntry {
+		uint16 value;
+		byte length;
+		bool leaf;
+	};
+
 	/**
 	 * Initialize decompressor.
 	 * @param src		source stream to read from
@@ -44,18 +63,25 @@ protected:
 	void init(ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 	/**
-	 * Get a number of bits from _src stream, starting with the least
-	 * significant unread bit of the current four byte block.
-	 * @param n		number of bits to get
+	 * Get a number of bits from the packed data, starting with the least
+	 * significant unread bit.
+	 * @param n		number of bits to get, at most 32
 	 * @return n-bits number
 	 */
-	uint32 getBitsLSB(int n);
+	uint32 getBitsLSB(int n) {
+		if (_nBits < n)
+			fetchBitsLSB();
+		uint32 ret = (uint32)_dwBits & ((1 << n) - 1);
+		_dwBits >>= n;
+		_nBits -= n;
+		return ret;
+	}
 
 	/**
-	 * Get one byte from _src stream.
+	 * Get one byte from the packed data.
 	 * @return byte
 	 */
-	byte getByteLSB();
+	byte getByteLSB() { return getBitsLSB(8); }
 
 	void fetchBitsLSB();
 
@@ -63,54 +89,49 @@ protected:
 	 * Write one byte into _dest stream
 	 * @param b byte to put
 	 */
-	void putByte(byte b);
+	void putByte(byte b) { _dest[_dwWrote++] = b; }
 
-	int huffman_lookup(const int *tree);
+	static void buildLookupTable(const int *tree, LookupEntry *table);
+	int huffman_lookup(const int *tree, const LookupEntry *table);
 
-	uint32 _dwBits;		///< bits buffer
+	uint64 _dwBits;		///< bits buffer
 	byte _nBits;		///< number of unread bits in _dwBits
 	uint32 _szPacked;	///< size of the compressed data
 	uint32 _szUnpacked;	///< size of the decompressed data
-	uint32 _dwRead;		///< number of bytes read from _src
+	uint32 _dwRead;		///< number of bytes taken from _srcData
 	uint32 _dwWrote;	///< number of bytes written to _dest
-	ReadStream *_src;
+	byte *_srcData;		///< the packed data, followed by padding
 	byte *_dest;
+
+	LookupEntry _lengthLookup[1 << kLookupBits];
+	LookupEntry _distanceLookup[1 << kLookupBits];
+	LookupEntry _asciiLookup[1 << kLookupBits];
 };
 
 void DecompressorDCL::init(ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
-	_src = src;
 	_dest = dest;
 	_szPacked = nPacked;
 	_szUnpacked = nUnpacked;
 	_nBits = 0;
 	_dwRead = _dwWrote = 0;
 	_dwBits = 0;
-}
-
-void DecompressorDCL::fetchBitsLSB() {
-	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << _nBits;
-		_nBits += 8;
-		_dwRead++;
-	}
-}
-
-uint32 DecompressorDCL::getBitsLSB(int n) {
-	// fetching more data to buffer if needed
-	if (_nBits < n)
-		fetchBitsLSB();
-	uint32 ret = (_dwBits & ~((~0) << n));
-	_dwBits >>= n;
-	_nBits -= n;
-	return ret;
-}
 
-byte DecompressorDCL::getByteLSB() {
-	return getBitsLSB(8);
+	// The packed data is followed by 8 zero bytes, so that the bit buffer
+	// can always be refilled with one 64 bit read. Missing data reads as
+	// zeroes as well.
+	delete[] _srcData;
+	_srcData = new byte[nPacked + 8];
+	const uint32 bytesRead = src->read(_srcData, nPacked);
+	memset(_srcData + bytesRead, 0, nPacked + 8 - bytesRead);
 }
 
-void DecompressorDCL::putByte(byte b) {
-	_dest[_dwWrote++] = b;
+void DecompressorDCL::fetchBitsLSB() {
+	// Fill the buffer up to 56 to 63 bits. The bits following the last full
+	// byte are loaded as well, and or'ed in again on the next refill.
+	if (_dwRead <= _szPacked)
+		_dwBits |= (((uint64)READ_LE_UINT32(_srcData + _dwRead + 4) << 32) | READ_LE_UINT32(_srcData + _dwRead)) << _nBits;
+	_dwRead += (63 - _nBits) >> 3;
+	_nBits |= 56;
 }
 
 #define HUFFMAN_LEAF 0x40000000
@@ -316,16 +337,40 @@ static const int ascii_tree[] = {
 	LN(509, 128)      LN(510, 26)
 };
 
-int DecompressorDCL::huffman_lookup(const int *tree) {
-	int pos = 0;
+void DecompressorDCL::buildLookupTable(const int *tree, LookupEntry *table) {
+	for (int bits = 0; bits < (1 << kLookupBits); bits++) {
+		int pos = 0;
+		int length = 0;
+
+		while (!(tree[pos] & HUFFMAN_LEAF) && length < kLookupBits) {
+			const int bit = (bits >> length) & 1;
+			pos = bit ? tree[pos] & 0xFFF : tree[pos] >> 12;
+			length++;
+		}
+
+		table[bits].leaf = (tree[pos] & HUFFMAN_LEAF) != 0;
+		table[bits].value = table[bits].leaf ? tree[pos] & 0xFFFF : pos;
+		table[bits].length = length;
+	}
+}
+
+int DecompressorDCL::huffman_lookup(const int *tree, const LookupEntry *table) {
+	if (_nBits < kLookupBits)
+		fetchBitsLSB();
+	const LookupEntry &entry = table[_dwBits & ((1 << kLookupBits) - 1)];
+	_dwBits >>= entry.length;
+	_nBits -= entry.length;
+
+	if (entry.leaf)
+		return entry.value;
 
+	// Only the longest codes of the ASCII tree get here
+	int pos = entry.value;
 	while (!(tree[pos] & HUFFMAN_LEAF)) {
 		int bit = getBitsLSB(1);
-		debug(8, "[%d]:%d->", pos, bit);
 		pos = bit ? tree[pos] & 0xFFF : tree[pos] >> 12;
 	}
 
-	debug(8, "=%02x\n", tree[pos] & 0xffff);
 	return tree[pos] & 0xFFFF;
 }
 
@@ -349,18 +394,21 @@ bool DecompressorDCL::unpack(ReadStream *src, byte *dest, uint32 nPacked, uint32
 	if (length_param < 3 || length_param > 6)
 		warning("Unexpected length_param value %d (expected in [3,6])", length_param);
 
+	buildLookupTable(length_tree, _lengthLookup);
+	buildLookupTable(distance_tree, _distanceLookup);
+	if (mode == DCL_ASCII_MODE)
+		buildLookupTable(ascii_tree, _asciiLookup);
+
 	while (_dwWrote < _szUnpacked) {
 		if (getBitsLSB(1)) { // (length,distance) pair
-			value = huffman_lookup(length_tree);
+			value = huffman_lookup(length_tree, _lengthLookup);
 
 			if (value < 8)
 				val_length = value + 2;
 			else
 				val_length = 8 + (1 << (value - 7)) + getBitsLSB(value - 7);
 
-			debug(8, " | ");
-
-			value = huffman_lookup(distance_tree);
+			value = huffman_lookup(distance_tree, _distanceLookup);
 
 			if (val_length == 2)
 				val_distance = (value << 2) | getBitsLSB(2);
@@ -368,8 +416,6 @@ bool DecompressorDCL::unpack(ReadStream *src, byte *dest, uint32 nPacked, uint32
 				val_distance = (value << length_param) | getBitsLSB(length_param);
 			val_distance ++;
 
-			debug(8, "\nCOPY(%d from %d)\n", val_length, val_distance);
-
 			if (val_length + _dwWrote > _szUnpacked) {
 				warning("DCL-INFLATE Error: Write out of bounds while copying %d bytes", val_length);
 				return false;
@@ -380,25 +426,22 @@ bool DecompressorDCL::unpack(ReadStream *src, byte *dest, uint32 nPacked, uint32
 				return false;
 			}
 
+			// Copy in chunks which do not overlap their source; when the
+			// distance is shorter than the length, the same chunk repeats
 			while (val_length) {
 				uint32 copy_length = (val_length > val_distance) ? val_distance : val_length;
 				assert(val_distance >= copy_length);
 				uint32 pos = _dwWrote - val_distance;
-				for (uint32 i = 0; i < copy_length; i++)
-					putByte(dest[pos + i]);
-
-				for (uint32 i = 0; i < copy_length; i++)
-					debug(9, "\33[32;31m%02x\33[37;37m ", dest[pos + i]);
-				debug(9, "\n");
+				memcpy(dest + _dwWrote, dest + pos, copy_length);
+				_dwWrote += copy_length;
 
 				val_length -= copy_length;
 				val_distance += copy_length;
 			}
 
 		} else { // Copy byte verbatim
-			value = (mode == DCL_ASCII_MODE) ? huffman_lookup(ascii_tree) : getByteLSB();
+			value = (mode == DCL_ASCII_MODE) ? huffman_lookup(ascii_tree, _asciiLookup) : getByteLSB();
 			putByte(value);
-			debug(9, "\33[32;31m%02x \33[37;37m", value);
 		}
 	}
 
@@ -68,7 +68,7 @@ bool File::open(const FSNode &node) {
 		return false;
 	}
 
-	SeekableReadStream *stream = node.createReadStream();
+	SeekableReadStream *stream = node.createDataReadStream();
 	return open(stream, node.getPath());
 }
 
@@ -141,6 +141,11 @@ uint32 File::read(void *ptr, uint32 len) {
 	return _handle->read(ptr, len);
 }
 
+const byte *File::readInPlace(uint32 size) {
+	assert(_handle);
+	return _handle->readInPlace(size);
+}
+
 
 DumpFile::DumpFile() : _handle(0) {
 }
@@ -126,6 +126,7 @@ public:
 	int32 size() const;	// implement abstract SeekableReadStream method
 	bool seek(int32 offs, int whence = SEEK_SET);	// implement abstract SeekableReadStream method
 	uint32 read(void *dataPtr, uint32 dataSize);	// implement abstract SeekableReadStream method
+	const byte *readInPlace(uint32 size);	// overload SeekableReadStream method
 };
 
 
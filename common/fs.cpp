@@ -139,6 +139,21 @@ SeekableReadStream *FSNode::createReadStream() const {
 	return _realNode->createReadStream();
 }
 
+SeekableReadStream *FSNode::createDataReadStream() const {
+	if (_realNode == 0)
+		return 0;
+
+	if (!_realNode->exists()) {
+		warning("FSNode::createDataReadStream: '%s' does not exist", getName().c_str());
+		return 0;
+	} else if (_realNode->isDirectory()) {
+		warning("FSNode::createDataReadStream: '%s' is a directory", getName().c_str());
+		return 0;
+	}
+
+	return _realNode->createDataReadStream();
+}
+
 WriteStream *FSNode::createWriteStream() const {
 	if (_realNode == 0)
 		return 0;
@@ -229,7 +244,7 @@ SeekableReadStream *FSDirectory::createReadStreamForMember(const String &name) c
 	FSNode *node = lookupCache(_fileCache, name);
 	if (!node)
 		return 0;
-	SeekableReadStream *stream = node->createReadStream();
+	SeekableReadStream *stream = node->createDataReadStream();
 	if (!stream)
 		warning("FSDirectory::createReadStreamForMember: Can't create stream for file '%s'", name.c_str());
 
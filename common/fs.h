@@ -214,6 +214,17 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStream() const;
 
+	/**
+	 * Creates a SeekableReadStream instance for a data file which is not
+	 * modified while the stream exists, like game data. The backend may
+	 * return a faster stream than createReadStream() for it, e.g. one on a
+	 * memory mapping. Do not use this for save games or other files which
+	 * may be written to meanwhile.
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	SeekableReadStream *createDataReadStream() const;
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
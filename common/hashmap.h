@@ -42,6 +42,20 @@
  */
 #define USE_HASHMAP_MEMORY_POOL
 
+/**
+ * @def USE_HASHMAP_SIZE_CLASS_POOL
+ * Enable the following define to let HashMaps allocate their nodes from the
+ * shared, thread-safe size class pools (see allocSmallChunk()) instead of a
+ * memory pool per HashMap. This lowers the memory usage of many small
+ * HashMaps, and makes the node allocations show up in the memory pool
+ * statistics.
+ */
+//#define USE_HASHMAP_SIZE_CLASS_POOL
+
+#ifdef USE_HASHMAP_SIZE_CLASS_POOL
+#undef USE_HASHMAP_MEMORY_POOL
+#endif
+
 
 #include "common/func.h"
 
@@ -49,7 +63,7 @@
 #include "common/debug.h"
 #endif
 
-#ifdef USE_HASHMAP_MEMORY_POOL
+#if defined(USE_HASHMAP_MEMORY_POOL) || defined(USE_HASHMAP_SIZE_CLASS_POOL)
 #include "common/memorypool.h"
 #endif
 
@@ -132,20 +146,26 @@ private:
 #endif
 
 	Node *allocNode(const Key &key) {
-#ifdef USE_HASHMAP_MEMORY_POOL
+#if defined(USE_HASHMAP_MEMORY_POOL)
 		return new (_nodePool) Node(key);
+#elif defined(USE_HASHMAP_SIZE_CLASS_POOL)
+		return new (allocSmallChunk(sizeof(Node))) Node(key);
 #else
 		return new Node(key);
 #endif
 	}
 
 	void freeNode(Node *node) {
-		if (node && node != HASHMAP_DUMMY_NODE)
-#ifdef USE_HASHMAP_MEMORY_POOL
+		if (node && node != HASHMAP_DUMMY_NODE) {
+#if defined(USE_HASHMAP_MEMORY_POOL)
 			_nodePool.deleteChunk(node);
+#elif defined(USE_HASHMAP_SIZE_CLASS_POOL)
+			node->~Node();
+			freeSmallChunk(node, sizeof(Node));
 #else
 			delete node;
 #endif
+		}
 	}
 
 	void assign(const HM_t &map);
@@ -24,6 +24,18 @@
 
 #include "common/list_intern.h"
 
+/**
+ * @def USE_LIST_SIZE_CLASS_POOL
+ * Enable the following define to let Lists allocate their nodes from the
+ * shared, thread-safe size class pools (see allocSmallChunk()) instead of
+ * the heap.
+ */
+//#define USE_LIST_SIZE_CLASS_POOL
+
+#ifdef USE_LIST_SIZE_CLASS_POOL
+#include "common/memorypool.h"
+#endif
+
 namespace Common {
 
 /**
@@ -194,7 +206,7 @@ public:
 		while (pos != &_anchor) {
 			Node *node = static_cast<Node *>(pos);
 			pos = pos->_next;
-			delete node;
+			freeNode(node);
 		}
 
 		_anchor._prev = &_anchor;
@@ -231,12 +243,29 @@ public:
 	}
 
 protected:
+	static Node *allocNode(const t_T &element) {
+#ifdef USE_LIST_SIZE_CLASS_POOL
+		return new (allocSmallChunk(sizeof(Node))) Node(element);
+#else
+		return new Node(element);
+#endif
+	}
+
+	static void freeNode(Node *node) {
+#ifdef USE_LIST_SIZE_CLASS_POOL
+		node->~Node();
+		freeSmallChunk(node, sizeof(Node));
+#else
+		delete node;
+#endif
+	}
+
 	NodeBase erase(NodeBase *pos) {
 		NodeBase n = *pos;
 		Node *node = static_cast<Node *>(pos);
 		n._prev->_next = n._next;
 		n._next->_prev = n._prev;
-		delete node;
+		freeNode(node);
 		return n;
 	}
 
@@ -244,7 +273,7 @@ protected:
 	 * Inserts element before pos.
 	 */
 	void insert(NodeBase *pos, const t_T &element) {
-		ListInternal::NodeBase *newNode = new Node(element);
+		ListInternal::NodeBase *newNode = allocNode(element);
 		assert(newNode);
 
 		newNode->_next = pos;
@@ -21,6 +21,8 @@
  */
 
 #include "common/memorypool.h"
+#include "common/atomic.h"
+#include "common/system.h"
 #include "common/util.h"
 
 namespace Common {
@@ -179,4 +181,224 @@ void MemoryPool::freeUnusedPages() {
 	}
 }
 
+#pragma mark -
+
+// The shared pools only ever hold their locks for a few instructions, so
+// spinning is cheaper than a Mutex, which would also need an OSystem to
+// be around (Strings are used long before and after that). Should the
+// holder have been preempted, spinning on is pointless though, so give up
+// the time slice after a while.
+
+enum {
+	kSpinsBeforeYield = 64
+};
+
+static void spinLock(volatile int32 &lock) {
+	uint spins = 0;
+	while (!atomicCompareAndSwap(lock, 0, 1)) {
+		if (++spins < kSpinsBeforeYield || !g_system) {
+			cpuRelax();
+		} else {
+			g_system->delayMillis(0);
+			spins = 0;
+		}
+	}
+}
+
+static void spinUnlock(volatile int32 &lock) {
+	atomicStore(lock, (int32)0);
+}
+
+// Registry of all SharedMemoryPool instances. Zero initialized, so that it
+// is usable during static initialization.
+static volatile int32 s_registryLock;
+static SharedMemoryPool *s_firstPool;
+
+SharedMemoryPool::SharedMemoryPool(const char *name, size_t chunkSize)
+	: _pool(chunkSize), _name(name), _lock(0), _returned(0), _allocations(0), _peak(0), _frees(0), _free(0) {
+
+	spinLock(s_registryLock);
+	_prevPool = 0;
+	_nextPool = s_firstPool;
+	if (s_firstPool)
+		s_firstPool->_prevPool = this;
+	s_firstPool = this;
+	spinUnlock(s_registryLock);
+}
+
+SharedMemoryPool::~SharedMemoryPool() {
+	spinLock(s_registryLock);
+	if (_prevPool)
+		_prevPool->_nextPool = _nextPool;
+	else
+		s_firstPool = _nextPool;
+	if (_nextPool)
+		_nextPool->_prevPool = _prevPool;
+	spinUnlock(s_registryLock);
+}
+
+void SharedMemoryPool::lock() {
+	spinLock(_lock);
+}
+
+void SharedMemoryPool::unlock() {
+	spinUnlock(_lock);
+}
+
+void *SharedMemoryPool::takeReturned() {
+	for (;;) {
+		void *head = atomicLoad(_returned);
+		if (!head || atomicCompareAndSwap(_returned, head, (void *)0))
+			return head;
+	}
+}
+
+void *SharedMemoryPool::allocChunk() {
+	lock();
+
+	// Reuse freed chunks first, then fall back to the underlying pool
+	if (!_free)
+		_free = takeReturned();
+
+	void *result;
+	if (_free) {
+		result = _free;
+		_free = *(void **)result;
+	} else {
+		result = _pool.allocChunk();
+	}
+
+	_allocations++;
+	const uint32 live = _allocations - (uint32)atomicLoad(_frees);
+	if (live > _peak)
+		_peak = live;
+
+	unlock();
+	return result;
+}
+
+void SharedMemoryPool::freeChunk(void *ptr) {
+	// Push the chunk onto _returned. Only whole lists are ever taken off
+	// it, so this is not subject to the ABA problem.
+	void *head;
+	do {
+		head = atomicLoad(_returned);
+		*(void **)ptr = head;
+	} while (!atomicCompareAndSwap(_returned, head, ptr));
+
+	atomicAdd(_frees, 1);
+}
+
+void SharedMemoryPool::freeUnusedPages() {
+	lock();
+
+	// Give all free chunks back to the underlying pool, which can then
+	// tell which of its pages are unused
+	void *chunk = takeReturned();
+	while (chunk) {
+		void *next = *(void **)chunk;
+		_pool.freeChunk(chunk);
+		chunk = next;
+	}
+
+	while (_free) {
+		void *next = *(void **)_free;
+		_pool.freeChunk(_free);
+		_free = next;
+	}
+
+	_pool.freeUnusedPages();
+
+	unlock();
+}
+
+SharedMemoryPool::Stats SharedMemoryPool::getStats() {
+	Stats stats;
+
+	lock();
+	stats.name = _name;
+	stats.chunkSize = _pool.getChunkSize();
+	stats.allocations = _allocations;
+	stats.live = _allocations - (uint32)atomicLoad(_frees);
+	stats.peak = _peak;
+	stats.pages = _pool.getPageCount();
+	unlock();
+
+	return stats;
+}
+
+uint SharedMemoryPool::getAllStats(Stats *stats, uint maxStats) {
+	uint count = 0;
+
+	spinLock(s_registryLock);
+	for (SharedMemoryPool *pool = s_firstPool; pool; pool = pool->_nextPool) {
+		if (count < maxStats)
+			stats[count] = pool->getStats();
+		count++;
+	}
+	spinUnlock(s_registryLock);
+
+	return count;
+}
+
+#pragma mark -
+
+enum {
+	NUM_SIZE_CLASSES = 10,
+	MAX_SMALL_CHUNK_SIZE = 256
+};
+
+static const size_t s_sizeClassSizes[NUM_SIZE_CLASSES] = {
+	8, 16, 24, 32, 48, 64, 96, 128, 192, 256
+};
+
+static const char *const s_sizeClassNames[NUM_SIZE_CLASSES] = {
+	"small 8", "small 16", "small 24", "small 32", "small 48",
+	"small 64", "small 96", "small 128", "small 192", "small 256"
+};
+
+/** Size class for each size up to MAX_SMALL_CHUNK_SIZE, in units of 8 bytes (rounded up). */
+static const byte s_sizeClassOfUnits[MAX_SMALL_CHUNK_SIZE / 8 + 1] = {
+	0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+	8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9
+};
+
+// Created on first use, to be independent of the static initialization
+// order. Never destroyed, since Strings may still be freed during static
+// destruction.
+static SharedMemoryPool *volatile s_sizeClassPools[NUM_SIZE_CLASSES];
+
+static SharedMemoryPool *getSizeClassPool(size_t size) {
+	const int sizeClass = s_sizeClassOfUnits[(size + 7) / 8];
+
+	SharedMemoryPool *pool = atomicLoad(s_sizeClassPools[sizeClass]);
+	if (!pool) {
+		pool = new SharedMemoryPool(s_sizeClassNames[sizeClass], s_sizeClassSizes[sizeClass]);
+		if (!atomicCompareAndSwap(s_sizeClassPools[sizeClass], (SharedMemoryPool *)0, pool)) {
+			// Another thread was quicker
+			delete pool;
+			pool = atomicLoad(s_sizeClassPools[sizeClass]);
+		}
+	}
+
+	return pool;
+}
+
+void *allocSmallChunk(size_t size) {
+	if (size > MAX_SMALL_CHUNK_SIZE)
+		return ::malloc(size);
+
+	return getSizeClassPool(size)->allocChunk();
+}
+
+void freeSmallChunk(void *ptr, size_t size) {
+	if (!ptr)
+		return;
+
+	if (size > MAX_SMALL_CHUNK_SIZE)
+		::free(ptr);
+	else
+		getSizeClassPool(size)->freeChunk(ptr);
+}
+
 } // End of namespace Common
@@ -94,6 +94,11 @@ public:
 	 * Return the chunk size used by this memory pool.
 	 */
 	size_t	getChunkSize() const { return _chunkSize; }
+
+	/**
+	 * Return the number of memory pages currently held by this pool.
+	 */
+	size_t	getPageCount() const { return _pages.size(); }
 };
 
 /**
@@ -141,6 +146,113 @@ public:
 	}
 };
 
+/**
+ * A memory pool for chunks of one size which may be used from several
+ * threads at once, and which keeps usage statistics.
+ *
+ * Chunks are taken from a MemoryPool, guarded by a spin lock. Freeing a
+ * chunk never takes that lock: freed chunks are pushed onto a lock-free
+ * list, which the allocating side takes over as a whole once it runs
+ * out of free chunks. So threads which only free (e.g. the audio thread
+ * releasing what the engine allocated) never wait.
+ *
+ * All live SharedMemoryPool instances are registered in a global list,
+ * see getAllStats().
+ */
+class SharedMemoryPool {
+public:
+	/**
+	 * Usage statistics of a pool.
+	 */
+	struct Stats {
+		const char *name;
+		size_t chunkSize;
+		uint32 live;		///< chunks currently allocated
+		uint32 peak;		///< maximum of live so far
+		uint32 pages;		///< memory pages held by the pool
+		uint32 allocations;	///< total number of allocChunk() calls
+	};
+
+	/**
+	 * Constructor for a shared memory pool.
+	 * @param name		name of the pool in the statistics; must stay valid
+	 *					during the lifetime of the pool
+	 * @param chunkSize	the chunk size of this memory pool
+	 */
+	SharedMemoryPool(const char *name, size_t chunkSize);
+	~SharedMemoryPool();
+
+	/**
+	 * Allocate a new chunk from the memory pool.
+	 */
+	void	*allocChunk();
+
+	/**
+	 * Return a chunk to the memory pool. Does not block. The same rules as
+	 * for MemoryPool::freeChunk() apply.
+	 */
+	void	freeChunk(void *ptr);
+
+	/**
+	 * Release memory pages which contain no allocated chunks anymore.
+	 */
+	void	freeUnusedPages();
+
+	size_t	getChunkSize() const { return _pool.getChunkSize(); }
+
+	Stats	getStats();
+
+	/**
+	 * Fill stats with the statistics of up to maxStats registered pools.
+	 *
+	 * @return the number of registered pools, which may exceed maxStats
+	 */
+	static uint	getAllStats(Stats *stats, uint maxStats);
+
+private:
+	SharedMemoryPool(const SharedMemoryPool&);
+	SharedMemoryPool& operator=(const SharedMemoryPool&);
+
+	void	lock();
+	void	unlock();
+
+	/** Atomically take the whole list of returned chunks. */
+	void	*takeReturned();
+
+	MemoryPool		_pool;
+	const char		*_name;
+	volatile int32	_lock;
+
+	/** Lock-free list of freed chunks, linked through their first word. */
+	void * volatile	_returned;
+
+	uint32			_allocations;	///< guarded by _lock
+	uint32			_peak;			///< guarded by _lock
+	volatile int32	_frees;
+
+	/** Free chunks taken over from _returned, guarded by _lock. */
+	void			*_free;
+
+	SharedMemoryPool	*_prevPool, *_nextPool;
+};
+
+/**
+ * Allocate a block of the given size from a thread-safe pool of blocks of
+ * similar size (there are pools for sizes up to 256 bytes; larger blocks
+ * come from malloc). Blocks must be released with freeSmallChunk(), passing
+ * the same size.
+ *
+ * This is meant for containers which allocate many small blocks, like the
+ * nodes of List and HashMap or String buffers, but know the size of each
+ * block when freeing it, so no per-block header is needed.
+ */
+void *allocSmallChunk(size_t size);
+
+/**
+ * Return a block allocated by allocSmallChunk() of the same size.
+ */
+void freeSmallChunk(void *ptr, size_t size);
+
 }	// End of namespace Common
 
 /**
@@ -0,0 +1,110 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_SPSC_QUEUE_H
+#define COMMON_SPSC_QUEUE_H
+
+#include "common/scummsys.h"
+#include "common/atomic.h"
+
+namespace Common {
+
+/**
+ * Fixed size, lock-free ring buffer for passing values from exactly one
+ * producer thread to exactly one consumer thread.
+ *
+ * push() may only be called by the producer, pop() only by the consumer;
+ * neither ever blocks. If several threads need to produce (or consume),
+ * they have to serialize access among themselves, e.g. with a Mutex. This
+ * is still useful when only the other side must never wait, as is the case
+ * for the audio mixing thread.
+ *
+ * @param T		value type, must be copyable
+ * @param SIZE	number of slots; one slot is always kept free, so at most
+ *				SIZE - 1 values can be queued at the same time.
+ */
+template<class T, uint SIZE>
+class SPSCQueue {
+public:
+	SPSCQueue() : _readPos(0), _writePos(0) {}
+
+	/**
+	 * Append a value. Producer side only.
+	 *
+	 * @return false if the queue is full (in which case nothing is changed)
+	 */
+	bool push(const T &value) {
+		const uint32 writePos = _writePos;
+		const uint32 nextPos = next(writePos);
+		if (nextPos == atomicLoad(_readPos))
+			return false;
+
+		_storage[writePos] = value;
+		atomicStore(_writePos, nextPos);
+		return true;
+	}
+
+	/**
+	 * Remove the oldest value. Consumer side only.
+	 *
+	 * @return false if the queue is empty (in which case value is untouched)
+	 */
+	bool pop(T &value) {
+		const uint32 readPos = _readPos;
+		if (readPos == atomicLoad(_writePos))
+			return false;
+
+		value = _storage[readPos];
+		atomicStore(_readPos, next(readPos));
+		return true;
+	}
+
+	/**
+	 * Check whether the queue is empty. The answer may already be outdated
+	 * when this returns, unless called from the consumer (for a false
+	 * result) or the producer (for a true result).
+	 */
+	bool empty() const {
+		return atomicLoad(_readPos) == atomicLoad(_writePos);
+	}
+
+	/**
+	 * Check whether push() would currently fail. The same caveat as for
+	 * empty() applies.
+	 */
+	bool full() const {
+		return next(atomicLoad(_writePos)) == atomicLoad(_readPos);
+	}
+
+private:
+	static uint32 next(uint32 pos) {
+		return (pos + 1 == SIZE) ? 0 : pos + 1;
+	}
+
+	T _storage[SIZE];
+	volatile uint32 _readPos;
+	volatile uint32 _writePos;
+};
+
+} // End of namespace Common
+
+#endif
@@ -19,6 +19,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include "common/atomic.h"
 #include "common/hash-str.h"
 #include "common/list.h"
 #include "common/memorypool.h"
@@ -27,7 +28,19 @@
 
 namespace Common {
 
-MemoryPool *g_refCountPool = 0; // FIXME: This is never freed right now
+static SharedMemoryPool *volatile g_refCountPool = 0; // FIXME: This is never freed right now
+
+static SharedMemoryPool *getRefCountPool() {
+	SharedMemoryPool *pool = atomicLoad(g_refCountPool);
+	if (!pool) {
+		pool = new SharedMemoryPool("String refcounts", sizeof(int));
+		if (!atomicCompareAndSwap(g_refCountPool, (SharedMemoryPool *)0, pool)) {
+			delete pool;
+			pool = atomicLoad(g_refCountPool);
+		}
+	}
+	return pool;
+}
 
 static uint32 computeCapacity(uint32 len) {
 	// By default, for the capacity we use the next multiple of 32
@@ -77,7 +90,7 @@ String::String(const String &str)
     : _size(str._size) {
 	if (str.isStorageIntern()) {
 		// String in internal storage: just copy it
-		memcpy(_storage, str._storage, _builtinCapacity);
+		memcpy(_storage, str._storage, _size + 1);
 		_str = _storage;
 	} else {
 		// String in external storage: use refcount mechanism
@@ -89,6 +102,25 @@ String::String(const String &str)
 	assert(_str != 0);
 }
 
+#ifdef SCUMMVM_HAS_RVALUE_REFERENCES
+String::String(String &&str)
+    : _size(str._size) {
+	if (str.isStorageIntern()) {
+		memcpy(_storage, str._storage, _size + 1);
+		_str = _storage;
+	} else {
+		// Take over the external storage, including its refcount
+		_extern._refCount = str._extern._refCount;
+		_extern._capacity = str._extern._capacity;
+		_str = str._str;
+	}
+
+	str._size = 0;
+	str._str = str._storage;
+	str._storage[0] = 0;
+}
+#endif
+
 String::String(char c)
     : _size(0), _str(_storage) {
 
@@ -177,12 +209,7 @@ void String::ensureCapacity(uint32 new_size, bool keep_old) {
 void String::incRefCount() const {
 	assert(!isStorageIntern());
 	if (_extern._refCount == 0) {
-		if (g_refCountPool == 0) {
-			g_refCountPool = new MemoryPool(sizeof(int));
-			assert(g_refCountPool);
-		}
-
-		_extern._refCount = (int *)g_refCountPool->allocChunk();
+		_extern._refCount = (int *)getRefCountPool()->allocChunk();
 		*_extern._refCount = 2;
 	} else {
 		++(*_extern._refCount);
@@ -200,8 +227,7 @@ void String::decRefCount(int *oldRefCount) {
 		// The ref count reached zero, so we free the string storage
 		// and the ref count storage.
 		if (oldRefCount) {
-			assert(g_refCountPool);
-			g_refCountPool->freeChunk(oldRefCount);
+			getRefCountPool()->freeChunk(oldRefCount);
 		}
 		delete[] _str;
 
@@ -241,6 +267,31 @@ String &String::operator=(const String &str) {
 	return *this;
 }
 
+#ifdef SCUMMVM_HAS_RVALUE_REFERENCES
+String &String::operator=(String &&str) {
+	if (&str == this)
+		return *this;
+
+	decRefCount(_extern._refCount);
+
+	_size = str._size;
+	if (str.isStorageIntern()) {
+		_str = _storage;
+		memcpy(_str, str._str, _size + 1);
+	} else {
+		_extern._refCount = str._extern._refCount;
+		_extern._capacity = str._extern._capacity;
+		_str = str._str;
+	}
+
+	str._size = 0;
+	str._str = str._storage;
+	str._storage[0] = 0;
+
+	return *this;
+}
+#endif
+
 String &String::operator=(char c) {
 	decRefCount(_extern._refCount);
 	_str = _storage;
@@ -280,6 +331,20 @@ String &String::operator+=(const String &str) {
 	return *this;
 }
 
+String &String::append(const char *str, uint32 len) {
+	if (_str <= str && str <= _str + _size)
+		return append(String(str, len).c_str(), len);
+
+	if (len > 0) {
+		ensureCapacity(_size + len, true);
+
+		memcpy(_str + _size, str, len);
+		_size += len;
+		_str[_size] = 0;
+	}
+	return *this;
+}
+
 String &String::operator+=(char c) {
 	ensureCapacity(_size + 1, true);
 
@@ -369,6 +434,34 @@ void String::clear() {
 	_storage[0] = 0;
 }
 
+void String::reserve(uint32 size) {
+	ensureCapacity(MAX(size, _size), true);
+}
+
+void String::swap(String &str) {
+	if (&str == this)
+		return;
+
+	const bool intern = isStorageIntern();
+	const bool strIntern = str.isStorageIntern();
+
+	// The union holds either the characters or the external storage data,
+	// so swapping it as a whole covers both cases
+	char tmp[_builtinCapacity];
+	memcpy(tmp, _storage, _builtinCapacity);
+	memcpy(_storage, str._storage, _builtinCapacity);
+	memcpy(str._storage, tmp, _builtinCapacity);
+
+	SWAP(_size, str._size);
+	SWAP(_str, str._str);
+
+	// Internal storage pointers still refer to the other object
+	if (strIntern)
+		_str = _storage;
+	if (intern)
+		str._str = str._storage;
+}
+
 void String::setChar(char c, uint32 p) {
 	assert(p <= _size);
 
@@ -430,7 +523,7 @@ String String::format(const char *fmt, ...) {
 
 	va_list va;
 	va_start(va, fmt);
-	output = String::vformat(fmt, va);
+	output.vappendFormat(fmt, va);
 	va_end(va);
 
 	return output;
@@ -439,14 +532,32 @@ String String::format(const char *fmt, ...) {
 // static
 String String::vformat(const char *fmt, va_list args) {
 	String output;
-	assert(output.isStorageIntern());
+	output.vappendFormat(fmt, args);
+	return output;
+}
+
+String &String::appendFormat(const char *fmt, ...) {
+	va_list va;
+	va_start(va, fmt);
+	vappendFormat(fmt, va);
+	va_end(va);
+
+	return *this;
+}
+
+String &String::vappendFormat(const char *fmt, va_list args) {
+	// We format right into the free space behind the current contents,
+	// so we must not share the storage
+	makeUnique();
+
+	int size = (isStorageIntern() ? _builtinCapacity : _extern._capacity) - _size;
 
 	va_list va;
 	scumm_va_copy(va, args);
-	int len = vsnprintf(output._str, _builtinCapacity, fmt, va);
+	int len = vsnprintf(_str + _size, size, fmt, va);
 	va_end(va);
 
-	if (len == -1 || len == _builtinCapacity - 1) {
+	if (len == -1 || len == size - 1) {
 		// MSVC and IRIX don't return the size the full string would take up.
 		// MSVC returns -1, IRIX returns the number of characters actually written,
 		// which is at the most the size of the buffer minus one, as the string is
@@ -457,35 +568,31 @@ String String::vformat(const char *fmt, va_list args) {
 		// For IRIX, because we lack a better mechanism, we assume failure
 		// if the return value equals size - 1.
 		// The downside to this is that whenever we try to format a string where the
-		// size is 1 below the built-in capacity, the size is needlessly increased.
+		// size is 1 below the free capacity, the size is needlessly increased.
 
 		// Try increasing the size of the string until it fits.
-		int size = _builtinCapacity;
 		do {
-			size *= 2;
-			output.ensureCapacity(size - 1, false);
-			assert(!output.isStorageIntern());
-			size = output._extern._capacity;
+			size = MAX(size * 2, (int)_builtinCapacity);
+			ensureCapacity(_size + size - 1, true);
+			size = (isStorageIntern() ? _builtinCapacity : _extern._capacity) - _size;
 
 			scumm_va_copy(va, args);
-			len = vsnprintf(output._str, size, fmt, va);
+			len = vsnprintf(_str + _size, size, fmt, va);
 			va_end(va);
 		} while (len == -1 || len >= size - 1);
-		output._size = len;
-	} else if (len < (int)_builtinCapacity) {
-		// vsnprintf succeeded
-		output._size = len;
-	} else {
+	} else if (len >= size) {
 		// vsnprintf didn't have enough space, so grow buffer
-		output.ensureCapacity(len, false);
+		ensureCapacity(_size + len, true);
 		scumm_va_copy(va, args);
-		int len2 = vsnprintf(output._str, len+1, fmt, va);
+		int len2 = vsnprintf(_str + _size, len + 1, fmt, va);
 		va_end(va);
 		assert(len == len2);
-		output._size = len2;
 	}
 
-	return output;
+	// vsnprintf also wrote the terminating zero
+	_size += len;
+
+	return *this;
 }
 
 
@@ -605,6 +712,23 @@ String operator+(const String &x, char y) {
 	return temp;
 }
 
+#ifdef SCUMMVM_HAS_RVALUE_REFERENCES
+String operator+(String &&x, const String &y) {
+	x += y;
+	return static_cast<String &&>(x);
+}
+
+String operator+(String &&x, const char *y) {
+	x += y;
+	return static_cast<String &&>(x);
+}
+
+String operator+(String &&x, char y) {
+	x += y;
+	return static_cast<String &&>(x);
+}
+#endif
+
 char *ltrim(char *t) {
 	while (isSpace(*t))
 		t++;
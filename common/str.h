@@ -26,6 +26,15 @@
 
 #include <stdarg.h>
 
+/**
+ * @def SCUMMVM_HAS_RVALUE_REFERENCES
+ * Defined if the compiler supports C++11 rvalue references, in which case
+ * String gets move constructors and move assignment.
+ */
+#if !defined(SCUMMVM_HAS_RVALUE_REFERENCES) && (__cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600))
+#define SCUMMVM_HAS_RVALUE_REFERENCES
+#endif
+
 namespace Common {
 
 /**
@@ -48,14 +57,19 @@ protected:
 	 * The size of the internal storage. Increasing this means less heap
 	 * allocations are needed, at the cost of more stack memory usage,
 	 * and of course lots of wasted memory. Empirically, 90% or more of
-	 * all String instances are less than 32 chars long. If a platform
-	 * is very short on stack space, it would be possible to lower this.
-	 * A value of 24 still seems acceptable, though considerably worse,
-	 * while 16 seems to be the lowest you want to go... Anything lower
-	 * than 8 makes no sense, since that's the size of member _extern
-	 * (on 32 bit machines; 12 bytes on systems with 64bit pointers).
+	 * all String instances are less than 32 chars long, but a good share
+	 * of the strings engines build in loops (file names with a directory,
+	 * formatted resource names, short messages) are a bit longer. Hence we
+	 * make the whole object 48 bytes, which leaves room for 40 characters
+	 * (32 on systems with 64bit pointers, where _size gets padded to the
+	 * size of a pointer). If a platform is very short on
+	 * stack space, it would be possible to lower this. A value of 24 still
+	 * seems acceptable, though considerably worse, while 16 seems to be the
+	 * lowest you want to go... Anything lower than 8 makes no sense, since
+	 * that's the size of member _extern (on 32 bit machines; 12 bytes on
+	 * systems with 64bit pointers).
 	 */
-	static const uint32 _builtinCapacity = 32 - sizeof(uint32) - sizeof(char *);
+	static const uint32 _builtinCapacity = 48 - 2 * sizeof(char *);
 
 	/**
 	 * Length of the string. Stored to avoid having to call strlen
@@ -106,6 +120,11 @@ public:
 	/** Construct a copy of the given string. */
 	String(const String &str);
 
+#ifdef SCUMMVM_HAS_RVALUE_REFERENCES
+	/** Construct a string by taking over the storage of str, which is left empty. */
+	String(String &&str);
+#endif
+
 	/** Construct a string consisting of the given character. */
 	explicit String(char c);
 
@@ -113,6 +132,9 @@ public:
 
 	String &operator=(const char *str);
 	String &operator=(const String &str);
+#ifdef SCUMMVM_HAS_RVALUE_REFERENCES
+	String &operator=(String &&str);
+#endif
 	String &operator=(char c);
 	String &operator+=(const char *str);
 	String &operator+=(const String &str);
@@ -200,6 +222,32 @@ public:
 	/** Clears the string, making it empty. */
 	void clear();
 
+	/**
+	 * Make sure that the string can grow to at least size characters
+	 * without allocating memory again. Use this before building a string
+	 * piecewise with append() or the += operators, when the final size is
+	 * roughly known.
+	 */
+	void reserve(uint32 size);
+
+	/** Append exactly len characters read from address str. */
+	String &append(const char *str, uint32 len);
+
+	/**
+	 * Append formatted data to the string, like format() would produce it,
+	 * but without creating a temporary String object.
+	 */
+	String &appendFormat(const char *fmt, ...) GCC_PRINTF(2,3);
+
+	/**
+	 * Append formatted data to the string, like vformat() would produce
+	 * it, but without creating a temporary String object.
+	 */
+	String &vappendFormat(const char *fmt, va_list args);
+
+	/** Exchange the contents of this string and str, without copying any heap storage. */
+	void swap(String &str);
+
 	/** Convert all characters in the string to lowercase. */
 	void toLowercase();
 
@@ -271,6 +319,14 @@ String operator+(const String &x, const char *y);
 String operator+(const String &x, char y);
 String operator+(char x, const String &y);
 
+#ifdef SCUMMVM_HAS_RVALUE_REFERENCES
+// Append to a temporary string in place, so that chains like
+// a + "/" + b only allocate once
+String operator+(String &&x, const String &y);
+String operator+(String &&x, const char *y);
+String operator+(String &&x, char y);
+#endif
+
 // Some useful additional comparison operators for Strings
 bool operator==(const char *x, const String &y);
 bool operator!=(const char *x, const String &y);
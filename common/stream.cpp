@@ -54,6 +54,17 @@ uint32 MemoryReadStream::read(void *dataPtr, uint32 dataSize) {
 	return dataSize;
 }
 
+const byte *MemoryReadStream::readInPlace(uint32 size) {
+	if (size > _size - _pos)
+		return 0;
+
+	const byte *data = _ptr;
+	_ptr += size;
+	_pos += size;
+
+	return data;
+}
+
 bool MemoryReadStream::seek(int32 offs, int whence) {
 	// Pre-Condition
 	assert(_pos <= _size);
@@ -240,6 +251,17 @@ bool SeekableSubReadStream::seek(int32 offset, int whence) {
 	return ret;
 }
 
+const byte *SeekableSubReadStream::readInPlace(uint32 size) {
+	if (size > _end - _pos)
+		return 0;
+
+	const byte *data = _parentStream->readInPlace(size);
+	if (data)
+		_pos += size;
+
+	return data;
+}
+
 uint32 SafeSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	// Make sure the parent stream is at the right position
 	seek(0, SEEK_CUR);
@@ -247,6 +269,30 @@ uint32 SafeSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	return SeekableSubReadStream::read(dataPtr, dataSize);
 }
 
+const byte *SafeSubReadStream::readInPlace(uint32 size) {
+	// Make sure the parent stream is at the right position
+	seek(0, SEEK_CUR);
+
+	return SeekableSubReadStream::readInPlace(size);
+}
+
+
+#pragma mark -
+
+StreamBuffer::StreamBuffer(SeekableReadStream &stream, uint32 size)
+	: _data(stream.readInPlace(size)), _copy(0), _size(size) {
+
+	if (!_data) {
+		_copy = (byte *)malloc(size);
+		assert(_copy || !size);
+		_size = stream.read(_copy, size);
+		_data = _copy;
+	}
+}
+
+StreamBuffer::~StreamBuffer() {
+	free(_copy);
+}
 
 #pragma mark -
 
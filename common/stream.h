@@ -371,6 +371,23 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Provide direct access to the next size bytes of the stream, if the
+	 * stream holds its data in memory (or has mapped it into memory), and
+	 * skip over them. This saves allocating a buffer and copying the data
+	 * into it with read(). The returned data must not be modified, and
+	 * stays valid as long as the stream (and its parent streams, if any)
+	 * exists.
+	 *
+	 * Streams which can not provide direct access, or which hold less than
+	 * size more bytes, return 0 and leave their position unchanged. Use
+	 * StreamBuffer to fall back to reading into a buffer in that case.
+	 *
+	 * @param size	the number of bytes to access
+	 * @return a pointer to the data, or 0 if direct access is not possible
+	 */
+	virtual const byte *readInPlace(uint32 size) { return 0; }
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
@@ -410,6 +427,42 @@ public:
 	virtual String readLine();
 };
 
+/**
+ * The next bytes of a SeekableReadStream, accessed directly via
+ * SeekableReadStream::readInPlace() if possible, and else read into a
+ * buffer owned by the StreamBuffer. Either way, the data stays valid until
+ * the StreamBuffer is destroyed (provided the stream still exists).
+ *
+ * Example:
+ *   StreamBuffer chunk(*stream, chunkSize);
+ *   decodeChunk(chunk.getData(), chunk.size());
+ */
+class StreamBuffer {
+public:
+	StreamBuffer(SeekableReadStream &stream, uint32 size);
+	~StreamBuffer();
+
+	/** Return the data. */
+	const byte *getData() const { return _data; }
+
+	/**
+	 * Return the number of bytes available, which is less than requested
+	 * if the end of the stream was reached.
+	 */
+	uint32 size() const { return _size; }
+
+	/** Return whether the data had to be copied. */
+	bool isCopy() const { return _copy != 0; }
+
+private:
+	StreamBuffer(const StreamBuffer &);
+	StreamBuffer &operator=(const StreamBuffer &);
+
+	const byte *_data;
+	byte *_copy;
+	uint32 _size;
+};
+
 /**
  * This is a ReadStream mixin subclass which adds non-endian read
  * methods whose endianness is set during the stream creation.
@@ -77,6 +77,8 @@ public:
 	virtual int32 size() const { return _end - _begin; }
 
 	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+	virtual const byte *readInPlace(uint32 size);
 };
 
 /**
@@ -111,6 +113,7 @@ public:
 	}
 
  virtual uint32 read(void *dataPtr, uint32 dataSize);
+ virtual const byte *readInPlace(uint32 size);
 };
 
 
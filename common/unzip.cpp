@@ -108,6 +108,9 @@ typedef struct {
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
+#include "common/mutex.h"
+#include "common/ptr.h"
+#include "common/zlib.h"
 
 #if defined(STRICTUNZIP) || defined(STRICTZIPUNZIP)
 /* like the STRICT of WIN32, we define a pointer that cannot be converted
@@ -379,6 +382,7 @@ typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_H
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _streamOwner;	/* owns _stream, which streamed members share */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -541,6 +545,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_streamOwner = Common::SharedPtr<Common::SeekableReadStream>(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -592,7 +597,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return NULL;
 	}
@@ -641,7 +645,6 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != NULL)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
 	delete s;
 	return UNZ_OK;
 }
@@ -1416,10 +1419,113 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+/**
+ * Gives direct access to the data of a member of a ZIP file, for members too
+ * large to be read into memory at once. Like SafeSubReadStream, it seeks the
+ * archive stream before every read, so that it can be used alongside other
+ * members of the same archive. It shares the archive stream, so it stays
+ * valid even if the archive is deleted first.
+ */
+class ZipMemberDataStream : public SeekableReadStream {
+	SharedPtr<SeekableReadStream> _parent;
+	SharedPtr<Mutex> _mutex;
+	const uint32 _begin;
+	const uint32 _size;
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+
+public:
+	ZipMemberDataStream(const SharedPtr<SeekableReadStream> &parent, const SharedPtr<Mutex> &mutex, uint32 begin, uint32 size)
+		: _parent(parent), _mutex(mutex), _begin(begin), _size(size), _pos(0), _eos(false), _err(false) {
+	}
+
+	virtual bool err() const { return _err; }
+	virtual void clearErr() { _eos = false; _err = false; }
+	virtual bool eos() const { return _eos; }
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+
+	virtual bool seek(int32 offset, int whence = SEEK_SET) {
+		int32 newPos;
+		switch (whence) {
+		case SEEK_END:
+			newPos = _size + offset;
+			break;
+		case SEEK_SET:
+			newPos = offset;
+			break;
+		case SEEK_CUR:
+			newPos = _pos + offset;
+			break;
+		default:
+			return false;
+		}
+
+		if (newPos < 0 || newPos > (int32)_size)
+			return false;
+
+		_pos = newPos;
+		_eos = false;
+		return true;
+	}
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize) {
+		if (dataSize > _size - _pos) {
+			dataSize = _size - _pos;
+			_eos = true;
+		}
+
+		StackLock lock(*_mutex);
+		if (!_parent->seek(_begin + _pos, SEEK_SET)) {
+			_err = true;
+			return 0;
+		}
+
+		const uint32 bytesRead = _parent->read(dataPtr, dataSize);
+		if (bytesRead < dataSize)
+			_err = true;
+		_pos += bytesRead;
+		return bytesRead;
+	}
+
+	virtual const byte *readInPlace(uint32 dataSize) {
+		if (dataSize > _size - _pos)
+			return 0;
+
+		StackLock lock(*_mutex);
+		if (!_parent->seek(_begin + _pos, SEEK_SET))
+			return 0;
+
+		const byte *data = _parent->readInPlace(dataSize);
+		if (data)
+			_pos += dataSize;
+		return data;
+	}
+};
 
 class ZipArchive : public Archive {
 	unzFile _zipFile;
 
+	/**
+	 * Guards _zipFile and the archive stream. Streamed members share the
+	 * archive stream, and may be read from other threads than the one
+	 * opening members (e.g. by audio streams).
+	 */
+	SharedPtr<Mutex> _mutex;
+
+	enum {
+		/**
+		 * Members at least this large are decompressed on the fly while
+		 * they are read, instead of all at once when they are opened.
+		 */
+		kStreamingThreshold = 256 * 1024
+	};
+
+	byte *readCurrentFile(const unz_file_info &fileInfo) const;
+	SeekableReadStream *createStreamForCurrentFile(const unz_file_info &fileInfo) const;
+
 public:
 	ZipArchive(unzFile zipFile);
 
@@ -1432,25 +1538,7 @@ public:
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
 };
 
-/*
-class ZipArchiveMember : public ArchiveMember {
-	unzFile _zipFile;
-
-public:
-	ZipArchiveMember(FSNode &node) : _node(node) {
-	}
-
-	String getName() const {
-		...
-	}
-
-	SeekableReadStream *open() {
-		...
-	}
-};
-*/
-
-ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
+ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile), _mutex(new Mutex()) {
 	assert(_zipFile);
 }
 
@@ -1459,26 +1547,18 @@ ZipArchive::~ZipArchive() {
 }
 
 bool ZipArchive::hasFile(const String &name) const {
-	return (unzLocateFile(_zipFile, name.c_str(), 2) == UNZ_OK);
+	StackLock lock(*_mutex);
+	return ((const unz_s *)_zipFile)->_hash.contains(name);
 }
 
 int ZipArchive::listMembers(ArchiveMemberList &list) const {
-	int matches = 0;
-	int err = unzGoToFirstFile(_zipFile);
-
-	while (err == UNZ_OK) {
-		char szCurrentFileName[UNZ_MAXFILENAMEINZIP+1];
-		if (unzGetCurrentFileInfo(_zipFile, NULL,
-		                          szCurrentFileName, sizeof(szCurrentFileName)-1,
-		                          NULL, 0, NULL, 0) == UNZ_OK) {
-			list.push_back(ArchiveMemberList::value_type(new GenericArchiveMember(szCurrentFileName, this)));
-			matches++;
-		}
+	StackLock lock(*_mutex);
+	const ZipHash &hash = ((const unz_s *)_zipFile)->_hash;
 
-		err = unzGoToNextFile(_zipFile);
-	}
+	for (ZipHash::const_iterator i = hash.begin(); i != hash.end(); ++i)
+		list.push_back(ArchiveMemberList::value_type(new GenericArchiveMember(i->_key, this)));
 
-	return matches;
+	return hash.size();
 }
 
 const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
@@ -1488,21 +1568,12 @@ const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 	return ArchiveMemberPtr(new GenericArchiveMember(name, this));
 }
 
-SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
-	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
-		return 0;
-
-	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
-		return 0;
-
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
-		return 0;
-
+byte *ZipArchive::readCurrentFile(const unz_file_info &fileInfo) const {
 	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
 	assert(buffer);
 
 	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
+		unzCloseCurrentFile(_zipFile);
 		free(buffer);
 		return 0;
 	}
@@ -1512,12 +1583,46 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 		return 0;
 	}
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
+	return buffer;
+}
+
+SeekableReadStream *ZipArchive::createStreamForCurrentFile(const unz_file_info &fileInfo) const {
+	// Read the member data straight from the archive stream. Note that
+	// unlike unzReadCurrentFile, this does not verify the CRC.
+	const unz_s *s = (const unz_s *)_zipFile;
+	const uint32 begin = s->pfile_in_zip_read->pos_in_zipfile + s->pfile_in_zip_read->byte_before_the_zipfile;
+	unzCloseCurrentFile(_zipFile);
 
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	SeekableReadStream *data = new ZipMemberDataStream(s->_streamOwner, _mutex, begin, fileInfo.compressed_size);
+	if (fileInfo.compression_method == 0)
+		return data;
+
+	return wrapDeflateReadStream(data, fileInfo.uncompressed_size);
+}
+
+SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
+	StackLock lock(*_mutex);
+
+	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
+		return 0;
+
+	unz_file_info fileInfo;
+	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
+		return 0;
+
+	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK) {
+		unzCloseCurrentFile(_zipFile);
+		return 0;
+	}
+
+	if (fileInfo.uncompressed_size >= kStreamingThreshold)
+		return createStreamForCurrentFile(fileInfo);
+
+	byte *buffer = readCurrentFile(fileInfo);
+	if (!buffer)
+		return 0;
+
+	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -142,6 +142,28 @@ public:
 		_stream.avail_in = 0;
 	}
 
+	/**
+	 * Create a stream for raw deflate data, without any header, as found
+	 * e.g. in ZIP files. The size of the uncompressed data must be known.
+	 */
+	GZipReadStream(SeekableReadStream *w, uint32 knownSize) : _wrapped(w), _stream() {
+		assert(w != 0);
+
+		_origSize = knownSize;
+		_pos = 0;
+		w->seek(0, SEEK_SET);
+		_eos = false;
+
+		// Negative MAX_WBITS tells zlib there's no header
+		_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return;
+
+		// Setup input buffer
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+	}
+
 	~GZipReadStream() {
 		inflateEnd(&_stream);
 	}
@@ -351,6 +373,15 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped) {
 	return toBeWrapped;
 }
 
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize) {
+#if defined(USE_ZLIB)
+	if (toBeWrapped)
+		return new GZipReadStream(toBeWrapped, knownSize);
+#endif
+	delete toBeWrapped;
+	return 0;
+}
+
 WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
 #if defined(USE_ZLIB)
 	if (toBeWrapped)
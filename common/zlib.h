@@ -91,6 +91,18 @@ bool inflateZlibHeaderless(byte *dst, uint dstLen, const byte *src, uint srcLen,
  */
 SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped);
 
+/**
+ * Take an arbitrary SeekableReadStream containing raw deflate data (i.e.
+ * without any zlib or gzip header, like the members of a ZIP file) and wrap
+ * it in a custom stream which provides transparent on-the-fly decompression.
+ * Unlike wrapCompressedReadStream, the wrapped stream is always taken over:
+ * if ZLIB support has been disabled, it is deleted and NULL is returned.
+ *
+ * @param toBeWrapped   the stream containing the deflate data
+ * @param knownSize     the size of the uncompressed data
+ */
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize);
+
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which provides
  * transparent on-the-fly compression. The compressed data is written in the
@@ -3059,14 +3059,17 @@ void Screen::shakeScreen(int times) {
 }
 
 void Screen::loadBitmap(const char *filename, int tempPage, int dstPage, Palette *pal, bool skip) {
-	uint32 fileSize;
-	uint8 *srcData = _vm->resource()->fileData(filename, &fileSize);
+	Common::SeekableReadStream *stream = _vm->resource()->createReadStream(filename);
 
-	if (!srcData) {
+	if (!stream) {
 		warning("couldn't load bitmap: '%s'", filename);
 		return;
 	}
 
+	// Decode straight from the archive data if it is in memory
+	Common::StreamBuffer buffer(*stream, stream->size());
+	const uint8 *srcData = buffer.getData();
+
 	if (skip)
 		srcData += 4;
 
@@ -3078,7 +3081,7 @@ void Screen::loadBitmap(const char *filename, int tempPage, int dstPage, Palette
 	if (pal && palSize)
 		loadPalette(srcData + 10, *pal, palSize);
 
-	uint8 *srcPtr = srcData + 10 + palSize;
+	const uint8 *srcPtr = srcData + 10 + palSize;
 	uint8 *dstData = getPagePtr(dstPage);
 	memset(dstData, 0, SCREEN_PAGE_SIZE);
 	if (dstPage == 0 || tempPage == 0)
@@ -3108,10 +3111,7 @@ void Screen::loadBitmap(const char *filename, int tempPage, int dstPage, Palette
 			Screen::convertAmigaGfx(dstData, 320, 200);
 	}
 
-	if (skip)
-		srcData -= 4;
-
-	delete[] srcData;
+	delete stream;
 }
 
 bool Screen::loadPalette(const char *filename, Palette &pal) {
@@ -95,6 +95,17 @@ void VQAMovie::freeBuffers() {
 	}
 }
 
+const byte *VQAMovie::readChunk(uint32 size) {
+	const byte *data = _file->readInPlace(size);
+	if (!data) {
+		byte *buf = (byte *)allocBuffer(0, size);
+		_file->read(buf, size);
+		data = buf;
+	}
+
+	return data;
+}
+
 uint32 VQAMovie::readTag() {
 	// Some tags have to be on an even offset, so they are padded with a
 	// zero byte. Skip that.
@@ -464,9 +475,7 @@ void VQAMovie::displayFrame(uint frameNum) {
 					break;
 
 				case MKTAG('C','B','F','Z'):	// Full codebook
-					inbuf = (byte *)allocBuffer(0, size);
-					_file->read(inbuf, size);
-					Screen::decodeFrame4(inbuf, _codeBook, _codeBookSize);
+					Screen::decodeFrame4(readChunk(size), _codeBook, _codeBookSize);
 					break;
 
 				case MKTAG('C','B','P','0'):	// Partial codebook
@@ -489,9 +498,7 @@ void VQAMovie::displayFrame(uint frameNum) {
 					break;
 
 				case MKTAG('C','P','L','Z'):	// Palette
-					inbuf = (byte *)allocBuffer(0, size);
-					_file->read(inbuf, size);
-					Screen::decodeFrame4(inbuf, _screen->getPalette(0).getData(), 768);
+					Screen::decodeFrame4(readChunk(size), _screen->getPalette(0).getData(), 768);
 					break;
 
 				case MKTAG('V','P','T','0'):	// Frame data
@@ -502,11 +509,8 @@ void VQAMovie::displayFrame(uint frameNum) {
 					break;
 
 				case MKTAG('V','P','T','Z'):	// Frame data
-					inbuf = (byte *)allocBuffer(0, size);
 					outbuf = (byte *)allocBuffer(1, 2 * _numVectorPointers);
-
-					_file->read(inbuf, size);
-					size = Screen::decodeFrame4(inbuf, outbuf, 2 * _numVectorPointers);
+					size = Screen::decodeFrame4(readChunk(size), outbuf, 2 * _numVectorPointers);
 
 					assert(size / 2 <= _numVectorPointers);
 
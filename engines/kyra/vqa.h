@@ -102,6 +102,12 @@ protected:
 	void *allocBuffer(int num, uint32 size);
 	void freeBuffers();
 
+	/**
+	 * Returns the next size bytes of the movie file, directly if the file
+	 * is in memory, else read into buffer 0.
+	 */
+	const byte *readChunk(uint32 size);
+
 	void decodeSND1(byte *inbuf, uint32 insize, byte *outbuf, uint32 outsize);
 
 	void displayFrame(uint frameNum);
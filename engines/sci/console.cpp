@@ -53,6 +53,7 @@
 #include "video/avi_decoder.h"
 #include "sci/video/seq_decoder.h"
 #ifdef ENABLE_SCI32
+#include "sci/graphics/frameout.h"
 #include "video/coktel_decoder.h"
 #include "sci/video/robot_decoder.h"
 #endif
@@ -201,6 +202,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("bpe",				WRAP_METHOD(Console, cmdBreakpointFunction));		// alias
 	// VM
 	DCmd_Register("script_steps",		WRAP_METHOD(Console, cmdScriptSteps));
+	DCmd_Register("stats",				WRAP_METHOD(Console, cmdStats));
 	DCmd_Register("vm_varlist",			WRAP_METHOD(Console, cmdVMVarlist));
 	DCmd_Register("vmvarlist",			WRAP_METHOD(Console, cmdVMVarlist));				// alias
 	DCmd_Register("vl",					WRAP_METHOD(Console, cmdVMVarlist));				// alias
@@ -420,7 +422,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" bp_function / bpe - Sets a breakpoint on the execution of the specified exported function\n");
 	DebugPrintf("\n");
 	DebugPrintf("VM:\n");
-	DebugPrintf(" script_steps - Shows the number of executed SCI operations\n");
+	DebugPrintf(" script_steps - Shows the number of executed SCI operations, and how fast they are executed\n");
+	DebugPrintf(" stats - Shows statistics about the caches of the interpreter\n");
 	DebugPrintf(" vm_varlist / vmvarlist / vl - Shows the addresses of variables in the VM\n");
 	DebugPrintf(" vm_vars / vmvars / vv - Displays or changes variables in the VM\n");
 	DebugPrintf(" stack - Lists the specified number of stack elements\n");
@@ -2634,9 +2637,68 @@ bool Console::cmdViewAccumulatorObject(int argc, const char **argv) {
 
 bool Console::cmdScriptSteps(int argc, const char **argv) {
 	DebugPrintf("Number of executed SCI operations: %d\n", _engine->_gamestate->scriptStepCounter);
+	DebugPrintf("Operations per second (while not sleeping): %d\n", _engine->_gamestate->getScriptStepsPerSecond());
 	return true;
 }
 
+bool Console::cmdStats(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		DebugPrintf("Shows statistics about the garbage collector, the caches of the\n");
+		DebugPrintf("interpreter and the screen updates of kFrameout (SCI32) since the\n");
+		DebugPrintf("last reset.\n");
+		DebugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	ResourceManager *resMan = _engine->getResMan();
+	SegManager *segMan = _engine->_gamestate->_segMan;
+	EngineState::GCStatistics &gcStats = _engine->_gamestate->gcStats;
+
+	if (argc == 2) {
+		// Also makes the next periodic collection run, see run_gc()
+		memset(&gcStats, 0, sizeof(gcStats));
+		resMan->resetCacheStatistics();
+#ifdef ENABLE_SCI32
+		if (_engine->_gfxFrameout)
+			_engine->_gfxFrameout->resetFrameStatistics();
+#endif
+		segMan->resetSelectorCacheStats();
+		DebugPrintf("Statistics reset\n");
+		return true;
+	}
+
+	DebugPrintf("Garbage collector: %d collections, %d skipped, %d objects freed\n", gcStats.runs, gcStats.skipped, gcStats.freed);
+	DebugPrintf("  Pause times: last %d ms, longest %d ms, average %d ms\n", gcStats.lastPause, gcStats.maxPause,
+				gcStats.runs ? gcStats.totalPause / gcStats.runs : 0);
+	const ResourceManager::CacheStatistics &resStats = resMan->getCacheStatistics();
+	DebugPrintf("Resource cache: %d KB of %d KB used, %d KB locked\n", resMan->getCacheMemory() / 1024,
+				resMan->getCacheBudget() / 1024, resMan->getLockedMemory() / 1024);
+	printHitRate(resStats.hits, resStats.misses);
+	DebugPrintf("  Time spent loading: %d ms, prefetched while idle: %d\n", resStats.loadTime, resStats.prefetched);
+	DebugPrintf("  Evicted: %d resources, %d KB\n", resStats.evictions, resStats.evictedBytes / 1024);
+	DebugPrintf("Selector cache: %d entries\n", segMan->getSelectorCacheSize());
+	printHitRate(segMan->getSelectorCacheHits(), segMan->getSelectorCacheMisses());
+
+#ifdef ENABLE_SCI32
+	if (_engine->_gfxFrameout) {
+		const GfxFrameout::FrameStatistics &frameStats = _engine->_gfxFrameout->getFrameStatistics();
+		DebugPrintf("kFrameout: %d frames, %d unchanged, %d full redraws\n", frameStats.frames,
+					frameStats.unchangedFrames, frameStats.fullFrames);
+		DebugPrintf("  Pixels redrawn per frame: %d\n", frameStats.frames ? frameStats.redrawnPixels / frameStats.frames : 0);
+		DebugPrintf("  Frame times: last %d ms, longest %d ms, average %d ms\n", frameStats.lastTime, frameStats.maxTime,
+					frameStats.frames ? frameStats.totalTime / frameStats.frames : 0);
+	}
+#endif
+	return true;
+}
+
+void Console::printHitRate(uint32 hits, uint32 misses) {
+	DebugPrintf("  Hits: %d, misses: %d", hits, misses);
+	if (hits + misses)
+		DebugPrintf(" (%d%% hits)", (int)(hits * 100.0 / (hits + misses)));
+	DebugPrintf("\n");
+}
+
 bool Console::cmdBacktrace(int argc, const char **argv) {
 	DebugPrintf("Call stack (current base: 0x%x):\n", _engine->_gamestate->executionStackBase);
 	Common::List<ExecStack>::const_iterator iter;
@@ -144,6 +144,7 @@ private:
 	bool cmdBreakpointFunction(int argc, const char **argv);
 	// VM
 	bool cmdScriptSteps(int argc, const char **argv);
+	bool cmdStats(int argc, const char **argv);
 	bool cmdVMVarlist(int argc, const char **argv);
 	bool cmdVMVars(int argc, const char **argv);
 	bool cmdStack(int argc, const char **argv);
@@ -171,6 +172,9 @@ private:
 	 */
 	void printKernelCallsFound(int kernelFuncNum, bool showFoundScripts);
 
+	/** Prints the hit and miss counts of a cache, as part of cmdStats() */
+	void printHitRate(uint32 hits, uint32 misses);
+
 	SciEngine *_engine;
 	DebugState &_debugState;
 	bool _mouseVisible;
@@ -33,7 +33,20 @@
 #include "sci/resource.h"
 
 namespace Sci {
-int Decompressor::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+
+static inline uint64 readBE64(const byte *ptr) {
+	return ((uint64)READ_BE_UINT32(ptr) << 32) | READ_BE_UINT32(ptr + 4);
+}
+
+static inline uint64 readLE64(const byte *ptr) {
+	return ((uint64)READ_LE_UINT32(ptr + 4) << 32) | READ_LE_UINT32(ptr);
+}
+
+Decompressor::~Decompressor() {
+	delete[] _srcCopy;
+}
+
+int Decompressor::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
 	uint32 chunk;
 	while (nPacked && !(src->eos() || src->err())) {
 		chunk = MIN<uint32>(1024, nPacked);
@@ -44,105 +57,170 @@ int Decompressor::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, ui
 	return (src->eos() || src->err()) ? 1 : 0;
 }
 
-void Decompressor::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
+void Decompressor::init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                         uint32 nUnpacked) {
-	_src = src;
 	_dest = dest;
 	_szPacked = nPacked;
 	_szUnpacked = nUnpacked;
 	_nBits = 0;
 	_dwRead = _dwWrote = 0;
 	_dwBits = 0;
-}
 
-void Decompressor::fetchBitsMSB() {
-	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << (24 - _nBits);
-		_nBits += 8;
-		_dwRead++;
+	// Resources are usually read from a memory mapped volume, so decode
+	// the data right there and only copy it for other streams. Data
+	// missing from the stream reads as zeroes, like it did when the bits
+	// were taken from the stream directly.
+	delete[] _srcCopy;
+	_srcCopy = 0;
+	_srcData = src->readInPlace(nPacked);
+	if (!_srcData) {
+		_srcCopy = new byte[nPacked];
+		const uint32 bytesRead = src->read(_srcCopy, nPacked);
+		memset(_srcCopy + bytesRead, 0, nPacked - bytesRead);
+		_srcData = _srcCopy;
 	}
 }
 
-uint32 Decompressor::getBitsMSB(int n) {
-	// fetching more data to buffer if needed
-	if (_nBits < n)
-		fetchBitsMSB();
-	uint32 ret = _dwBits >> (32 - n);
-	_dwBits <<= n;
-	_nBits -= n;
-	return ret;
+void Decompressor::readTail(byte *tail) const {
+	memset(tail, 0, 8);
+	memcpy(tail, _srcData + _dwRead, _szPacked - _dwRead);
 }
 
-byte Decompressor::getByteMSB() {
-	return getBitsMSB(8);
+void Decompressor::fetchBitsMSB() {
+	// Fill the buffer up to 56 to 63 bits, in one go. The bits following
+	// the last full byte are loaded as well, which does no harm, as they
+	// are or'ed in again (with the same value) on the next refill.
+	if (_dwRead + 8 <= _szPacked) {
+		_dwBits |= readBE64(_srcData + _dwRead) >> _nBits;
+	} else if (_dwRead < _szPacked) {
+		byte tail[8];
+		readTail(tail);
+		_dwBits |= readBE64(tail) >> _nBits;
+	}
+	_dwRead += (63 - _nBits) >> 3;
+	_nBits |= 56;
 }
 
 void Decompressor::fetchBitsLSB() {
-	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << _nBits;
-		_nBits += 8;
-		_dwRead++;
+	if (_dwRead + 8 <= _szPacked) {
+		_dwBits |= readLE64(_srcData + _dwRead) << _nBits;
+	} else if (_dwRead < _szPacked) {
+		byte tail[8];
+		readTail(tail);
+		_dwBits |= readLE64(tail) << _nBits;
 	}
+	_dwRead += (63 - _nBits) >> 3;
+	_nBits |= 56;
 }
 
-uint32 Decompressor::getBitsLSB(int n) {
-	// fetching more data to buffer if needed
-	if (_nBits < n)
-		fetchBitsLSB();
-	uint32 ret = (_dwBits & ~((~0) << n));
-	_dwBits >>= n;
-	_nBits -= n;
-	return ret;
-}
-
-byte Decompressor::getByteLSB() {
-	return getBitsLSB(8);
+void Decompressor::copyFromDest(uint32 distance, uint32 length) {
+	byte *dest = _dest + _dwWrote;
+	const byte *src = dest - distance;
+	_dwWrote += length;
+
+	if (distance >= length) {
+		memcpy(dest, src, length);
+	} else {
+		// Overlapping: every byte may depend on one written just before
+		while (length--)
+			*dest++ = *src++;
+	}
 }
 
-void Decompressor::putByte(byte b) {
-	_dest[_dwWrote++] = b;
-}
 //-------------------------------
 //  Huffman decompressor
 //-------------------------------
-int DecompressorHuffman::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorHuffman::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
 								uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
-	byte numnodes;
 	int16 c;
 	uint16 terminator;
 
-	numnodes = _src->readByte();
-	terminator = _src->readByte() | 0x100;
-	_nodes = new byte [numnodes << 1];
-	_src->read(_nodes, numnodes << 1);
+	_numNodes = getHeaderByte();
+	terminator = getHeaderByte() | 0x100;
+	if (_dwRead + (_numNodes << 1) > _szPacked)
+		return 1;
+	_nodes = _srcData + _dwRead;
+	_dwRead += _numNodes << 1;
+
+	buildLookupTable();
 
 	while ((c = getc2()) != terminator && (c >= 0) && !isFinished())
 		putByte(c);
 
-	delete[] _nodes;
 	return _dwWrote == _szUnpacked ? 0 : 1;
 }
 
+void DecompressorHuffman::buildLookupTable() {
+	// Walk the tree for every possible combination of the next kLookupBits
+	// bits, so that getc2() usually needs a single table lookup per code
+	for (int bits = 0; bits < (1 << kLookupBits); bits++) {
+		LookupEntry &entry = _lookup[bits];
+		int node = 0;
+		int length = 0;
+
+		entry.leaf = false;
+		while (length < kLookupBits && node < _numNodes && _nodes[(node << 1) + 1]) {
+			const byte children = _nodes[(node << 1) + 1];
+			if (bits & (1 << (kLookupBits - 1 - length))) {
+				length++;
+				if (!(children & 0x0F)) {
+					// Escape code, a literal byte follows
+					entry.leaf = true;
+					node = -1;
+					break;
+				}
+				node += children & 0x0F; // use lower 4 bits
+			} else {
+				length++;
+				node += children >> 4; // use higher 4 bits
+			}
+		}
+
+		if (node >= _numNodes) {
+			// Corrupt tree, getc2() reports this by returning -1
+			entry.leaf = true;
+			entry.value = -2;
+		} else if (!entry.leaf && (length < kLookupBits || !_nodes[(node << 1) + 1])) {
+			entry.leaf = true;
+			entry.value = (int16)(_nodes[node << 1] | (_nodes[(node << 1) + 1] << 8));
+		} else {
+			entry.value = node;
+		}
+		entry.length = length;
+	}
+}
+
 int16 DecompressorHuffman::getc2() {
-	byte *node = _nodes;
-	int16 next;
-	while (node[1]) {
+	const LookupEntry &entry = _lookup[peekBitsMSB(kLookupBits)];
+	skipBitsMSB(entry.length);
+
+	if (entry.leaf) {
+		if (entry.value == -1)
+			return getByteMSB() | 0x100;
+		return entry.value == -2 ? -1 : entry.value;
+	}
+
+	// Codes longer than kLookupBits bits are rare, continue bit by bit
+	int node = entry.value;
+	while (_nodes[(node << 1) + 1]) {
+		const byte children = _nodes[(node << 1) + 1];
 		if (getBitsMSB(1)) {
-			next = node[1] & 0x0F; // use lower 4 bits
-			if (next == 0)
+			if (!(children & 0x0F))
 				return getByteMSB() | 0x100;
+			node += children & 0x0F; // use lower 4 bits
 		} else
-			next = node[1] >> 4; // use higher 4 bits
-		node += next << 1;
+			node += children >> 4; // use higher 4 bits
+		if (node >= _numNodes)
+			return -1;
 	}
-	return (int16)(*node | (node[1] << 8));
+	return (int16)(_nodes[node << 1] | (_nodes[(node << 1) + 1] << 8));
 }
 
 //-------------------------------
 // LZW Decompressor for SCI0/01/1
 //-------------------------------
-void DecompressorLZW::init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+void DecompressorLZW::init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
 	Decompressor::init(src, dest, nPacked, nUnpacked);
 
 	_numbits = 9;
@@ -150,7 +228,7 @@ void DecompressorLZW::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
 	_endtoken = 0x1ff;
 }
 
-int DecompressorLZW::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorLZW::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
 								uint32 nUnpacked) {
 	byte *buffer = NULL;
 
@@ -176,29 +254,28 @@ int DecompressorLZW::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
 	return 0;
 }
 
-int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPacked,
+uint32 DecompressorLZW::putToken(const Token &token) {
+	const uint32 length = MIN<uint32>(token.length, _szUnpacked - _dwWrote);
+	copyFromDest(_dwWrote - token.offset, length);
+	return length;
+}
+
+int DecompressorLZW::unpackLZW(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                                 uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
 
 	uint16 token; // The last received value
 	uint16 tokenlastlength = 0;
 
-	uint16 *tokenlist = (uint16 *)malloc(4096 * sizeof(uint16)); // pointers to dest[]
-	uint16* tokenlengthlist = (uint16 *)malloc(4096 * sizeof(uint16)); // char length of each token
-	if (!tokenlist || !tokenlengthlist) {
-		free(tokenlist);
-		free(tokenlengthlist);
-
-		error("[DecompressorLZW::unpackLZW] Cannot allocate token memory buffers");
-	}
+	// The string of token n is the string of the token which came before
+	// n was added, plus one byte, so all strings can be found in the output
+	Token *tokens = new Token[4096];
 
 	while (!isFinished()) {
 		token = getBitsLSB(_numbits);
 
 		if (token == 0x101) {
-			free(tokenlist);
-			free(tokenlengthlist);
-
+			delete[] tokens;
 			return 0; // terminator
 		}
 
@@ -210,22 +287,16 @@ int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPack
 			if (token > 0xff) {
 				if (token >= _curtoken) {
 					warning("unpackLZW: Bad token %x", token);
-
-					free(tokenlist);
-					free(tokenlengthlist);
-
+					delete[] tokens;
 					return SCI_ERROR_DECOMPRESSION_ERROR;
 				}
-				tokenlastlength = tokenlengthlist[token] + 1;
+				tokenlastlength = tokens[token].length;
 				if (_dwWrote + tokenlastlength > _szUnpacked) {
 					// For me this seems a normal situation, It's necessary to handle it
 					warning("unpackLZW: Trying to write beyond the end of array(len=%d, destctr=%d, tok_len=%d)",
 					        _szUnpacked, _dwWrote, tokenlastlength);
-					for (int i = 0; _dwWrote < _szUnpacked; i++)
-						putByte(dest[tokenlist[token] + i]);
-				} else
-					for (int i = 0; i < tokenlastlength; i++)
-						putByte(dest[tokenlist[token] + i]);
+				}
+				putToken(tokens[token]);
 			} else {
 				tokenlastlength = 1;
 				if (_dwWrote >= _szUnpacked)
@@ -238,42 +309,32 @@ int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPack
 				_endtoken = (_endtoken << 1) + 1;
 			}
 			if (_curtoken <= _endtoken) {
-				tokenlist[_curtoken] = _dwWrote - tokenlastlength;
-				tokenlengthlist[_curtoken] = tokenlastlength;
+				tokens[_curtoken].offset = _dwWrote - tokenlastlength;
+				tokens[_curtoken].length = tokenlastlength + 1;
 				_curtoken++;
 			}
 
 		}
 	}
 
-	free(tokenlist);
-	free(tokenlengthlist);
+	delete[] tokens;
 
 	return _dwWrote == _szUnpacked ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
 
-int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorLZW::unpackLZW1(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                                 uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
 
-	byte *stak = (byte *)malloc(0x1014);
-	unsigned int tokensSize = 0x1004 * sizeof(Tokenlist);
-	Tokenlist *tokens = (Tokenlist *)malloc(tokensSize);
-	if (!stak || !tokens) {
-		free(stak);
-		free(tokens);
-
-		error("[DecompressorLZW::unpackLZW1] Cannot allocate decompression buffers");
-	}
-
-	memset(tokens, 0, tokensSize);
-
-	byte lastchar = 0;
-	uint16 stakptr = 0, lastbits = 0;
+	// Unlike in unpackLZW(), the token for the previous string plus one
+	// byte is added after the first byte of the next string is known. As
+	// that byte is written right after the previous string, the token can
+	// still be described by its position in the output.
+	Token *tokens = new Token[0x1004];
+	Token last = { 0, 0 };
 
 	byte decryptstart = 0;
 	uint16 bitstring;
-	uint16 token;
 	bool bExit = false;
 
 	while (!isFinished() && !bExit) {
@@ -284,9 +345,11 @@ int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPac
 				bExit = true;
 				continue;
 			}
+			last.offset = _dwWrote;
+			last.length = 1;
 			putByte(bitstring);
-			lastbits = bitstring;
-			lastchar = (bitstring & 0xff);
+			if (_dwWrote == _szUnpacked)
+				bExit = true;
 			decryptstart = 1;
 			break;
 
@@ -304,41 +367,41 @@ int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPac
 				continue;
 			}
 
-			token = bitstring;
-			if (token >= _curtoken) { // index past current point
-				token = lastbits;
-				stak[stakptr++] = lastchar;
-			}
-			while ((token > 0xff) && (token < 0x1004)) { // follow links back in data
-				stak[stakptr++] = tokens[token].data;
-				token = tokens[token].next;
-			}
-			lastchar = stak[stakptr++] = token & 0xff;
-			// put stack in buffer
-			while (stakptr > 0) {
-				putByte(stak[--stakptr]);
-				if (_dwWrote == _szUnpacked) {
-					bExit = true;
-					continue;
-				}
+			const uint32 offset = _dwWrote;
+			Token current;
+			if (bitstring >= _curtoken) {
+				// The token being defined: the previous string, plus its
+				// own first byte
+				current.offset = last.offset;
+				current.length = last.length + 1;
+				putToken(current);
+			} else if (bitstring > 0xff) {
+				current = tokens[bitstring];
+				putToken(current);
+			} else {
+				current.length = 1;
+				putByte(bitstring);
 			}
+			if (_dwWrote == _szUnpacked)
+				bExit = true;
+
 			// put token into record
 			if (_curtoken <= _endtoken) {
-				tokens[_curtoken].data = lastchar;
-				tokens[_curtoken].next = lastbits;
+				tokens[_curtoken].offset = last.offset;
+				tokens[_curtoken].length = last.length + 1;
 				_curtoken++;
 				if (_curtoken == _endtoken && _numbits < 12) {
 					_numbits++;
 					_endtoken = (_endtoken << 1) + 1;
 				}
 			}
-			lastbits = bitstring;
+			last.offset = offset;
+			last.length = current.length;
 			break;
 		}
 	}
 
-	free(stak);
-	free(tokens);
+	delete[] tokens;
 
 	return _dwWrote == _szUnpacked ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
@@ -621,7 +684,7 @@ void DecompressorLZW::reorderView(byte *src, byte *dest) {
 // DCL decompressor for SCI1.1
 //----------------------------------------------
 
-int DecompressorDCL::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
+int DecompressorDCL::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked,
                             uint32 nUnpacked) {
 	return Common::decompressDCL(src, dest, nPacked, nUnpacked) ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
@@ -632,7 +695,7 @@ int DecompressorDCL::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
 // STACpack/LZS decompressor for SCI32
 // Based on Andre Beck's code from http://micky.ibh.de/~beck/stuff/lzs4i4l/
 //----------------------------------------------
-int DecompressorLZS::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+int DecompressorLZS::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
 	init(src, dest, nPacked, nUnpacked);
 	return unpackLZS();
 }
@@ -660,8 +723,10 @@ int DecompressorLZS::unpackLZS() {
 				}
 				copyComp(offs, clen);
 			}
-		} else // Literal byte follows
+		} else if (_dwWrote < _szUnpacked) // Literal byte follows
 			putByte(getByteMSB());
+		else
+			getByteMSB();
 	} // end of while ()
 	return _dwWrote == _szUnpacked ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
@@ -698,10 +763,11 @@ uint32 DecompressorLZS::getCompLen() {
 }
 
 void DecompressorLZS::copyComp(int offs, uint32 clen) {
-	int hpos = _dwWrote - offs;
-
-	while (clen--)
-		putByte(_dest[hpos++]);
+	if ((uint32)offs > _dwWrote) {
+		warning("lzsDecomp: copy from before the start of the data");
+		offs = _dwWrote;
+	}
+	copyFromDest(offs, MIN<uint32>(clen, _szUnpacked - _dwWrote));
 }
 
 #endif	// #ifdef ENABLE_SCI32
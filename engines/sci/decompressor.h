@@ -26,7 +26,7 @@
 #include "common/scummsys.h"
 
 namespace Common {
-class ReadStream;
+class SeekableReadStream;
 }
 
 namespace Sci {
@@ -48,14 +48,19 @@ enum ResourceCompression {
 /**
  * Base class for decompressors.
  * Simply copies nPacked bytes from src to dest.
+ *
+ * Subclasses access the packed data in memory, straight in the stream if
+ * possible (see Common::SeekableReadStream::readInPlace()), and then take
+ * bits from a 64 bit buffer, which only needs to be refilled every few
+ * codes.
  */
 class Decompressor {
 public:
-	Decompressor() {}
-	virtual ~Decompressor() {}
+	Decompressor() : _srcData(0), _srcCopy(0) {}
+	virtual ~Decompressor();
 
 
-	virtual int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	virtual int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
 	/**
@@ -66,56 +71,115 @@ protected:
 	 * @param nUnpacket	size of unpacked data
 	 * @return 0 on success, non-zero on error
 	 */
-	virtual void init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	virtual void init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 	/**
-	 * Get a number of bits from _src stream, starting with the most
-	 * significant unread bit of the current four byte block.
-	 * @param n		number of bits to get
+	 * Get a number of bits from the packed data, most significant bit
+	 * first.
+	 * @param n		number of bits to get, at most 32
 	 * @return n-bits number
 	 */
-	uint32 getBitsMSB(int n);
+	uint32 getBitsMSB(int n) {
+		if (_nBits < n)
+			fetchBitsMSB();
+		const uint32 ret = (uint32)(_dwBits >> (64 - n));
+		_dwBits <<= n;
+		_nBits -= n;
+		return ret;
+	}
 
 	/**
-	 * Get a number of bits from _src stream, starting with the least
-	 * significant unread bit of the current four byte block.
-	 * @param n		number of bits to get
+	 * Get a number of bits from the packed data, least significant bit
+	 * first.
+	 * @param n		number of bits to get, at most 32
 	 * @return n-bits number
 	 */
-	uint32 getBitsLSB(int n);
+	uint32 getBitsLSB(int n) {
+		if (_nBits < n)
+			fetchBitsLSB();
+		const uint32 ret = (uint32)_dwBits & (n == 32 ? 0xFFFFFFFF : ((1u << n) - 1));
+		_dwBits >>= n;
+		_nBits -= n;
+		return ret;
+	}
 
 	/**
-	 * Get one byte from _src stream.
+	 * Return the next bits of the packed data, most significant bit first,
+	 * without consuming them. Use skipBitsMSB() to consume them.
+	 * @param n		number of bits to get, at most 32
+	 * @return n-bits number
+	 */
+	uint32 peekBitsMSB(int n) {
+		if (_nBits < n)
+			fetchBitsMSB();
+		return (uint32)(_dwBits >> (64 - n));
+	}
+
+	void skipBitsMSB(int n) {
+		_dwBits <<= n;
+		_nBits -= n;
+	}
+
+	/**
+	 * Get one byte from the packed data.
 	 * @return byte
 	 */
-	byte getByteMSB();
-	byte getByteLSB();
+	byte getByteMSB() { return getBitsMSB(8); }
+	byte getByteLSB() { return getBitsLSB(8); }
+
+	/**
+	 * Get one byte from the packed data, ignoring the bit buffer. May only
+	 * be used before any bits have been read.
+	 */
+	byte getHeaderByte() {
+		assert(!_nBits);
+		const byte b = (_dwRead < _szPacked) ? _srcData[_dwRead] : 0;
+		_dwRead++;
+		return b;
+	}
 
 	void fetchBitsMSB();
 	void fetchBitsLSB();
 
+	/**
+	 * Copy the last (less than 8) bytes of the packed data, starting at
+	 * _dwRead, to tail, and fill it up with zeroes.
+	 */
+	void readTail(byte *tail) const;
+
 	/**
 	 * Write one byte into _dest stream
 	 * @param b byte to put
 	 */
+	void putByte(byte b) {
+		_dest[_dwWrote++] = b;
+	}
 
-	virtual void putByte(byte b);
+	/**
+	 * Copy length bytes, which start distance bytes before the current
+	 * position in _dest, to the current position. The source and the
+	 * destination may overlap, in which case the copied bytes repeat.
+	 * The caller has to check that the bytes fit into _dest.
+	 */
+	void copyFromDest(uint32 distance, uint32 length);
 
 	/**
 	 * Returns true if all expected data has been unpacked to _dest
 	 * and there is no more data in _src.
 	 */
 	bool isFinished() {
-		return (_dwWrote == _szUnpacked) && (_dwRead >= _szPacked);
+		// Bytes in the bit buffer don't count as read
+		return (_dwWrote == _szUnpacked) && (_dwRead - _nBits / 8 >= _szPacked);
 	}
 
-	uint32 _dwBits;		///< bits buffer
+	uint64 _dwBits;		///< bits buffer
 	byte _nBits;		///< number of unread bits in _dwBits
 	uint32 _szPacked;	///< size of the compressed data
 	uint32 _szUnpacked;	///< size of the decompressed data
-	uint32 _dwRead;		///< number of bytes read from _src
+	uint32 _dwRead;		///< number of bytes taken from _srcData
 	uint32 _dwWrote;	///< number of bytes written to _dest
-	Common::ReadStream *_src;
+	const byte *_srcData;	///< the packed data
+	byte *_srcCopy;		///< the packed data, if it is not accessible in the stream
 	byte *_dest;
 };
 
@@ -124,12 +188,31 @@ protected:
  */
 class DecompressorHuffman : public Decompressor {
 public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
+	enum {
+		kLookupBits = 8
+	};
+
+	/**
+	 * What happens after reading kLookupBits bits, starting at the root of
+	 * the tree: either a leaf, or the escape code for a literal byte is
+	 * reached after 'length' bits, or (if length is kLookupBits) decoding
+	 * continues bit by bit at 'node'.
+	 */
+	struct LookupEntry {
+		int16 value;	///< the leaf value, or -1 for the escape code, or the node to continue at
+		byte length;	///< number of bits used
+		bool leaf;		///< true for leaves and escape codes
+	};
+
+	void buildLookupTable();
 	int16 getc2();
 
-	byte *_nodes;
+	const byte *_nodes;
+	byte _numNodes;
+	LookupEntry _lookup[1 << kLookupBits];
 };
 
 /**
@@ -141,8 +224,8 @@ public:
 	DecompressorLZW(int nCompression) {
 		_compression = nCompression;
 	}
-	void init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	void init(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
 	enum {
@@ -152,8 +235,8 @@ protected:
 	};
 	// unpacking procedures
 	// TODO: unpackLZW and unpackLZW1 are similar and should be merged
-	int unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
-	int unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpackLZW1(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpackLZW(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 	// functions to post-process view and pic resources
 	void reorderPic(byte *src, byte *dest, int dsize);
@@ -162,11 +245,21 @@ protected:
 	int getRLEsize(byte *rledata, int dsize);
 	void buildCelHeaders(byte **seeker, byte **writer, int celindex, int *cc_lengths, int max);
 
-	// decompressor data
-	struct Tokenlist {
-		byte data;
-		uint16 next;
+	/**
+	 * The string of a token is kept in the output: it starts 'offset'
+	 * bytes into _dest and is 'length' bytes long.
+	 */
+	struct Token {
+		uint32 offset;
+		uint16 length;
 	};
+
+	/**
+	 * Write the string of a token to _dest, or as much of it as fits.
+	 * @return the number of bytes written
+	 */
+	uint32 putToken(const Token &token);
+
 	uint16 _numbits;
 	uint16 _curtoken, _endtoken;
 	int _compression;
@@ -177,7 +270,7 @@ protected:
  */
 class DecompressorDCL : public Decompressor {
 public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 };
 
 #ifdef ENABLE_SCI32
@@ -186,7 +279,7 @@ public:
  */
 class DecompressorLZS : public Decompressor {
 public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 protected:
 	int unpackLZS();
 	uint32 getCompLen();
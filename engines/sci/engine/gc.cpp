@@ -22,6 +22,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 namespace Sci {
@@ -160,8 +161,23 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	return normalizeAddresses(s->_segMan, wm._map);
 }
 
-void run_gc(EngineState *s) {
+void run_gc(EngineState *s, bool onlyIfChanged) {
 	SegManager *segMan = s->_segMan;
+	EngineState::GCStatistics &stats = s->gcStats;
+
+	// Objects only become garbage after they have been allocated, and the
+	// heap can only grow through allocations. If nothing has been allocated
+	// since the last collection, any garbage left is already accounted for
+	// in the memory used then, and collecting it can wait until the next
+	// allocation. This saves the full marking pass in scenes which do not
+	// allocate anything, which is most of the time.
+	if (onlyIfChanged && stats.runs && segMan->getHeapChanges() == stats.lastHeapChanges) {
+		stats.skipped++;
+		return;
+	}
+
+	const uint32 startTime = g_system->getMillis();
+	uint32 freed = 0;
 
 	// Some debug stuff
 	debugC(kDebugLevelGC, "[GC] Running...");
@@ -195,6 +211,7 @@ void run_gc(EngineState *s) {
 				if (!activeRefs->contains(addr)) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
+					freed++;
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
@@ -207,6 +224,16 @@ void run_gc(EngineState *s) {
 
 	delete activeRefs;
 
+	const uint32 pause = g_system->getMillis() - startTime;
+	stats.runs++;
+	stats.freed += freed;
+	stats.lastPause = pause;
+	stats.totalPause += pause;
+	if (pause > stats.maxPause)
+		stats.maxPause = pause;
+	stats.lastHeapChanges = segMan->getHeapChanges();
+	debugC(kDebugLevelGC, "[GC] Freed %d objects in %d ms", freed, pause);
+
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -50,10 +50,17 @@ typedef Common::HashMap<reg_t, bool, reg_t_Hash> AddrSet;
 AddrSet *findAllActiveReferences(EngineState *s);
 
 /**
- * Runs garbage collection on the current system state
+ * Runs garbage collection on the current system state.
+ * This is always a full mark and sweep of the whole heap. Marking in
+ * steps would need a write barrier on every store of a reg_t, so scenes
+ * which keep allocating still pay for the full pass every
+ * scriptGCInterval kernel calls.
  * @param s The state in which we should gc
+ * @param onlyIfChanged If set, the collection is skipped when no
+ *        deallocatable objects have been allocated and no scripts have
+ *        been unloaded since the last collection
  */
-void run_gc(EngineState *s);
+void run_gc(EngineState *s, bool onlyIfChanged = false);
 
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
@@ -206,6 +206,13 @@ reg_t kScriptID(EngineState *s, int argc, reg_t *argv) {
 	if (argv[0].segment)
 		return argv[0];
 
+	// Rooms are loaded through here, after the game has stored the number
+	// of the new room in its global. Queue the resources a room usually
+	// needs, so that those which its init code does not ask for right away
+	// get loaded while the game waits, instead of when they are first used.
+	if (script == s->currentRoomNumber() && !s->_segMan->getScriptSegment(script))
+		g_sci->getResMan()->prefetchRoomResources(script);
+
 	SegmentId scriptSeg = s->_segMan->getScriptSegment(script, SCRIPT_GET_LOAD);
 
 	if (!scriptSeg)
@@ -0,0 +1,122 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef SCI_ENGINE_PATHFINDING_H
+#define SCI_ENGINE_PATHFINDING_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Sci {
+
+// SCI-defined polygon types
+enum {
+	POLY_TOTAL_ACCESS = 0,
+	POLY_NEAREST_ACCESS = 1,
+	POLY_BARRED_ACCESS = 2,
+	POLY_CONTAINED_ACCESS = 3
+};
+
+/** A polygon, as read from an SCI polygon object */
+struct PathfindingPolygon {
+	int type;
+	Common::Array<Common::Point> points;
+};
+
+typedef Common::Array<PathfindingPolygon> PathfindingPolygonSet;
+
+/** The input of kAvoidPath */
+struct PathfindingQuery {
+	PathfindingPolygonSet polygons;
+	Common::Point start, end;
+
+	// Screen size
+	int width, height;
+
+	// Optimization level (0, 1 or 2)
+	int opt;
+
+	// Set in LSL5 room 660, see findPath()
+	bool lsl5Room660;
+
+	PathfindingQuery() : width(320), height(190), opt(1), lsl5Room660(false) {}
+};
+
+struct VisibilityGraph;
+
+/**
+ * Remembers which polygon vertices can see each other, for the last few
+ * polygon sets that paths were searched in. Rooms usually keep the same
+ * polygons for a long time, while their actors ask for new paths every few
+ * steps, so most of the work of findPath() can be shared between calls.
+ * The polygon set is compared by contents, so it does not matter whether
+ * the scripts create new polygon objects or modify the old ones.
+ */
+class PathfindingCache {
+public:
+	PathfindingCache();
+	~PathfindingCache();
+
+	void clear();
+
+	/**
+	 * Returns the visibility graph of the given polygon set, creating an
+	 * empty one if necessary.
+	 * @param key			the contents of the polygon set
+	 * @param vertexCount	the number of vertices in the polygon set
+	 * @return the graph, or NULL if the polygon set is too large to be cached
+	 */
+	VisibilityGraph *getGraph(const Common::Array<int16> &key, uint vertexCount);
+
+	struct Statistics {
+		uint32 hits;		///< Paths searched in a cached polygon set
+		uint32 misses;		///< Paths searched in a polygon set which was not cached
+		uint32 uncached;	///< Paths searched without the cache (start or end point on an edge)
+	};
+
+	Statistics &getStatistics() { return _stats; }
+
+private:
+	Common::Array<VisibilityGraph *> _graphs;
+	uint32 _useCounter;
+	Statistics _stats;
+};
+
+/**
+ * Computes a path from query.start to query.end around the polygons. If the
+ * end point cannot be reached, the path only leads up to the start point.
+ * @param query		the input of kAvoidPath
+ * @param cache		the cache to use, or NULL
+ * @param path		receives the points of the path
+ * @return false if no path could be computed at all
+ */
+bool findPath(const PathfindingQuery &query, PathfindingCache *cache, Common::Array<Common::Point> &path);
+
+/**
+ * Checks whether a point lies inside or on the edge of a polygon. The type
+ * of the polygon is ignored.
+ */
+bool polygonContainsPoint(const PathfindingPolygon &polygon, const Common::Point &p);
+
+} // End of namespace Sci
+
+#endif // SCI_ENGINE_PATHFINDING_H
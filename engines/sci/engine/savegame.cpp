@@ -221,6 +221,8 @@ void SegManager::saveLoadWithSerializer(Common::Serializer &s) {
 
 	syncArray<Class>(s, _classTable);
 
+	invalidateSelectorCache();
+
 	// Now that all scripts are loaded, init their objects
 	for (uint i = 0; i < _heap.size(); i++) {
 		if (!_heap[i] ||  _heap[i]->getType() != SEG_TYPE_SCRIPT)
@@ -49,6 +49,8 @@ Script::Script() : SegmentObj(SEG_TYPE_SCRIPT) {
 	_localsCount = 0;
 
 	_markedAsDeleted = false;
+
+	_instructionIndex = NULL;
 }
 
 Script::~Script() {
@@ -61,6 +63,53 @@ void Script::freeScript() {
 	_bufSize = 0;
 
 	_objects.clear();
+
+	invalidateInstructions();
+}
+
+void Script::invalidateInstructions() {
+	free(_instructionIndex);
+	_instructionIndex = NULL;
+	_instructions.clear();
+}
+
+const PMachineInstruction &Script::decodeInstruction(uint16 offset) {
+	assert(offset < _bufSize);
+
+	if (!_instructionIndex)
+		_instructionIndex = (uint16 *)calloc(_bufSize, sizeof(uint16));
+
+	// Only decode into the cache while the index can hold it, which is
+	// for all practical purposes always
+	PMachineInstruction *instruction = &_uncachedInstruction;
+	if (_instructionIndex && _instructions.size() < 0xFFFF) {
+		_instructions.push_back(PMachineInstruction());
+		_instructionIndex[offset] = _instructions.size();
+		instruction = &_instructions.back();
+	}
+
+	instruction->size = readPMachineInstruction(_buf + offset, instruction->extOpcode, instruction->opparams);
+
+	// Resolve relative branches and calls here, so that the VM doesn't have
+	// to redo it (and check the branch target) every time they are executed
+	instruction->target = 0;
+	switch (instruction->extOpcode >> 1) {
+	case op_bt:
+	case op_bnt:
+	case op_jmp:
+		instruction->target = offset + instruction->size + instruction->opparams[0];
+		if (instruction->target >= getScriptSize())
+			error("[VM] Branch at offset %d jumps past the end of script %d (offset %d, script is %d bytes)",
+				offset, _nr, instruction->target, getScriptSize());
+		break;
+	case op_call:
+		instruction->target = offset + instruction->size + instruction->opparams[0];
+		break;
+	default:
+		break;
+	}
+
+	return *instruction;
 }
 
 void Script::init(int script_nr, ResourceManager *resMan) {
@@ -79,6 +128,8 @@ void Script::init(int script_nr, ResourceManager *resMan) {
 	_buf = 0;
 	_heapStart = 0;
 
+	invalidateInstructions();
+
 	_scriptSize = script->size;
 	_bufSize = script->size;
 	_heapSize = 0;
@@ -145,6 +196,7 @@ void Script::load(ResourceManager *resMan) {
 
 	// Check scripts for matching signatures and patch those, if found
 	matchSignatureAndPatch(_nr, _buf, script->size);
+	invalidateInstructions();
 
 	if (getSciVersion() >= SCI_VERSION_1_1 && getSciVersion() <= SCI_VERSION_2_1) {
 		Resource *heap = resMan->findResource(ResourceId(kResourceTypeHeap, _nr), 0);
@@ -471,6 +523,7 @@ void Script::mcpyInOut(int dst, const void *src, size_t n) {
 	if (_buf) {
 		assert(dst + n <= _bufSize);
 		memcpy(_buf + dst, src, n);
+		invalidateInstructions();
 	}
 }
 
@@ -74,6 +74,17 @@ private:
 
 	ObjMap _objects;	/**< Table for objects, contains property variables */
 
+	/**
+	 * Cache of decoded instructions, filled as they are executed. For each
+	 * offset into _buf, _instructionIndex holds the index into _instructions
+	 * plus one, or 0 if the instruction at that offset was not decoded yet.
+	 */
+	uint16 *_instructionIndex;
+	Common::Array<PMachineInstruction> _instructions;
+	PMachineInstruction _uncachedInstruction;
+
+	const PMachineInstruction &decodeInstruction(uint16 offset);
+
 public:
 	int getLocalsOffset() const { return _localsOffset; }
 	uint16 getLocalsCount() const { return _localsCount; }
@@ -85,6 +96,22 @@ public:
 
 	int getScriptNumber() const { return _nr; }
 	SegmentId getLocalsSegment() const { return _localsSegment; }
+
+	/**
+	 * Returns the instruction at the given offset, as decoded by
+	 * readPMachineInstruction(). Every instruction is only decoded once, the
+	 * result is kept until the script is reloaded or written to.
+	 * The returned reference is only valid until the next call on this script.
+	 */
+	const PMachineInstruction &getInstruction(uint16 offset) {
+		if (_instructionIndex && _instructionIndex[offset])
+			return _instructions[_instructionIndex[offset] - 1];
+		return decodeInstruction(offset);
+	}
+
+	/** Drops all decoded instructions, e.g. after the script was modified. */
+	void invalidateInstructions();
+
 	reg_t *getLocalsBegin() { return _localsBlock ? _localsBlock->_locals.begin() : NULL; }
 	void syncLocalsBlock(SegManager *segMan);
 	ObjMap &getObjectMap() { return _objects; }
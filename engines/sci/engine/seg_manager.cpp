@@ -43,6 +43,11 @@ SegManager::SegManager(ResourceManager *resMan) {
 
 	_resMan = resMan;
 
+	_selectorCacheHits = 0;
+	_selectorCacheMisses = 0;
+
+	_heapChanges = 0;
+
 	createClassTable();
 }
 
@@ -75,6 +80,8 @@ void SegManager::resetSegMan() {
 	// Reinitialize class table
 	_classTable.clear();
 	createClassTable();
+
+	invalidateSelectorCache();
 }
 
 void SegManager::initSysStrings() {
@@ -153,6 +160,7 @@ void SegManager::deallocate(SegmentId seg) {
 		_scriptSegMap.erase(scr->getScriptNumber());
 		if (scr->getLocalsSegment())
 			deallocate(scr->getLocalsSegment());
+		invalidateSelectorCache();
 	}
 
 	delete mobj;
@@ -383,6 +391,7 @@ reg_t SegManager::allocateHunkEntry(const char *hunk_type, int size) {
 	table = (HunkTable *)_heap[_hunksSegId];
 
 	offset = table->allocEntry();
+	_heapChanges++;
 
 	reg_t addr = make_reg(_hunksSegId, offset);
 	Hunk *h = &(table->_table[offset]);
@@ -418,6 +427,7 @@ Clone *SegManager::allocateClone(reg_t *addr) {
 		table = (CloneTable *)_heap[_clonesSegId];
 
 	offset = table->allocEntry();
+	_heapChanges++;
 
 	*addr = make_reg(_clonesSegId, offset);
 	return &(table->_table[offset]);
@@ -432,6 +442,7 @@ List *SegManager::allocateList(reg_t *addr) {
 	table = (ListTable *)_heap[_listsSegId];
 
 	offset = table->allocEntry();
+	_heapChanges++;
 
 	*addr = make_reg(_listsSegId, offset);
 	return &(table->_table[offset]);
@@ -446,6 +457,7 @@ Node *SegManager::allocateNode(reg_t *addr) {
 	table = (NodeTable *)_heap[_nodesSegId];
 
 	offset = table->allocEntry();
+	_heapChanges++;
 
 	*addr = make_reg(_nodesSegId, offset);
 	return &(table->_table[offset]);
@@ -813,6 +825,7 @@ byte *SegManager::allocDynmem(int size, const char *descr, reg_t *addr) {
 	SegmentId seg;
 	SegmentObj *mobj = allocSegment(new DynMem(), &seg);
 	*addr = make_reg(seg, 0);
+	_heapChanges++;
 
 	DynMem &d = *(DynMem *)mobj;
 
@@ -848,6 +861,7 @@ SciArray<reg_t> *SegManager::allocateArray(reg_t *addr) {
 		table = (ArrayTable *)_heap[_arraysSegId];
 
 	offset = table->allocEntry();
+	_heapChanges++;
 
 	*addr = make_reg(_arraysSegId, offset);
 	return &(table->_table[offset]);
@@ -888,6 +902,7 @@ SciString *SegManager::allocateString(reg_t *addr) {
 		table = (StringTable *)_heap[_stringSegId];
 
 	offset = table->allocEntry();
+	_heapChanges++;
 
 	*addr = make_reg(_stringSegId, offset);
 	return &(table->_table[offset]);
@@ -983,6 +998,8 @@ int SegManager::instantiateScript(int scriptNum) {
 	scr->initializeClasses(this);
 	scr->initializeObjects(this, segmentId);
 
+	invalidateSelectorCache();
+
 	return segmentId;
 }
 
@@ -1001,6 +1018,8 @@ void SegManager::uninstantiateScript(int script_nr) {
 	if (scr->getLockers() > 0)
 		return;
 
+	invalidateSelectorCache();
+
 	// Free all classtable references to this script
 	for (uint i = 0; i < classTableSize(); i++)
 		if (getClass(i).reg.segment == segmentId)
@@ -1013,6 +1032,7 @@ void SegManager::uninstantiateScript(int script_nr) {
 	if (!scr->getLockers()) {
 		// The actual script deletion seems to be done by SCI scripts themselves
 		scr->markDeleted();
+		_heapChanges++;
 		debugC(kDebugLevelScripts, "Unloaded script 0x%x.", script_nr);
 	}
 }
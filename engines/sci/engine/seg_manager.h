@@ -43,6 +43,13 @@ enum ScriptLoadType {
 
 class Script;
 
+/** A cached result of lookupSelector(), see SegManager::findCachedSelector() */
+struct CachedSelector {
+	SelectorType type;
+	int varIndex;		///< For variables, the index of the variable
+	reg_t funcAddress;	///< For methods, the address of the method
+};
+
 class SegManager : public Common::Serializable {
 	friend class Console;
 public:
@@ -441,6 +448,73 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	// Selector lookup cache
+
+	/**
+	 * Returns the result of a previous lookupSelector() call for the given
+	 * selector on an object with the given base address (see
+	 * Object::getPos()), or NULL if there is none.
+	 * Cached results stay valid until scripts are loaded or unloaded:
+	 * lookups only depend on the method table of the object itself and on
+	 * its class and superclasses, which clones share with their base object.
+	 */
+	const CachedSelector *findCachedSelector(reg_t objPos, Selector selectorId) {
+		SelectorCache::const_iterator i = _selectorCache.find(SelectorCacheKey(objPos, selectorId));
+		if (i == _selectorCache.end()) {
+			_selectorCacheMisses++;
+			return NULL;
+		}
+		_selectorCacheHits++;
+		return &i->_value;
+	}
+
+	void cacheSelector(reg_t objPos, Selector selectorId, const CachedSelector &cached) {
+		_selectorCache[SelectorCacheKey(objPos, selectorId)] = cached;
+	}
+
+	void invalidateSelectorCache() { _selectorCache.clear(); }
+
+	/**
+	 * Returns the number of allocations of deallocatable objects and of
+	 * script unloads so far. Only these let the memory used by the heap grow,
+	 * so the garbage collector uses this to skip collections when there can
+	 * be no new garbage worth collecting.
+	 */
+	uint32 getHeapChanges() const { return _heapChanges; }
+
+	uint32 getSelectorCacheSize() const { return _selectorCache.size(); }
+	uint32 getSelectorCacheHits() const { return _selectorCacheHits; }
+	uint32 getSelectorCacheMisses() const { return _selectorCacheMisses; }
+	void resetSelectorCacheStats() { _selectorCacheHits = _selectorCacheMisses = 0; }
+
+private:
+	struct SelectorCacheKey {
+		reg_t objPos;
+		Selector selectorId;
+
+		SelectorCacheKey(reg_t pos, Selector id) : objPos(pos), selectorId(id) {}
+	};
+
+	struct SelectorCacheKey_Hash {
+		uint operator()(const SelectorCacheKey &x) const {
+			return (((uint)x.objPos.segment << 16) | x.objPos.offset) * 31 + x.selectorId;
+		}
+	};
+
+	struct SelectorCacheKey_EqualTo {
+		bool operator()(const SelectorCacheKey &x, const SelectorCacheKey &y) const {
+			return x.objPos == y.objPos && x.selectorId == y.selectorId;
+		}
+	};
+
+	typedef Common::HashMap<SelectorCacheKey, CachedSelector, SelectorCacheKey_Hash, SelectorCacheKey_EqualTo> SelectorCache;
+
+	SelectorCache _selectorCache;
+	uint32 _selectorCacheHits;
+	uint32 _selectorCacheMisses;
+
+	uint32 _heapChanges;
+
 private:
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
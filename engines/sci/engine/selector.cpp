@@ -264,31 +264,48 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 				PRINT_REG(obj_location));
 	}
 
-	index = obj->locateVarSelector(segMan, selectorId);
+	// Lookups only depend on the object's base (see SegManager::findCachedSelector())
+	const reg_t objPos = obj->getPos();
+	const CachedSelector *cached = segMan->findCachedSelector(objPos, selectorId);
+	CachedSelector result;
 
-	if (index >= 0) {
-		// Found it as a variable
-		if (varp) {
-			varp->obj = obj_location;
-			varp->varindex = index;
-		}
-		return kSelectorVariable;
+	if (cached) {
+		result = *cached;
 	} else {
-		// Check if it's a method, with recursive lookup in superclasses
-		while (obj) {
-			index = obj->funcSelectorPosition(selectorId);
-			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
-				return kSelectorMethod;
-			} else {
-				obj = segMan->getObject(obj->getSuperClassSelector());
+		result.type = kSelectorNone;
+		result.varIndex = -1;
+		result.funcAddress = NULL_REG;
+
+		index = obj->locateVarSelector(segMan, selectorId);
+
+		if (index >= 0) {
+			// Found it as a variable
+			result.type = kSelectorVariable;
+			result.varIndex = index;
+		} else {
+			// Check if it's a method, with recursive lookup in superclasses
+			while (obj) {
+				index = obj->funcSelectorPosition(selectorId);
+				if (index >= 0) {
+					result.type = kSelectorMethod;
+					result.funcAddress = obj->getFunction(index);
+					break;
+				} else {
+					obj = segMan->getObject(obj->getSuperClassSelector());
+				}
 			}
 		}
 
-		return kSelectorNone;
+		segMan->cacheSelector(objPos, selectorId, result);
+	}
+
+	if (result.type == kSelectorVariable && varp) {
+		varp->obj = obj_location;
+		varp->varindex = result.varIndex;
+	} else if (result.type == kSelectorMethod && fptr) {
+		*fptr = result.funcAddress;
 	}
+	return result.type;
 
 
 //	return _lookupSelector_function(segMan, obj, selectorId, fptr);
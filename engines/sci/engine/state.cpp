@@ -32,6 +32,7 @@
 #include "sci/engine/vm.h"
 #include "sci/engine/script.h"
 #include "sci/engine/message.h"
+#include "sci/engine/pathfinding.h"
 
 namespace Sci {
 
@@ -70,11 +71,13 @@ static const uint16 s_halfWidthSJISMap[256] = {
 EngineState::EngineState(SegManager *segMan)
 : _segMan(segMan), _dirseeker() {
 
+	_pathfindingCache = new PathfindingCache();
 	reset(false);
 }
 
 EngineState::~EngineState() {
 	delete _msgState;
+	delete _pathfindingCache;
 }
 
 void EngineState::reset(bool isRestoring) {
@@ -98,6 +101,7 @@ void EngineState::reset(bool isRestoring) {
 	lastWaitTime = 0;
 
 	gcCountDown = 0;
+	memset(&gcStats, 0, sizeof(gcStats));
 
 	_throttleCounter = 0;
 	_throttleLastTime = 0;
@@ -112,12 +116,21 @@ void EngineState::reset(bool isRestoring) {
 	_cursorWorkaroundActive = false;
 
 	scriptStepCounter = 0;
+	scriptStepStartTime = g_system->getMillis();
+	sleepTime = 0;
 	scriptGCInterval = GC_INTERVAL;
 
 	_videoState.reset();
 	_syncedAudioOptions = false;
 }
 
+uint32 EngineState::getScriptStepsPerSecond() const {
+	const uint32 runTime = g_system->getMillis() - scriptStepStartTime - sleepTime;
+	if (!runTime)
+		return 0;
+	return (uint32)(scriptStepCounter * 1000.0 / runTime);
+}
+
 void EngineState::speedThrottler(uint32 neededSleep) {
 	if (_throttleTrigger) {
 		uint32 curTime = g_system->getMillis();
@@ -44,6 +44,7 @@ namespace Sci {
 
 class EventManager;
 class MessageState;
+class PathfindingCache;
 class SoundCommandParser;
 
 enum AbortGameState {
@@ -199,6 +200,14 @@ public:
 	int16 gameIsRestarting; // is set when restarting (=1) or restoring the game (=2)
 
 	int scriptStepCounter; // Counts the number of steps executed
+	uint32 scriptStepStartTime; // Time at which scriptStepCounter was reset
+	uint32 sleepTime; // Time spent in SciEngine::sleep() since then
+
+	/**
+	 * Returns the number of steps executed per second since scriptStepCounter
+	 * was reset, not counting the time the game was sleeping.
+	 */
+	uint32 getScriptStepsPerSecond() const;
 	int scriptGCInterval; // Number of steps in between gcs
 
 	uint16 currentRoomNumber() const;
@@ -217,8 +226,22 @@ public:
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
 
+	/** Statistics about the garbage collector, see the stats console command */
+	struct GCStatistics {
+		uint32 runs;		///< Number of collections
+		uint32 skipped;		///< Number of periodic collections skipped, see run_gc()
+		uint32 freed;		///< Number of objects freed in total
+		uint32 lastPause;	///< Duration of the last collection, in ms
+		uint32 maxPause;	///< Duration of the longest collection, in ms
+		uint32 totalPause;	///< Duration of all collections, in ms
+		uint32 lastHeapChanges;	///< SegManager::getHeapChanges() at the last collection
+	} gcStats;
+
 	MessageState *_msgState;
 
+	/** Visibility graphs of recently used polygon sets, see kAvoidPath */
+	PathfindingCache *_pathfindingCache;
+
 	// MemorySegment provides access to a 256-byte block of memory that remains
 	// intact across restarts and restores
 	enum {
@@ -628,9 +628,13 @@ void run_vm(EngineState *s) {
 			error("run_vm(): program counter gone astray, addr: %d, code buffer size: %d",
 			s->xs->addr.pc.offset, scr->getBufSize());
 
-		// Get opcode
-		byte extOpcode;
-		s->xs->addr.pc.offset += readPMachineInstruction(scr->getBuf() + s->xs->addr.pc.offset, extOpcode, opparams);
+		// Get opcode. The instruction is copied, since the opcode may cause
+		// more instructions of this script to be decoded.
+		const PMachineInstruction &instruction = scr->getInstruction(s->xs->addr.pc.offset);
+		const byte extOpcode = instruction.extOpcode;
+		const uint16 target = instruction.target;
+		memcpy(opparams, instruction.opparams, sizeof(opparams));
+		s->xs->addr.pc.offset += instruction.size;
 		const byte opcode = extOpcode >> 1;
 		//debug("%s: %d, %d, %d, %d, acc = %04x:%04x, script %d, local script %d", opcodeNames[opcode], opparams[0], opparams[1], opparams[2], opparams[3], PRINT_REG(s->r_acc), scr->getScriptNumber(), local_script->getScriptNumber());
 
@@ -766,29 +770,17 @@ void run_vm(EngineState *s) {
 		case op_bt: // 0x17 (23)
 			// Branch relative if true
 			if (s->r_acc.offset || s->r_acc.segment)
-				s->xs->addr.pc.offset += opparams[0];
-
-			if (s->xs->addr.pc.offset >= local_script->getScriptSize())
-				error("[VM] op_bt: request to jump past the end of script %d (offset %d, script is %d bytes)",
-					local_script->getScriptNumber(), s->xs->addr.pc.offset, local_script->getScriptSize());
+				s->xs->addr.pc.offset = target;
 			break;
 
 		case op_bnt: // 0x18 (24)
 			// Branch relative if not true
 			if (!(s->r_acc.offset || s->r_acc.segment))
-				s->xs->addr.pc.offset += opparams[0];
-
-			if (s->xs->addr.pc.offset >= local_script->getScriptSize())
-				error("[VM] op_bnt: request to jump past the end of script %d (offset %d, script is %d bytes)",
-					local_script->getScriptNumber(), s->xs->addr.pc.offset, local_script->getScriptSize());
+				s->xs->addr.pc.offset = target;
 			break;
 
 		case op_jmp: // 0x19 (25)
-			s->xs->addr.pc.offset += opparams[0];
-
-			if (s->xs->addr.pc.offset >= local_script->getScriptSize())
-				error("[VM] op_jmp: request to jump past the end of script %d (offset %d, script is %d bytes)",
-					local_script->getScriptNumber(), s->xs->addr.pc.offset, local_script->getScriptSize());
+			s->xs->addr.pc.offset = target;
 			break;
 
 		case op_ldi: // 0x1a (26)
@@ -833,7 +825,7 @@ void run_vm(EngineState *s) {
 			StackPtr call_base = s->xs->sp - argc;
 			s->xs->sp[1].offset += s->r_rest;
 
-			uint16 localCallOffset = s->xs->addr.pc.offset + opparams[0];
+			uint16 localCallOffset = target;
 
 			ExecStack xstack(s->xs->objp, s->xs->objp, s->xs->sp,
 							(call_base->requireUint16()) + s->r_rest, call_base,
@@ -855,7 +847,7 @@ void run_vm(EngineState *s) {
 			// Run the garbage collector, if needed
 			if (s->gcCountDown-- <= 0) {
 				s->gcCountDown = s->scriptGCInterval;
-				run_gc(s);
+				run_gc(s, true);
 			}
 
 			// Call kernel function
@@ -364,6 +364,17 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj, Selector selectorid,
  */
 int readPMachineInstruction(const byte *src, byte &extOpcode, int16 opparams[4]);
 
+/**
+ * An instruction as decoded by readPMachineInstruction, see
+ * Script::getInstruction()
+ */
+struct PMachineInstruction {
+	int16 opparams[4];	///< The opcode parameters
+	uint16 size;		///< The length in bytes of the instruction
+	uint16 target;		///< The destination of a branch or call, resolved when decoded
+	byte extOpcode;		///< The extended opcode
+};
+
 } // End of namespace Sci
 
 #endif // SCI_ENGINE_VM_H
@@ -27,6 +27,7 @@
 #include "sci/sci.h"
 #include "sci/event.h"
 #include "sci/console.h"
+#include "sci/resource.h"
 #include "sci/engine/state.h"
 #include "sci/engine/kernel.h"
 #include "sci/graphics/screen.h"
@@ -320,14 +321,18 @@ SciEvent EventManager::getSciEvent(unsigned int mask) {
 
 void SciEngine::sleep(uint32 msecs) {
 	uint32 time;
-	const uint32 wakeup_time = g_system->getMillis() + msecs;
+	const uint32 start_time = g_system->getMillis();
+	const uint32 wakeup_time = start_time + msecs;
 
 	while (true) {
 		// let backend process events and update the screen
 		_eventMan->getSciEvent(SCI_EVENT_PEEK);
 		time = g_system->getMillis();
 		if (time + 10 < wakeup_time) {
-			g_system->delayMillis(10);
+			// Use the time to load resources the game is going to need,
+			// one at a time, so that we do not oversleep by much
+			if (!_resMan->prefetchNextResource())
+				g_system->delayMillis(10);
 		} else {
 			if (time < wakeup_time)
 				g_system->delayMillis(wakeup_time - time);
@@ -335,6 +340,9 @@ void SciEngine::sleep(uint32 msecs) {
 		}
 
 	}
+
+	if (_gamestate)
+		_gamestate->sleepTime += g_system->getMillis() - start_time;
 }
 
 
@@ -35,7 +35,7 @@
 namespace Sci {
 
 GfxCache::GfxCache(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette)
-	: _resMan(resMan), _screen(screen), _palette(palette) {
+	: _resMan(resMan), _screen(screen), _palette(palette), _viewUseCounter(0) {
 }
 
 GfxCache::~GfxCache() {
@@ -54,8 +54,8 @@ void GfxCache::purgeFontCache() {
 
 void GfxCache::purgeViewCache() {
 	for (ViewCache::iterator iter = _cachedViews.begin(); iter != _cachedViews.end(); ++iter) {
-		delete iter->_value;
-		iter->_value = 0;
+		delete iter->_value.view;
+		iter->_value.view = 0;
 	}
 
 	_cachedViews.clear();
@@ -76,14 +76,43 @@ GfxFont *GfxCache::getFont(GuiResourceId fontId) {
 	return _cachedFonts[fontId];
 }
 
+/**
+ * Frees the least recently used views, until at most MAX_CACHED_VIEWS views
+ * using at most MAX_CACHED_VIEW_MEMORY remain. The most recently used view
+ * is always kept.
+ */
+void GfxCache::freeOldViews() {
+	for (;;) {
+		uint32 memoryUsage = 0;
+		ViewCache::iterator oldest = _cachedViews.end();
+		for (ViewCache::iterator iter = _cachedViews.begin(); iter != _cachedViews.end(); ++iter) {
+			memoryUsage += iter->_value.view->getMemoryUsage();
+			if (oldest == _cachedViews.end() || iter->_value.lastUsed < oldest->_value.lastUsed)
+				oldest = iter;
+		}
+
+		if (_cachedViews.size() <= 1 || (_cachedViews.size() <= MAX_CACHED_VIEWS && memoryUsage <= MAX_CACHED_VIEW_MEMORY))
+			break;
+
+		delete oldest->_value.view;
+		_cachedViews.erase(oldest);
+	}
+}
+
 GfxView *GfxCache::getView(GuiResourceId viewId) {
-	if (_cachedViews.size() >= MAX_CACHED_VIEWS)
-		purgeViewCache();
+	ViewCache::iterator iter = _cachedViews.find(viewId);
+	if (iter != _cachedViews.end()) {
+		iter->_value.lastUsed = ++_viewUseCounter;
+		return iter->_value.view;
+	}
 
-	if (!_cachedViews.contains(viewId))
-		_cachedViews[viewId] = new GfxView(_resMan, _screen, _palette, viewId);
+	GfxView *view = new GfxView(_resMan, _screen, _palette, viewId);
+	CachedView &cachedView = _cachedViews[viewId];
+	cachedView.view = view;
+	cachedView.lastUsed = ++_viewUseCounter;
 
-	return _cachedViews[viewId];
+	freeOldViews();
+	return view;
 }
 
 int16 GfxCache::kernelViewGetCelWidth(GuiResourceId viewId, int16 loopNo, int16 celNo) {
@@ -31,7 +31,13 @@ class GfxFont;
 class GfxView;
 
 typedef Common::HashMap<int, GfxFont *> FontCache;
-typedef Common::HashMap<int, GfxView *> ViewCache;
+
+struct CachedView {
+	GfxView *view;
+	uint32 lastUsed;
+};
+
+typedef Common::HashMap<int, CachedView> ViewCache;
 
 /**
  * Cache class, handles caching of views/fonts
@@ -54,6 +60,7 @@ public:
 private:
 	void purgeFontCache();
 	void purgeViewCache();
+	void freeOldViews();
 
 	ResourceManager *_resMan;
 	GfxScreen *_screen;
@@ -61,6 +68,7 @@ private:
 
 	FontCache _cachedFonts;
 	ViewCache _cachedViews;
+	uint32 _viewUseCounter;
 };
 
 } // End of namespace Sci
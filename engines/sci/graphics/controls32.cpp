@@ -30,6 +30,7 @@
 #include "sci/graphics/compare.h"
 #include "sci/graphics/controls32.h"
 #include "sci/graphics/font.h"
+#include "sci/graphics/frameout.h"
 #include "sci/graphics/screen.h"
 #include "sci/graphics/text32.h"
 
@@ -180,7 +181,7 @@ void GfxControls32::kernelTexteditChange(reg_t controlObject) {
 			// Modify the buffer and show it
 			_text->createTextBitmap(controlObject, 0, 0, hunkId);
 
-			_text->drawTextBitmap(0, 0, nsRect, controlObject);
+			_text->drawTextBitmap(0, 0, nsRect, controlObject, Common::Rect(_screen->getDisplayWidth(), _screen->getDisplayHeight()));
 			//texteditCursorDraw(rect, text.c_str(), cursorPos);	// TODO: Cursor
 			g_system->updateScreen();
 		} else {
@@ -199,6 +200,9 @@ void GfxControls32::kernelTexteditChange(reg_t controlObject) {
 		textChanged = false;
 		g_sci->sleep(10);
 	}	// while
+
+	// The text was drawn behind the back of kFrameout
+	g_sci->_gfxFrameout->invalidate();
 }
 
 } // End of namespace Sci
@@ -21,6 +21,7 @@
  */
 
 #include "common/algorithm.h"
+#include "common/debug-channels.h"
 #include "common/events.h"
 #include "common/keyboard.h"
 #include "common/list_intern.h"
@@ -28,6 +29,8 @@
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "engines/engine.h"
+#include "graphics/font.h"
+#include "graphics/fontman.h"
 #include "graphics/surface.h"
 
 #include "sci/sci.h"
@@ -58,6 +61,9 @@ GfxFrameout::GfxFrameout(SegManager *segMan, ResourceManager *resMan, GfxCoordAd
 	_coordAdjuster = (GfxCoordAdjuster32 *)coordAdjuster;
 	_scriptsRunningWidth = 320;
 	_scriptsRunningHeight = 200;
+	_redrawAll = true;
+	_showRedrawRects = false;
+	resetFrameStatistics();
 }
 
 GfxFrameout::~GfxFrameout() {
@@ -68,6 +74,12 @@ void GfxFrameout::clear() {
 	deletePlaneItems(NULL_REG);
 	_planes.clear();
 	deletePlanePictures(NULL_REG);
+	_lastDrawStates.clear();
+	_redrawAll = true;
+}
+
+void GfxFrameout::resetFrameStatistics() {
+	memset(&_frameStats, 0, sizeof(_frameStats));
 }
 
 void GfxFrameout::kernelAddPlane(reg_t object) {
@@ -96,6 +108,7 @@ void GfxFrameout::kernelAddPlane(reg_t object) {
 	newPlane.pictureId = 0xFFFF;
 	newPlane.planePictureMirrored = false;
 	newPlane.planeBack = 0;
+	newPlane.blackout = false;
 	_planes.push_back(newPlane);
 
 	kernelUpdatePlane(object);
@@ -470,7 +483,7 @@ bool GfxFrameout::isPictureOutOfView(FrameoutEntry *itemEntry, Common::Rect plan
 	return false;
 }
 
-void GfxFrameout::drawPicture(FrameoutEntry *itemEntry, int16 planeOffsetX, int16 planeOffsetY, bool planePictureMirrored) {
+void GfxFrameout::drawPicture(FrameoutEntry *itemEntry, int16 planeOffsetX, int16 planeOffsetY, bool planePictureMirrored, const Common::Rect &clipRect) {
 	int16 pictureOffsetX = planeOffsetX;
 	int16 pictureX = itemEntry->x;
 	if ((planeOffsetX) || (itemEntry->picStartX)) {
@@ -493,18 +506,297 @@ void GfxFrameout::drawPicture(FrameoutEntry *itemEntry, int16 planeOffsetX, int1
 		}
 	}
 
-	itemEntry->picture->drawSci32Vga(itemEntry->celNo, pictureX, itemEntry->y, pictureOffsetX, pictureOffsetY, planePictureMirrored);
+	itemEntry->picture->drawSci32Vga(itemEntry->celNo, pictureX, itemEntry->y, pictureOffsetX, pictureOffsetY, planePictureMirrored, clipRect);
 	//	warning("picture cel %d %d", itemEntry->celNo, itemEntry->priority);
 }
 
+enum {
+	/** More dirty rects than this are merged into one */
+	MAX_DIRTY_RECTS = 16
+};
+
+static uint32 hashValue(uint32 hash, int32 value) {
+	return (hash ^ (uint32)value) * 16777619;
+}
+
+static uint32 hashRect(uint32 hash, const Common::Rect &rect) {
+	hash = hashValue(hash, rect.left);
+	hash = hashValue(hash, rect.top);
+	hash = hashValue(hash, rect.right);
+	return hashValue(hash, rect.bottom);
+}
+
+static uint32 objectKey(reg_t object) {
+	return (object.segment << 16) | object.offset;
+}
+
+/**
+ * Works out where a screen item goes and sets its nsRect, without drawing
+ * it yet.
+ */
+void GfxFrameout::prepareScreenItem(PlaneEntry &plane, FrameoutEntry *itemEntry) {
+	itemEntry->drawCel = false;
+	itemEntry->drawText = false;
+
+	GfxView *view = (itemEntry->viewId != 0xFFFF) ? _cache->getView(itemEntry->viewId) : NULL;
+
+	if (view && view->isSci2Hires()) {
+		int16 dummyX = 0;
+		view->adjustToUpscaledCoordinates(itemEntry->y, itemEntry->x);
+		view->adjustToUpscaledCoordinates(itemEntry->z, dummyX);
+	} else if (getSciVersion() == SCI_VERSION_2_1) {
+		itemEntry->x = upscaleHorizontalCoordinate(itemEntry->x);
+		itemEntry->y = upscaleVerticalCoordinate(itemEntry->y);
+		itemEntry->z = upscaleVerticalCoordinate(itemEntry->z);
+	}
+
+	// Adjust according to current scroll position
+	itemEntry->x -= plane.planeOffsetX;
+	itemEntry->y -= plane.planeOffsetY;
+
+	uint16 useInsetRect = readSelectorValue(_segMan, itemEntry->object, SELECTOR(useInsetRect));
+	if (useInsetRect) {
+		itemEntry->celRect.top = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inTop));
+		itemEntry->celRect.left = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inLeft));
+		itemEntry->celRect.bottom = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inBottom));
+		itemEntry->celRect.right = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inRight));
+		if (view && view->isSci2Hires()) {
+			view->adjustToUpscaledCoordinates(itemEntry->celRect.top, itemEntry->celRect.left);
+			view->adjustToUpscaledCoordinates(itemEntry->celRect.bottom, itemEntry->celRect.right);
+		}
+		itemEntry->celRect.translate(itemEntry->x, itemEntry->y);
+		// TODO: maybe we should clip the cels rect with this, i'm not sure
+		//  the only currently known usage is game menu of gk1
+	} else if (view) {
+			if ((itemEntry->scaleX == 128) && (itemEntry->scaleY == 128))
+				view->getCelRect(itemEntry->loopNo, itemEntry->celNo,
+					itemEntry->x, itemEntry->y, itemEntry->z, itemEntry->celRect);
+			else
+				view->getCelScaledRect(itemEntry->loopNo, itemEntry->celNo, 
+					itemEntry->x, itemEntry->y, itemEntry->z, itemEntry->scaleX,
+					itemEntry->scaleY, itemEntry->celRect);
+
+		Common::Rect nsRect = itemEntry->celRect;
+		// Translate back to actual coordinate within scrollable plane
+		nsRect.translate(plane.planeOffsetX, plane.planeOffsetY);
+
+		if (view && view->isSci2Hires()) {
+			view->adjustBackUpscaledCoordinates(nsRect.top, nsRect.left);
+			view->adjustBackUpscaledCoordinates(nsRect.bottom, nsRect.right);
+		} else if (getSciVersion() == SCI_VERSION_2_1) {
+			nsRect = upscaleRect(nsRect);
+		}
+
+		if (g_sci->getGameId() == GID_PHANTASMAGORIA2) {
+			// HACK: Some (?) objects in Phantasmagoria 2 have no NS rect. Skip them for now.
+			// TODO: Remove once we figure out how Phantasmagoria 2 draws objects on screen.
+			if (lookupSelector(_segMan, itemEntry->object, SELECTOR(nsLeft), NULL, NULL) != kSelectorVariable)
+				return;
+		}
+
+		g_sci->_gfxCompare->setNSRect(itemEntry->object, nsRect);
+	}
+
+	int16 screenHeight = _screen->getHeight();
+	int16 screenWidth = _screen->getWidth();
+	if (view && view->isSci2Hires()) {
+		screenHeight = _screen->getDisplayHeight();
+		screenWidth = _screen->getDisplayWidth();
+	}
+
+	if (itemEntry->celRect.bottom < 0 || itemEntry->celRect.top >= screenHeight)
+		return;
+
+	if (itemEntry->celRect.right < 0 || itemEntry->celRect.left >= screenWidth)
+		return;
+
+	Common::Rect clipRect, translatedClipRect;
+	clipRect = itemEntry->celRect;
+
+	if (view && view->isSci2Hires()) {
+		clipRect.clip(plane.upscaledPlaneClipRect);
+		translatedClipRect = clipRect;
+		translatedClipRect.translate(plane.upscaledPlaneRect.left, plane.upscaledPlaneRect.top);
+	} else {
+		clipRect.clip(plane.planeClipRect);
+		translatedClipRect = clipRect;
+		translatedClipRect.translate(plane.planeRect.left, plane.planeRect.top);
+	}
+
+	if (view && !clipRect.isEmpty()) {
+		itemEntry->drawCel = true;
+		itemEntry->drawRect = translatedClipRect;
+
+		// Palettes are set up before anything is drawn, in the same order
+		// as the cels would be drawn
+		if (view->getPalette())
+			_palette->set(view->getPalette(), false);
+
+		// Hires cels are drawn in display coordinates
+		if (view->isSci2Hires())
+			_redrawAll = true;
+	}
+
+	// Draw text, if it exists
+	if (lookupSelector(_segMan, itemEntry->object, SELECTOR(text), NULL, NULL) == kSelectorVariable) {
+		itemEntry->drawText = true;
+		itemEntry->textRect = g_sci->_gfxText32->getTextBitmapRect(itemEntry->x, itemEntry->y, plane.planeRect, itemEntry->object);
+	}
+}
+
+/**
+ * Remembers what something drawn in the current frame looks like. Things
+ * drawn under the same key are merged.
+ */
+void GfxFrameout::recordDrawState(uint32 key, const Common::Rect &rect, uint32 hash) {
+	FrameoutDrawStateMap::iterator state = _drawStates.find(key);
+	if (state == _drawStates.end()) {
+		FrameoutDrawState &newState = _drawStates[key];
+		newState.rect = rect;
+		newState.hash = hash;
+	} else {
+		if (state->_value.rect.isEmpty())
+			state->_value.rect = rect;
+		else if (!rect.isEmpty())
+			state->_value.rect.extend(rect);
+		state->_value.hash = hashValue(state->_value.hash, hash);
+	}
+}
+
+void GfxFrameout::addDirtyRect(Common::Rect rect) {
+	rect.clip(_screen->getWidth(), _screen->getHeight());
+	if (rect.isEmpty())
+		return;
+
+	// Merge overlapping rects, so that nothing is drawn twice
+	for (uint i = 0; i < _dirtyRects.size();) {
+		if (_dirtyRects[i].intersects(rect)) {
+			rect.extend(_dirtyRects[i]);
+			_dirtyRects.remove_at(i);
+			i = 0;
+		} else {
+			i++;
+		}
+	}
+	_dirtyRects.push_back(rect);
+
+	if (_dirtyRects.size() > MAX_DIRTY_RECTS) {
+		for (uint i = 1; i < _dirtyRects.size(); i++)
+			_dirtyRects[0].extend(_dirtyRects[i]);
+		_dirtyRects.resize(1);
+	}
+}
+
+/**
+ * Draws all planes, as prepared by kernelFrameout(). Only pixels inside
+ * clipRect are changed.
+ */
+void GfxFrameout::drawPlanes(const Common::Rect &clipRect) {
+	uint planeNr = 0;
+	for (PlaneList::iterator it = _planes.begin(); it != _planes.end(); ++it, ++planeNr) {
+		Common::Rect planeRect = it->planeRect;
+		planeRect.clip(clipRect);
+
+		if (it->priority == 0xffff) { // Plane currently not meant to be shown
+			// If plane was shown before, delete plane rect
+			if (it->blackout && !planeRect.isEmpty())
+				_paint32->fillRect(planeRect, 0);
+			continue;
+		}
+
+		// There is a race condition lurking in SQ6, which causes the game to hang in the intro, when teleporting to Polysorbate LX.
+		// Since I first wrote the patch, the race has stopped occurring for me though.
+		// I'll leave this for investigation later, when someone can reproduce.
+		//if (it->pictureId == 0xffff)	// FIXME: This is what SSCI does, and fixes the intro of LSL7, but breaks the dialogs in GK1 (adds black boxes)
+		if (it->planeBack && !planeRect.isEmpty())
+			_paint32->fillRect(planeRect, it->planeBack);
+
+		_coordAdjuster->pictureSetDisplayArea(it->planeRect);
+
+		FrameoutList &itemList = _planeItems[planeNr];
+		for (FrameoutList::iterator listIterator = itemList.begin(); listIterator != itemList.end(); listIterator++) {
+			FrameoutEntry *itemEntry = *listIterator;
+
+			if (itemEntry->object.isNull()) {
+				// Picture cel data
+				if (itemEntry->drawCel && itemEntry->drawRect.intersects(clipRect))
+					drawPicture(itemEntry, it->planeOffsetX, it->planeOffsetY, it->planePictureMirrored, clipRect);
+				continue;
+			}
+
+			if (itemEntry->drawCel && itemEntry->drawRect.intersects(clipRect)) {
+				GfxView *view = _cache->getView(itemEntry->viewId);
+
+				Common::Rect translatedClipRect = itemEntry->drawRect;
+				translatedClipRect.clip(clipRect);
+				Common::Rect celClipRect = translatedClipRect;
+				if (view->isSci2Hires())
+					celClipRect.translate(-it->upscaledPlaneRect.left, -it->upscaledPlaneRect.top);
+				else
+					celClipRect.translate(-it->planeRect.left, -it->planeRect.top);
+
+				if ((itemEntry->scaleX == 128) && (itemEntry->scaleY == 128))
+					view->draw(itemEntry->celRect, celClipRect, translatedClipRect, 
+						itemEntry->loopNo, itemEntry->celNo, 255, 0, view->isSci2Hires());
+				else
+					view->drawScaled(itemEntry->celRect, celClipRect, translatedClipRect, 
+						itemEntry->loopNo, itemEntry->celNo, 255, itemEntry->scaleX, itemEntry->scaleY);
+			}
+
+			if (itemEntry->drawText && itemEntry->textRect.intersects(clipRect))
+				g_sci->_gfxText32->drawTextBitmap(itemEntry->x, itemEntry->y, it->planeRect, itemEntry->object, clipRect);
+		}
+	}
+}
+
+/**
+ * Outlines the rects redrawn in the current frame on the backend screen,
+ * and shows how long the frame took. Done while the Graphics debug channel
+ * is enabled.
+ */
+void GfxFrameout::drawRedrawRects() {
+	Graphics::Surface *surface = g_system->lockScreen();
+	if (!surface)
+		return;
+
+	const byte color = _palette->matchColor(255, 0, 0) & 0xFF;
+	for (uint i = 0; i < _dirtyRects.size(); i++) {
+		Common::Rect rect = _dirtyRects[i];
+		if (_screen->getUpscaledHires()) {
+			_screen->adjustToUpscaledCoordinates(rect.top, rect.left);
+			_screen->adjustToUpscaledCoordinates(rect.bottom, rect.right);
+		}
+		rect.clip(surface->w, surface->h);
+		if (!rect.isEmpty())
+			surface->frameRect(rect, color);
+	}
+
+	const Graphics::Font *font = FontMan.getFontByUsage(Graphics::FontManager::kConsoleFont);
+	font->drawString(surface, Common::String::format("%d ms", _frameStats.lastTime), 2, 2, surface->w - 4, color);
+
+	g_system->unlockScreen();
+}
+
 void GfxFrameout::kernelFrameout() {
 	if (g_sci->_robotDecoder->isVideoLoaded()) {
 		showVideo();
+		_redrawAll = true;
 		return;
 	}
 
+	const uint32 startTime = g_system->getMillis();
+
+	const bool showRedrawRects = DebugMan.isDebugChannelEnabled(kDebugLevelGraphics);
+	if (showRedrawRects != _showRedrawRects) {
+		// Draw over the outlines of the last frame, or everything once more
+		_showRedrawRects = showRedrawRects;
+		_redrawAll = true;
+	}
+
 	_palette->palVaryUpdate();
 
+	// First work out what is going to be drawn where. Everything that does
+	// not depend on the screen contents (nsRects, palettes) happens here.
 	for (PlaneList::iterator it = _planes.begin(); it != _planes.end(); it++) {
 		reg_t planeObject = it->object;
 		uint16 planeLastPriority = it->lastPriority;
@@ -513,27 +805,24 @@ void GfxFrameout::kernelFrameout() {
 		uint16 planePriority = it->priority = readSelectorValue(_segMan, planeObject, SELECTOR(priority));
 
 		it->lastPriority = planePriority;
-		if (planePriority == 0xffff) { // Plane currently not meant to be shown
-			// If plane was shown before, delete plane rect
-			if (planePriority != planeLastPriority)
-				_paint32->fillRect(it->planeRect, 0);
+		it->blackout = (planePriority == 0xffff && planePriority != planeLastPriority);
+
+		uint32 planeHash = hashValue(2166136261u, planePriority);
+		planeHash = hashValue(planeHash, it->blackout);
+		planeHash = hashValue(planeHash, it->planeBack);
+		planeHash = hashValue(planeHash, it->pictureId);
+		planeHash = hashValue(planeHash, it->planeOffsetX);
+		planeHash = hashValue(planeHash, it->planeOffsetY);
+		planeHash = hashValue(planeHash, it->planePictureMirrored);
+		recordDrawState(objectKey(planeObject), it->planeRect, planeHash);
+
+		_planeItems.push_back(FrameoutList());
+		if (planePriority == 0xffff) // Plane currently not meant to be shown
 			continue;
-		}
 
-		// There is a race condition lurking in SQ6, which causes the game to hang in the intro, when teleporting to Polysorbate LX.
-		// Since I first wrote the patch, the race has stopped occurring for me though.
-		// I'll leave this for investigation later, when someone can reproduce.
-		//if (it->pictureId == 0xffff)	// FIXME: This is what SSCI does, and fixes the intro of LSL7, but breaks the dialogs in GK1 (adds black boxes)
-		if (it->planeBack)
-			_paint32->fillRect(it->planeRect, it->planeBack);
-
-		GuiResourceId planeMainPictureId = it->pictureId;
-
-		_coordAdjuster->pictureSetDisplayArea(it->planeRect);
-		_palette->drewPicture(planeMainPictureId);
-
-		FrameoutList itemList;
+		_palette->drewPicture(it->pictureId);
 
+		FrameoutList &itemList = _planeItems.back();
 		createPlaneItemList(planeObject, itemList);
 
 //		warning("Plane %s", _segMan->getObjectName(planeObject));
@@ -548,121 +837,119 @@ void GfxFrameout::kernelFrameout() {
 				itemEntry->picStartX = upscaleHorizontalCoordinate(itemEntry->picStartX);
 				itemEntry->picStartY = upscaleVerticalCoordinate(itemEntry->picStartY);
 
-				if (!isPictureOutOfView(itemEntry, it->planeRect, it->planeOffsetX, it->planeOffsetY))
-					drawPicture(itemEntry, it->planeOffsetX, it->planeOffsetY, it->planePictureMirrored);
+				itemEntry->drawCel = !isPictureOutOfView(itemEntry, it->planeRect, it->planeOffsetX, it->planeOffsetY);
+				itemEntry->drawText = false;
+				// Picture cels only change when the whole plane does
+				itemEntry->drawRect = it->planeRect;
+				if (itemEntry->drawCel && itemEntry->celNo == 0)
+					itemEntry->picture->setSci32Palette();
+
+				uint32 celHash = hashValue(planeHash, itemEntry->picture->getResourceId());
+				celHash = hashValue(celHash, itemEntry->celNo);
+				uint32 hash = hashValue(celHash, itemEntry->drawCel);
+				hash = hashValue(hash, itemEntry->x);
+				hash = hashValue(hash, itemEntry->y);
+				hash = hashValue(hash, itemEntry->picStartX);
+				hash = hashValue(hash, itemEntry->picStartY);
+				hash = hashValue(hash, itemEntry->priority);
+				recordDrawState(celHash, itemEntry->drawCel ? itemEntry->drawRect : Common::Rect(), hash);
 			} else {
-				GfxView *view = (itemEntry->viewId != 0xFFFF) ? _cache->getView(itemEntry->viewId) : NULL;
-				
-				if (view && view->isSci2Hires()) {
-					int16 dummyX = 0;
-					view->adjustToUpscaledCoordinates(itemEntry->y, itemEntry->x);
-					view->adjustToUpscaledCoordinates(itemEntry->z, dummyX);
-				} else if (getSciVersion() == SCI_VERSION_2_1) {
-					itemEntry->x = upscaleHorizontalCoordinate(itemEntry->x);
-					itemEntry->y = upscaleVerticalCoordinate(itemEntry->y);
-					itemEntry->z = upscaleVerticalCoordinate(itemEntry->z);
-				}
-
-				// Adjust according to current scroll position
-				itemEntry->x -= it->planeOffsetX;
-				itemEntry->y -= it->planeOffsetY;
-
-				uint16 useInsetRect = readSelectorValue(_segMan, itemEntry->object, SELECTOR(useInsetRect));
-				if (useInsetRect) {
-					itemEntry->celRect.top = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inTop));
-					itemEntry->celRect.left = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inLeft));
-					itemEntry->celRect.bottom = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inBottom));
-					itemEntry->celRect.right = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inRight));
-					if (view && view->isSci2Hires()) {
-						view->adjustToUpscaledCoordinates(itemEntry->celRect.top, itemEntry->celRect.left);
-						view->adjustToUpscaledCoordinates(itemEntry->celRect.bottom, itemEntry->celRect.right);
-					}
-					itemEntry->celRect.translate(itemEntry->x, itemEntry->y);
-					// TODO: maybe we should clip the cels rect with this, i'm not sure
-					//  the only currently known usage is game menu of gk1
-				} else if (view) {
-						if ((itemEntry->scaleX == 128) && (itemEntry->scaleY == 128))
-							view->getCelRect(itemEntry->loopNo, itemEntry->celNo,
-								itemEntry->x, itemEntry->y, itemEntry->z, itemEntry->celRect);
-						else
-							view->getCelScaledRect(itemEntry->loopNo, itemEntry->celNo, 
-								itemEntry->x, itemEntry->y, itemEntry->z, itemEntry->scaleX,
-								itemEntry->scaleY, itemEntry->celRect);
-
-					Common::Rect nsRect = itemEntry->celRect;
-					// Translate back to actual coordinate within scrollable plane
-					nsRect.translate(it->planeOffsetX, it->planeOffsetY);
-
-					if (view && view->isSci2Hires()) {
-						view->adjustBackUpscaledCoordinates(nsRect.top, nsRect.left);
-						view->adjustBackUpscaledCoordinates(nsRect.bottom, nsRect.right);
-					} else if (getSciVersion() == SCI_VERSION_2_1) {
-						nsRect = upscaleRect(nsRect);
-					}
-
-					if (g_sci->getGameId() == GID_PHANTASMAGORIA2) {
-						// HACK: Some (?) objects in Phantasmagoria 2 have no NS rect. Skip them for now.
-						// TODO: Remove once we figure out how Phantasmagoria 2 draws objects on screen.
-						if (lookupSelector(_segMan, itemEntry->object, SELECTOR(nsLeft), NULL, NULL) != kSelectorVariable)
-							continue;
-					}
-
-					g_sci->_gfxCompare->setNSRect(itemEntry->object, nsRect);
-				}
-
-				int16 screenHeight = _screen->getHeight();
-				int16 screenWidth = _screen->getWidth();
-				if (view && view->isSci2Hires()) {
-					screenHeight = _screen->getDisplayHeight();
-					screenWidth = _screen->getDisplayWidth();
-				}
-
-				if (itemEntry->celRect.bottom < 0 || itemEntry->celRect.top >= screenHeight)
-					continue;
-
-				if (itemEntry->celRect.right < 0 || itemEntry->celRect.left >= screenWidth)
-					continue;
-
-				Common::Rect clipRect, translatedClipRect;
-				clipRect = itemEntry->celRect;
-
-				if (view && view->isSci2Hires()) {
-					clipRect.clip(it->upscaledPlaneClipRect);
-					translatedClipRect = clipRect;
-					translatedClipRect.translate(it->upscaledPlaneRect.left, it->upscaledPlaneRect.top);
-				} else {
-					clipRect.clip(it->planeClipRect);
-					translatedClipRect = clipRect;
-					translatedClipRect.translate(it->planeRect.left, it->planeRect.top);
-				}
-
-				if (view) {
-					if (!clipRect.isEmpty()) {
-						if ((itemEntry->scaleX == 128) && (itemEntry->scaleY == 128))
-							view->draw(itemEntry->celRect, clipRect, translatedClipRect, 
-								itemEntry->loopNo, itemEntry->celNo, 255, 0, view->isSci2Hires());
-						else
-							view->drawScaled(itemEntry->celRect, clipRect, translatedClipRect, 
-								itemEntry->loopNo, itemEntry->celNo, 255, itemEntry->scaleX, itemEntry->scaleY);
-					}
-				}
-
-				// Draw text, if it exists
-				if (lookupSelector(_segMan, itemEntry->object, SELECTOR(text), NULL, NULL) == kSelectorVariable) {
-					g_sci->_gfxText32->drawTextBitmap(itemEntry->x, itemEntry->y, it->planeRect, itemEntry->object);
+				prepareScreenItem(*it, itemEntry);
+
+				Common::Rect rect;
+				if (itemEntry->drawCel)
+					rect = itemEntry->drawRect;
+				uint32 hash = hashValue(2166136261u, objectKey(planeObject));
+				hash = hashValue(hash, itemEntry->drawCel);
+				hash = hashValue(hash, itemEntry->viewId);
+				hash = hashValue(hash, itemEntry->loopNo);
+				hash = hashValue(hash, itemEntry->celNo);
+				hash = hashRect(hash, itemEntry->celRect);
+				hash = hashRect(hash, itemEntry->drawRect);
+				hash = hashValue(hash, itemEntry->scaleX);
+				hash = hashValue(hash, itemEntry->scaleY);
+				hash = hashValue(hash, itemEntry->priority);
+				hash = hashValue(hash, itemEntry->y);
+				hash = hashValue(hash, itemEntry->givenOrderNr);
+				if (itemEntry->drawText && !itemEntry->textRect.isEmpty()) {
+					// The text bitmap may have changed without us knowing
+					hash = hashValue(hash, _frameStats.frames);
+					if (rect.isEmpty())
+						rect = itemEntry->textRect;
+					else
+						rect.extend(itemEntry->textRect);
 				}
+				recordDrawState(objectKey(itemEntry->object), rect, hash);
 			}
 		}
+	}
 
-		for (PlanePictureList::iterator pictureIt = _planePictures.begin(); pictureIt != _planePictures.end(); pictureIt++) {
-			if (pictureIt->object == planeObject) {
-				delete[] pictureIt->pictureCels;
-				pictureIt->pictureCels = 0;
+	// Then find out what has changed since the last frame
+	bool redrawAll = _redrawAll || _screen->getUpscaledHires() || _screen->fontIsUpscaled();
+	_dirtyRects.clear();
+	if (!redrawAll) {
+		for (FrameoutDrawStateMap::const_iterator state = _drawStates.begin(); state != _drawStates.end(); ++state) {
+			FrameoutDrawStateMap::const_iterator lastState = _lastDrawStates.find(state->_key);
+			if (lastState == _lastDrawStates.end()) {
+				addDirtyRect(state->_value.rect);
+			} else if (lastState->_value.hash != state->_value.hash || lastState->_value.rect != state->_value.rect) {
+				addDirtyRect(state->_value.rect);
+				addDirtyRect(lastState->_value.rect);
 			}
 		}
+		for (FrameoutDrawStateMap::const_iterator lastState = _lastDrawStates.begin(); lastState != _lastDrawStates.end(); ++lastState) {
+			if (!_drawStates.contains(lastState->_key))
+				addDirtyRect(lastState->_value.rect);
+		}
+
+		// Redrawing a few big rects costs about as much as redrawing everything
+		uint32 dirtyPixels = 0;
+		for (uint i = 0; i < _dirtyRects.size(); i++)
+			dirtyPixels += _dirtyRects[i].width() * _dirtyRects[i].height();
+		if (dirtyPixels * 3 > (uint32)_screen->getWidth() * _screen->getHeight() * 2)
+			redrawAll = true;
+	}
+	_lastDrawStates = _drawStates;
+	_drawStates.clear(true);
+
+	// Now draw everything inside the changed rects
+	if (redrawAll) {
+		_dirtyRects.clear();
+		_dirtyRects.push_back(Common::Rect(_screen->getWidth(), _screen->getHeight()));
+		drawPlanes(Common::Rect(_screen->getDisplayWidth(), _screen->getDisplayHeight()));
+	} else {
+		for (uint i = 0; i < _dirtyRects.size(); i++)
+			drawPlanes(_dirtyRects[i]);
 	}
 
-	_screen->copyToScreen();
+	for (PlanePictureList::iterator pictureIt = _planePictures.begin(); pictureIt != _planePictures.end(); pictureIt++) {
+		delete[] pictureIt->pictureCels;
+		pictureIt->pictureCels = 0;
+	}
+	_planeItems.clear();
+
+	if (redrawAll || _showRedrawRects) {
+		_screen->copyToScreen();
+	} else {
+		for (uint i = 0; i < _dirtyRects.size(); i++)
+			_screen->copyRectToScreen(_dirtyRects[i]);
+	}
+	_redrawAll = false;
+
+	const uint32 frameTime = g_system->getMillis() - startTime;
+	_frameStats.frames++;
+	if (_dirtyRects.empty())
+		_frameStats.unchangedFrames++;
+	if (redrawAll)
+		_frameStats.fullFrames++;
+	for (uint i = 0; i < _dirtyRects.size(); i++)
+		_frameStats.redrawnPixels += _dirtyRects[i].width() * _dirtyRects[i].height();
+	_frameStats.lastTime = frameTime;
+	_frameStats.maxTime = MAX(_frameStats.maxTime, frameTime);
+	_frameStats.totalTime += frameTime;
+
+	if (_showRedrawRects)
+		drawRedrawRects();
 
 	g_sci->getEngineState()->_throttleTrigger = true;
 }
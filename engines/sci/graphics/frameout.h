@@ -23,6 +23,9 @@
 #ifndef SCI_GRAPHICS_FRAMEOUT_H
 #define SCI_GRAPHICS_FRAMEOUT_H
 
+#include "common/array.h"
+#include "common/hashmap.h"
+
 namespace Sci {
 
 class GfxPicture;
@@ -40,6 +43,7 @@ struct PlaneEntry {
 	Common::Rect upscaledPlaneClipRect;
 	bool planePictureMirrored;
 	byte planeBack;
+	bool blackout; // plane got hidden in the current frame
 };
 
 typedef Common::List<PlaneEntry> PlaneList;
@@ -60,10 +64,27 @@ struct FrameoutEntry {
 	GfxPicture *picture;
 	int16 picStartX;
 	int16 picStartY;
+
+	// Set up by kernelFrameout() before anything is drawn
+	bool drawCel;
+	bool drawText;
+	Common::Rect drawRect; // on screen, clipped to the plane
+	Common::Rect textRect;
 };
 
 typedef Common::List<FrameoutEntry *> FrameoutList;
 
+/**
+ * What a plane, screen item or picture cel looked like when it was last
+ * drawn, to find the parts of the screen that have to be redrawn.
+ */
+struct FrameoutDrawState {
+	Common::Rect rect;
+	uint32 hash;
+};
+
+typedef Common::HashMap<uint32, FrameoutDrawState> FrameoutDrawStateMap;
+
 struct PlanePictureEntry {
 	reg_t object;
 	int16 startX;
@@ -104,11 +125,35 @@ public:
 	void deletePlanePictures(reg_t object);
 	void clear();
 
+	/**
+	 * Makes the next kFrameout call redraw the whole screen, for when
+	 * something else has drawn over it.
+	 */
+	void invalidate() { _redrawAll = true; }
+
+	struct FrameStatistics {
+		uint32 frames;
+		uint32 unchangedFrames;	///< frames in which nothing was redrawn
+		uint32 fullFrames;		///< frames in which the whole screen was redrawn
+		uint32 redrawnPixels;
+		uint32 lastTime;		///< in ms
+		uint32 maxTime;
+		uint32 totalTime;
+	};
+
+	const FrameStatistics &getFrameStatistics() const { return _frameStats; }
+	void resetFrameStatistics();
+
 private:
 	void showVideo();
 	void createPlaneItemList(reg_t planeObject, FrameoutList &itemList);
 	bool isPictureOutOfView(FrameoutEntry *itemEntry, Common::Rect planeRect, int16 planeOffsetX, int16 planeOffsetY);
-	void drawPicture(FrameoutEntry *itemEntry, int16 planeOffsetX, int16 planeOffsetY, bool planePictureMirrored);
+	void drawPicture(FrameoutEntry *itemEntry, int16 planeOffsetX, int16 planeOffsetY, bool planePictureMirrored, const Common::Rect &clipRect);
+	void prepareScreenItem(PlaneEntry &plane, FrameoutEntry *itemEntry);
+	void recordDrawState(uint32 key, const Common::Rect &rect, uint32 hash);
+	void addDirtyRect(Common::Rect rect);
+	void drawPlanes(const Common::Rect &clipRect);
+	void drawRedrawRects();
 	int16 upscaleHorizontalCoordinate(int16 coordinate);
 	int16 upscaleVerticalCoordinate(int16 coordinate);
 	Common::Rect upscaleRect(Common::Rect &rect);
@@ -129,6 +174,16 @@ private:
 
 	uint16 _scriptsRunningWidth;
 	uint16 _scriptsRunningHeight;
+
+	// The items of each plane in the current frame, sorted, in plane order
+	Common::Array<FrameoutList> _planeItems;
+
+	FrameoutDrawStateMap _drawStates;
+	FrameoutDrawStateMap _lastDrawStates;
+	Common::Array<Common::Rect> _dirtyRects;
+	bool _redrawAll;
+	bool _showRedrawRects;	///< Set while the Graphics debug channel is enabled, see drawRedrawRects()
+	FrameStatistics _frameStats;
 };
 
 } // End of namespace Sci
@@ -38,6 +38,7 @@ namespace Sci {
 GfxPicture::GfxPicture(ResourceManager *resMan, GfxCoordAdjuster *coordAdjuster, GfxPorts *ports, GfxScreen *screen, GfxPalette *palette, GuiResourceId resourceId, bool EGAdrawingVisualize)
 	: _resMan(resMan), _coordAdjuster(coordAdjuster), _ports(ports), _screen(screen), _palette(palette), _resourceId(resourceId), _EGAdrawingVisualize(EGAdrawingVisualize) {
 	assert(resourceId != -1);
+	_clipRect = Common::Rect(_screen->getWidth(), _screen->getHeight());
 	initData(resourceId);
 }
 
@@ -77,7 +78,8 @@ void GfxPicture::draw(int16 animationNr, bool mirroredFlag, bool addToFlag, int1
 #ifdef ENABLE_SCI32
 	case 0x0e: // SCI32 VGA picture
 		_resourceType = SCI_PICTURE_TYPE_SCI32;
-		drawSci32Vga(0, 0, 0, 0, 0, false);
+		setSci32Palette();
+		drawSci32Vga(0, 0, 0, 0, 0, false, Common::Rect(_screen->getWidth(), _screen->getHeight()));
 		break;
 #endif
 	default:
@@ -184,26 +186,34 @@ int16 GfxPicture::getSci32celPriority(int16 celNo) {
 	return READ_SCI11ENDIAN_UINT16(inbuffer + cel_headerPos + 36);
 }
 
-void GfxPicture::drawSci32Vga(int16 celNo, int16 drawX, int16 drawY, int16 pictureX, int16 pictureY, bool mirrored) {
+void GfxPicture::setSci32Palette() {
 	byte *inbuffer = _resource->data;
 	int size = _resource->size;
-	int header_size = READ_SCI11ENDIAN_UINT16(inbuffer);
 	int palette_data_ptr = READ_SCI11ENDIAN_UINT32(inbuffer + 6);
+	Palette palette;
+
+	// Create palette and set it
+	_palette->createFromData(inbuffer + palette_data_ptr, size - palette_data_ptr, &palette);
+	_palette->set(&palette, true);
+}
+
+/**
+ * Draws one cel of an SCI32 picture. The palette of the picture is not set
+ * here, see setSci32Palette().
+ */
+void GfxPicture::drawSci32Vga(int16 celNo, int16 drawX, int16 drawY, int16 pictureX, int16 pictureY, bool mirrored, const Common::Rect &clipRect) {
+	byte *inbuffer = _resource->data;
+	int size = _resource->size;
+	int header_size = READ_SCI11ENDIAN_UINT16(inbuffer);
 //	int celCount = inbuffer[2];
 	int cel_headerPos = header_size;
 	int cel_RlePos, cel_LiteralPos;
-	Palette palette;
 
 	// HACK
 	_mirroredFlag = mirrored;
 	_addToFlag = false;
 	_resourceType = SCI_PICTURE_TYPE_SCI32;
-
-	if (celNo == 0) {
-		// Create palette and set it
-		_palette->createFromData(inbuffer + palette_data_ptr, size - palette_data_ptr, &palette);
-		_palette->set(&palette, true);
-	}
+	_clipRect = clipRect;
 
 	// Header
 	// [headerSize:WORD] [celCount:BYTE] [Unknown:BYTE] [Unknown:WORD] [paletteOffset:DWORD] [Unknown:DWORD]
@@ -363,7 +373,7 @@ void GfxPicture::drawCelData(byte *inbuffer, int size, int headerPos, int rlePos
 			x = leftX;
 			while (y < lastY) {
 				curByte = *ptr++;
-				if ((curByte != clearColor) && (priority >= _screen->getPriority(x, y)))
+				if ((curByte != clearColor) && _clipRect.contains(x, y) && (priority >= _screen->getPriority(x, y)))
 					_screen->putPixel(x, y, drawMask, curByte, priority, 0);
 
 				x++;
@@ -379,7 +389,7 @@ void GfxPicture::drawCelData(byte *inbuffer, int size, int headerPos, int rlePos
 			x = rightX - 1;
 			while (y < lastY) {
 				curByte = *ptr++;
-				if ((curByte != clearColor) && (priority >= _screen->getPriority(x, y)))
+				if ((curByte != clearColor) && _clipRect.contains(x, y) && (priority >= _screen->getPriority(x, y)))
 					_screen->putPixel(x, y, drawMask, curByte, priority, 0);
 
 				if (x == leftX) {
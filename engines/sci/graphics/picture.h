@@ -58,7 +58,8 @@ public:
 	int16 getSci32celWidth(int16 celNo);
 	int16 getSci32celHeight(int16 celNo);
 	int16 getSci32celPriority(int16 celNo);
-	void drawSci32Vga(int16 celNo, int16 callerX, int16 callerY, int16 pictureX, int16 pictureY, bool mirrored);
+	void setSci32Palette();
+	void drawSci32Vga(int16 celNo, int16 callerX, int16 callerY, int16 pictureX, int16 pictureY, bool mirrored, const Common::Rect &clipRect);
 #endif
 
 private:
@@ -96,6 +97,9 @@ private:
 	int16 _EGApaletteNo;
 	byte _priority;
 
+	// Pixels outside of this rect are not drawn
+	Common::Rect _clipRect;
+
 	// If true, we will show the whole EGA drawing process...
 	bool _EGAdrawingVisualize;
 };
@@ -230,6 +230,45 @@ void GfxScreen::putPixel(int x, int y, byte drawMask, byte color, byte priority,
 		_controlScreen[offset] = control;
 }
 
+/**
+ * Puts a row of pixels onto the visual and priority screens, like calling
+ * putPixel() for each pixel that is not behind something with a higher
+ * priority. The colors are translated through mapping first.
+ */
+void GfxScreen::putPixelSpan(int x, int y, int length, const byte *colors, const byte *mapping, byte drawMask, byte priority) {
+	const int offset = y * _width + x;
+	const byte *priorityPtr = _priorityScreen + offset;
+	int start = 0;
+
+	while (start < length) {
+		// Find the next run of pixels that are not hidden
+		while (start < length && priorityPtr[start] > priority)
+			start++;
+		int end = start;
+		while (end < length && priorityPtr[end] <= priority)
+			end++;
+		if (start == end)
+			break;
+
+		if (drawMask & GFX_SCREEN_MASK_VISUAL) {
+			byte *visualPtr = _visualScreen + offset;
+			for (int i = start; i < end; i++)
+				visualPtr[i] = mapping[colors[i]];
+
+			if (!_upscaledHires) {
+				memcpy(_displayScreen + offset + start, visualPtr + start, end - start);
+			} else {
+				for (int i = start; i < end; i++)
+					putPixel(x + i, y, GFX_SCREEN_MASK_VISUAL, visualPtr[i], 0, 0);
+			}
+		}
+		if (drawMask & GFX_SCREEN_MASK_PRIORITY)
+			memset(_priorityScreen + offset + start, priority, end - start);
+
+		start = end;
+	}
+}
+
 /**
  * This is used to put font pixels onto the screen - we adjust differently, so that we won't
  *  do triple pixel lines in any case on upscaled hires. That way the font will not get distorted
@@ -173,7 +173,11 @@ void GfxText32::disposeTextBitmap(reg_t hunkId) {
 	_segMan->freeHunkEntry(hunkId);
 }
 
-void GfxText32::drawTextBitmap(int16 x, int16 y, Common::Rect planeRect, reg_t textObject) {
+/**
+ * Draws the text bitmap of a screen item. Only the pixels inside clipRect
+ * are drawn, which is in display coordinates if the fonts are upscaled.
+ */
+void GfxText32::drawTextBitmap(int16 x, int16 y, Common::Rect planeRect, reg_t textObject, const Common::Rect &clipRect) {
 	reg_t hunkId = readSelector(_segMan, textObject, SELECTOR(bitmap));
 	uint16 backColor = readSelectorValue(_segMan, textObject, SELECTOR(back));
 	// Sanity check: Check if the hunk is set. If not, either the game scripts
@@ -209,12 +213,35 @@ void GfxText32::drawTextBitmap(int16 x, int16 y, Common::Rect planeRect, reg_t t
 	for (int curY = 0; curY < height; curY++) {
 		for (int curX = 0; curX < width; curX++) {
 			byte pixel = surface[curByte++];
-			if (pixel != skipColor && pixel != backColor)
+			if (pixel != skipColor && pixel != backColor && clipRect.contains(curX + textX, curY + textY))
 				_screen->putFontPixel(textY, curX + textX, curY, pixel);
 		}
 	}
 }
 
+/**
+ * Returns the rect drawTextBitmap() draws into, or an empty rect if it draws
+ * nothing.
+ */
+Common::Rect GfxText32::getTextBitmapRect(int16 x, int16 y, Common::Rect planeRect, reg_t textObject) {
+	reg_t hunkId = readSelector(_segMan, textObject, SELECTOR(bitmap));
+	if (hunkId.isNull() || x < 0 || y < 0)
+		return Common::Rect();
+
+	byte *memoryPtr = _segMan->getHunkPointer(hunkId);
+	if (!memoryPtr)
+		return Common::Rect();
+
+	uint16 textX = planeRect.left + x;
+	uint16 textY = planeRect.top + y;
+	if (_screen->fontIsUpscaled()) {
+		textX = textX * _screen->getDisplayWidth() / _screen->getWidth();
+		textY = textY * _screen->getDisplayHeight() / _screen->getHeight();
+	}
+
+	return Common::Rect(textX, textY, textX + READ_LE_UINT16(memoryPtr), textY + READ_LE_UINT16(memoryPtr + 2));
+}
+
 int16 GfxText32::GetLongest(const char *text, int16 maxWidth, GfxFont *font) {
 	uint16 curChar = 0;
 	int16 maxChars = 0, curCharCount = 0;
@@ -34,7 +34,8 @@ public:
 	~GfxText32();
 	reg_t createTextBitmap(reg_t textObject, uint16 maxWidth = 0, uint16 maxHeight = 0, reg_t prevHunk = NULL_REG);
 	void disposeTextBitmap(reg_t hunkId);
-	void drawTextBitmap(int16 x, int16 y, Common::Rect planeRect, reg_t textObject);
+	void drawTextBitmap(int16 x, int16 y, Common::Rect planeRect, reg_t textObject, const Common::Rect &clipRect);
+	Common::Rect getTextBitmapRect(int16 x, int16 y, Common::Rect planeRect, reg_t textObject);
 	int16 GetLongest(const char *text, int16 maxWidth, GfxFont *font);
 
 	void kernelTextSize(const char *text, int16 font, int16 maxWidth, int16 *textWidth, int16 *textHeight);
@@ -42,7 +42,7 @@ GfxView::~GfxView() {
 	for (uint16 loopNum = 0; loopNum < _loopCount; loopNum++) {
 		// and through the cells of each loop
 		for (uint16 celNum = 0; celNum < _loop[loopNum].celCount; celNum++) {
-			delete[] _loop[loopNum].cel[celNum].rawBitmap;
+			freeDecodedCel(&_loop[loopNum].cel[celNum]);
 		}
 		delete[] _loop[loopNum].cel;
 	}
@@ -82,6 +82,8 @@ void GfxView::initData(GuiResourceId resourceId) {
 	_EGAmapping = NULL;
 	_sci2ScaleRes = SCI_VIEW_NATIVERES_NONE;
 	_isScaleable = true;
+	_decodedCelSize = 0;
+	_celUseCounter = 0;
 
 	// we adjust inside getCelRect for SCI0EARLY (that version didn't have the +1 when calculating bottom)
 	_adjustForSci0Early = getSciVersion() == SCI_VERSION_0_EARLY ? -1 : 0;
@@ -201,6 +203,10 @@ void GfxView::initData(GuiResourceId resourceId) {
 					}
 				}
 				cel->rawBitmap = 0;
+				cel->spanRows = 0;
+				cel->spans = 0;
+				cel->decodedSize = 0;
+				cel->lastUsed = 0;
 				if (_loop[loopNo].mirrorFlag)
 					cel->displaceX = -cel->displaceX;
 			}
@@ -293,6 +299,10 @@ void GfxView::initData(GuiResourceId resourceId) {
 					SWAP(cel->offsetRLE, cel->offsetLiteral);
 
 				cel->rawBitmap = 0;
+				cel->spanRows = 0;
+				cel->spans = 0;
+				cel->decodedSize = 0;
+				cel->lastUsed = 0;
 				if (_loop[loopNo].mirrorFlag)
 					cel->displaceX = -cel->displaceX;
 
@@ -580,23 +590,35 @@ void GfxView::unpackCel(int16 loopNo, int16 celNo, byte *outPtr, uint32 pixelCou
 }
 
 const byte *GfxView::getBitmap(int16 loopNo, int16 celNo) {
+	return getDecodedCel(loopNo, celNo)->rawBitmap;
+}
+
+/**
+ * Returns the cel with its bitmap and span list, decoding it first if
+ * needed. Decoding may free other cels of this view, so only the bitmap of
+ * the cel asked for last is guaranteed to be valid.
+ */
+const CelInfo *GfxView::getDecodedCel(int16 loopNo, int16 celNo) {
 	loopNo = CLIP<int16>(loopNo, 0, _loopCount -1);
 	celNo = CLIP<int16>(celNo, 0, _loop[loopNo].celCount - 1);
-	if (_loop[loopNo].cel[celNo].rawBitmap)
-		return _loop[loopNo].cel[celNo].rawBitmap;
+	CelInfo *cel = &_loop[loopNo].cel[celNo];
+	cel->lastUsed = ++_celUseCounter;
+	if (cel->rawBitmap)
+		return cel;
 
-	uint16 width = _loop[loopNo].cel[celNo].width;
-	uint16 height = _loop[loopNo].cel[celNo].height;
+	uint16 width = cel->width;
+	uint16 height = cel->height;
 	// allocating memory to store cel's bitmap
 	int pixelCount = width * height;
-	_loop[loopNo].cel[celNo].rawBitmap = new byte[pixelCount];
-	byte *pBitmap = _loop[loopNo].cel[celNo].rawBitmap;
+	freeOldDecodedCels(pixelCount, cel);
+	cel->rawBitmap = new byte[pixelCount];
+	byte *pBitmap = cel->rawBitmap;
 
 	// unpack the actual cel bitmap data
 	unpackCel(loopNo, celNo, pBitmap, pixelCount);
 
 	if (_resMan->getViewType() == kViewEga)
-		unditherBitmap(pBitmap, width, height, _loop[loopNo].cel[celNo].clearKey);
+		unditherBitmap(pBitmap, width, height, cel->clearKey);
 
 	// mirroring the cel if needed
 	if (_loop[loopNo].mirrorFlag) {
@@ -604,7 +626,83 @@ const byte *GfxView::getBitmap(int16 loopNo, int16 celNo) {
 			for (int j = 0; j < width / 2; j++)
 				SWAP(pBitmap[j], pBitmap[width - j - 1]);
 	}
-	return _loop[loopNo].cel[celNo].rawBitmap;
+
+	buildSpans(cel);
+	_decodedCelSize += cel->decodedSize;
+	return cel;
+}
+
+/**
+ * Collects the runs of non-transparent pixels in each row of a decoded cel,
+ * so that drawing can skip the transparent parts and copy the rest.
+ */
+void GfxView::buildSpans(CelInfo *cel) {
+	const byte *bitmap = cel->rawBitmap;
+	uint32 spanCount = 0;
+	int x, y;
+
+	for (y = 0; y < cel->height; y++, bitmap += cel->width) {
+		for (x = 0; x < cel->width; x++) {
+			if (bitmap[x] != cel->clearKey && (x == 0 || bitmap[x - 1] == cel->clearKey))
+				spanCount++;
+		}
+	}
+
+	cel->spanRows = new uint32[cel->height + 1];
+	cel->spans = new CelSpan[MAX<uint32>(spanCount, 1)];
+	spanCount = 0;
+
+	bitmap = cel->rawBitmap;
+	for (y = 0; y < cel->height; y++, bitmap += cel->width) {
+		cel->spanRows[y] = spanCount;
+		x = 0;
+		while (x < cel->width) {
+			while (x < cel->width && bitmap[x] == cel->clearKey)
+				x++;
+			const int start = x;
+			while (x < cel->width && bitmap[x] != cel->clearKey)
+				x++;
+			if (x > start) {
+				cel->spans[spanCount].start = start;
+				cel->spans[spanCount].length = x - start;
+				spanCount++;
+			}
+		}
+	}
+	cel->spanRows[cel->height] = spanCount;
+
+	cel->decodedSize = cel->width * cel->height + (cel->height + 1) * sizeof(uint32) + spanCount * sizeof(CelSpan);
+}
+
+void GfxView::freeDecodedCel(CelInfo *cel) {
+	delete[] cel->rawBitmap;
+	delete[] cel->spanRows;
+	delete[] cel->spans;
+	cel->rawBitmap = 0;
+	cel->spanRows = 0;
+	cel->spans = 0;
+	_decodedCelSize -= cel->decodedSize;
+	cel->decodedSize = 0;
+}
+
+/**
+ * Frees the least recently used decoded cels other than keep, until
+ * neededSize more bytes fit into MAX_DECODED_CEL_MEMORY.
+ */
+void GfxView::freeOldDecodedCels(uint32 neededSize, const CelInfo *keep) {
+	while (_decodedCelSize && _decodedCelSize + neededSize > MAX_DECODED_CEL_MEMORY) {
+		CelInfo *oldest = 0;
+		for (uint16 loopNum = 0; loopNum < _loopCount; loopNum++) {
+			for (uint16 celNum = 0; celNum < _loop[loopNum].celCount; celNum++) {
+				CelInfo *cel = &_loop[loopNum].cel[celNum];
+				if (cel->rawBitmap && cel != keep && (!oldest || cel->lastUsed < oldest->lastUsed))
+					oldest = cel;
+			}
+		}
+		if (!oldest)
+			break;
+		freeDecodedCel(oldest);
+	}
 }
 
 /**
@@ -703,8 +801,8 @@ void GfxView::unditherBitmap(byte *bitmapPtr, int16 width, int16 height, byte cl
 void GfxView::draw(const Common::Rect &rect, const Common::Rect &clipRect, const Common::Rect &clipRectTranslated,
 			int16 loopNo, int16 celNo, byte priority, uint16 EGAmappingNr, bool upscaledHires) {
 	const Palette *palette = _embeddedPal ? &_viewPalette : &_palette->_sysPalette;
-	const CelInfo *celInfo = getCelInfo(loopNo, celNo);
-	const byte *bitmap = getBitmap(loopNo, celNo);
+	const CelInfo *celInfo = getDecodedCel(loopNo, celNo);
+	const byte *bitmap = celInfo->rawBitmap;
 	const int16 celHeight = celInfo->height;
 	const int16 celWidth = celInfo->width;
 	const byte clearKey = celInfo->clearKey;
@@ -717,33 +815,43 @@ void GfxView::draw(const Common::Rect &rect, const Common::Rect &clipRect, const
 
 	const int16 width = MIN(clipRect.width(), celWidth);
 	const int16 height = MIN(clipRect.height(), celHeight);
+	const int16 offsetX = clipRect.left - rect.left;
+	const int16 offsetY = clipRect.top - rect.top;
 
-	bitmap += (clipRect.top - rect.top) * celWidth + (clipRect.left - rect.left);
+	if (offsetX < 0 || offsetY < 0)
+		return;
 
 	if (!_EGAmapping) {
+		// Only the non-transparent spans of each row are drawn
+		bitmap += offsetY * celWidth;
 		for (y = 0; y < height; y++, bitmap += celWidth) {
-			for (x = 0; x < width; x++) {
-				const byte color = bitmap[x];
-				if (color != clearKey) {
-					const int x2 = clipRectTranslated.left + x;
-					const int y2 = clipRectTranslated.top + y;
-					if (!upscaledHires) {
-						if (priority >= _screen->getPriority(x2, y2))
-							_screen->putPixel(x2, y2, drawMask, palette->mapping[color], priority, 0);
-					} else {
-						// UpscaledHires means view is hires and is supposed to
-						// get drawn onto lowres screen.
-						// FIXME(?): we can't read priority directly with the
-						// hires coordinates. May not be needed at all in kq6
-						// FIXME: Handle proper aspect ratio. Some GK1 hires images
-						// are in 640x400 instead of 640x480
-						_screen->putPixelOnDisplay(x2, y2, palette->mapping[color]);
-					}
+			const uint32 lastSpan = celInfo->spanRows[offsetY + y + 1];
+			for (uint32 spanNo = celInfo->spanRows[offsetY + y]; spanNo < lastSpan; spanNo++) {
+				const CelSpan &span = celInfo->spans[spanNo];
+				const int16 start = MAX<int16>(span.start, offsetX);
+				const int16 end = MIN<int16>(span.start + span.length, offsetX + width);
+				if (start >= end)
+					continue;
+
+				const int x2 = clipRectTranslated.left + start - offsetX;
+				const int y2 = clipRectTranslated.top + y;
+				if (!upscaledHires) {
+					_screen->putPixelSpan(x2, y2, end - start, bitmap + start, palette->mapping, drawMask, priority);
+				} else {
+					// UpscaledHires means view is hires and is supposed to
+					// get drawn onto lowres screen.
+					// FIXME(?): we can't read priority directly with the
+					// hires coordinates. May not be needed at all in kq6
+					// FIXME: Handle proper aspect ratio. Some GK1 hires images
+					// are in 640x400 instead of 640x480
+					for (x = start; x < end; x++)
+						_screen->putPixelOnDisplay(x2 + x - start, y2, palette->mapping[bitmap[x]]);
 				}
 			}
 		}
 	} else {
 		byte *EGAmapping = _EGAmapping + (EGAmappingNr * SCI_VIEW_EGAMAPPING_SIZE);
+		bitmap += offsetY * celWidth + offsetX;
 		for (y = 0; y < height; y++, bitmap += celWidth) {
 			for (x = 0; x < width; x++) {
 				const byte color = EGAmapping[bitmap[x]];
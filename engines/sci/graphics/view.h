@@ -32,6 +32,12 @@ enum Sci32ViewNativeResolution {
 	SCI_VIEW_NATIVERES_640x400 = 2
 };
 
+/** A run of non-transparent pixels in a row of a cel */
+struct CelSpan {
+	uint16 start;
+	uint16 length;
+};
+
 struct CelInfo {
 	int16 width, height;
 	int16 scriptWidth, scriptHeight;
@@ -42,6 +48,10 @@ struct CelInfo {
 	uint32 offsetRLE;
 	uint32 offsetLiteral;
 	byte *rawBitmap;
+	uint32 *spanRows; // index of the first span of each row, height + 1 entries
+	CelSpan *spans;
+	uint32 decodedSize;
+	uint32 lastUsed;
 };
 
 struct LoopInfo {
@@ -87,8 +97,18 @@ public:
 
 	byte getColorAtCoordinate(int16 loopNo, int16 celNo, int16 x, int16 y);
 
+	/**
+	 * Returns the memory used by this view: its resource and the cels
+	 * decoded so far.
+	 */
+	uint32 getMemoryUsage() const { return _resourceSize + _decodedCelSize; }
+
 private:
 	void initData(GuiResourceId resourceId);
+	const CelInfo *getDecodedCel(int16 loopNo, int16 celNo);
+	void buildSpans(CelInfo *cel);
+	void freeDecodedCel(CelInfo *cel);
+	void freeOldDecodedCels(uint32 neededSize, const CelInfo *keep);
 	void unpackCel(int16 loopNo, int16 celNo, byte *outPtr, uint32 pixelCount);
 	void unditherBitmap(byte *bitmap, int16 width, int16 height, byte clearKey);
 
@@ -118,6 +138,11 @@ private:
 	// this is not set for some views in laura bow 2 floppy and signals that the view shall never get scaled
 	//  even if scaleX/Y are set (inside kAnimate)
 	bool _isScaleable;
+
+	// Decoded cels are freed again, least recently used first, once they
+	// take up more than MAX_DECODED_CEL_MEMORY
+	uint32 _decodedCelSize;
+	uint32 _celUseCounter;
 };
 
 } // End of namespace Sci
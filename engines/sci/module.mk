@@ -22,6 +22,7 @@ MODULE_OBJS := \
 	engine/kmovement.o \
 	engine/kparse.o \
 	engine/kpathing.o \
+	engine/pathfinding.o \
 	engine/kscripts.o \
 	engine/ksound.o \
 	engine/kstring.o \
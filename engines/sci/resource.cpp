@@ -22,9 +22,11 @@
 
 // Resource library
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 
 #include "sci/resource.h"
@@ -193,6 +195,9 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : _resMan(resMan), _i
 	_source = NULL;
 	_header = NULL;
 	_headerSize = 0;
+	_lruPrev = NULL;
+	_lruNext = NULL;
+	_prefetched = false;
 }
 
 Resource::~Resource() {
@@ -369,7 +374,20 @@ Common::SeekableReadStream *ResourceManager::getVolumeFile(ResourceSource *sourc
 }
 
 void ResourceManager::loadResource(Resource *res) {
+	// Most resources load in well under a millisecond, too fast to time
+	// them one by one with getMillis(). They are mostly loaded in bursts,
+	// e.g. when a room is entered, so time the bursts instead: a load which
+	// starts in the millisecond the previous one ended in continues it.
+	const uint32 startTime = g_system->getMillis();
+	if (startTime != _loadBurstEnd) {
+		_loadTimeBeforeBurst = _cacheStats.loadTime;
+		_loadBurstStart = startTime;
+	}
+
 	res->_source->loadResource(this, res);
+
+	_loadBurstEnd = g_system->getMillis();
+	_cacheStats.loadTime = _loadTimeBeforeBurst + (_loadBurstEnd - _loadBurstStart);
 }
 
 
@@ -770,6 +788,9 @@ void ResourceManager::scanNewSources() {
 			source->scanSource(this);
 		}
 	}
+
+	if (_audioMapIndexChanged)
+		saveAudioMapIndex();
 }
 
 void DirectoryResourceSource::scanSource(ResourceManager *resMan) {
@@ -886,12 +907,26 @@ void ResourceManager::freeResourceSources() {
 }
 
 ResourceManager::ResourceManager() {
+	_audioMapIndexLoaded = false;
+	_audioMapIndexChanged = false;
 }
 
 void ResourceManager::init(bool initFromFallbackDetector) {
 	_memoryLocked = 0;
 	_memoryLRU = 0;
-	_LRU.clear();
+	for (int i = 0; i < kLRUClassCount; i++)
+		_LRU[i].first = _LRU[i].last = NULL;
+	_loadBurstEnd = 0;
+	resetCacheStatistics();
+
+	_maxMemory = DEFAULT_MAX_MEMORY;
+	if (ConfMan.hasKey("sci_resource_cache_size")) {
+		const int cacheSize = ConfMan.getInt("sci_resource_cache_size");
+		if (cacheSize > 0)
+			setCacheBudget(MIN<int>(cacheSize, MAX_CACHE_SIZE_KB) * 1024);
+		else
+			warning("Ignoring invalid sci_resource_cache_size %d, using %d KB", cacheSize, DEFAULT_MAX_MEMORY / 1024);
+	}
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 
@@ -989,12 +1024,43 @@ ResourceManager::~ResourceManager() {
 	}
 }
 
+ResourceManager::LRUClass ResourceManager::getLRUClass(const Resource *res) {
+	if (res->_prefetched)
+		return kLRUClassPrefetched;
+
+	switch (res->getType()) {
+	case kResourceTypeAudio:
+	case kResourceTypeSync:
+	case kResourceTypeAudio36:
+	case kResourceTypeSync36:
+		return kLRUClassAudio;
+	case kResourceTypeView:
+	case kResourceTypePic:
+	case kResourceTypePalette:
+	case kResourceTypeCursor:
+	case kResourceTypeFont:
+		return kLRUClassGraphics;
+	default:
+		return kLRUClassOther;
+	}
+}
+
 void ResourceManager::removeFromLRU(Resource *res) {
 	if (res->_status != kResStatusEnqueued) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+	LRUList &list = _LRU[getLRUClass(res)];
+	if (res->_lruPrev)
+		res->_lruPrev->_lruNext = res->_lruNext;
+	else
+		list.first = res->_lruNext;
+	if (res->_lruNext)
+		res->_lruNext->_lruPrev = res->_lruPrev;
+	else
+		list.last = res->_lruPrev;
+	res->_lruPrev = res->_lruNext = NULL;
+
 	_memoryLRU -= res->size;
 	res->_status = kResStatusAllocated;
 }
@@ -1004,7 +1070,15 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+	LRUList &list = _LRU[getLRUClass(res)];
+	res->_lruPrev = NULL;
+	res->_lruNext = list.first;
+	if (list.first)
+		list.first->_lruPrev = res;
+	else
+		list.last = res;
+	list.first = res;
+
 	_memoryLRU += res->size;
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s.%03d (%d bytes) to lru control: %d bytes total",
@@ -1015,34 +1089,99 @@ void ResourceManager::addToLRU(Resource *res) {
 }
 
 void ResourceManager::printLRU() {
-	int mem = 0;
+	static const char *const classNames[kLRUClassCount] = { "Prefetched", "Audio", "Other", "Graphics" };
+	uint32 mem = 0;
 	int entries = 0;
-	Common::List<Resource *>::iterator it = _LRU.begin();
-	Resource *res;
-
-	while (it != _LRU.end()) {
-		res = *it;
-		debug("\t%s: %d bytes", res->_id.toString().c_str(), res->size);
-		mem += res->size;
-		++entries;
-		++it;
+
+	for (int i = 0; i < kLRUClassCount; i++) {
+		debug("%s:", classNames[i]);
+		for (Resource *res = _LRU[i].first; res; res = res->_lruNext) {
+			debug("\t%s: %d bytes", res->_id.toString().c_str(), res->size);
+			mem += res->size;
+			++entries;
+		}
 	}
 
 	debug("Total: %d entries, %d bytes (mgr says %d)", entries, mem, _memoryLRU);
 }
 
 void ResourceManager::freeOldResources() {
-	while (MAX_MEMORY < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = *_LRU.reverse_begin();
+	int lruClass = kLRUClassPrefetched;
+
+	while (_maxMemory < _memoryLRU) {
+		while (!_LRU[lruClass].last) {
+			lruClass++;
+			assert(lruClass < kLRUClassCount);
+		}
+
+		Resource *goner = _LRU[lruClass].last;
 		removeFromLRU(goner);
 		goner->unalloc();
+		_cacheStats.evictions++;
+		_cacheStats.evictedBytes += goner->size;
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s.%03d (%d bytes)", getResourceTypeName(goner->type), goner->number, goner->size);
 #endif
 	}
 }
 
+void ResourceManager::setCacheBudget(uint32 bytes) {
+	_maxMemory = bytes;
+	freeOldResources();
+}
+
+void ResourceManager::resetCacheStatistics() {
+	memset(&_cacheStats, 0, sizeof(_cacheStats));
+	// Only count the rest of a burst of loads still going on
+	_loadTimeBeforeBurst = 0;
+	_loadBurstStart = _loadBurstEnd;
+}
+
+void ResourceManager::prefetchResource(ResourceId id) {
+	Resource *res = testResource(id);
+	if (!res || res->_status != kResStatusNoMalloc)
+		return;
+
+	for (Common::List<ResourceId>::const_iterator it = _prefetchQueue.begin(); it != _prefetchQueue.end(); ++it) {
+		if (*it == id)
+			return;
+	}
+
+	_prefetchQueue.push_back(id);
+}
+
+void ResourceManager::prefetchRoomResources(uint16 roomNumber) {
+	static const ResourceType types[] = {
+		kResourceTypePic, kResourceTypeView, kResourceTypeSound, kResourceTypeMessage, kResourceTypeText
+	};
+
+	for (int i = 0; i < ARRAYSIZE(types); i++)
+		prefetchResource(ResourceId(types[i], roomNumber));
+}
+
+bool ResourceManager::prefetchNextResource() {
+	while (!_prefetchQueue.empty()) {
+		const ResourceId id = _prefetchQueue.front();
+		_prefetchQueue.pop_front();
+
+		// Skip resources which have been loaded in the meantime
+		Resource *res = testResource(id);
+		if (!res || res->_status != kResStatusNoMalloc)
+			continue;
+
+		loadResource(res);
+		if (res->_status == kResStatusAllocated) {
+			res->_prefetched = true;
+			addToLRU(res);
+			_cacheStats.prefetched++;
+			freeOldResources();
+		}
+		return true;
+	}
+
+	return false;
+}
+
 Common::List<ResourceId> ResourceManager::listResources(ResourceType type, int mapNumber) {
 	Common::List<ResourceId> resources;
 
@@ -1062,10 +1201,16 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc) {
+		_cacheStats.misses++;
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
-		removeFromLRU(retval);
+	} else {
+		_cacheStats.hits++;
+		if (retval->_status == kResStatusEnqueued)
+			removeFromLRU(retval);
+	}
+	retval->_prefetched = false;
+
 	// Unless an error occurred, the resource is now either
 	// locked or allocated, but never queued or freed.
 
@@ -1858,6 +2003,11 @@ Resource *ResourceManager::updateResource(ResourceId resId, ResourceSource *src,
 		_resMap.setVal(resId, res);
 	}
 
+	if (res->_status == kResStatusEnqueued) {
+		removeFromLRU(res);
+		res->unalloc();
+	}
+
 	res->_status = kResStatusNoMalloc;
 	res->_source = src;
 	res->_headerSize = 0;
@@ -242,6 +242,9 @@ protected:
 	uint16 _lockers; /**< Number of places where this resource was locked */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
+	Resource *_lruPrev; /**< Next more recently used resource, while enqueued */
+	Resource *_lruNext; /**< Next less recently used resource, while enqueued */
+	bool _prefetched; /**< Loaded by ResourceManager::prefetchNextResource() and not used since */
 
 	bool loadPatch(Common::SeekableReadStream *file);
 	bool loadFromPatchFile();
@@ -316,6 +319,22 @@ public:
 	 */
 	Resource *testResource(ResourceId id);
 
+	/**
+	 * Opens an audio resource for streaming, without loading it into memory.
+	 * This only works for resources in audio volumes, callers have to fall
+	 * back to findResource() for all others.
+	 *
+	 * The stream starts with the SCI1.1 resource header, if there is one,
+	 * followed by the sample. It reads from a file handle of its own, so
+	 * that it can be used in the audio thread.
+	 *
+	 * @param id				Id of the audio resource
+	 * @param compressionType	Receives the compression type of the audio volume
+	 * @param headerSize		Receives the size of the resource header
+	 * @return					The stream, or NULL if the resource can't be streamed
+	 */
+	Common::SeekableReadStream *openAudioResource(ResourceId id, uint32 &compressionType, uint32 &headerSize);
+
 	/**
 	 * Returns a list of all resources of the specified type.
 	 * @param type		The resource type to look for
@@ -324,6 +343,58 @@ public:
 	 */
 	Common::List<ResourceId> listResources(ResourceType type, int mapNumber = -1);
 
+	/** Statistics about the cache of unlocked resources */
+	struct CacheStatistics {
+		uint32 hits;			///< Lookups of resources which were still in memory
+		uint32 misses;			///< Lookups which had to load the resource
+		uint32 loadTime;		///< Time spent loading and decompressing resources, in ms, timed per burst of loads
+		uint32 evictions;		///< Number of resources freed to stay within the budget
+		uint32 evictedBytes;	///< Number of bytes freed to stay within the budget
+		uint32 prefetched;		///< Number of resources loaded while the engine was idle
+	};
+
+	const CacheStatistics &getCacheStatistics() const { return _cacheStats; }
+	void resetCacheStatistics();
+
+	/**
+	 * Sets the number of bytes unlocked resources may occupy before the least
+	 * recently used ones are freed. The default is taken from the
+	 * "sci_resource_cache_size" config key (in KB), if it exists and is
+	 * positive. Larger values than 1GB are clamped.
+	 */
+	void setCacheBudget(uint32 bytes);
+	uint32 getCacheBudget() const { return _maxMemory; }
+	uint32 getCacheMemory() const { return _memoryLRU; }
+	uint32 getLockedMemory() const { return _memoryLocked; }
+
+	/** Prints the contents of the cache of unlocked resources, as debug output */
+	void printLRU();
+
+	/**
+	 * Queues a resource to be loaded while the engine is idle, see
+	 * prefetchNextResource(). Once loaded, the resource is added to the LRU,
+	 * in the class which is evicted first until it is looked up. Resources
+	 * which are needed before that are simply loaded by findResource() as
+	 * usual.
+	 */
+	void prefetchResource(ResourceId id);
+
+	/**
+	 * Queues the resources likely to be used by a room for prefetching.
+	 * Sierra's games use the room number for the pic, the main view, the
+	 * music and the messages of the room, so these are queued, if they
+	 * exist.
+	 */
+	void prefetchRoomResources(uint16 roomNumber);
+
+	/**
+	 * Loads the next resource queued by prefetchResource(), if any. Called
+	 * by SciEngine::sleep() while the game waits anyway.
+	 *
+	 * @return true if a resource was loaded, false if there was nothing to do
+	 */
+	bool prefetchNextResource();
+
 	void setAudioLanguage(int language);
 	int getAudioLanguage() const;
 	void changeAudioDirectory(Common::String path);
@@ -379,22 +450,78 @@ public:
 	ResourceType convertResType(byte type);
 
 protected:
-	// Maximum number of bytes to allow being allocated for resources
+	// Default number of bytes to allow being allocated for resources
 	// Note: maxMemory will not be interpreted as a hard limit, only as a restriction
-	// for resources which are not explicitly locked. However, a warning will be
-	// issued whenever this limit is exceeded.
+	// for resources which are not explicitly locked.
 	enum {
-		MAX_MEMORY = 256 * 1024	// 256KB
+		DEFAULT_MAX_MEMORY = 4 * 1024 * 1024,	// 4MB
+		MAX_CACHE_SIZE_KB = 1024 * 1024			// Upper limit for "sci_resource_cache_size", 1GB
+	};
+
+	/**
+	 * Unlocked resources are kept in one LRU list per eviction class. When
+	 * over budget, resources are freed from the first non-empty class.
+	 * Prefetched resources go first until they are used, as the guess that
+	 * they are needed may be wrong. Then audio, which is rarely played twice
+	 * in a row and is by far the largest, while views and pics are reused
+	 * all the time while the player stays in a room.
+	 */
+	enum LRUClass {
+		kLRUClassPrefetched = 0,
+		kLRUClassAudio,
+		kLRUClassOther,
+		kLRUClassGraphics,
+		kLRUClassCount
+	};
+
+	struct LRUList {
+		Resource *first;	///< Most recently used resource
+		Resource *last;		///< Least recently used resource
 	};
 
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	Common::List<ResourceSource *> _sources;
-	int _memoryLocked;	///< Amount of resource bytes in locked memory
-	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	uint32 _maxMemory;		///< Budget for resources under LRU control
+	uint32 _memoryLocked;	///< Amount of resource bytes in locked memory
+	uint32 _memoryLRU;		///< Amount of resource bytes under LRU control
+	LRUList _LRU[kLRUClassCount]; ///< Last Resource Used lists
+	CacheStatistics _cacheStats;
+	uint32 _loadBurstStart;			///< Time the current burst of resource loads started at, see loadResource()
+	uint32 _loadBurstEnd;			///< Time the last resource load ended at
+	uint32 _loadTimeBeforeBurst;	///< CacheStatistics::loadTime before the current burst
+
+	Common::List<ResourceId> _prefetchQueue;	///< Resources to load while the engine is idle
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
+
+	/** An entry of an SCI1.1 audio map, as stored in the audio map index */
+	struct AudioMapIndexEntry {
+		ResourceId id;
+		uint32 offset;
+		uint32 size;
+
+		AudioMapIndexEntry() : offset(0), size(0) {}
+		AudioMapIndexEntry(ResourceId id_, uint32 offset_, uint32 size_) : id(id_), offset(offset_), size(size_) {}
+	};
+
+	/**
+	 * The contents of an SCI1.1 audio map. They are only valid as long as
+	 * both the map and the audio volume it refers to stay the same.
+	 */
+	struct AudioMapIndex {
+		uint16 mapNumber;
+		uint32 mapSize;
+		uint32 mapChecksum;
+		Common::String volumeName;
+		uint32 volumeSize;
+
+		Common::Array<AudioMapIndexEntry> entries;
+	};
+
+	Common::Array<AudioMapIndex> _audioMapIndex; ///< Audio maps read in this or earlier runs
+	bool _audioMapIndexLoaded;
+	bool _audioMapIndexChanged;
 	ResVersion _volVersion; ///< resource.0xx version
 	ResVersion _mapVersion; ///< resource.map version
 
@@ -483,6 +610,22 @@ protected:
 	 */
 	int readAudioMapSCI1(ResourceSource *map, bool unload = false);
 
+	/**
+	 * Looks up an audio map in the audio map index.
+	 * @param key	The audio map, with everything but the entries filled in
+	 * @return		The indexed audio map, or NULL if it has not been indexed
+	 */
+	const AudioMapIndex *findAudioMapIndex(const AudioMapIndex &key);
+
+	/**
+	 * Adds an audio map to the audio map index, replacing older versions
+	 * of it. The index is saved after the next scan of new sources.
+	 */
+	void addAudioMapIndex(const AudioMapIndex &index);
+
+	void loadAudioMapIndex();
+	void saveAudioMapIndex();
+
 	/**--- Patch management functions ---*/
 
 	/**
@@ -508,7 +651,7 @@ protected:
 	 */
 	bool hasOldScriptHeader();
 
-	void printLRU();
+	static LRUClass getLRUClass(const Resource *res);
 	void addToLRU(Resource *res);
 	void removeFromLRU(Resource *res);
 
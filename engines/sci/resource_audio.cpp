@@ -24,6 +24,9 @@
 
 #include "common/archive.h"
 #include "common/file.h"
+#include "common/savefile.h"
+#include "common/substream.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 
 #include "sci/resource.h"
@@ -222,6 +225,165 @@ void ResourceManager::removeAudioResource(ResourceId resId) {
 	}
 }
 
+enum {
+	AUDIO_MAP_INDEX_VERSION = 1
+};
+
+static uint32 getAudioMapChecksum(const byte *data, uint32 size) {
+	// Adler-32
+	uint32 a = 1, b = 0;
+	for (uint32 i = 0; i < size; i++) {
+		a = (a + data[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	return (b << 16) | a;
+}
+
+// The audio map index is saved as <target>.audiomap, which contains:
+// dw 'SAMI'
+// w version
+// w number of maps
+// For each map:
+// w map number
+// dw map size
+// dw map checksum
+// w length of volume name, followed by the name
+// dw volume size
+// dw number of entries
+// 15-byte entries:
+// b type
+// w number
+// dw tuple
+// dw offset
+// dw size
+
+const ResourceManager::AudioMapIndex *ResourceManager::findAudioMapIndex(const AudioMapIndex &key) {
+	if (!_audioMapIndexLoaded)
+		loadAudioMapIndex();
+
+	for (uint i = 0; i < _audioMapIndex.size(); i++) {
+		const AudioMapIndex &index = _audioMapIndex[i];
+		if (index.mapNumber == key.mapNumber && index.mapSize == key.mapSize && index.mapChecksum == key.mapChecksum
+				&& index.volumeName == key.volumeName && index.volumeSize == key.volumeSize)
+			return &index;
+	}
+
+	return NULL;
+}
+
+void ResourceManager::addAudioMapIndex(const AudioMapIndex &index) {
+	// The index belongs to the game, so there is none without a game engine,
+	// e.g. in the fallback detector
+	if (!g_sci)
+		return;
+
+	for (uint i = 0; i < _audioMapIndex.size(); i++) {
+		if (_audioMapIndex[i].mapNumber == index.mapNumber && _audioMapIndex[i].volumeName == index.volumeName) {
+			_audioMapIndex.remove_at(i);
+			break;
+		}
+	}
+
+	_audioMapIndex.push_back(index);
+	_audioMapIndexChanged = true;
+}
+
+void ResourceManager::loadAudioMapIndex() {
+	_audioMapIndexLoaded = true;
+	_audioMapIndex.clear();
+
+	if (!g_sci)
+		return;
+
+	Common::InSaveFile *in = g_system->getSavefileManager()->openForLoading(g_sci->getFilePrefix() + ".audiomap");
+	if (!in)
+		return;
+
+	if (in->readUint32BE() != MKTAG('S','A','M','I') || in->readUint16LE() != AUDIO_MAP_INDEX_VERSION) {
+		delete in;
+		return;
+	}
+
+	uint16 mapCount = in->readUint16LE();
+	for (uint16 i = 0; i < mapCount && !in->eos() && !in->err(); i++) {
+		AudioMapIndex index;
+		index.mapNumber = in->readUint16LE();
+		index.mapSize = in->readUint32LE();
+		index.mapChecksum = in->readUint32LE();
+
+		uint16 nameLength = in->readUint16LE();
+		for (uint16 j = 0; j < nameLength; j++)
+			index.volumeName += (char)in->readByte();
+
+		index.volumeSize = in->readUint32LE();
+
+		uint32 entryCount = in->readUint32LE();
+		if (in->eos() || entryCount > (uint32)(in->size() - in->pos()) / 15)
+			break;
+
+		index.entries.resize(entryCount);
+		for (uint32 j = 0; j < entryCount; j++) {
+			AudioMapIndexEntry &entry = index.entries[j];
+			ResourceType type = (ResourceType)in->readByte();
+			uint16 number = in->readUint16LE();
+			uint32 tuple = in->readUint32LE();
+			entry.id = ResourceId(type, number, tuple);
+			entry.offset = in->readUint32LE();
+			entry.size = in->readUint32LE();
+		}
+
+		_audioMapIndex.push_back(index);
+	}
+
+	if (in->eos() || in->err()) {
+		warning("Audio map index is corrupt, ignoring it");
+		_audioMapIndex.clear();
+	}
+
+	delete in;
+}
+
+void ResourceManager::saveAudioMapIndex() {
+	_audioMapIndexChanged = false;
+
+	if (!g_sci)
+		return;
+
+	// The index is an optimization only, failing to save it is not fatal
+	Common::OutSaveFile *out = g_system->getSavefileManager()->openForSaving(g_sci->getFilePrefix() + ".audiomap");
+	if (!out)
+		return;
+
+	out->writeUint32BE(MKTAG('S','A','M','I'));
+	out->writeUint16LE(AUDIO_MAP_INDEX_VERSION);
+	out->writeUint16LE(_audioMapIndex.size());
+
+	for (uint i = 0; i < _audioMapIndex.size(); i++) {
+		const AudioMapIndex &index = _audioMapIndex[i];
+		out->writeUint16LE(index.mapNumber);
+		out->writeUint32LE(index.mapSize);
+		out->writeUint32LE(index.mapChecksum);
+		out->writeUint16LE(index.volumeName.size());
+		out->writeString(index.volumeName);
+		out->writeUint32LE(index.volumeSize);
+
+		out->writeUint32LE(index.entries.size());
+		for (uint j = 0; j < index.entries.size(); j++) {
+			const AudioMapIndexEntry &entry = index.entries[j];
+			out->writeByte(entry.id.getType());
+			out->writeUint16LE(entry.id.getNumber());
+			out->writeUint32LE(entry.id.getTuple());
+			out->writeUint32LE(entry.offset);
+			out->writeUint32LE(entry.size);
+		}
+	}
+
+	out->finalize();
+	if (out->err())
+		warning("Failed to save the audio map index");
+	delete out;
+}
+
 // Early SCI1.1 65535.MAP structure (uses RESOURCE.AUD):
 // =========
 // 6-byte entries:
@@ -292,6 +454,32 @@ int ResourceManager::readAudioMapSCI11(ResourceSource *map) {
 	if (!src)
 		return SCI_ERROR_NO_RESOURCE_FILES_FOUND;
 
+	AudioMapIndex index;
+	index.mapNumber = map->_volumeNumber;
+	index.mapSize = mapRes->size;
+	index.mapChecksum = getAudioMapChecksum(mapRes->data, mapRes->size);
+	index.volumeName = src->getLocationName();
+	index.volumeSize = 0;
+
+	Common::SeekableReadStream *volumeStream = getVolumeFile(src);
+	if (volumeStream) {
+		index.volumeSize = volumeStream->size();
+		if (src->_resourceFile)
+			delete volumeStream;
+	}
+
+	// Use the entries from the last run, if neither the map nor the volume
+	// have changed since then. This mostly saves reading the sizes of the
+	// samples from the volume for the LB2 floppy/Mother Goose format.
+	const AudioMapIndex *indexed = findAudioMapIndex(index);
+	if (indexed) {
+		for (uint i = 0; i < indexed->entries.size(); i++) {
+			const AudioMapIndexEntry &entry = indexed->entries[i];
+			addResource(entry.id, src, entry.offset, entry.size);
+		}
+		return 0;
+	}
+
 	byte *ptr = mapRes->data;
 
 	// Heuristic to detect entry size
@@ -319,7 +507,7 @@ int ResourceManager::readAudioMapSCI11(ResourceSource *map) {
 				ptr += 3;
 			}
 
-			addResource(ResourceId(kResourceTypeAudio, n), src, offset);
+			index.entries.push_back(AudioMapIndexEntry(ResourceId(kResourceTypeAudio, n), offset, 0));
 		}
 	} else if (map->_volumeNumber == 0 && entrySize == 10 && ptr[3] == 0) {
 		// QFG3 demo format
@@ -336,7 +524,7 @@ int ResourceManager::readAudioMapSCI11(ResourceSource *map) {
 			uint32 size = READ_LE_UINT32(ptr);
 			ptr += 4;
 
-			addResource(ResourceId(kResourceTypeAudio, n), src, offset, size);
+			index.entries.push_back(AudioMapIndexEntry(ResourceId(kResourceTypeAudio, n), offset, size));
 		}
 	} else if (map->_volumeNumber == 0 && entrySize == 8 && READ_LE_UINT16(ptr + 2) == 0xffff) {
 		// LB2 Floppy/Mother Goose SCI1.1 format
@@ -361,7 +549,7 @@ int ResourceManager::readAudioMapSCI11(ResourceSource *map) {
 			stream->skip(5);
 			uint32 size = stream->readUint32LE() + headerSize + 2;
 
-			addResource(ResourceId(kResourceTypeAudio, n), src, offset, size);
+			index.entries.push_back(AudioMapIndexEntry(ResourceId(kResourceTypeAudio, n), offset, size));
 		}
 	} else {
 		bool isEarly = (entrySize != 11);
@@ -392,7 +580,7 @@ int ResourceManager::readAudioMapSCI11(ResourceSource *map) {
 				ptr += 2;
 
 				if (syncSize > 0)
-					addResource(ResourceId(kResourceTypeSync36, map->_volumeNumber, n & 0xffffff3f), src, offset, syncSize);
+					index.entries.push_back(AudioMapIndexEntry(ResourceId(kResourceTypeSync36, map->_volumeNumber, n & 0xffffff3f), offset, syncSize));
 			}
 
 			if (n & 0x40) {
@@ -402,10 +590,16 @@ int ResourceManager::readAudioMapSCI11(ResourceSource *map) {
 				ptr += 2;
 			}
 
-			addResource(ResourceId(kResourceTypeAudio36, map->_volumeNumber, n & 0xffffff3f), src, offset + syncSize);
+			index.entries.push_back(AudioMapIndexEntry(ResourceId(kResourceTypeAudio36, map->_volumeNumber, n & 0xffffff3f), offset + syncSize, 0));
 		}
 	}
 
+	for (uint i = 0; i < index.entries.size(); i++) {
+		const AudioMapIndexEntry &entry = index.entries[i];
+		addResource(entry.id, src, entry.offset, entry.size);
+	}
+
+	addAudioMapIndex(index);
 	return 0;
 }
 
@@ -833,6 +1027,23 @@ void WaveResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
 		delete fileStream;
 }
 
+int32 AudioVolumeResourceSource::getCompressedOffset(int32 offset, uint32 &compressedSize) const {
+	// Look up our offset in the offset-translation table, and calculate the
+	// compressed size by using the next offset
+	const int32 *mappingTable = _audioCompressionOffsetMapping;
+
+	do {
+		if (*mappingTable == offset) {
+			const int32 compressedOffset = mappingTable[1];
+			compressedSize = mappingTable[3] - compressedOffset;
+			return compressedOffset;
+		}
+		mappingTable += 2;
+	} while (*mappingTable);
+
+	return 0;
+}
+
 void AudioVolumeResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
 	Common::SeekableReadStream *fileStream = getVolumeFile(resMan, res);
 	if (!fileStream)
@@ -841,27 +1052,17 @@ void AudioVolumeResourceSource::loadResource(ResourceManager *resMan, Resource *
 	if (_audioCompressionType) {
 		// this file is compressed, so lookup our offset in the offset-translation table and get the new offset
 		//  also calculate the compressed size by using the next offset
-		int32 *mappingTable = _audioCompressionOffsetMapping;
-		int32 compressedOffset = 0;
-
-		do {
-			if (*mappingTable == res->_fileOffset) {
-				mappingTable++;
-				compressedOffset = *mappingTable;
-				// Go to next compressed offset and use that to calculate size of compressed sample
-				switch (res->getType()) {
-				case kResourceTypeSync:
-				case kResourceTypeSync36:
-					// we should already have a (valid) size
-					break;
-				default:
-					mappingTable += 2;
-					res->size = *mappingTable - compressedOffset;
-				}
-				break;
-			}
-			mappingTable += 2;
-		} while (*mappingTable);
+		uint32 compressedSize = 0;
+		int32 compressedOffset = getCompressedOffset(res->_fileOffset, compressedSize);
+
+		switch (res->getType()) {
+		case kResourceTypeSync:
+		case kResourceTypeSync36:
+			// we should already have a (valid) size
+			break;
+		default:
+			res->size = compressedSize;
+		}
 
 		if (!compressedOffset)
 			error("could not translate offset to compressed offset in audio volume");
@@ -891,6 +1092,79 @@ void AudioVolumeResourceSource::loadResource(ResourceManager *resMan, Resource *
 		delete fileStream;
 }
 
+Common::SeekableReadStream *ResourceManager::openAudioResource(ResourceId id, uint32 &compressionType, uint32 &headerSize) {
+	Resource *res = testResource(id);
+	if (!res || res->_source->getSourceType() != kSourceAudioVolume)
+		return NULL;
+
+	AudioVolumeResourceSource *source = static_cast<AudioVolumeResourceSource *>(res->_source);
+	int32 offset = res->_fileOffset;
+	uint32 size = res->size;
+
+	compressionType = source->getAudioCompressionType();
+	headerSize = 0;
+
+	if (compressionType) {
+		// Compressed audio has no SCI1.1 resource header
+		offset = source->getCompressedOffset(offset, size);
+		if (!offset)
+			return NULL;
+	}
+
+	// The volume files of the resource manager are shared, so the audio
+	// gets a file of its own
+	Common::SeekableReadStream *file;
+	if (source->_resourceFile) {
+		file = source->_resourceFile->createReadStream();
+	} else {
+		Common::File *volumeFile = new Common::File();
+		if (!volumeFile->open(source->getLocationName())) {
+			delete volumeFile;
+			return NULL;
+		}
+		file = volumeFile;
+	}
+	if (!file)
+		return NULL;
+
+	if (!compressionType && getSciVersion() >= SCI_VERSION_1_1) {
+		// See Resource::loadFromAudioVolumeSCI11()
+		file->seek(offset, SEEK_SET);
+		if (file->readUint32BE() == MKTAG('R','I','F','F')) {
+			size = file->readUint32LE() + 8;
+		} else {
+			file->seek(offset, SEEK_SET);
+			if (convertResType(file->readByte()) != kResourceTypeAudio) {
+				delete file;
+				return NULL;
+			}
+
+			headerSize = file->readByte();
+			if (headerSize != 7 && headerSize != 11 && headerSize != 12) {
+				delete file;
+				return NULL;
+			}
+
+			if (headerSize != 7) {
+				file->skip(7);
+				size = file->readUint32LE();
+			}
+
+			// Skip the resource type and header size, but keep the header
+			offset += 2;
+			size += headerSize;
+		}
+	}
+
+	const int32 end = MIN<int32>(offset + size, file->size());
+	if (file->err() || offset >= end) {
+		delete file;
+		return NULL;
+	}
+
+	return new Common::SeekableSubReadStream(file, offset, end, DisposeAfterUse::YES);
+}
+
 bool ResourceManager::addAudioSources() {
 	Common::List<ResourceId> resources = listResources(kResourceTypeMap);
 	Common::List<ResourceId>::iterator itr;
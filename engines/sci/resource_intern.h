@@ -152,6 +152,15 @@ public:
 	virtual void loadResource(ResourceManager *resMan, Resource *res);
 
 	virtual uint32 getAudioCompressionType() const;
+
+	/**
+	 * Translates the offset of a resource in the original volume into its
+	 * offset in the compressed volume.
+	 * @param offset			the offset in the original volume
+	 * @param compressedSize	receives the size of the compressed sample
+	 * @return the offset in the compressed volume, or 0 if it is unknown
+	 */
+	int32 getCompressedOffset(int32 offset, uint32 &compressedSize) const;
 };
 
 class ExtAudioMapResourceSource : public ResourceSource {
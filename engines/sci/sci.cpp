@@ -716,6 +716,11 @@ void SciEngine::runGame() {
 			break;	// exit loop
 		}
 	} while (true);
+
+	// When replaying a recorded session, report how fast the scripts ran,
+	// so that recordings can be used to benchmark the interpreter
+	if (!ConfMan.get("record_mode").compareToIgnoreCase("playback"))
+		debug("Executed %d SCI operations, %d per second", _gamestate->scriptStepCounter, _gamestate->getScriptStepsPerSecond());
 }
 
 void SciEngine::exitGame() {
@@ -30,6 +30,7 @@
 
 #include "common/file.h"
 #include "common/memstream.h"
+#include "common/substream.h"
 #include "common/system.h"
 
 #include "audio/audiostream.h"
@@ -120,6 +121,11 @@ enum SolFlags {
 	kSolFlagIsSigned   = 1 << 3
 };
 
+enum {
+	/** Audio resources up to this size are read into memory instead of being streamed */
+	MAX_BUFFERED_AUDIO_SIZE = 64 * 1024
+};
+
 // FIXME: Move this to sound/adpcm.cpp?
 // Note that the 16-bit version is also used in coktelvideo.cpp
 static const uint16 tableDPCM16[128] = {
@@ -182,6 +188,133 @@ static void deDPCM8(byte *soundBuf, Common::SeekableReadStream &audioStream, uin
 	}
 }
 
+/**
+ * Plays DPCM compressed SOL audio, decoding it while it is being played
+ * instead of all at once beforehand.
+ */
+class SOLStream : public Audio::SeekableAudioStream {
+public:
+	SOLStream(Common::SeekableReadStream *stream, uint16 rate, byte audioFlags);
+	~SOLStream();
+
+	int readBuffer(int16 *buffer, const int numSamples);
+	bool isStereo() const { return false; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return _samplePos >= _sampleCount; }
+
+	bool seek(const Audio::Timestamp &where);
+	Audio::Timestamp getLength() const { return Audio::Timestamp(0, _sampleCount, _rate); }
+
+private:
+	enum {
+		BUFFER_SIZE = 1024
+	};
+
+	void restart();
+	bool fillBuffer();
+
+	Common::SeekableReadStream *_stream;
+	uint16 _rate;
+	byte _audioFlags;
+	uint32 _sampleCount;
+	uint32 _samplePos;
+
+	int32 _sample;		///< The DPCM state, i.e. the last decoded sample
+	byte _lastByte;		///< In 8 bit streams, the byte which holds the current nibble
+
+	byte _buffer[BUFFER_SIZE];
+	uint32 _bufferPos;
+	uint32 _bufferSize;
+};
+
+SOLStream::SOLStream(Common::SeekableReadStream *stream, uint16 rate, byte audioFlags)
+	: _stream(stream), _rate(rate), _audioFlags(audioFlags) {
+
+	// Each byte holds one 16 bit sample or two 8 bit samples
+	_sampleCount = (audioFlags & kSolFlag16Bit) ? stream->size() : stream->size() * 2;
+	restart();
+}
+
+SOLStream::~SOLStream() {
+	delete _stream;
+}
+
+void SOLStream::restart() {
+	_stream->seek(0, SEEK_SET);
+	_samplePos = 0;
+	_sample = (_audioFlags & kSolFlag16Bit) ? 0 : 0x80;
+	_lastByte = 0;
+	_bufferPos = _bufferSize = 0;
+}
+
+bool SOLStream::fillBuffer() {
+	_bufferPos = 0;
+	_bufferSize = _stream->read(_buffer, BUFFER_SIZE);
+	return _bufferSize > 0;
+}
+
+int SOLStream::readBuffer(int16 *buffer, const int numSamples) {
+	// Unsigned samples are converted like in the raw audio streams
+	const uint16 signFlip = (_audioFlags & kSolFlagIsSigned) ? 0 : 0x8000;
+	const int samples = MIN<int>(numSamples, _sampleCount - _samplePos);
+
+	for (int i = 0; i < samples; i++) {
+		if (_audioFlags & kSolFlag16Bit) {
+			if (_bufferPos == _bufferSize && !fillBuffer()) {
+				_sampleCount = _samplePos;
+				return i;
+			}
+
+			const byte b = _buffer[_bufferPos++];
+			if (b & 0x80)
+				_sample -= tableDPCM16[b & 0x7f];
+			else
+				_sample += tableDPCM16[b];
+			_sample = CLIP<int32>(_sample, -32768, 32767);
+
+			*buffer++ = (int16)((uint16)_sample ^ signFlip);
+		} else {
+			byte nibble;
+			if (_samplePos & 1) {
+				nibble = _lastByte & 0xf;
+			} else {
+				if (_bufferPos == _bufferSize && !fillBuffer()) {
+					_sampleCount = _samplePos;
+					return i;
+				}
+				_lastByte = _buffer[_bufferPos++];
+				nibble = _lastByte >> 4;
+			}
+
+			byte out;
+			deDPCM8Nibble(&out, _sample, nibble);
+			*buffer++ = (int16)((out << 8) ^ signFlip);
+		}
+
+		_samplePos++;
+	}
+
+	return samples;
+}
+
+bool SOLStream::seek(const Audio::Timestamp &where) {
+	const uint32 target = where.convertToFramerate(_rate).totalNumberOfFrames();
+	if (target > _sampleCount)
+		return false;
+
+	// DPCM can only be decoded from the start
+	if (target < _samplePos)
+		restart();
+
+	int16 skipBuffer[BUFFER_SIZE];
+	while (_samplePos < target) {
+		if (readBuffer(skipBuffer, MIN<uint32>(BUFFER_SIZE, target - _samplePos)) <= 0)
+			return false;
+	}
+
+	return true;
+}
+
 // Sierra SOL audio file reader
 // Check here for more info: http://wiki.multimedia.cx/index.php?title=Sierra_Audio
 static bool readSOLHeader(Common::SeekableReadStream *audioStream, int headerSize, uint32 &size, uint16 &audioRate, byte &audioFlags, uint32 resSize) {
@@ -249,57 +382,72 @@ Audio::RewindableAudioStream *AudioPlayer::getAudioStream(uint32 number, uint32
 	Audio::SeekableAudioStream *audioSeekStream = 0;
 	Audio::RewindableAudioStream *audioStream = 0;
 	uint32 size = 0;
-	byte *data = 0;
 	byte flags = 0;
-	Sci::Resource *audioRes;
 
 	*sampleLen = 0;
 
-	if (volume == 65535) {
-		audioRes = _resMan->findResource(ResourceId(kResourceTypeAudio, number), false);
-		if (!audioRes) {
-			warning("Failed to find audio entry %i", number);
-			return NULL;
+	ResourceId audioId;
+	if (volume == 65535)
+		audioId = ResourceId(kResourceTypeAudio, number);
+	else
+		audioId = ResourceId(kResourceTypeAudio36, volume, number);
+
+	// Samples in audio volumes are streamed from there. Everything else is
+	// copied, because ResourceManager may free the original data later.
+	uint32 audioCompressionType = 0;
+	uint32 headerSize = 0;
+	Common::SeekableReadStream *dataStream = _resMan->openAudioResource(audioId, audioCompressionType, headerSize);
+
+	if (dataStream) {
+		// Short samples, like most sound effects, are read into memory, so
+		// that they don't keep their file open for as long as they exist
+		if (dataStream->size() <= MAX_BUFFERED_AUDIO_SIZE) {
+			Common::SeekableReadStream *memoryStream = dataStream->readStream(dataStream->size());
+			delete dataStream;
+			dataStream = memoryStream;
 		}
 	} else {
-		audioRes = _resMan->findResource(ResourceId(kResourceTypeAudio36, volume, number), false);
+		Sci::Resource *audioRes = _resMan->findResource(audioId, false);
 		if (!audioRes) {
-			warning("Failed to find audio entry (%i, %i, %i, %i, %i)", volume, (number >> 24) & 0xff,
-					(number >> 16) & 0xff, (number >> 8) & 0xff, number & 0xff);
+			if (volume == 65535)
+				warning("Failed to find audio entry %i", number);
+			else
+				warning("Failed to find audio entry (%i, %i, %i, %i, %i)", volume, (number >> 24) & 0xff,
+						(number >> 16) & 0xff, (number >> 8) & 0xff, number & 0xff);
 			return NULL;
 		}
-	}
 
-	byte audioFlags;
-	uint32 audioCompressionType = audioRes->getAudioCompressionType();
+		audioCompressionType = audioRes->getAudioCompressionType();
+		headerSize = audioRes->_headerSize;
+
+		byte *data = (byte *)malloc(headerSize + audioRes->size);
+		assert(data);
+		if (headerSize)
+			memcpy(data, audioRes->_header, headerSize);
+		memcpy(data + headerSize, audioRes->data, audioRes->size);
+		dataStream = new Common::MemoryReadStream(data, headerSize + audioRes->size, DisposeAfterUse::YES);
+	}
 
 	if (audioCompressionType) {
 #if (defined(USE_MAD) || defined(USE_VORBIS) || defined(USE_FLAC))
 		// Compressed audio made by our tool
-		byte *compressedData = (byte *)malloc(audioRes->size);
-		assert(compressedData);
-		// We copy over the compressed data in our own buffer. We have to do
-		// this, because ResourceManager may free the original data late. All
-		// other compression types already decompress completely into an
-		// additional buffer here. MP3/OGG/FLAC decompression works on-the-fly
-		// instead.
-		memcpy(compressedData, audioRes->data, audioRes->size);
-		Common::SeekableReadStream *compressedStream = new Common::MemoryReadStream(compressedData, audioRes->size, DisposeAfterUse::YES);
-
 		switch (audioCompressionType) {
 		case MKTAG('M','P','3',' '):
 #ifdef USE_MAD
-			audioSeekStream = Audio::makeMP3Stream(compressedStream, DisposeAfterUse::YES);
+			audioSeekStream = Audio::makeMP3Stream(dataStream, DisposeAfterUse::YES);
+			dataStream = 0;
 #endif
 			break;
 		case MKTAG('O','G','G',' '):
 #ifdef USE_VORBIS
-			audioSeekStream = Audio::makeVorbisStream(compressedStream, DisposeAfterUse::YES);
+			audioSeekStream = Audio::makeVorbisStream(dataStream, DisposeAfterUse::YES);
+			dataStream = 0;
 #endif
 			break;
 		case MKTAG('F','L','A','C'):
 #ifdef USE_FLAC
-			audioSeekStream = Audio::makeFLACStream(compressedStream, DisposeAfterUse::YES);
+			audioSeekStream = Audio::makeFLACStream(dataStream, DisposeAfterUse::YES);
+			dataStream = 0;
 #endif
 			break;
 		}
@@ -308,69 +456,78 @@ Audio::RewindableAudioStream *AudioPlayer::getAudioStream(uint32 number, uint32
 #endif
 	} else {
 		// Original source file
-		if (audioRes->_headerSize > 0) {
-			// SCI1.1
-			Common::MemoryReadStream headerStream(audioRes->_header, audioRes->_headerSize, DisposeAfterUse::NO);
+		byte header[14];
+		const uint32 headerBytes = dataStream->read(header, sizeof(header));
+		dataStream->seek(0, SEEK_SET);
 
-			if (readSOLHeader(&headerStream, audioRes->_headerSize, size, _audioRate, audioFlags, audioRes->size)) {
-				Common::MemoryReadStream dataStream(audioRes->data, audioRes->size, DisposeAfterUse::NO);
-				data = readSOLAudio(&dataStream, size, audioFlags, flags);
+		if (headerSize > 0) {
+			// SCI1.1
+			byte audioFlags;
+
+			if (readSOLHeader(dataStream, headerSize, size, _audioRate, audioFlags, dataStream->size() - headerSize)) {
+				const uint32 dataEnd = MIN<uint32>(headerSize + size, dataStream->size());
+				Common::SeekableReadStream *solStream = new Common::SeekableSubReadStream(dataStream, headerSize, dataEnd, DisposeAfterUse::YES);
+				dataStream = 0;
+
+				if (audioFlags & kSolFlagCompressed) {
+					audioSeekStream = new SOLStream(solStream, _audioRate, audioFlags);
+				} else {
+					// We assume that the sound data is raw PCM
+					if (audioFlags & kSolFlag16Bit)
+						flags |= Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN;
+					if (!(audioFlags & kSolFlagIsSigned))
+						flags |= Audio::FLAG_UNSIGNED;
+
+					audioSeekStream = Audio::makeRawStream(solStream, _audioRate, flags, DisposeAfterUse::YES);
+				}
 			}
-		} else if (audioRes->size > 4 && READ_BE_UINT32(audioRes->data) == MKTAG('R','I','F','F')) {
+		} else if (headerBytes > 4 && READ_BE_UINT32(header) == MKTAG('R','I','F','F')) {
 			// WAVE detected
-			Common::SeekableReadStream *waveStream = new Common::MemoryReadStream(audioRes->data, audioRes->size, DisposeAfterUse::NO);
 
 			// Calculate samplelen from WAVE header
 			int waveSize = 0, waveRate = 0;
 			byte waveFlags = 0;
-			Audio::loadWAVFromStream(*waveStream, waveSize, waveRate, waveFlags);
+			Audio::loadWAVFromStream(*dataStream, waveSize, waveRate, waveFlags);
 			*sampleLen = (waveFlags & Audio::FLAG_16BITS ? waveSize >> 1 : waveSize) * 60 / waveRate;
 
-			waveStream->seek(0, SEEK_SET);
-			audioStream = Audio::makeWAVStream(waveStream, DisposeAfterUse::YES);
-		} else if (audioRes->size > 4 && READ_BE_UINT32(audioRes->data) == MKTAG('F','O','R','M')) {
+			dataStream->seek(0, SEEK_SET);
+			audioStream = Audio::makeWAVStream(dataStream, DisposeAfterUse::YES);
+			dataStream = 0;
+		} else if (headerBytes > 4 && READ_BE_UINT32(header) == MKTAG('F','O','R','M')) {
 			// AIFF detected
-			Common::SeekableReadStream *waveStream = new Common::MemoryReadStream(audioRes->data, audioRes->size, DisposeAfterUse::NO);
 
 			// Calculate samplelen from AIFF header
 			int waveSize = 0, waveRate = 0;
 			byte waveFlags = 0;
-			Audio::loadAIFFFromStream(*waveStream, waveSize, waveRate, waveFlags);
+			Audio::loadAIFFFromStream(*dataStream, waveSize, waveRate, waveFlags);
 			*sampleLen = (waveFlags & Audio::FLAG_16BITS ? waveSize >> 1 : waveSize) * 60 / waveRate;
 
-			waveStream->seek(0, SEEK_SET);
-			audioStream = Audio::makeAIFFStream(waveStream, DisposeAfterUse::YES);
-		} else if (audioRes->size > 14 && READ_BE_UINT16(audioRes->data) == 1 && READ_BE_UINT16(audioRes->data + 2) == 1
-				&& READ_BE_UINT16(audioRes->data + 4) == 5 && READ_BE_UINT32(audioRes->data + 10) == 0x00018051) {
+			dataStream->seek(0, SEEK_SET);
+			audioStream = Audio::makeAIFFStream(dataStream, DisposeAfterUse::YES);
+			dataStream = 0;
+		} else if (headerBytes == sizeof(header) && dataStream->size() > 14 && READ_BE_UINT16(header) == 1 && READ_BE_UINT16(header + 2) == 1
+				&& READ_BE_UINT16(header + 4) == 5 && READ_BE_UINT32(header + 10) == 0x00018051) {
 			// Mac snd detected
-			Common::SeekableReadStream *sndStream = new Common::MemoryReadStream(audioRes->data, audioRes->size, DisposeAfterUse::NO);
-
-			audioSeekStream = Audio::makeMacSndStream(sndStream, DisposeAfterUse::YES);
+			audioSeekStream = Audio::makeMacSndStream(dataStream, DisposeAfterUse::YES);
+			dataStream = 0;
 		} else {
 			// SCI1 raw audio
-			size = audioRes->size;
-			data = (byte *)malloc(size);
-			assert(data);
-			memcpy(data, audioRes->data, size);
 			flags = Audio::FLAG_UNSIGNED;
 			_audioRate = 11025;
+			audioSeekStream = Audio::makeRawStream(dataStream, _audioRate, flags, DisposeAfterUse::YES);
+			dataStream = 0;
 		}
-
-		if (data)
-			audioSeekStream = Audio::makeRawStream(data, size, _audioRate, flags);
 	}
 
+	// Streams which could not be decoded are still ours
+	delete dataStream;
+
 	if (audioSeekStream) {
 		*sampleLen = (audioSeekStream->getLength().msecs() * 60) / 1000; // we translate msecs to ticks
 		audioStream = audioSeekStream;
 	}
-	// We have to make sure that we don't depend on resource manager pointers
-	// after this point, because the actual audio resource may get unloaded by
-	// resource manager at any time.
-	if (audioStream)
-		return audioStream;
 
-	return NULL;
+	return audioStream;
 }
 
 void AudioPlayer::setSoundSync(ResourceId id, reg_t syncObjAddr, SegManager *segMan) {
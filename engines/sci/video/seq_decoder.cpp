@@ -136,10 +136,8 @@ const Graphics::Surface *SeqDecoder::decodeNextFrame() {
 
 		delete[] linebuf;
 	} else {
-		byte *buf = new byte[frameSize];
-		_fileStream->read(buf, frameSize);
-		decodeFrame(buf, rleSize, buf + rleSize, frameSize - rleSize, (byte *)_surface->pixels + SEQ_SCREEN_WIDTH * frameTop, frameLeft, frameWidth, frameHeight, colorKey);
-		delete[] buf;
+		Common::StreamBuffer buf(*_fileStream, frameSize);
+		decodeFrame(buf.getData(), rleSize, buf.getData() + rleSize, frameSize - rleSize, (byte *)_surface->pixels + SEQ_SCREEN_WIDTH * frameTop, frameLeft, frameWidth, frameHeight, colorKey);
 	}
 
 	if (_curFrame == -1)
@@ -159,7 +157,7 @@ const Graphics::Surface *SeqDecoder::decodeNextFrame() {
 	} \
 	memcpy(dest + writeRow * SEQ_SCREEN_WIDTH + writeCol, litData + litPos, n);
 
-bool SeqDecoder::decodeFrame(byte *rleData, int rleSize, byte *litData, int litSize, byte *dest, int left, int width, int height, int colorKey) {
+bool SeqDecoder::decodeFrame(const byte *rleData, int rleSize, const byte *litData, int litSize, byte *dest, int left, int width, int height, int colorKey) {
 	int writeRow = 0;
 	int writeCol = left;
 	int litPos = 0;
@@ -69,7 +69,7 @@ private:
 	};
 
 	void readPaletteChunk(uint16 chunkSize);
-	bool decodeFrame(byte *rleData, int rleSize, byte *litData, int litSize, byte *dest, int left, int width, int height, int colorKey);
+	bool decodeFrame(const byte *rleData, int rleSize, const byte *litData, int litSize, byte *dest, int left, int width, int height, int colorKey);
 
 	uint16 _width, _height;
 	uint16 _frameDelay;
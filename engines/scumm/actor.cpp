@@ -554,7 +554,7 @@ void Actor::walkActor() {
 
 		_walkdata.curbox = next_box;
 
-		if (findPathTowards(_walkbox, next_box, _walkdata.destbox, foundPath))
+		if (findPathTowards(_walkbox, next_box, _walkdata.destbox, _pos, _walkdata.dest, foundPath))
 			break;
 
 		if (calcMovementFactor(foundPath))
@@ -773,7 +773,7 @@ void Actor_v3::walkActor() {
 
 		_walkdata.curbox = next_box;
 
-		findPathTowardsOld(_walkbox, next_box, _walkdata.destbox, p2, p3);
+		findPathTowardsOld(_walkbox, next_box, _walkdata.destbox, _pos, _walkdata.dest, p2, p3);
 		if (p2.x == 32000 && p3.x == 32000) {
 			break;
 		}
@@ -206,6 +206,14 @@ public:
 	void faceToObject(int obj);
 	void turnToDirection(int newdir);
 	virtual void walkActor();
+
+	/**
+	 * Computes the points the actor walks through to get to a destination
+	 * from where it stands, the destination itself being the last one.
+	 * Returns false if the destination box can't be reached.
+	 */
+	virtual bool findWalkPath(const Common::Point &dest, int destBox, Common::Array<Common::Point> &waypoints);
+
 	void drawActorCostume(bool hitTestMode = false);
 	virtual void prepareDrawActorCostume(BaseCostumeRenderer *bcr);
 	virtual void animateCostume();
@@ -308,7 +316,7 @@ protected:
 
 	virtual bool isPlayer();
 
-	bool findPathTowards(byte box, byte box2, byte box3, Common::Point &foundPath);
+	bool findPathTowards(byte box, byte box2, byte box3, const Common::Point &curPos, const Common::Point &dest, Common::Point &foundPath);
 };
 
 class Actor_v3 : public Actor {
@@ -316,10 +324,11 @@ public:
 	Actor_v3(ScummEngine *scumm, int id) : Actor(scumm, id) {}
 
 	virtual void walkActor();
+	virtual bool findWalkPath(const Common::Point &dest, int destBox, Common::Array<Common::Point> &waypoints);
 
 protected:
 	virtual void setupActorScale();
-	void findPathTowardsOld(byte box, byte box2, byte box3, Common::Point &p2, Common::Point &p3);
+	void findPathTowardsOld(byte box, byte box2, byte box3, const Common::Point &curPos, const Common::Point &dest, Common::Point &p2, Common::Point &p3);
 };
 
 class Actor_v2 : public Actor_v3 {
@@ -328,6 +337,7 @@ public:
 
 	virtual void initActor(int mode);
 	virtual void walkActor();
+	virtual bool findWalkPath(const Common::Point &dest, int destBox, Common::Array<Common::Point> &waypoints);
 	virtual AdjustBoxResult adjustXYToBeInBox(int dstX, int dstY);
 
 protected:
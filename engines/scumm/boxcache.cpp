@@ -0,0 +1,132 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/util.h"
+
+#include "scumm/boxes.h"
+
+namespace Scumm {
+
+BoxCache::BoxCache() {
+	invalidate();
+}
+
+void BoxCache::invalidate() {
+	_valid = false;
+	_boxes.clear();
+	_gridLeft = _gridTop = 0;
+	_gridWidth = _gridHeight = 0;
+	_gridCells.clear();
+	_gridBoxes.clear();
+	_itineraryMatrix.clear();
+	_gates.clear();
+}
+
+void BoxCache::setBoxes(const Common::Array<BoxCoords> &boxes) {
+	invalidate();
+
+	_boxes.resize(boxes.size());
+	for (uint i = 0; i < boxes.size(); i++) {
+		Entry &entry = _boxes[i];
+		const BoxCoords &box = boxes[i];
+		entry.coords = box;
+		entry.minX = MIN(MIN(box.ul.x, box.ur.x), MIN(box.ll.x, box.lr.x));
+		entry.maxX = MAX(MAX(box.ul.x, box.ur.x), MAX(box.ll.x, box.lr.x));
+		entry.minY = MIN(MIN(box.ul.y, box.ur.y), MIN(box.ll.y, box.lr.y));
+		entry.maxY = MAX(MAX(box.ul.y, box.ur.y), MAX(box.ll.y, box.lr.y));
+	}
+
+	_valid = true;
+	if (_boxes.empty())
+		return;
+
+	int right = _boxes[0].maxX, bottom = _boxes[0].maxY;
+	_gridLeft = _boxes[0].minX;
+	_gridTop = _boxes[0].minY;
+	for (uint i = 1; i < _boxes.size(); i++) {
+		_gridLeft = MIN<int>(_gridLeft, _boxes[i].minX);
+		_gridTop = MIN<int>(_gridTop, _boxes[i].minY);
+		right = MAX<int>(right, _boxes[i].maxX);
+		bottom = MAX<int>(bottom, _boxes[i].maxY);
+	}
+	_gridWidth = (right - _gridLeft) / GRID_CELL_SIZE + 1;
+	_gridHeight = (bottom - _gridTop) / GRID_CELL_SIZE + 1;
+
+	// Count the boxes of each cell first, then fill in the boxes, so that
+	// the boxes of all cells can be kept in a single array
+	Common::Array<uint32> count;
+	count.resize(_gridWidth * _gridHeight + 1);
+	for (uint i = 0; i < count.size(); i++)
+		count[i] = 0;
+
+	for (int pass = 0; pass < 2; pass++) {
+		for (uint i = 0; i < _boxes.size(); i++) {
+			const Entry &entry = _boxes[i];
+			for (int y = (entry.minY - _gridTop) / GRID_CELL_SIZE; y <= (entry.maxY - _gridTop) / GRID_CELL_SIZE; y++) {
+				for (int x = (entry.minX - _gridLeft) / GRID_CELL_SIZE; x <= (entry.maxX - _gridLeft) / GRID_CELL_SIZE; x++) {
+					const int cell = y * _gridWidth + x;
+					if (pass == 0)
+						count[cell]++;
+					else
+						_gridBoxes[_gridCells[cell] + count[cell]++] = i;
+				}
+			}
+		}
+
+		if (pass == 0) {
+			_gridCells.resize(count.size());
+			uint32 start = 0;
+			for (uint i = 0; i < count.size(); i++) {
+				_gridCells[i] = start;
+				start += count[i];
+				count[i] = 0;
+			}
+			_gridBoxes.resize(start);
+		}
+	}
+}
+
+const byte *BoxCache::getBoxesAt(int x, int y, int &count) const {
+	count = 0;
+	if (x < _gridLeft || y < _gridTop)
+		return NULL;
+
+	const int cellX = (x - _gridLeft) / GRID_CELL_SIZE;
+	const int cellY = (y - _gridTop) / GRID_CELL_SIZE;
+	if (cellX >= _gridWidth || cellY >= _gridHeight)
+		return NULL;
+
+	const int cell = cellY * _gridWidth + cellX;
+	count = _gridCells[cell + 1] - _gridCells[cell];
+	return count ? &_gridBoxes[_gridCells[cell]] : NULL;
+}
+
+const BoxGate *BoxCache::findGate(int box1, int box2) const {
+	GateMap::const_iterator i = _gates.find((uint)box1 << 8 | (uint)box2);
+	return i != _gates.end() ? &i->_value : NULL;
+}
+
+void BoxCache::addGate(int box1, int box2, const BoxGate &gate) {
+	_gates[(uint)box1 << 8 | (uint)box2] = gate;
+}
+
+} // End of namespace Scumm
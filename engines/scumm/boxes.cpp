@@ -205,6 +205,11 @@ void ScummEngine::setBoxFlags(int box, int val) {
 			ptr->v2.flags = val;
 		else
 			ptr->old.flags = val;
+
+		// The v0 boxes are shorter than the v2 ones, so their flags overlap
+		// the coordinates of the next box
+		if (_game.version == 0)
+			_boxCache->invalidate();
 	}
 }
 
@@ -497,19 +502,37 @@ int ScummEngine_v6::getSpecialBox(int x, int y) {
 	int numOfBoxes;
 	byte flag;
 
+	const int box = getBoxAt(x, y);
+	if (box < 0)
+		return (-1);
+
 	numOfBoxes = getNumBoxes() - 1;
 
-	for (i = numOfBoxes; i >= 0; i--) {
+	// A visible box for the player only hides the boxes below it
+	for (i = numOfBoxes; i >= box; i--) {
 		flag = getBoxFlags(i);
 
 		if (!(flag & kBoxInvisible) && (flag & kBoxPlayerOnly))
 			return (-1);
+	}
+
+	return box;
+}
+
+/**
+ * Returns the highest numbered box which contains the given point, or -1 if
+ * there is none.
+ */
+int ScummEngine::getBoxAt(int x, int y) {
+	int count;
+	const byte *boxes = getBoxCache().getBoxesAt(x, y, count);
 
-		if (checkXYInBoxBounds(i, x, y))
-			return (i);
+	while (count--) {
+		if (checkXYInBoxBounds(boxes[count], x, y))
+			return boxes[count];
 	}
 
-	return (-1);
+	return -1;
 }
 
 bool ScummEngine::checkXYInBoxBounds(int boxnum, int x, int y) {
@@ -571,7 +594,34 @@ bool ScummEngine::checkXYInBoxBounds(int boxnum, int x, int y) {
 	return true;
 }
 
+BoxCache &ScummEngine::getBoxCache() {
+	if (!_boxCache->isValid()) {
+		Common::Array<BoxCoords> boxes;
+		boxes.resize(getNumBoxes());
+		for (uint i = 0; i < boxes.size(); i++)
+			boxes[i] = readBoxCoordinates(i);
+		_boxCache->setBoxes(boxes);
+
+		if (_game.version == 0 && !boxes.empty()) {
+			Common::Array<byte> &itineraryMatrix = _boxCache->getItineraryMatrix();
+			itineraryMatrix.resize(boxes.size() * boxes.size());
+			calcItineraryMatrix(&itineraryMatrix[0], boxes.size());
+		}
+	}
+
+	return *_boxCache;
+}
+
 BoxCoords ScummEngine::getBoxCoordinates(int boxnum) {
+	const BoxCache &cache = getBoxCache();
+	if (boxnum >= 0 && boxnum < cache.getNumBoxes())
+		return cache.getCoords(boxnum);
+
+	// Let getBoxBaseAddr() deal with invalid box numbers
+	return readBoxCoordinates(boxnum);
+}
+
+BoxCoords ScummEngine::readBoxCoordinates(int boxnum) {
 	BoxCoords tmp, *box = &tmp;
 	Box *bp = getBoxBaseAddr(boxnum);
 	assert(bp);
@@ -719,9 +769,8 @@ int ScummEngine::getNextBox(byte from, byte to) {
 	boxm = getBoxMatrixBaseAddr();
 
 	if (_game.version == 0) {
-		// calculate shortest paths
-		byte *itineraryMatrix = (byte *)malloc(numOfBoxes * numOfBoxes);
-		calcItineraryMatrix(itineraryMatrix, numOfBoxes);
+		// The shortest paths are computed along with the box cache
+		const Common::Array<byte> &itineraryMatrix = getBoxCache().getItineraryMatrix();
 
 		dest = to;
 		do {
@@ -731,7 +780,6 @@ int ScummEngine::getNextBox(byte from, byte to) {
 		if (dest == Actor::kInvalidBox)
 			dest = -1;
 
-		free(itineraryMatrix);
 		return dest;
 	} else if (_game.version <= 2) {
 		// The v2 box matrix is a real matrix with numOfBoxes rows and columns.
@@ -780,11 +828,65 @@ int ScummEngine::getNextBox(byte from, byte to) {
 	return dest;
 }
 
+/**
+ * Computes the boxes an actor goes through to get from box 'from' to box
+ * 'to', as getNextBox() leads it from one box to the next. The path starts
+ * with the box after 'from' and ends with 'to'.
+ * Returns false if there is no connection.
+ */
+bool ScummEngine::getBoxPath(int from, int to, Common::Array<byte> &path) {
+	path.clear();
+	if (from == Actor::kInvalidBox) {
+		path.push_back(to);
+		return true;
+	}
+
+	// A path through more boxes than there are would go in circles, so a
+	// broken box matrix can't hang us
+	for (int box = from, left = getNumBoxes(); box != to; left--) {
+		if (left == 0)
+			return false;
+
+		box = getNextBox(box, to);
+		if (box < 0)
+			return false;
+		path.push_back(box);
+	}
+
+	return true;
+}
+
+bool Actor::findWalkPath(const Common::Point &dest, int destBox, Common::Array<Common::Point> &waypoints) {
+	Common::Array<byte> boxes;
+	Common::Point pos = _pos;
+	Common::Point foundPath;
+	int box = _walkbox;
+
+	waypoints.clear();
+	if (!_vm->getBoxPath(box, destBox, boxes))
+		return false;
+
+	// Follow the boxes like walkActor() does
+	for (uint i = 0; i < boxes.size() && box != kInvalidBox; i++) {
+		if (findPathTowards(box, boxes[i], destBox, pos, dest, foundPath))
+			break;
+		if (foundPath != pos) {
+			waypoints.push_back(foundPath);
+			pos = foundPath;
+		}
+		box = boxes[i];
+	}
+
+	waypoints.push_back(dest);
+	return true;
+}
+
 /*
  * Computes the next point actor a has to walk towards in a straight
- * line in order to get from box1 to box3 via box2.
+ * line in order to get from box1 to box3 via box2, when it is at curPos
+ * and walks to dest. Returns true if it can walk straight to dest.
  */
-bool Actor::findPathTowards(byte box1nr, byte box2nr, byte box3nr, Common::Point &foundPath) {
+bool Actor::findPathTowards(byte box1nr, byte box2nr, byte box3nr, const Common::Point &curPos, const Common::Point &dest, Common::Point &foundPath) {
 	assert(_vm->_game.version >= 3);
 	BoxCoords box1 = _vm->getBoxCoordinates(box1nr);
 	BoxCoords box2 = _vm->getBoxCoordinates(box2nr);
@@ -815,11 +917,11 @@ bool Actor::findPathTowards(byte box1nr, byte box2nr, byte box3nr, Common::Point
 					if (flag & 2)
 						SWAP(box2.ul.y, box2.ur.y);
 				} else {
-					pos = _pos.y;
+					pos = curPos.y;
 					if (box2nr == box3nr) {
-						int diffX = _walkdata.dest.x - _pos.x;
-						int diffY = _walkdata.dest.y - _pos.y;
-						int boxDiffX = box1.ul.x - _pos.x;
+						int diffX = dest.x - curPos.x;
+						int diffY = dest.y - curPos.y;
+						int boxDiffX = box1.ul.x - curPos.x;
 
 						if (diffX != 0) {
 							int t;
@@ -829,7 +931,7 @@ bool Actor::findPathTowards(byte box1nr, byte box2nr, byte box3nr, Common::Point
 							if (t == 0 && (diffY <= 0 || diffX <= 0)
 									&& (diffY >= 0 || diffX >= 0))
 								t = -1;
-							pos = _pos.y + t;
+							pos = curPos.y + t;
 						}
 					}
 
@@ -872,16 +974,16 @@ bool Actor::findPathTowards(byte box1nr, byte box2nr, byte box3nr, Common::Point
 				} else {
 
 					if (box2nr == box3nr) {
-						int diffX = _walkdata.dest.x - _pos.x;
-						int diffY = _walkdata.dest.y - _pos.y;
-						int boxDiffY = box1.ul.y - _pos.y;
+						int diffX = dest.x - curPos.x;
+						int diffY = dest.y - curPos.y;
+						int boxDiffY = box1.ul.y - curPos.y;
 
-						pos = _pos.x;
+						pos = curPos.x;
 						if (diffY != 0) {
 							pos += diffX * boxDiffY / diffY;
 						}
 					} else {
-						pos = _pos.x;
+						pos = curPos.x;
 					}
 
 					q = pos;
@@ -1193,11 +1295,10 @@ bool ScummEngine_v0::areBoxesNeighbors(int box1nr, int box2nr) {
 	return false;
 }
 
-void Actor_v3::findPathTowardsOld(byte box1, byte box2, byte finalBox, Common::Point &p2, Common::Point &p3) {
-	Common::Point gateA[2];
-	Common::Point gateB[2];
-
-	getGates(_vm->getBoxCoordinates(box1), _vm->getBoxCoordinates(box2), gateA, gateB);
+void Actor_v3::findPathTowardsOld(byte box1, byte box2, byte finalBox, const Common::Point &curPos, const Common::Point &dest, Common::Point &p2, Common::Point &p3) {
+	const BoxGate &gate = _vm->getBoxGate(box1, box2);
+	const Common::Point *gateA = gate.gateA;
+	const Common::Point *gateB = gate.gateB;
 
 	p2.x = 32000;
 	p3.x = 32000;
@@ -1208,20 +1309,100 @@ void Actor_v3::findPathTowardsOld(byte box1, byte box2, byte finalBox, Common::P
 		// 'maze' in the zeppelin (see bug #1032964).
 		if (_vm->_game.id != GID_INDY3 || _vm->getMaskFromBox(box1) == _vm->getMaskFromBox(box2)) {
 			// Is the actor (x,y) between both gates?
-			if (compareSlope(_pos, _walkdata.dest, gateA[0]) !=
-					compareSlope(_pos, _walkdata.dest, gateB[0]) &&
-					compareSlope(_pos, _walkdata.dest, gateA[1]) !=
-					compareSlope(_pos, _walkdata.dest, gateB[1])) {
+			if (compareSlope(curPos, dest, gateA[0]) !=
+					compareSlope(curPos, dest, gateB[0]) &&
+					compareSlope(curPos, dest, gateA[1]) !=
+					compareSlope(curPos, dest, gateB[1])) {
 				return;
 			}
 		}
 	}
 
-	p3 = closestPtOnLine(gateA[1], gateB[1], _pos);
+	p3 = closestPtOnLine(gateA[1], gateB[1], curPos);
+
+	if (compareSlope(curPos, p3, gateA[0]) == compareSlope(curPos, p3, gateB[0])) {
+		p2 = closestPtOnLine(gateA[0], gateB[0], curPos);
+	}
+}
+
+bool Actor_v3::findWalkPath(const Common::Point &dest, int destBox, Common::Array<Common::Point> &waypoints) {
+	Common::Array<byte> boxes;
+	Common::Point pos = _pos;
+	Common::Point p2, p3;
+	int box = _walkbox;
+
+	waypoints.clear();
+	if (!_vm->getBoxPath(box, destBox, boxes))
+		return false;
+
+	// Follow the boxes like walkActor() does
+	for (uint i = 0; i < boxes.size() && box != kInvalidBox; i++) {
+		// Can't walk through locked boxes
+		int flags = _vm->getBoxFlags(boxes[i]);
+		if ((flags & kBoxLocked) && !((flags & kBoxPlayerOnly) && !isPlayer()))
+			return false;
 
-	if (compareSlope(_pos, p3, gateA[0]) == compareSlope(_pos, p3, gateB[0])) {
-		p2 = closestPtOnLine(gateA[0], gateB[0], _pos);
+		findPathTowardsOld(box, boxes[i], destBox, pos, dest, p2, p3);
+		if (p2.x == 32000 && p3.x == 32000)
+			break;
+
+		if (p2.x != 32000 && p2 != pos) {
+			waypoints.push_back(p2);
+			pos = p2;
+		}
+		if (p3 != pos) {
+			waypoints.push_back(p3);
+			pos = p3;
+		}
+		box = boxes[i];
 	}
+
+	waypoints.push_back(dest);
+	return true;
+}
+
+bool Actor_v2::findWalkPath(const Common::Point &dest, int destBox, Common::Array<Common::Point> &waypoints) {
+	Common::Array<byte> boxes;
+	Common::Point pos = _pos;
+	Common::Point tmp, foundPath;
+	int box = _walkbox;
+
+	waypoints.clear();
+	if (!_vm->getBoxPath(box, destBox, boxes))
+		return false;
+
+	// Follow the boxes like walkActor() does, leaving out the direct paths
+	// through several boxes of the v0 games
+	for (uint i = 0; i < boxes.size() && box != kInvalidBox; i++) {
+		getClosestPtOnBox(_vm->getBoxCoordinates(boxes[i]), pos.x, pos.y, tmp.x, tmp.y);
+		getClosestPtOnBox(_vm->getBoxCoordinates(box), tmp.x, tmp.y, foundPath.x, foundPath.y);
+		if (foundPath != pos) {
+			waypoints.push_back(foundPath);
+			pos = foundPath;
+		}
+
+		// Can't walk through locked boxes
+		int flags = _vm->getBoxFlags(boxes[i]);
+		if ((flags & kBoxLocked) && !((flags & kBoxPlayerOnly) && !isPlayer()))
+			return false;
+
+		box = boxes[i];
+	}
+
+	waypoints.push_back(dest);
+	return true;
+}
+
+const BoxGate &ScummEngine::getBoxGate(int box1, int box2) {
+	BoxCache &cache = getBoxCache();
+	const BoxGate *gate = cache.findGate(box1, box2);
+	if (gate)
+		return *gate;
+
+	BoxGate newGate;
+	getGates(getBoxCoordinates(box1), getBoxCoordinates(box2), newGate.gateA, newGate.gateB);
+	cache.addGate(box1, box2, newGate);
+	return *cache.findGate(box1, box2);
 }
 
 /**
@@ -23,6 +23,8 @@
 #ifndef SCUMM_BOXES_H
 #define SCUMM_BOXES_H
 
+#include "common/array.h"
+#include "common/hashmap.h"
 #include "common/rect.h"
 
 namespace Scumm {
@@ -51,6 +53,69 @@ struct BoxCoords {			/* Box coordinates */
 
 int getClosestPtOnBox(const BoxCoords &box, int x, int y, int16& outX, int16& outY);
 
+struct BoxGate {			/* The corridor between two boxes, see getGates() */
+	Common::Point gateA[2];
+	Common::Point gateB[2];
+};
+
+/**
+ * Keeps what is derived from the walkboxes of the room: their coordinates
+ * and bounding boxes, a grid which lists the boxes overlapping each of its
+ * cells, so the boxes containing a point can be found without testing all
+ * of them, and the itineraries and gates between boxes. It is invalidated
+ * when the boxes or the box matrix change, and filled again when it is
+ * next used.
+ */
+class BoxCache {
+public:
+	enum {
+		GRID_CELL_SIZE = 32
+	};
+
+	BoxCache();
+
+	bool isValid() const { return _valid; }
+	void invalidate();
+
+	/** Sets the coordinates of all boxes, and builds the grid */
+	void setBoxes(const Common::Array<BoxCoords> &boxes);
+
+	int getNumBoxes() const { return _boxes.size(); }
+	const BoxCoords &getCoords(int box) const { return _boxes[box].coords; }
+
+	/**
+	 * Returns the boxes whose bounding boxes contain the point, in
+	 * ascending order.
+	 */
+	const byte *getBoxesAt(int x, int y, int &count) const;
+
+	/** Shortest paths between the boxes, used by the v0 games */
+	Common::Array<byte> &getItineraryMatrix() { return _itineraryMatrix; }
+
+	const BoxGate *findGate(int box1, int box2) const;
+	void addGate(int box1, int box2, const BoxGate &gate);
+
+private:
+	struct Entry {
+		BoxCoords coords;
+		int16 minX, minY;
+		int16 maxX, maxY;
+	};
+
+	bool _valid;
+	Common::Array<Entry> _boxes;
+
+	int _gridLeft, _gridTop;
+	int _gridWidth, _gridHeight;
+	Common::Array<uint32> _gridCells;	///< Index of the first box of each cell in _gridBoxes, and the end of the last one
+	Common::Array<byte> _gridBoxes;
+
+	Common::Array<byte> _itineraryMatrix;
+
+	typedef Common::HashMap<uint, BoxGate> GateMap;
+	GateMap _gates;
+};
+
 } // End of namespace Scumm
 
 #endif
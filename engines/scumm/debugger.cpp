@@ -29,10 +29,21 @@
 #include "scumm/actor.h"
 #include "scumm/boxes.h"
 #include "scumm/debugger.h"
+#ifdef ENABLE_HE
+#include "scumm/he/intern_he.h"
+#include "scumm/he/wiz_he.h"
+#endif
 #include "scumm/imuse/imuse.h"
+#ifdef ENABLE_SCUMM_7_8
+#include "scumm/imuse_digi/dimuse.h"
+#endif
 #include "scumm/object.h"
 #include "scumm/resource.h"
 #include "scumm/scumm.h"
+#ifdef ENABLE_SCUMM_7_8
+#include "scumm/scumm_v7.h"
+#include "scumm/smush/smush_player.h"
+#endif
 #include "scumm/sound.h"
 
 namespace Scumm {
@@ -71,6 +82,7 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	DCmd_Register("actors",    WRAP_METHOD(ScummDebugger, Cmd_PrintActor));
 	DCmd_Register("box",       WRAP_METHOD(ScummDebugger, Cmd_PrintBox));
 	DCmd_Register("matrix",    WRAP_METHOD(ScummDebugger, Cmd_PrintBoxMatrix));
+	DCmd_Register("walkpath",  WRAP_METHOD(ScummDebugger, Cmd_PrintWalkPath));
 	DCmd_Register("camera",    WRAP_METHOD(ScummDebugger, Cmd_Camera));
 	DCmd_Register("room",      WRAP_METHOD(ScummDebugger, Cmd_Room));
 	DCmd_Register("objects",   WRAP_METHOD(ScummDebugger, Cmd_PrintObjects));
@@ -97,6 +109,8 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 
 	DCmd_Register("imuse",     WRAP_METHOD(ScummDebugger, Cmd_IMuse));
 
+	DCmd_Register("stats",     WRAP_METHOD(ScummDebugger, Cmd_Stats));
+
 	DCmd_Register("resetcursors",    WRAP_METHOD(ScummDebugger, Cmd_ResetCursors));
 }
 
@@ -567,6 +581,38 @@ bool ScummDebugger::Cmd_PrintBox(int argc, const char **argv) {
 	return true;
 }
 
+bool ScummDebugger::Cmd_PrintWalkPath(int argc, const char **argv) {
+	if (argc != 4) {
+		DebugPrintf("Syntax: walkpath <actornum> <x> <y>\n");
+		return true;
+	}
+
+	int actnum = atoi(argv[1]);
+	if (actnum < 0 || actnum >= _vm->_numActors) {
+		DebugPrintf("Actor %d is out of range (range: 1 - %d)\n", actnum, _vm->_numActors);
+		return true;
+	}
+
+	Actor *a = _vm->_actors[actnum];
+	if (!a->isInCurrentRoom()) {
+		DebugPrintf("Actor %d is not in the current room\n", actnum);
+		return true;
+	}
+
+	AdjustBoxResult abr = a->adjustXYToBeInBox(atoi(argv[2]), atoi(argv[3]));
+	Common::Array<Common::Point> waypoints;
+	if (!a->findWalkPath(Common::Point(abr.x, abr.y), abr.box, waypoints)) {
+		DebugPrintf("Actor %d can't walk from box %d to box %d\n", actnum, a->_walkbox, abr.box);
+		return true;
+	}
+
+	DebugPrintf("Actor %d walks from (%d, %d) in box %d:\n", actnum, a->getPos().x, a->getPos().y, a->_walkbox);
+	for (uint i = 0; i < waypoints.size(); i++)
+		DebugPrintf("  (%d, %d)\n", waypoints[i].x, waypoints[i].y);
+	DebugPrintf("ending in box %d\n", abr.box);
+	return true;
+}
+
 bool ScummDebugger::Cmd_PrintBoxMatrix(int argc, const char **argv) {
 	byte *boxm = _vm->getBoxMatrixBaseAddr();
 	int num = _vm->getNumBoxes();
@@ -862,6 +908,73 @@ bool ScummDebugger::Cmd_Passcode(int argc, const char **argv) {
 	return false;
 }
 
+bool ScummDebugger::Cmd_Stats(int argc, const char **argv) {
+	StripCache &stripCache = _vm->_gdi->getStripCache();
+#ifdef ENABLE_HE
+	WizImageCache *wizCache = (_vm->_game.heversion >= 71) ? &((ScummEngine_v71he *)_vm)->_wiz->_imageCache : 0;
+#endif
+
+	if (argc > 1) {
+		if (argc == 2 && !strcmp(argv[1], "reset")) {
+			stripCache.resetStatistics();
+#ifdef ENABLE_HE
+			if (wizCache)
+				wizCache->resetStatistics();
+#endif
+#ifdef ENABLE_SCUMM_7_8
+			if (_vm->_imuseDigital)
+				_vm->_imuseDigital->resetBundleCacheStatistics();
+#endif
+		} else {
+			DebugPrintf("Usage: %s [reset]\n", argv[0]);
+		}
+		return true;
+	}
+
+	const StripCache::Statistics &stripStats = stripCache.getStatistics();
+	printCacheStats("Strip cache", stripCache.getMemory(), stripCache.getBudget(),
+	                stripStats.hits, stripStats.misses, stripStats.evictions);
+
+#ifdef ENABLE_HE
+	if (wizCache) {
+		const WizImageCache::Statistics &wizStats = wizCache->getStatistics();
+		printCacheStats("Wiz image cache", wizCache->getMemory(), wizCache->getBudget(),
+		                wizStats.hits, wizStats.misses, wizStats.evictions);
+	}
+#endif
+
+#ifdef ENABLE_SCUMM_7_8
+	if (_vm->_imuseDigital) {
+		BundleBlockCache::Statistics bundleStats;
+		uint32 memory, budget;
+		_vm->_imuseDigital->getBundleCacheStatistics(bundleStats, memory, budget);
+
+		printCacheStats("Bundle block cache", memory, budget,
+		                bundleStats.hits, bundleStats.misses, bundleStats.evictions);
+		const double seconds = MAX<uint32>(_vm->_system->getMillis() - bundleStats.startTime, 1) / 1000.0;
+		DebugPrintf("  %.1f hits/s, %.1f decompressions/s, %d blocks read ahead\n",
+		            bundleStats.hits / seconds, bundleStats.decompressions / seconds, bundleStats.readAheads);
+	}
+
+	if (_vm->_game.version >= 7 && ((ScummEngine_v7 *)_vm)->_splayer) {
+		const SmushPlayer::Statistics &smushStats = ((ScummEngine_v7 *)_vm)->_splayer->getStatistics();
+		DebugPrintf("Last SMUSH video: %d frames decoded, %d shown, %d dropped\n",
+		            smushStats.decoded, smushStats.shown, smushStats.dropped);
+		DebugPrintf("  %d decoded late, at most %d decoded ahead\n",
+		            smushStats.underruns, smushStats.maxQueued);
+	}
+#endif
+
+	return true;
+}
+
+void ScummDebugger::printCacheStats(const char *name, uint32 memory, uint32 budget, uint32 hits, uint32 misses, uint32 evictions) {
+	const uint32 lookups = hits + misses;
+	DebugPrintf("%s: %d KB of %d KB used\n", name, memory / 1024, budget / 1024);
+	DebugPrintf("  %d hits, %d misses (%d%% hit rate), %d evictions\n",
+	            hits, misses, lookups ? hits * 100 / lookups : 0, evictions);
+}
+
 bool ScummDebugger::Cmd_ResetCursors(int argc, const char **argv) {
 	_vm->resetCursors();
 	detach();
@@ -46,6 +46,7 @@ private:
 	bool Cmd_PrintActor(int argc, const char **argv);
 	bool Cmd_PrintBox(int argc, const char **argv);
 	bool Cmd_PrintBoxMatrix(int argc, const char **argv);
+	bool Cmd_PrintWalkPath(int argc, const char **argv);
 	bool Cmd_PrintObjects(int argc, const char **argv);
 	bool Cmd_Actor(int argc, const char **argv);
 	bool Cmd_Camera(int argc, const char **argv);
@@ -65,9 +66,11 @@ private:
 
 	bool Cmd_IMuse(int argc, const char **argv);
 
+	bool Cmd_Stats(int argc, const char **argv);
 	bool Cmd_ResetCursors(int argc, const char **argv);
 
 	void printBox(int box);
+	void printCacheStats(const char *name, uint32 memory, uint32 budget, uint32 hits, uint32 misses, uint32 evictions);
 	void drawBox(int box);
 };
 
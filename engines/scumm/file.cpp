@@ -184,6 +184,18 @@ uint32 ScummFile::read(void *dataPtr, uint32 dataSize) {
 	return realLen;
 }
 
+const byte *ScummFile::readInPlace(uint32 size) {
+	// Encrypted data must be decoded into a buffer by read()
+	if (_encbyte)
+		return 0;
+
+	// Do not hand out data beyond the end of the subfile
+	if (_subFileLen && pos() + (int32)size > _subFileLen)
+		return 0;
+
+	return File::readInPlace(size);
+}
+
 #pragma mark -
 #pragma mark --- ScummDiskImage ---
 #pragma mark -
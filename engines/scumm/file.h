@@ -74,6 +74,7 @@ public:
 	int32 size() const;
 	bool seek(int32 offs, int whence = SEEK_SET);
 	uint32 read(void *dataPtr, uint32 dataSize);
+	const byte *readInPlace(uint32 size);
 };
 
 class ScummDiskImage : public BaseScummFile {
@@ -118,6 +119,7 @@ public:
 	int32 size() const { return _stream->size(); }
 	bool seek(int32 offs, int whence = SEEK_SET) { return _stream->seek(offs, whence); }
 	uint32 read(void *dataPtr, uint32 dataSize);
+	const byte *readInPlace(uint32 size) { return _encbyte ? 0 : _stream->readInPlace(size); }
 };
 
 } // End of namespace Scumm
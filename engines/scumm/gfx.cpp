@@ -214,22 +214,29 @@ Gdi::Gdi(ScummEngine *vm) : _vm(vm) {
 	_zbufferDisabled = false;
 	_objectMode = false;
 	_distaff = false;
+
+	_cacheStrips = true;
 }
 
 Gdi::~Gdi() {
 }
 
 GdiHE::GdiHE(ScummEngine *vm) : Gdi(vm), _tmskPtr(0) {
+	// Transparency masks are combined with the z-plane masks which are
+	// already there, so they can't be cached
+	_cacheStrips = (vm->_game.heversion < 72);
 }
 
 
 GdiNES::GdiNES(ScummEngine *vm) : Gdi(vm) {
 	memset(&_NES, 0, sizeof(_NES));
+	_cacheStrips = false;
 }
 
 #ifdef USE_RGB_COLOR
 GdiPCEngine::GdiPCEngine(ScummEngine *vm) : Gdi(vm) {
 	memset(&_PCE, 0, sizeof(_PCE));
+	_cacheStrips = false;
 }
 
 GdiPCEngine::~GdiPCEngine() {
@@ -241,10 +248,12 @@ GdiPCEngine::~GdiPCEngine() {
 
 GdiV1::GdiV1(ScummEngine *vm) : Gdi(vm) {
 	memset(&_V1, 0, sizeof(_V1));
+	_cacheStrips = false;
 }
 
 GdiV2::GdiV2(ScummEngine *vm) : Gdi(vm) {
 	_roomStrips = 0;
+	_cacheStrips = false;
 }
 
 GdiV2::~GdiV2() {
@@ -274,6 +283,7 @@ void Gdi::init() {
 }
 
 void Gdi::roomChanged(byte *roomptr) {
+	_stripCache.invalidate();
 }
 
 void GdiNES::roomChanged(byte *roomptr) {
@@ -1008,7 +1018,7 @@ void ScummEngine::redrawBGStrip(int start, int num) {
 	else
 		room = getResourceAddress(rtRoom, _roomResource);
 
-	_gdi->drawBitmap(room + _IM00_offs, &_virtscr[kMainVirtScreen], s, 0, _roomWidth, _virtscr[kMainVirtScreen].h, s, num, 0);
+	_gdi->drawBitmap(room + _IM00_offs, &_virtscr[kMainVirtScreen], s, 0, _roomWidth, _virtscr[kMainVirtScreen].h, s, num, Gdi::dbRoomBackground);
 }
 
 void ScummEngine::restoreBackground(Common::Rect rect, byte backColor) {
@@ -1782,6 +1792,12 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 
 	numzbuf = getZPlanes(ptr, zplane_list, false);
 
+	// Strips of the room background are copied from the strip cache, if
+	// they have been decoded before
+	const bool useStripCache = _cacheStrips && (flag & dbRoomBackground) && y == 0;
+	if (useStripCache)
+		prepareStripCache(smap_ptr, vs, height, numzbuf);
+
 	if (y + height > vs->h) {
 		warning("Gdi::drawBitmap, strip drawn to %d below window bottom %d", y + height, vs->h);
 	}
@@ -1830,7 +1846,16 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 		else
 			dstPtr = (byte *)vs->pixels + y * vs->pitch + (x * 8 * vs->format.bytesPerPixel);
 
-		transpStrip = drawStrip(dstPtr, vs, x, y, width, height, stripnr, smap_ptr);
+		const byte *cachedStrip = useStripCache ? _stripCache.find(stripnr) : 0;
+		if (cachedStrip) {
+			drawCachedStrip(cachedStrip, dstPtr, vs, x, y, height, numzbuf, zplane_list);
+			transpStrip = false;
+		} else {
+			transpStrip = drawStrip(dstPtr, vs, x, y, width, height, stripnr, smap_ptr);
+		}
+
+		// Strips with transparent pixels depend on what was drawn before
+		const bool cacheable = useStripCache && !cachedStrip && !transpStrip;
 
 		// COMI and HE games only uses flag value
 		if (_vm->_game.version == 8 || _vm->_game.heversion >= 60)
@@ -1844,7 +1869,13 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 				clear8Col(frontBuf, vs->pitch, height, vs->format.bytesPerPixel);
 		}
 
-		decodeMask(x, y, width, height, stripnr, numzbuf, zplane_list, transpStrip, flag);
+		// Cached strips come with their masks
+		if (!cachedStrip) {
+			decodeMask(x, y, width, height, stripnr, numzbuf, zplane_list, transpStrip, flag);
+
+			if (cacheable)
+				storeCachedStrip(stripnr, dstPtr, vs, x, y, height, numzbuf, zplane_list);
+		}
 
 #if 0
 		// HACK: blit mask(s) onto normal screen. Useful to debug masking
@@ -1872,6 +1903,62 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 	}
 }
 
+/**
+ * Makes sure that the strip cache holds strips which were decoded from the
+ * given room image, with the given height and z-planes and the current room
+ * palette. Otherwise, it is emptied.
+ */
+void Gdi::prepareStripCache(const byte *smap_ptr, const VirtScreen *vs, int height, int numzbuf) {
+	if (_stripCache.validate(smap_ptr, height, numzbuf, _vm->_roomPalette))
+		return;
+
+	const int roomStrips = MAX(_vm->_roomWidth, (int)vs->w) / 8;
+	_stripCache.reset(roomStrips, 8 * height * vs->format.bytesPerPixel, MAX(numzbuf - 1, 0) * height);
+}
+
+/**
+ * Copies a freshly decoded strip of the room background, and the masks
+ * decodeMask() has produced for it, into the strip cache.
+ */
+void Gdi::storeCachedStrip(int stripnr, const byte *dstPtr, const VirtScreen *vs,
+	                int x, int y, int height, int numzbuf, const byte *zplane_list[9]) {
+	byte *data = _stripCache.insert(stripnr);
+	if (!data)
+		return;
+
+	blit(data, 8 * vs->format.bytesPerPixel, dstPtr, vs->pitch, 8, height, vs->format.bytesPerPixel);
+
+	byte *cachedMask = data + _stripCache.getPixelSize();
+	for (int i = 1; i < numzbuf; i++, cachedMask += height) {
+		if (!zplane_list[i])
+			continue;
+
+		const byte *mask_ptr = getMaskBuffer(x, y, i);
+		for (int h = 0; h < height; h++)
+			cachedMask[h] = mask_ptr[h * _numStrips];
+	}
+}
+
+/**
+ * Draws a strip of the room background from the strip cache, including its
+ * masks.
+ */
+void Gdi::drawCachedStrip(const byte *cachedStrip, byte *dstPtr, const VirtScreen *vs,
+	                int x, int y, int height, int numzbuf, const byte *zplane_list[9]) {
+	blit(dstPtr, vs->pitch, cachedStrip, 8 * vs->format.bytesPerPixel, 8, height, vs->format.bytesPerPixel);
+
+	const byte *cachedMask = cachedStrip + _stripCache.getPixelSize();
+	for (int i = 1; i < numzbuf; i++, cachedMask += height) {
+		// decodeMask() leaves these masks alone, too
+		if (!zplane_list[i])
+			continue;
+
+		byte *mask_ptr = getMaskBuffer(x, y, i);
+		for (int h = 0; h < height; h++)
+			mask_ptr[h * _numStrips] = cachedMask[h];
+	}
+}
+
 bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width, const int height,
 					int stripnr, const byte *smap_ptr) {
 	// Do some input verification and make sure the strip/strip offset
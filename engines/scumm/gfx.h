@@ -28,6 +28,8 @@
 
 #include "graphics/surface.h"
 
+#include "scumm/stripcache.h"
+
 namespace Scumm {
 
 class ScummEngine;
@@ -197,6 +199,14 @@ protected:
 	/** Flag which is true when an object is being rendered, false otherwise. */
 	bool _objectMode;
 
+	/**
+	 * Decoded strips of the room background. Only used by the generic strip
+	 * decoders; the subclasses for the oldest games and consoles have room
+	 * formats of their own, which are decoded once per room anyway.
+	 */
+	StripCache _stripCache;
+	bool _cacheStrips;
+
 public:
 	/** Flag which is true when loading objects or titles for distaff, in PCEngine version of Loom. */
 	bool _distaff;
@@ -244,6 +254,13 @@ protected:
 					const int x, const int y, const int width, const int height,
 	                int stripnr, int numstrip);
 
+	/* Strip cache */
+	void prepareStripCache(const byte *smap_ptr, const VirtScreen *vs, int height, int numzbuf);
+	void storeCachedStrip(int stripnr, const byte *dstPtr, const VirtScreen *vs,
+	                int x, int y, int height, int numzbuf, const byte *zplane_list[9]);
+	void drawCachedStrip(const byte *cachedStrip, byte *dstPtr, const VirtScreen *vs,
+	                int x, int y, int height, int numzbuf, const byte *zplane_list[9]);
+
 public:
 	Gdi(ScummEngine *vm);
 	virtual ~Gdi();
@@ -267,10 +284,13 @@ public:
 
 	void resetBackground(int top, int bottom, int strip);
 
+	StripCache &getStripCache() { return _stripCache; }
+
 	enum DrawBitmapFlags {
-		dbAllowMaskOr   = 1 << 0,
-		dbDrawMaskOnAll = 1 << 1,
-		dbObjectMode    = 2 << 2
+		dbAllowMaskOr    = 1 << 0,
+		dbDrawMaskOnAll  = 1 << 1,
+		dbObjectMode     = 2 << 2,
+		dbRoomBackground = 1 << 4
 	};
 };
 
@@ -194,6 +194,8 @@ protected:
 
 	virtual void redrawBGAreas();
 
+	virtual void resourceChanged(ResType type, ResId idx);
+
 	virtual void processActors();
 	void preProcessAuxQueue();
 	void postProcessAuxQueue();
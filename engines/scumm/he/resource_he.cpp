@@ -341,6 +341,14 @@ void ScummEngine_v72he::readMAXS(int blockSize) {
 		ScummEngine_v6::readMAXS(blockSize);
 }
 
+void ScummEngine_v71he::resourceChanged(ResType type, ResId idx) {
+	ScummEngine_v70he::resourceChanged(type, idx);
+
+	// Wiz images are modified in place, so decoded copies of them are stale
+	if (type == rtImage)
+		_wiz->_imageCache.invalidate(idx);
+}
+
 byte *ScummEngine_v72he::getStringAddress(ResId idx) {
 	byte *addr = getResourceAddress(rtString, idx);
 	if (addr == NULL)
@@ -413,6 +413,22 @@ void Wiz::copyWizImage(uint8 *dst, const uint8 *src, int dstPitch, int dstType,
 	}
 }
 
+void Wiz::copyDecodedWizImage(uint8 *dst, const DecodedWizImage &image, int dstPitch, int dstType, int dstw, int dsth, int srcx, int srcy, const Common::Rect *rect, int flags) {
+	Common::Rect r1, r2;
+	if (calcClipRects(dstw, dsth, srcx, srcy, image.width, image.height, rect, r1, r2)) {
+		dst += r2.top * dstPitch + r2.left * image.bitDepth;
+		if (flags & kWIFFlipY) {
+			const int dy = (srcy < 0) ? srcy : (image.height - r1.height());
+			r1.translate(0, dy);
+		}
+		if (flags & kWIFFlipX) {
+			const int dx = (srcx < 0) ? srcx : (image.width - r1.width());
+			r1.translate(dx, 0);
+		}
+		WizImageCache::drawImage(image, dst, dstPitch, dstType, r1, flags);
+	}
+}
+
 static void decodeWizMask(uint8 *&dst, uint8 &mask, int w, int maskType) {
 	switch (maskType) {
 	case 0:
@@ -448,6 +464,23 @@ static void decodeWizMask(uint8 *&dst, uint8 &mask, int w, int maskType) {
 }
 
 #ifdef USE_RGB_COLOR
+/**
+ * Writes a run of 16 bit pixels, either 'count' different ones (dataInc = 2)
+ * or the same one 'count' times (dataInc = 0). Deciding how to write them
+ * once per run instead of once per pixel lets plain copies use memcpy().
+ */
+template<int type>
+static void write16BitRun(uint8 *dstPtr, int dstInc, const uint8 *dataPtr, int dataInc, int count, int dstType, const uint8 *xmapPtr) {
+	if (type == kWizCopy) {
+		// The pixels of the image are little endian
+		copy16BitRun(dstPtr, dstInc, dataPtr, dataInc, count, false, dstType);
+		return;
+	}
+
+	for (; count--; dataPtr += dataInc, dstPtr += dstInc)
+		Wiz::write16BitColor<type>(dstPtr, dataPtr, dstType, xmapPtr);
+}
+
 void Wiz::copyMaskWizImage(uint8 *dst, const uint8 *src, const uint8 *mask, int dstPitch, int dstType, int dstw, int dsth, int srcx, int srcy, int srcw, int srch, const Common::Rect *rect, int flags, const uint8 *palPtr) {
 	Common::Rect srcRect, dstRect;
 	if (!calcClipRects(dstw, dsth, srcx, srcy, srcw, srch, rect, srcRect, dstRect)) {
@@ -506,12 +539,10 @@ void Wiz::copyMaskWizImage(uint8 *dst, const uint8 *src, const uint8 *mask, int
 					if (w < 0) {
 						code += w;
 					}
-					while (code--) {
-						if (*maskPtr != 5)
-							write16BitColor<kWizCopy>(dstPtr, dataPtr, dstType, palPtr);
-						dataPtr += 2;
-						dstPtr += dstInc;
-					}
+					if (*maskPtr != 5)
+						write16BitRun<kWizCopy>(dstPtr, dstInc, dataPtr, 2, code, dstType, palPtr);
+					dataPtr += code * 2;
+					dstPtr += dstInc * code;
 					maskPtr++;
 				} else {
 					code = (code >> 2) + 1;
@@ -770,10 +801,8 @@ void Wiz::decompress16BitWizImage(uint8 *dst, int dstPitch, int dstType, const u
 					if (w < 0) {
 						code += w;
 					}
-					while (code--) {
-						write16BitColor<type>(dstPtr, dataPtr, dstType, xmapPtr);
-						dstPtr += dstInc;
-					}
+					write16BitRun<type>(dstPtr, dstInc, dataPtr, 0, code, dstType, xmapPtr);
+					dstPtr += dstInc * code;
 					dataPtr += 2;
 				} else {
 					code = (code >> 2) + 1;
@@ -790,11 +819,9 @@ void Wiz::decompress16BitWizImage(uint8 *dst, int dstPitch, int dstType, const u
 					if (w < 0) {
 						code += w;
 					}
-					while (code--) {
-						write16BitColor<type>(dstPtr, dataPtr, dstType, xmapPtr);
-						dataPtr += 2;
-						dstPtr += dstInc;
-					}
+					write16BitRun<type>(dstPtr, dstInc, dataPtr, 2, code, dstType, xmapPtr);
+					dataPtr += code * 2;
+					dstPtr += dstInc * code;
 				}
 			}
 		}
@@ -833,6 +860,42 @@ void Wiz::write8BitColor(uint8 *dstPtr, const uint8 *dataPtr, int dstType, const
 	}
 }
 
+/**
+ * Writes a run of pixels, either 'count' different ones (dataInc = 1) or the
+ * same one 'count' times (dataInc = 0). Deciding how to write them once per
+ * run instead of once per pixel lets plain copies and fills of 8 bit pixels
+ * use memcpy() and memset().
+ */
+template<int type>
+static void write8BitRun(uint8 *dstPtr, int dstInc, const uint8 *dataPtr, int dataInc, int count, int dstType, const uint8 *palPtr, const uint8 *xmapPtr, uint8 bitDepth) {
+	if (type != kWizXMap && bitDepth == 1) {
+		if (dstInc == 1 && dataInc == 0) {
+			memset(dstPtr, (type == kWizRMap) ? palPtr[*dataPtr] : *dataPtr, count);
+		} else if (dstInc == 1 && type == kWizCopy) {
+			memcpy(dstPtr, dataPtr, count);
+		} else {
+			for (; count--; dataPtr += dataInc, dstPtr += dstInc)
+				*dstPtr = (type == kWizRMap) ? palPtr[*dataPtr] : *dataPtr;
+		}
+		return;
+	}
+
+	if (type != kWizXMap && bitDepth == 2) {
+		const bool nativeDst = (dstType == kDstScreen || dstType == kDstCursor);
+		for (; count--; dataPtr += dataInc, dstPtr += dstInc) {
+			const uint16 color = (type == kWizRMap) ? READ_LE_UINT16(palPtr + *dataPtr * 2) : *dataPtr;
+			if (nativeDst)
+				WRITE_UINT16(dstPtr, color);
+			else
+				WRITE_LE_UINT16(dstPtr, color);
+		}
+		return;
+	}
+
+	for (; count--; dataPtr += dataInc, dstPtr += dstInc)
+		Wiz::write8BitColor<type>(dstPtr, dataPtr, dstType, palPtr, xmapPtr, bitDepth);
+}
+
 template<int type>
 void Wiz::decompressWizImage(uint8 *dst, int dstPitch, int dstType, const uint8 *src, const Common::Rect &srcRect, int flags, const uint8 *palPtr, const uint8 *xmapPtr, uint8 bitDepth) {
 	const uint8 *dataPtr, *dataPtrNext;
@@ -904,10 +967,8 @@ void Wiz::decompressWizImage(uint8 *dst, int dstPitch, int dstType, const uint8
 					if (w < 0) {
 						code += w;
 					}
-					while (code--) {
-						write8BitColor<type>(dstPtr, dataPtr, dstType, palPtr, xmapPtr, bitDepth);
-						dstPtr += dstInc;
-					}
+					write8BitRun<type>(dstPtr, dstInc, dataPtr, 0, code, dstType, palPtr, xmapPtr, bitDepth);
+					dstPtr += dstInc * code;
 					dataPtr++;
 				} else {
 					code = (code >> 2) + 1;
@@ -924,11 +985,9 @@ void Wiz::decompressWizImage(uint8 *dst, int dstPitch, int dstType, const uint8
 					if (w < 0) {
 						code += w;
 					}
-					while (code--) {
-						write8BitColor<type>(dstPtr, dataPtr, dstType, palPtr, xmapPtr, bitDepth);
-						dataPtr++;
-						dstPtr += dstInc;
-					}
+					write8BitRun<type>(dstPtr, dstInc, dataPtr, 1, code, dstType, palPtr, xmapPtr, bitDepth);
+					dataPtr += code;
+					dstPtr += dstInc * code;
 				}
 			}
 		}
@@ -951,6 +1010,15 @@ void Wiz::decompressRawWizImage(uint8 *dst, int dstPitch, int dstType, const uin
 	if (w <= 0 || h <= 0) {
 		return;
 	}
+	if (type == kWizCopy && bitDepth == 1 && transColor == -1) {
+		// Nothing is transparent, so the lines can be copied as they are
+		while (h--) {
+			memcpy(dst, src, w);
+			src += srcPitch;
+			dst += dstPitch;
+		}
+		return;
+	}
 	while (h--) {
 		for (int i = 0; i < w; ++i) {
 			uint8 col = src[i];
@@ -1528,6 +1596,7 @@ uint8 *Wiz::drawWizImage(int resNum, int state, int maskNum, int maskState, int
 			getWizImageDim(dstResNum, 0, cw, ch);
 			dstPitch = cw * _vm->_bytesPerPixel;
 			dstType = kDstResource;
+			_imageCache.invalidate(dstResNum);
 		} else {
 			VirtScreen *pvs = &_vm->_virtscr[kMainVirtScreen];
 			if (flags & kWIFMarkBufferDirty) {
@@ -1582,7 +1651,13 @@ uint8 *Wiz::drawWizImage(int resNum, int state, int maskNum, int maskState, int
 			dstPitch /= _vm->_bytesPerPixel;
 			copyWizImageWithMask(dst, wizd, dstPitch, cw, ch, x1, y1, width, height, &rScreen, 0, 1);
 		} else {
-			copyWizImage(dst, wizd, dstPitch, dstType, cw, ch, x1, y1, width, height, &rScreen, flags, palPtr, xmapPtr, _vm->_bytesPerPixel);
+			// Shadows depend on what is drawn below them, so they can't be cached
+			const DecodedWizImage *image = xmapPtr ? NULL : _imageCache.getImage(resNum, state, wizd, width, height, palPtr, _vm->_bytesPerPixel);
+			if (image) {
+				copyDecodedWizImage(dst, *image, dstPitch, dstType, cw, ch, x1, y1, &rScreen, flags);
+			} else {
+				copyWizImage(dst, wizd, dstPitch, dstType, cw, ch, x1, y1, width, height, &rScreen, flags, palPtr, xmapPtr, _vm->_bytesPerPixel);
+			}
 		}
 		break;
 #ifdef USE_RGB_COLOR
@@ -1844,6 +1919,7 @@ void Wiz::drawWizPolygonTransform(int resNum, int state, Common::Point *wp, int
 		getWizImageDim(dstResNum, 0, dstw, dsth);
 		dstpitch = dstw * _vm->_bytesPerPixel;
 		dstType = kDstResource;
+		_imageCache.invalidate(dstResNum);
 	} else {
 		if (flags & kWIFMarkBufferDirty) {
 			dst = pvs->getPixels(0, 0);
@@ -24,6 +24,7 @@
 #define SCUMM_HE_WIZ_HE_H
 
 #include "common/rect.h"
+#include "scumm/he/wizcache_he.h"
 
 namespace Scumm {
 
@@ -158,6 +159,7 @@ public:
 	WizImage _images[NUM_IMAGES];
 	uint16 _imagesNum;
 	WizPolygon _polygons[NUM_POLYGONS];
+	WizImageCache _imageCache;
 
 	Wiz(ScummEngine_v71he *vm);
 
@@ -215,6 +217,7 @@ public:
 	static void copyAuxImage(uint8 *dst1, uint8 *dst2, const uint8 *src, int dstw, int dsth, int srcx, int srcy, int srcw, int srch, uint8 bitdepth);
 	static void copyWizImageWithMask(uint8 *dst, const uint8 *src, int dstPitch, int dstw, int dsth, int srcx, int srcy, int srcw, int srch, const Common::Rect *rect, int maskT, int maskP);
 	static void copyWizImage(uint8 *dst, const uint8 *src, int dstPitch, int dstType, int dstw, int dsth, int srcx, int srcy, int srcw, int srch, const Common::Rect *rect, int flags, const uint8 *palPtr, const uint8 *xmapPtr, uint8 bitdepth);
+	static void copyDecodedWizImage(uint8 *dst, const DecodedWizImage &image, int dstPitch, int dstType, int dstw, int dsth, int srcx, int srcy, const Common::Rect *rect, int flags);
 	static void copyRawWizImage(uint8 *dst, const uint8 *src, int dstPitch, int dstType, int dstw, int dsth, int srcx, int srcy, int srcw, int srch, const Common::Rect *rect, int flags, const uint8 *palPtr, int transColor, uint8 bitdepth);
 #ifdef USE_RGB_COLOR
 	static void copy16BitWizImage(uint8 *dst, const uint8 *src, int dstPitch, int dstType, int dstw, int dsth, int srcx, int srcy, int srcw, int srch, const Common::Rect *rect, int flags, const uint8 *xmapPtr);
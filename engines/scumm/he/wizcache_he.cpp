@@ -0,0 +1,270 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifdef ENABLE_HE
+
+#include "common/endian.h"
+#include "common/util.h"
+
+#include "scumm/he/wiz_he.h"
+#include "scumm/he/wizcache_he.h"
+
+namespace Scumm {
+
+void copy16BitRun(uint8 *dst, int dstInc, const uint8 *src, int srcInc, int count, bool srcNative, int dstType) {
+#ifdef SCUMM_LITTLE_ENDIAN
+	const bool swap = false;
+#else
+	const bool dstNative = (dstType == kDstScreen || dstType == kDstCursor);
+	const bool swap = (srcNative != dstNative);
+#endif
+
+	if (!swap && srcInc == 2 && dstInc == 2) {
+		memcpy(dst, src, count * 2);
+		return;
+	}
+
+	for (; count--; src += srcInc, dst += dstInc) {
+		const uint16 color = READ_UINT16(src);
+		WRITE_UINT16(dst, swap ? SWAP_BYTES_16(color) : color);
+	}
+}
+
+uint32 DecodedWizImage::getMemory() const {
+	return sizeof(DecodedWizImage) + palette.size() + pixels.size() + runs.size() * sizeof(Run) + lines.size() * sizeof(uint32);
+}
+
+WizImageCache::WizImageCache() : _memory(0), _budget(DEFAULT_BUDGET), _useCounter(0) {
+	resetStatistics();
+}
+
+WizImageCache::~WizImageCache() {
+	clear();
+}
+
+void WizImageCache::clear() {
+	for (ImageMap::iterator i = _images.begin(); i != _images.end(); ++i)
+		delete i->_value;
+	_images.clear();
+	_memory = 0;
+}
+
+void WizImageCache::invalidate(int resNum) {
+	for (ImageMap::iterator i = _images.begin(); i != _images.end(); ++i) {
+		if (i->_key.resNum == resNum)
+			remove(i);
+	}
+}
+
+void WizImageCache::remove(ImageMap::iterator i) {
+	_memory -= i->_value->getMemory();
+	delete i->_value;
+	_images.erase(i);
+}
+
+void WizImageCache::evictOldest() {
+	// Only a few hundred images are in use at a time, and images are only
+	// evicted once the budget is used up, so a linear search is good enough
+	ImageMap::iterator oldest = _images.end();
+	for (ImageMap::iterator i = _images.begin(); i != _images.end(); ++i) {
+		if (oldest == _images.end() || i->_value->lastUse < oldest->_value->lastUse)
+			oldest = i;
+	}
+
+	if (oldest != _images.end()) {
+		remove(oldest);
+		_stats.evictions++;
+	}
+}
+
+const DecodedWizImage *WizImageCache::getImage(int resNum, int state, const uint8 *data, int width, int height, const uint8 *palPtr, uint8 bitDepth) {
+	const uint32 paletteSize = palPtr ? 256 * bitDepth : 0;
+
+	Key key;
+	key.resNum = resNum;
+	key.state = state;
+	key.palPtr = palPtr;
+
+	ImageMap::iterator i = _images.find(key);
+	if (i != _images.end()) {
+		DecodedWizImage *image = i->_value;
+		if (image->data == data && image->width == width && image->height == height && image->bitDepth == bitDepth &&
+		    (!paletteSize || !memcmp(&image->palette[0], palPtr, paletteSize))) {
+			_stats.hits++;
+			image->lastUse = ++_useCounter;
+			return image;
+		}
+
+		// The resource was reloaded or the palette changed
+		remove(i);
+	}
+
+	_stats.misses++;
+
+	// Images which would take up a large part of the budget are not worth
+	// dropping all the others for
+	if (width <= 0 || height <= 0 || width > 0xFFFF || (uint32)(width * height * bitDepth) > _budget / 4)
+		return 0;
+
+	DecodedWizImage *image = new DecodedWizImage();
+	image->resNum = resNum;
+	image->state = state;
+	image->data = data;
+	image->width = width;
+	image->height = height;
+	image->bitDepth = bitDepth;
+	if (paletteSize) {
+		image->palette.resize(paletteSize);
+		memcpy(&image->palette[0], palPtr, paletteSize);
+	}
+	decodeImage(*image, data, palPtr);
+	image->lastUse = ++_useCounter;
+
+	const uint32 memory = image->getMemory();
+	while (!_images.empty() && _memory + memory > _budget)
+		evictOldest();
+
+	_images[key] = image;
+	_memory += memory;
+	return image;
+}
+
+void WizImageCache::decodeImage(DecodedWizImage &image, const uint8 *src, const uint8 *palPtr) {
+	const int width = image.width;
+	const int bitDepth = image.bitDepth;
+
+	image.pixels.resize(width * image.height * bitDepth);
+	image.runs.clear();
+	image.lines.resize(image.height + 1);
+
+	const uint8 *dataPtr = src;
+	for (int y = 0; y < image.height; y++) {
+		image.lines[y] = image.runs.size();
+
+		const uint16 lineSize = READ_LE_UINT16(dataPtr); dataPtr += 2;
+		const uint8 *dataPtrNext = dataPtr + lineSize;
+		uint8 *line = &image.pixels[y * width * bitDepth];
+
+		int x = 0;
+		while (lineSize != 0 && x < width) {
+			const uint8 code = *dataPtr++;
+			if (code & 1) {
+				x += code >> 1;
+				continue;
+			}
+
+			const int length = (code >> 2) + 1;
+			const int count = MIN(length, width - x);
+			for (int i = 0; i < count; i++) {
+				const uint8 index = (code & 2) ? *dataPtr : dataPtr[i];
+				if (bitDepth == 2) {
+					WRITE_UINT16(line + (x + i) * 2, palPtr ? READ_LE_UINT16(palPtr + index * 2) : index);
+				} else {
+					line[x + i] = palPtr ? palPtr[index] : index;
+				}
+			}
+			dataPtr += (code & 2) ? 1 : length;
+
+			// Repeated and literal runs often follow each other, and can be
+			// copied in one go
+			if (image.runs.size() > image.lines[y] && image.runs.back().x + image.runs.back().length == x) {
+				image.runs.back().length += count;
+			} else {
+				DecodedWizImage::Run run;
+				run.x = x;
+				run.length = count;
+				image.runs.push_back(run);
+			}
+			x += count;
+		}
+
+		dataPtr = dataPtrNext;
+	}
+
+	image.lines[image.height] = image.runs.size();
+}
+
+void WizImageCache::drawImage(const DecodedWizImage &image, uint8 *dst, int dstPitch, int dstType, const Common::Rect &srcRect, int flags) {
+	const int bitDepth = image.bitDepth;
+	const int h = srcRect.height();
+	const int w = srcRect.width();
+	if (h <= 0 || w <= 0)
+		return;
+
+	if (flags & kWIFFlipY) {
+		dst += (h - 1) * dstPitch;
+		dstPitch = -dstPitch;
+	}
+	const bool flipX = (flags & kWIFFlipX) != 0;
+	if (flipX)
+		dst += (w - 1) * bitDepth;
+
+	for (int y = srcRect.top; y < srcRect.bottom; y++, dst += dstPitch) {
+		const uint8 *line = &image.pixels[y * image.width * bitDepth];
+
+		for (uint i = image.lines[y]; i < image.lines[y + 1]; i++) {
+			const DecodedWizImage::Run &run = image.runs[i];
+			if (run.x >= srcRect.right)
+				break;
+
+			const int left = MAX<int>(run.x, srcRect.left);
+			const int right = MIN<int>(run.x + run.length, srcRect.right);
+			if (left >= right)
+				continue;
+
+			const uint8 *src = line + left * bitDepth;
+			int count = right - left;
+
+			if (!flipX) {
+				uint8 *dstPtr = dst + (left - srcRect.left) * bitDepth;
+				if (bitDepth == 1)
+					memcpy(dstPtr, src, count);
+				else
+					copy16BitRun(dstPtr, 2, src, 2, count, true, dstType);
+			} else {
+				uint8 *dstPtr = dst - (left - srcRect.left) * bitDepth;
+				if (bitDepth == 1) {
+					while (count--)
+						*dstPtr-- = *src++;
+				} else {
+					copy16BitRun(dstPtr, -2, src, 2, count, true, dstType);
+				}
+			}
+		}
+	}
+}
+
+void WizImageCache::setBudget(uint32 bytes) {
+	_budget = bytes;
+	while (_memory > _budget)
+		evictOldest();
+}
+
+void WizImageCache::resetStatistics() {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+}
+
+} // End of namespace Scumm
+
+#endif // ENABLE_HE
@@ -0,0 +1,154 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if !defined(SCUMM_HE_WIZCACHE_HE_H) && defined(ENABLE_HE)
+#define SCUMM_HE_WIZCACHE_HE_H
+
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/rect.h"
+
+namespace Scumm {
+
+/**
+ * A state of a compressed (type 1) Wiz image, decoded ahead of time. The
+ * pixels are already mapped through the palette, and the opaque parts of
+ * each line are kept as a list of runs, so drawing the image only needs to
+ * copy these runs.
+ */
+struct DecodedWizImage {
+	struct Run {
+		uint16 x;
+		uint16 length;
+	};
+
+	int resNum;
+	int state;
+	const uint8 *data;				///< WIZD block the image was decoded from
+	int width;
+	int height;
+	uint8 bitDepth;
+	Common::Array<uint8> palette;	///< Copy of the palette used for decoding, empty if none
+	Common::Array<uint8> pixels;	///< All pixels, in native byte order
+	Common::Array<Run> runs;		///< The opaque runs, line by line
+	Common::Array<uint32> lines;	///< Index of the first run of each line, and the end of the last one
+	uint32 lastUse;
+
+	uint32 getMemory() const;
+};
+
+/**
+ * Copies a run of 16 bit pixels to a surface of the given type (kDstScreen
+ * etc.), converting the byte order where needed. The screen and cursors use
+ * the native byte order, all other surfaces are little endian.
+ * @param dstInc	2, or -2 to write from right to left
+ * @param srcInc	2 to copy 'count' different pixels, or 0 to repeat one
+ * @param srcNative	whether the source pixels are in native byte order rather
+ *					than little endian
+ */
+void copy16BitRun(uint8 *dst, int dstInc, const uint8 *src, int srcInc, int count, bool srcNative, int dstType);
+
+/**
+ * Keeps decoded Wiz images, keyed on the image, its state and the palette
+ * they are drawn with. HE games draw the same sprites with the same palette
+ * over and over, so decoding the RLE data and remapping the colors for each
+ * frame is wasted work. When the cache would grow beyond its budget, the
+ * images which were used least recently are dropped.
+ */
+class WizImageCache {
+public:
+	enum {
+		DEFAULT_BUDGET = 2 * 1024 * 1024
+	};
+
+	WizImageCache();
+	~WizImageCache();
+
+	void clear();
+
+	/** Drops all states of an image, e.g. because it was modified or unloaded */
+	void invalidate(int resNum);
+
+	/**
+	 * Looks up a state of an image, decoding it if necessary. The image is
+	 * decoded again if its data or the contents of the palette changed.
+	 * @param data		the WIZD block of the state
+	 * @param palPtr	the palette to map the pixels through, or NULL
+	 * @return the decoded image, or NULL if it is too large to be cached
+	 */
+	const DecodedWizImage *getImage(int resNum, int state, const uint8 *data, int width, int height, const uint8 *palPtr, uint8 bitDepth);
+
+	/** Decodes the RLE data of a Wiz image, as drawn by Wiz::decompressWizImage() */
+	static void decodeImage(DecodedWizImage &image, const uint8 *src, const uint8 *palPtr);
+
+	/**
+	 * Draws a decoded image. The arguments are the same as those of
+	 * Wiz::decompressWizImage(), except that there is no shadow.
+	 */
+	static void drawImage(const DecodedWizImage &image, uint8 *dst, int dstPitch, int dstType, const Common::Rect &srcRect, int flags);
+
+	void setBudget(uint32 bytes);
+	uint32 getBudget() const { return _budget; }
+	uint32 getMemory() const { return _memory; }
+
+	struct Statistics {
+		uint32 hits;		///< Images which were drawn from the cache
+		uint32 misses;		///< Images which had to be decoded
+		uint32 evictions;	///< Images which were dropped to stay within the budget
+	};
+
+	const Statistics &getStatistics() const { return _stats; }
+	void resetStatistics();
+
+private:
+	struct Key {
+		int resNum;
+		int state;
+		const uint8 *palPtr;
+
+		bool operator==(const Key &key) const {
+			return resNum == key.resNum && state == key.state && palPtr == key.palPtr;
+		}
+	};
+
+	struct KeyHash {
+		// The palettes are few, so they are left out of the hash
+		uint operator()(const Key &key) const {
+			return (uint)key.resNum * 31 + (uint)key.state;
+		}
+	};
+
+	typedef Common::HashMap<Key, DecodedWizImage *, KeyHash> ImageMap;
+
+	void remove(ImageMap::iterator i);
+	void evictOldest();
+
+	ImageMap _images;
+	uint32 _memory;
+	uint32 _budget;
+	uint32 _useCounter;
+	Statistics _stats;
+};
+
+} // End of namespace Scumm
+
+#endif
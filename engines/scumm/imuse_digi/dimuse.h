@@ -158,6 +158,16 @@ public:
 	int32 getCurVoiceLipSyncHeight();
 	int32 getCurMusicLipSyncWidth(int syncId);
 	int32 getCurMusicLipSyncHeight(int syncId);
+
+	/**
+	 * Decompresses the bundle blocks which the playing tracks are going to
+	 * read next, so the callback does not have to. Called once per frame
+	 * from the engine loop.
+	 */
+	void readAhead();
+
+	void getBundleCacheStatistics(BundleBlockCache::Statistics &stats, uint32 &memory, uint32 &budget);
+	void resetBundleCacheStatistics();
 };
 
 } // End of namespace Scumm
@@ -21,6 +21,7 @@
 
 
 #include "common/scummsys.h"
+#include "common/system.h"
 #include "scumm/scumm.h"
 #include "scumm/util.h"
 #include "scumm/file.h"
@@ -138,8 +139,106 @@ int BundleDirCache::matchFile(const char *filename) {
 	}
 }
 
-BundleMgr::BundleMgr(BundleDirCache *cache) {
+BundleBlockCache::BundleBlockCache() : _memory(0), _budget(DEFAULT_BUDGET), _useCounter(0) {
+	resetStatistics();
+}
+
+BundleBlockCache::~BundleBlockCache() {
+	clear();
+}
+
+void BundleBlockCache::clear() {
+	for (BlockMap::iterator i = _blocks.begin(); i != _blocks.end(); ++i)
+		free(i->_value.data);
+	_blocks.clear();
+	_memory = 0;
+}
+
+const byte *BundleBlockCache::find(int bundle, int32 index, int block, int32 &size) {
+	Key key;
+	key.bundle = bundle;
+	key.index = index;
+	key.block = block;
+
+	BlockMap::iterator i = _blocks.find(key);
+	if (i == _blocks.end()) {
+		_stats.misses++;
+		return NULL;
+	}
+
+	_stats.hits++;
+	i->_value.lastUse = ++_useCounter;
+	size = i->_value.size;
+	return i->_value.data;
+}
+
+bool BundleBlockCache::contains(int bundle, int32 index, int block) const {
+	Key key;
+	key.bundle = bundle;
+	key.index = index;
+	key.block = block;
+
+	return _blocks.contains(key);
+}
+
+void BundleBlockCache::insert(int bundle, int32 index, int block, const byte *data, int32 size) {
+	assert(size >= 0 && size <= BLOCK_SIZE);
+	if (size > (int32)_budget || contains(bundle, index, block))
+		return;
+
+	while (!_blocks.empty() && _memory + size > _budget)
+		evictOldest();
+
+	Key key;
+	key.bundle = bundle;
+	key.index = index;
+	key.block = block;
+
+	Block &entry = _blocks[key];
+	entry.data = (byte *)malloc(size);
+	assert(entry.data);
+	memcpy(entry.data, data, size);
+	entry.size = size;
+	entry.lastUse = ++_useCounter;
+	_memory += size;
+}
+
+void BundleBlockCache::evictOldest() {
+	// With the default budget there are only about a hundred blocks, and
+	// blocks are only evicted once the budget is used up, so a linear search
+	// is good enough
+	BlockMap::iterator oldest = _blocks.end();
+	for (BlockMap::iterator i = _blocks.begin(); i != _blocks.end(); ++i) {
+		if (oldest == _blocks.end() || i->_value.lastUse < oldest->_value.lastUse)
+			oldest = i;
+	}
+
+	if (oldest != _blocks.end()) {
+		_memory -= oldest->_value.size;
+		free(oldest->_value.data);
+		_blocks.erase(oldest);
+		_stats.evictions++;
+	}
+}
+
+void BundleBlockCache::setBudget(uint32 bytes) {
+	_budget = bytes;
+	while (_memory > _budget)
+		evictOldest();
+}
+
+void BundleBlockCache::resetStatistics() {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.decompressions = 0;
+	_stats.readAheads = 0;
+	_stats.evictions = 0;
+	_stats.startTime = g_system->getMillis();
+}
+
+BundleMgr::BundleMgr(BundleDirCache *cache, BundleBlockCache *blockCache) {
 	_cache = cache;
+	_blockCache = blockCache;
 	_bundleTable = NULL;
 	_compTable = NULL;
 	_numFiles = 0;
@@ -191,9 +290,11 @@ bool BundleMgr::open(const char *filename, bool &compressed, bool errorFlag) {
 	_bundleTable = _cache->getTable(slot);
 	_indexTable = _cache->getIndexTable(slot);
 	assert(_bundleTable);
+	_fileBundleId = slot;
 	_compTableLoaded = false;
 	_outputSize = 0;
 	_lastBlock = -1;
+	_nextBlock = -1;
 
 	return true;
 }
@@ -206,6 +307,7 @@ void BundleMgr::close() {
 		_numCompItems = 0;
 		_compTableLoaded = false;
 		_lastBlock = -1;
+		_nextBlock = -1;
 		_outputSize = 0;
 		_curSampleId = -1;
 		free(_compTable);
@@ -245,6 +347,55 @@ bool BundleMgr::loadCompTable(int32 index) {
 	return true;
 }
 
+void BundleMgr::decompressBlock(int32 index, int block) {
+	int32 size;
+	const byte *data = _blockCache->find(_fileBundleId, index, block, size);
+	if (data) {
+		memcpy(_compOutputBuff, data, size);
+		_outputSize = size;
+		_lastBlock = block;
+		return;
+	}
+
+	// CMI hack: one more zero byte at the end of input buffer
+	_compInputBuff[_compTable[block].size] = 0;
+	_file->seek(_bundleTable[index].offset + _compTable[block].offset, SEEK_SET);
+	_file->read(_compInputBuff, _compTable[block].size);
+	_outputSize = BundleCodecs::decompressCodec(_compTable[block].codec, _compInputBuff, _compOutputBuff, _compTable[block].size);
+	if (_outputSize > 0x2000) {
+		error("_outputSize: %d", _outputSize);
+	}
+	_lastBlock = block;
+
+	_blockCache->getStatistics().decompressions++;
+	_blockCache->insert(_fileBundleId, index, block, _compOutputBuff, _outputSize);
+}
+
+void BundleMgr::readAhead() {
+	if (!_file->isOpen() || !_compTableLoaded || _nextBlock < 0 || _nextBlock >= _numCompItems)
+		return;
+
+	// Without room in the cache, the block would be decompressed twice
+	if (_blockCache->getBudget() < BundleBlockCache::BLOCK_SIZE ||
+	    _nextBlock == _lastBlock || _blockCache->contains(_fileBundleId, _curSampleId, _nextBlock))
+		return;
+
+	// Decompress into a buffer of our own, so _lastBlock stays valid
+	byte output[BundleBlockCache::BLOCK_SIZE];
+	_compInputBuff[_compTable[_nextBlock].size] = 0;
+	_file->seek(_bundleTable[_curSampleId].offset + _compTable[_nextBlock].offset, SEEK_SET);
+	_file->read(_compInputBuff, _compTable[_nextBlock].size);
+	const int32 outputSize = BundleCodecs::decompressCodec(_compTable[_nextBlock].codec, _compInputBuff, output, _compTable[_nextBlock].size);
+	if (outputSize > 0x2000) {
+		error("outputSize: %d", outputSize);
+	}
+
+	BundleBlockCache::Statistics &stats = _blockCache->getStatistics();
+	stats.decompressions++;
+	stats.readAheads++;
+	_blockCache->insert(_fileBundleId, _curSampleId, _nextBlock, output, outputSize);
+}
+
 int32 BundleMgr::decompressSampleByCurIndex(int32 offset, int32 size, byte **compFinal, int headerSize, bool headerOutside) {
 	return decompressSampleByIndex(_curSampleId, offset, size, compFinal, headerSize, headerOutside);
 }
@@ -286,17 +437,9 @@ int32 BundleMgr::decompressSampleByIndex(int32 index, int32 offset, int32 size,
 	skip = (offset + headerSize) % 0x2000;
 
 	for (i = firstBlock; i <= lastBlock; i++) {
-		if (_lastBlock != i) {
-			// CMI hack: one more zero byte at the end of input buffer
-			_compInputBuff[_compTable[i].size] = 0;
-			_file->seek(_bundleTable[index].offset + _compTable[i].offset, SEEK_SET);
-			_file->read(_compInputBuff, _compTable[i].size);
-			_outputSize = BundleCodecs::decompressCodec(_compTable[i].codec, _compInputBuff, _compOutputBuff, _compTable[i].size);
-			if (_outputSize > 0x2000) {
-				error("_outputSize: %d", _outputSize);
-			}
-			_lastBlock = i;
-		}
+		if (_lastBlock != i)
+			decompressBlock(index, i);
+		_nextBlock = i + 1;
 
 		outputSize = _outputSize;
 
@@ -24,6 +24,7 @@
 
 #include "common/scummsys.h"
 #include "common/file.h"
+#include "common/hashmap.h"
 
 namespace Scumm {
 
@@ -63,6 +64,91 @@ public:
 	bool isSndDataExtComp(int slot);
 };
 
+/**
+ * Keeps decompressed blocks of compressed bundles. It is shared by all the
+ * sounds which are open, so tracks which play the same music, e.g. while
+ * crossfading, don't decompress the same blocks again. When the cache would
+ * grow beyond its budget, the blocks which were used least recently are
+ * dropped.
+ *
+ * Like the rest of the sound manager, it is only used with the iMUSE mutex
+ * held.
+ */
+class BundleBlockCache {
+public:
+	enum {
+		BLOCK_SIZE = 0x2000,
+		DEFAULT_BUDGET = 1024 * 1024
+	};
+
+	BundleBlockCache();
+	~BundleBlockCache();
+
+	void clear();
+
+	/**
+	 * Looks up a block of a sound.
+	 * @param bundle	the slot of the bundle in the BundleDirCache
+	 * @return the decompressed block, or NULL if it is not cached. It is valid
+	 *         until the next block is inserted.
+	 */
+	const byte *find(int bundle, int32 index, int block, int32 &size);
+
+	/** Adds a decompressed block of a sound, of at most BLOCK_SIZE bytes */
+	void insert(int bundle, int32 index, int block, const byte *data, int32 size);
+
+	bool contains(int bundle, int32 index, int block) const;
+
+	void setBudget(uint32 bytes);
+	uint32 getBudget() const { return _budget; }
+	uint32 getMemory() const { return _memory; }
+
+	struct Statistics {
+		uint32 hits;			///< Blocks which were found in the cache
+		uint32 misses;			///< Blocks which were not found in the cache
+		uint32 decompressions;	///< Blocks which were decompressed, on a miss or ahead of time
+		uint32 readAheads;		///< Blocks which were decompressed before they were needed
+		uint32 evictions;		///< Blocks which were dropped to stay within the budget
+		uint32 startTime;		///< Time in ms when the statistics were reset
+	};
+
+	Statistics &getStatistics() { return _stats; }
+	void resetStatistics();
+
+private:
+	struct Key {
+		int bundle;
+		int32 index;
+		int block;
+
+		bool operator==(const Key &key) const {
+			return bundle == key.bundle && index == key.index && block == key.block;
+		}
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const {
+			return ((uint)key.bundle * 1021 + (uint)key.index) * 4099 + (uint)key.block;
+		}
+	};
+
+	struct Block {
+		byte *data;
+		int32 size;
+		uint32 lastUse;
+	};
+
+	typedef Common::HashMap<Key, Block, KeyHash> BlockMap;
+
+	void evictOldest();
+
+	BlockMap _blocks;
+	uint32 _memory;
+	uint32 _budget;
+	uint32 _useCounter;
+	Statistics _stats;
+};
+
 class BundleMgr {
 
 private:
@@ -74,6 +160,7 @@ private:
 	};
 
 	BundleDirCache *_cache;
+	BundleBlockCache *_blockCache;
 	BundleDirCache::AudioTable *_bundleTable;
 	BundleDirCache::IndexNode *_indexTable;
 	CompTable *_compTable;
@@ -88,12 +175,14 @@ private:
 	byte *_compInputBuff;
 	int _outputSize;
 	int _lastBlock;
+	int _nextBlock;
 
 	bool loadCompTable(int32 index);
+	void decompressBlock(int32 index, int block);
 
 public:
 
-	BundleMgr(BundleDirCache *_cache);
+	BundleMgr(BundleDirCache *_cache, BundleBlockCache *blockCache);
 	~BundleMgr();
 
 	bool open(const char *filename, bool &compressed, bool errorFlag = false);
@@ -102,6 +191,13 @@ public:
 	int32 decompressSampleByName(const char *name, int32 offset, int32 size, byte **compFinal, bool headerOutside);
 	int32 decompressSampleByIndex(int32 index, int32 offset, int32 size, byte **compFinal, int header_size, bool headerOutside);
 	int32 decompressSampleByCurIndex(int32 offset, int32 size, byte **compFinal, int headerSize, bool headerOutside);
+
+	/**
+	 * Decompresses the block following the last one read into the block
+	 * cache, unless it is cached already. This is meant to be called from
+	 * the engine thread, so the iMUSE callback finds the block in the cache.
+	 */
+	void readAhead();
 };
 
 } // End of namespace Scumm
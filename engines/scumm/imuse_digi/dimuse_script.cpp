@@ -433,4 +433,27 @@ void IMuseDigital::pause(bool p) {
 	_pause = p;
 }
 
+void IMuseDigital::readAhead() {
+	Common::StackLock lock(_mutex, "IMuseDigital::readAhead()");
+
+	for (int l = 0; l < MAX_DIGITAL_TRACKS + MAX_DIGITAL_FADETRACKS; l++) {
+		Track *track = _track[l];
+		if (track->used && track->stream && track->soundDesc && !track->souStreamUsed)
+			_sound->readAhead(track->soundDesc);
+	}
+}
+
+void IMuseDigital::getBundleCacheStatistics(BundleBlockCache::Statistics &stats, uint32 &memory, uint32 &budget) {
+	Common::StackLock lock(_mutex, "IMuseDigital::getBundleCacheStatistics()");
+	BundleBlockCache &cache = _sound->getBundleBlockCache();
+	stats = cache.getStatistics();
+	memory = cache.getMemory();
+	budget = cache.getBudget();
+}
+
+void IMuseDigital::resetBundleCacheStatistics() {
+	Common::StackLock lock(_mutex, "IMuseDigital::resetBundleCacheStatistics()");
+	_sound->getBundleBlockCache().resetStatistics();
+}
+
 } // End of namespace Scumm
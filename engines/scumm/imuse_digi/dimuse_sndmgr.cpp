@@ -46,6 +46,8 @@ ImuseDigiSndMgr::ImuseDigiSndMgr(ScummEngine *scumm) {
 	_disk = 0;
 	_cacheBundleDir = new BundleDirCache();
 	assert(_cacheBundleDir);
+	_cacheBundleBlocks = new BundleBlockCache();
+	assert(_cacheBundleBlocks);
 	BundleCodecs::initializeImcTables();
 }
 
@@ -55,6 +57,7 @@ ImuseDigiSndMgr::~ImuseDigiSndMgr() {
 	}
 
 	delete _cacheBundleDir;
+	delete _cacheBundleBlocks;
 	BundleCodecs::releaseImcTables();
 }
 
@@ -320,7 +323,7 @@ ImuseDigiSndMgr::SoundDesc *ImuseDigiSndMgr::allocSlot() {
 bool ImuseDigiSndMgr::openMusicBundle(SoundDesc *sound, int &disk) {
 	bool result = false;
 
-	sound->bundle = new BundleMgr(_cacheBundleDir);
+	sound->bundle = new BundleMgr(_cacheBundleDir, _cacheBundleBlocks);
 	assert(sound->bundle);
 	if (_vm->_game.id == GID_CMI) {
 		if (_vm->_game.features & GF_DEMO) {
@@ -355,7 +358,7 @@ bool ImuseDigiSndMgr::openMusicBundle(SoundDesc *sound, int &disk) {
 bool ImuseDigiSndMgr::openVoiceBundle(SoundDesc *sound, int &disk) {
 	bool result = false;
 
-	sound->bundle = new BundleMgr(_cacheBundleDir);
+	sound->bundle = new BundleMgr(_cacheBundleDir, _cacheBundleBlocks);
 	assert(sound->bundle);
 	if (_vm->_game.id == GID_CMI) {
 		if (_vm->_game.features & GF_DEMO) {
@@ -731,4 +734,11 @@ int32 ImuseDigiSndMgr::getDataFromRegion(SoundDesc *soundDesc, int region, byte
 	return size;
 }
 
+void ImuseDigiSndMgr::readAhead(SoundDesc *soundDesc) {
+	assert(checkForProperHandle(soundDesc));
+
+	if ((soundDesc->bundle) && (!soundDesc->compressed))
+		soundDesc->bundle->readAhead();
+}
+
 } // End of namespace Scumm
@@ -115,6 +115,7 @@ private:
 	ScummEngine *_vm;
 	byte _disk;
 	BundleDirCache *_cacheBundleDir;
+	BundleBlockCache *_cacheBundleBlocks;
 
 	bool openMusicBundle(SoundDesc *sound, int &disk);
 	bool openVoiceBundle(SoundDesc *sound, int &disk);
@@ -146,6 +147,11 @@ public:
 	void getSyncSizeAndPtrById(SoundDesc *soundDesc, int number, int32 &sync_size, byte **sync_ptr);
 
 	int32 getDataFromRegion(SoundDesc *soundDesc, int region, byte **buf, int32 offset, int32 size);
+
+	/** Decompresses the bundle block which a sound is going to read next, if it isn't cached yet */
+	void readAhead(SoundDesc *soundDesc);
+
+	BundleBlockCache &getBundleBlockCache() { return *_cacheBundleBlocks; }
 };
 
 } // End of namespace Scumm
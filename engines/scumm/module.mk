@@ -5,6 +5,7 @@ MODULE_OBJS := \
 	akos.o \
 	base-costume.o \
 	bomp.o \
+	boxcache.o \
 	boxes.o \
 	camera.o \
 	charset.o \
@@ -63,6 +64,7 @@ MODULE_OBJS := \
 	scumm.o \
 	sound.o \
 	string.o \
+	stripcache.o \
 	usage_bits.o \
 	util.o \
 	vars.o \
@@ -126,6 +128,7 @@ MODULE_OBJS += \
 	he/script_v100he.o \
 	he/sprite_he.o \
 	he/wiz_he.o \
+	he/wizcache_he.o \
 	he/logic/baseball2001.o \
 	he/logic/basketball.o \
 	he/logic/football.o \
@@ -25,6 +25,7 @@
 #include "common/config-manager.h"
 #endif
 
+#include "scumm/boxes.h"
 #include "scumm/charset.h"
 #include "scumm/dialogs.h"
 #include "scumm/file.h"
@@ -686,6 +687,11 @@ int ScummEngine::loadResource(ResType type, ResId idx) {
 		size = _fileHandle->readUint32BE();
 		_fileHandle->seek(-8, SEEK_CUR);
 	}
+	// Resources are always copied, even where the data file could hand out
+	// its data in place (see Common::SeekableReadStream::readInPlace()):
+	// resources outlive the data file, which is replaced on the next
+	// openRoom(), scripts modify some of them in memory, and most games
+	// XOR encrypt their data files anyway.
 	_fileHandle->read(_res->createResource(type, idx, size), size);
 
 	// dump the resource if requested
@@ -834,6 +840,7 @@ byte *ResourceManager::createResource(ResType type, ResId idx, uint32 size) {
 	_types[type][idx]._address = ptr;
 	_types[type][idx]._size = size;
 	setResourceCounter(type, idx, 1);
+	_vm->resourceChanged(type, idx);
 	return ptr;
 }
 
@@ -899,6 +906,7 @@ void ResourceManager::nukeResource(ResType type, ResId idx) {
 		debugC(DEBUG_RESOURCE, "nukeResource(%s,%d)", nameOfResType(type), idx);
 		_allocatedSize -= _types[type][idx]._size;
 		_types[type][idx].nuke();
+		_vm->resourceChanged(type, idx);
 	}
 }
 
@@ -988,10 +996,18 @@ bool ScummEngine::isResourceInUse(ResType type, ResId idx) const {
 	}
 }
 
+void ScummEngine::resourceChanged(ResType type, ResId idx) {
+	// The box data is copied into new resources after they are created, so
+	// the box cache is only filled again when it is next used
+	if (type == rtMatrix)
+		_boxCache->invalidate();
+}
+
 void ResourceManager::setModified(ResType type, ResId idx) {
 	if (!validateResource("Modified", type, idx))
 		return;
 	_types[type][idx].setModified();
+	_vm->resourceChanged(type, idx);
 }
 
 void ResourceManager::setOffHeap(ResType type, ResId idx) {
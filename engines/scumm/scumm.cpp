@@ -35,6 +35,7 @@
 #include "graphics/cursorman.h"
 
 #include "scumm/akos.h"
+#include "scumm/boxes.h"
 #include "scumm/charset.h"
 #include "scumm/costume.h"
 #include "scumm/debugger.h"
@@ -135,6 +136,7 @@ ScummEngine::ScummEngine(OSystem *syst, const DetectorResult &dr)
 	} else {
 		_gdi = new Gdi(this);
 	}
+	_boxCache = new BoxCache();
 	_res = new ResourceManager(this);
 
 	// Convert MD5 checksum back into a digest
@@ -642,6 +644,7 @@ ScummEngine::~ScummEngine() {
 
 	delete _res;
 	delete _gdi;
+	delete _boxCache;
 }
 
 
@@ -2408,6 +2411,7 @@ void ScummEngine_v7::scummLoop_handleSound() {
 		// In CoMI and the Dig the full (non-demo) version invoke IMuseDigital::refreshScripts
 		if ((_game.id == GID_DIG || _game.id == GID_CMI) && !(_game.features & GF_DEMO))
 			_imuseDigital->refreshScripts();
+		_imuseDigital->readAhead();
 	}
 	if (_smixer) {
 		_smixer->flush();
@@ -24,6 +24,7 @@
 #define SCUMM_H
 
 #include "engines/engine.h"
+#include "common/array.h"
 #include "common/endian.h"
 #include "common/events.h"
 #include "common/file.h"
@@ -91,6 +92,8 @@ class Sound;
 
 struct Box;
 struct BoxCoords;
+struct BoxGate;
+class BoxCache;
 struct FindObjectInRoom;
 
 // Use g_scumm from error() ONLY
@@ -744,6 +747,12 @@ protected:
 	int readSoundResourceSmallHeader(ResId idx);
 	bool isResourceInUse(ResType type, ResId idx) const;
 
+	/**
+	 * Called when a resource was created, modified in place or unloaded, so
+	 * that anything derived from its contents can be dropped.
+	 */
+	virtual void resourceChanged(ResType type, ResId idx);
+
 	virtual void setupRoomSubBlocks();
 	virtual void resetRoomSubBlocks();
 
@@ -1114,13 +1123,16 @@ public:
 	byte getNumBoxes();
 	byte *getBoxMatrixBaseAddr();
 	int getNextBox(byte from, byte to);
+	bool getBoxPath(int from, int to, Common::Array<byte> &path);
 
 	void setBoxFlags(int box, int val);
 	void setBoxScale(int box, int b);
 
 	bool checkXYInBoxBounds(int box, int x, int y);
+	int getBoxAt(int x, int y);
 
 	BoxCoords getBoxCoordinates(int boxnum);
+	const BoxGate &getBoxGate(int box1, int box2);
 
 	byte getMaskFromBox(int box);
 	Box *getBoxBaseAddr(int box);
@@ -1145,6 +1157,10 @@ protected:
 	void createBoxMatrix();
 	virtual bool areBoxesNeighbors(int i, int j);
 
+	BoxCache *_boxCache;
+	BoxCache &getBoxCache();
+	BoxCoords readBoxCoordinates(int boxnum);
+
 	/* String class */
 public:
 	CharsetRenderer *_charset;
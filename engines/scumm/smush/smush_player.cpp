@@ -241,6 +241,14 @@ SmushPlayer::SmushPlayer(ScummEngine_v7 *scumm) {
 	_paused = false;
 	_pauseStartTime = 0;
 	_pauseTime = 0;
+
+	for (int i = 0; i < FRAME_QUEUE_SIZE; i++) {
+		_frameQueue[i].pixels = NULL;
+		_frameQueue[i].size = 0;
+	}
+	_frameQueueHead = 0;
+	_frameQueueLength = 0;
+	memset(&_stats, 0, sizeof(_stats));
 }
 
 SmushPlayer::~SmushPlayer() {
@@ -296,6 +304,14 @@ void SmushPlayer::release() {
 	free(_frameBuffer);
 	_frameBuffer = NULL;
 
+	for (int i = 0; i < FRAME_QUEUE_SIZE; i++) {
+		free(_frameQueue[i].pixels);
+		_frameQueue[i].pixels = NULL;
+		_frameQueue[i].size = 0;
+	}
+	_frameQueueHead = 0;
+	_frameQueueLength = 0;
+
 	_IACTstream = NULL;
 
 	_vm->_smushActive = false;
@@ -781,15 +797,13 @@ void SmushPlayer::handleZlibFrameObject(int32 subSize, Common::SeekableReadStrea
 	}
 
 	int32 chunkSize = subSize;
-	byte *chunkBuffer = (byte *)malloc(chunkSize);
-	assert(chunkBuffer);
-	b.read(chunkBuffer, chunkSize);
+	Common::StreamBuffer chunk(b, chunkSize);
+	const byte *chunkBuffer = chunk.getData();
 
 	unsigned long decompressedSize = READ_BE_UINT32(chunkBuffer);
 	byte *fobjBuffer = (byte *)malloc(decompressedSize);
 	if (!Common::uncompress(fobjBuffer, &decompressedSize, chunkBuffer + 4, chunkSize - 4))
 		error("SmushPlayer::handleZlibFrameObject() Zlib uncompress error");
-	free(chunkBuffer);
 
 	byte *ptr = fobjBuffer;
 	int codec = READ_LE_UINT16(ptr); ptr += 2;
@@ -821,13 +835,9 @@ void SmushPlayer::handleFrameObject(int32 subSize, Common::SeekableReadStream &b
 	b.readUint16LE();
 
 	int32 chunk_size = subSize - 14;
-	byte *chunk_buffer = (byte *)malloc(chunk_size);
-	assert(chunk_buffer);
-	b.read(chunk_buffer, chunk_size);
-
-	decodeFrameObject(codec, chunk_buffer, left, top, width, height);
+	Common::StreamBuffer chunk(b, chunk_size);
 
-	free(chunk_buffer);
+	decodeFrameObject(codec, chunk.getData(), left, top, width, height);
 }
 
 void SmushPlayer::handleFrame(int32 frameSize, Common::SeekableReadStream &b) {
@@ -901,6 +911,7 @@ void SmushPlayer::handleFrame(int32 frameSize, Common::SeekableReadStream &b) {
 	_smixer->handleFrame();
 
 	_frame++;
+	_stats.decoded++;
 }
 
 void SmushPlayer::handleAnimHeader(int32 subSize, Common::SeekableReadStream &b) {
@@ -1019,7 +1030,8 @@ void SmushPlayer::parseNextFrame() {
 	const int32 subOffset = _base->pos();
 
 	if (_base->pos() >= (int32)_baseSize) {
-		_vm->_smushVideoShouldFinish = true;
+		// The video finishes once the frames which were decoded ahead
+		// have been shown
 		_endOfFile = true;
 		return;
 	}
@@ -1071,6 +1083,96 @@ void SmushPlayer::warpMouse(int x, int y, int buttons) {
 	_warpButtons = buttons;
 }
 
+uint32 SmushPlayer::getElapsedTime() {
+	if (_insanity) {
+		// Seeking makes a mess of trying to sync the audio to
+		// the sound. Synt to time instead.
+		return _vm->_system->getMillis() - _pauseTime - _startTime;
+	} else if (_vm->_mixer->isSoundHandleActive(_compressedFileSoundHandle)) {
+		// Compressed SMUSH files.
+		return _vm->_mixer->getSoundElapsedTime(_compressedFileSoundHandle);
+	} else if (_vm->_mixer->isSoundHandleActive(_IACTchannel)) {
+		// Curse of Monkey Island SMUSH files.
+		return _vm->_mixer->getSoundElapsedTime(_IACTchannel);
+	} else {
+		// For other SMUSH files, we don't necessarily have any
+		// one channel to sync against, so we have to use
+		// elapsed real time.
+		return _vm->_system->getMillis() - _pauseTime - _startTime;
+	}
+}
+
+void SmushPlayer::queueFrame(uint32 frame) {
+	assert(_frameQueueLength < FRAME_QUEUE_SIZE);
+	QueuedFrame &queued = _frameQueue[(_frameQueueHead + _frameQueueLength) % FRAME_QUEUE_SIZE];
+	queued.frame = frame;
+	queued.width = 0;
+	queued.height = 0;
+
+	if (_updateNeeded) {
+		// Workaround for bug #1386333: "FT DEMO: assertion triggered
+		// when playing movie". Some frames there are 384 x 224
+		const int w = MIN(_width, _vm->_screenWidth);
+		const int h = MIN(_height, _vm->_screenHeight);
+
+		if (queued.size < (uint32)(w * h)) {
+			free(queued.pixels);
+			queued.size = w * h;
+			queued.pixels = (byte *)malloc(queued.size);
+		}
+		for (int y = 0; y < h; y++)
+			memcpy(queued.pixels + y * w, _dst + y * _width, w);
+
+		queued.width = w;
+		queued.height = h;
+		_updateNeeded = false;
+	}
+
+	queued.palDirtyMin = _palDirtyMin;
+	queued.palDirtyMax = _palDirtyMax;
+	if (_palDirtyMax >= _palDirtyMin) {
+		memcpy(queued.pal + _palDirtyMin * 3, _pal + _palDirtyMin * 3, (_palDirtyMax - _palDirtyMin + 1) * 3);
+		_palDirtyMax = -1;
+		_palDirtyMin = 256;
+	}
+
+	_frameQueueLength++;
+	_stats.maxQueued = MAX<uint32>(_stats.maxQueued, _frameQueueLength);
+}
+
+void SmushPlayer::showQueuedFrame(uint32 elapsed, int &skipped) {
+	QueuedFrame &queued = _frameQueue[_frameQueueHead];
+	if (elapsed < ((queued.frame - _startFrame) * 1000) / _speed)
+		return;
+
+	bool skipFrame = (elapsed >= ((queued.frame - _startFrame + 1) * 1000) / _speed);
+
+	if (queued.palDirtyMax >= queued.palDirtyMin) {
+		_vm->_system->getPaletteManager()->setPalette(queued.pal + queued.palDirtyMin * 3, queued.palDirtyMin, queued.palDirtyMax - queued.palDirtyMin + 1);
+		skipFrame = false;
+	}
+	if (skipFrame) {
+		if (++skipped > 10) {
+			skipFrame = false;
+			skipped = 0;
+		}
+	} else
+		skipped = 0;
+
+	if (queued.width != 0) {
+		if (skipFrame) {
+			_stats.dropped++;
+		} else {
+			_vm->_system->copyRectToScreen(queued.pixels, queued.width, 0, 0, queued.width, queued.height);
+			_vm->_system->updateScreen();
+			_stats.shown++;
+		}
+	}
+
+	_frameQueueHead = (_frameQueueHead + 1) % FRAME_QUEUE_SIZE;
+	_frameQueueLength--;
+}
+
 void SmushPlayer::updateScreen() {
 	uint32 end_time, start_time = _vm->_system->getMillis();
 	_updateNeeded = true;
@@ -1173,37 +1275,31 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 
 	_pauseTime = 0;
 
+	_frameQueueHead = 0;
+	_frameQueueLength = 0;
+	memset(&_stats, 0, sizeof(_stats));
+
 	int skipped = 0;
 
 	for (;;) {
-		uint32 now, elapsed;
-		bool skipFrame = false;
-
-		if (_insanity) {
-			// Seeking makes a mess of trying to sync the audio to
-			// the sound. Synt to time instead.
-			now = _vm->_system->getMillis() - _pauseTime;
-			elapsed = now - _startTime;
-		} else if (_vm->_mixer->isSoundHandleActive(_compressedFileSoundHandle)) {
-			// Compressed SMUSH files.
-			elapsed = _vm->_mixer->getSoundElapsedTime(_compressedFileSoundHandle);
-		} else if (_vm->_mixer->isSoundHandleActive(_IACTchannel)) {
-			// Curse of Monkey Island SMUSH files.
-			elapsed = _vm->_mixer->getSoundElapsedTime(_IACTchannel);
-		} else {
-			// For other SMUSH files, we don't necessarily have any
-			// one channel to sync against, so we have to use
-			// elapsed real time.
-			now = _vm->_system->getMillis() - _pauseTime;
-			elapsed = now - _startTime;
-		}
-
-		if (elapsed >= ((_frame - _startFrame) * 1000) / _speed) {
-			if (elapsed >= ((_frame + 1) * 1000) / _speed)
-				skipFrame = true;
-			else
-				skipFrame = false;
-			timerCallback();
+		// Decode the next frame once it is due. Unless INSANE has to react
+		// to the player while the frames are decoded, frames are also
+		// decoded ahead while there is room in the queue, so that frames
+		// which take long to decode don't make the following ones late.
+		// The audio of the frames is queued in the mixer as they are decoded.
+		bool decoded = false;
+		if (!_endOfFile && _frameQueueLength < FRAME_QUEUE_SIZE) {
+			const bool due = getElapsedTime() >= ((_frame - _startFrame) * 1000) / _speed;
+			if (due || !_insanity) {
+				if (due && !_insanity && _frameQueueLength == 0 && _frame != _startFrame)
+					_stats.underruns++;
+
+				const uint32 decodedFrames = _stats.decoded;
+				timerCallback();
+				if (_stats.decoded != decodedFrames)
+					queueFrame(_frame - 1);
+				decoded = true;
+			}
 		}
 
 		_vm->scummLoop_handleSound();
@@ -1214,33 +1310,9 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 		}
 		_vm->parseEvents();
 		_vm->processInput();
-		if (_palDirtyMax >= _palDirtyMin) {
-			_vm->_system->getPaletteManager()->setPalette(_pal + _palDirtyMin * 3, _palDirtyMin, _palDirtyMax - _palDirtyMin + 1);
-
-			_palDirtyMax = -1;
-			_palDirtyMin = 256;
-			skipFrame = false;
-		}
-		if (skipFrame) {
-			if (++skipped > 10) {
-				skipFrame = false;
-				skipped = 0;
-			}
-		} else
-			skipped = 0;
-		if (_updateNeeded) {
-			if (!skipFrame) {
-				// Workaround for bug #1386333: "FT DEMO: assertion triggered
-				// when playing movie". Some frames there are 384 x 224
-				int w = MIN(_width, _vm->_screenWidth);
-				int h = MIN(_height, _vm->_screenHeight);
-
-				_vm->_system->copyRectToScreen(_dst, _width, 0, 0, w, h);
-				_vm->_system->updateScreen();
-				_updateNeeded = false;
-			}
-		}
-		if (_endOfFile)
+		if (_frameQueueLength > 0)
+			showQueuedFrame(getElapsedTime(), skipped);
+		if (_endOfFile && _frameQueueLength == 0)
 			break;
 		if (_vm->shouldQuit() || _vm->_saveLoadFlag || _vm->_smushVideoShouldFinish) {
 			_smixer->stop();
@@ -1249,9 +1321,13 @@ void SmushPlayer::play(const char *filename, int32 speed, int32 offset, int32 st
 			_IACTpos = 0;
 			break;
 		}
-		_vm->_system->delayMillis(10);
+		if (!decoded)
+			_vm->_system->delayMillis(10);
 	}
 
+	debugC(DEBUG_SMUSH, "SmushPlayer::play(): %d frames decoded, %d shown, %d dropped, %d decoded late, at most %d queued",
+	       _stats.decoded, _stats.shown, _stats.dropped, _stats.underruns, _stats.maxQueued);
+
 	release();
 
 	// Reset mouse state
@@ -82,10 +82,40 @@ private:
 	bool _middleAudio;
 	bool _skipPalette;
 
+	enum {
+		/** Number of frames which are decoded ahead of the one shown */
+		FRAME_QUEUE_SIZE = 4
+	};
+
+	/** A decoded frame which waits to be shown */
+	struct QueuedFrame {
+		uint32 frame;
+		byte *pixels;
+		uint32 size;
+		int width, height;
+		int palDirtyMin, palDirtyMax;
+		byte pal[0x300];
+	};
+
+	QueuedFrame _frameQueue[FRAME_QUEUE_SIZE];
+	int _frameQueueHead;
+	int _frameQueueLength;
+
 public:
 	SmushPlayer(ScummEngine_v7 *scumm);
 	~SmushPlayer();
 
+	struct Statistics {
+		uint32 decoded;		///< Frames which were decoded
+		uint32 shown;		///< Frames which were shown
+		uint32 dropped;		///< Frames which were not shown because they were late
+		uint32 underruns;	///< Frames which were due before they were decoded
+		uint32 maxQueued;	///< Most frames which were decoded ahead at a time
+	};
+
+	/** Returns the statistics of the last video played */
+	const Statistics &getStatistics() const { return _stats; }
+
 	void pause();
 	void unpause();
 
@@ -109,12 +139,17 @@ protected:
 	const char *getString(int id);
 
 private:
+	Statistics _stats;
+
 	SmushFont *getFont(int font);
 	void parseNextFrame();
 	void init(int32 spped);
 	void setupAnim(const char *file);
 	void updateScreen();
 	void tryCmpFile(const char *filename);
+	uint32 getElapsedTime();
+	void queueFrame(uint32 frame);
+	void showQueuedFrame(uint32 elapsed, int &skipped);
 
 	bool readString(const char *file);
 	void decodeFrameObject(int codec, const uint8 *src, int left, int top, int width, int height);
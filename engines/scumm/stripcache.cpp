@@ -0,0 +1,148 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "scumm/stripcache.h"
+
+namespace Scumm {
+
+StripCache::StripCache()
+	: _smap(0), _height(0), _numZBuffer(0),
+	  _pixelSize(0), _maskSize(0), _memory(0), _budget(DEFAULT_BUDGET), _useCounter(0) {
+	memset(_palette, 0, sizeof(_palette));
+	resetStatistics();
+}
+
+StripCache::~StripCache() {
+	clear();
+}
+
+void StripCache::reset(int numStrips, uint32 pixelSize, uint32 maskSize) {
+	clear();
+
+	_entries.resize(numStrips);
+	for (int i = 0; i < numStrips; i++) {
+		_entries[i].data = 0;
+		_entries[i].lastUse = 0;
+	}
+
+	_pixelSize = pixelSize;
+	_maskSize = maskSize;
+}
+
+void StripCache::clear() {
+	for (uint i = 0; i < _entries.size(); i++) {
+		free(_entries[i].data);
+		_entries[i].data = 0;
+	}
+
+	_memory = 0;
+	_useCounter = 0;
+}
+
+bool StripCache::validate(const byte *smap, int height, int numZBuffer, const byte *palette) {
+	// Scripts may change the room palette at any time, e.g. in Loom, so it
+	// is compared on every redraw
+	if (smap == _smap && height == _height && numZBuffer == _numZBuffer
+			&& !memcmp(palette, _palette, sizeof(_palette)))
+		return true;
+
+	clear();
+	_smap = smap;
+	_height = height;
+	_numZBuffer = numZBuffer;
+	memcpy(_palette, palette, sizeof(_palette));
+	return false;
+}
+
+void StripCache::invalidate() {
+	clear();
+	_smap = 0;
+}
+
+const byte *StripCache::find(int strip) {
+	if (strip < 0 || strip >= (int)_entries.size() || !_entries[strip].data) {
+		_stats.misses++;
+		return 0;
+	}
+
+	_stats.hits++;
+	_entries[strip].lastUse = ++_useCounter;
+	return _entries[strip].data;
+}
+
+byte *StripCache::insert(int strip) {
+	const uint32 size = _pixelSize + _maskSize;
+	if (strip < 0 || strip >= (int)_entries.size() || size > _budget)
+		return 0;
+
+	Entry &entry = _entries[strip];
+	if (!entry.data) {
+		while (_memory + size > _budget)
+			evictOldest();
+
+		entry.data = (byte *)malloc(size);
+		if (!entry.data)
+			return 0;
+		_memory += size;
+	}
+
+	entry.lastUse = ++_useCounter;
+	return entry.data;
+}
+
+void StripCache::remove(int strip) {
+	if (strip < 0 || strip >= (int)_entries.size() || !_entries[strip].data)
+		return;
+
+	free(_entries[strip].data);
+	_entries[strip].data = 0;
+	_memory -= _pixelSize + _maskSize;
+}
+
+void StripCache::evictOldest() {
+	// Rooms have a few hundred strips at most, and strips are only evicted
+	// once the budget is used up, so a linear search is good enough
+	int oldest = -1;
+	for (uint i = 0; i < _entries.size(); i++) {
+		if (_entries[i].data && (oldest < 0 || _entries[i].lastUse < _entries[oldest].lastUse))
+			oldest = i;
+	}
+
+	if (oldest >= 0) {
+		remove(oldest);
+		_stats.evictions++;
+	}
+}
+
+void StripCache::setBudget(uint32 bytes) {
+	_budget = bytes;
+	while (_memory > _budget)
+		evictOldest();
+}
+
+void StripCache::resetStatistics() {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+}
+
+} // End of namespace Scumm
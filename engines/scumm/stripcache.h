@@ -0,0 +1,127 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef SCUMM_STRIPCACHE_H
+#define SCUMM_STRIPCACHE_H
+
+#include "common/array.h"
+
+namespace Scumm {
+
+/**
+ * Keeps decoded strips of the room background, together with their z-plane
+ * masks, so that redrawing them, e.g. when scrolling, only needs to copy
+ * them. All strips have the same size, which is set by reset(). When the
+ * cache would grow beyond its budget, the strips which were used least
+ * recently are dropped.
+ */
+class StripCache {
+public:
+	enum {
+		DEFAULT_BUDGET = 1024 * 1024
+	};
+
+	StripCache();
+	~StripCache();
+
+	/**
+	 * Empties the cache and sets the layout of the strips it holds.
+	 * @param numStrips		number of strips in the room
+	 * @param pixelSize		size of the pixels of a strip, in bytes
+	 * @param maskSize		size of the masks of a strip, in bytes
+	 */
+	void reset(int numStrips, uint32 pixelSize, uint32 maskSize);
+
+	/** Empties the cache, keeping the layout of the strips */
+	void clear();
+
+	/**
+	 * Checks whether the cached strips were decoded from the given room
+	 * image, with the given height, number of z-planes and room palette. If
+	 * not, the cache is emptied and remembers the new ones; the caller then
+	 * has to reset() it with the new layout.
+	 * @return true if the cached strips can still be used
+	 */
+	bool validate(const byte *smap, int height, int numZBuffer, const byte *palette);
+
+	/** Empties the cache and forgets what its strips were decoded from */
+	void invalidate();
+
+	/**
+	 * Looks up a strip.
+	 * @return the pixels of the strip, followed by its masks, or NULL if the
+	 *         strip is not cached
+	 */
+	const byte *find(int strip);
+
+	/**
+	 * Makes room for a strip, dropping others if necessary. The caller has
+	 * to fill in the pixels, followed by the masks.
+	 * @return the memory for the strip, or NULL if it can't be cached
+	 */
+	byte *insert(int strip);
+
+	/** Drops a strip, e.g. because it turned out not to be cacheable */
+	void remove(int strip);
+
+	void setBudget(uint32 bytes);
+	uint32 getBudget() const { return _budget; }
+	uint32 getMemory() const { return _memory; }
+	uint32 getPixelSize() const { return _pixelSize; }
+	uint32 getMaskSize() const { return _maskSize; }
+
+	struct Statistics {
+		uint32 hits;		///< Strips which were copied from the cache
+		uint32 misses;		///< Strips which had to be decoded
+		uint32 evictions;	///< Strips which were dropped to stay within the budget
+	};
+
+	const Statistics &getStatistics() const { return _stats; }
+	void resetStatistics();
+
+private:
+	struct Entry {
+		byte *data;
+		uint32 lastUse;
+	};
+
+	void evictOldest();
+
+	Common::Array<Entry> _entries;
+
+	/** What the cached strips were decoded from, see validate() */
+	const byte *_smap;
+	int _height;
+	int _numZBuffer;
+	byte _palette[256];
+
+	uint32 _pixelSize;
+	uint32 _maskSize;
+	uint32 _memory;
+	uint32 _budget;
+	uint32 _useCounter;
+	Statistics _stats;
+};
+
+} // End of namespace Scumm
+
+#endif
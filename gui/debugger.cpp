@@ -24,6 +24,7 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "common/debug-channels.h"
+#include "common/memorypool.h"
 #include "common/system.h"
 
 #include "engines/engine.h"
@@ -64,6 +65,8 @@ Debugger::Debugger() {
 	DCmd_Register("debugflag_list",		WRAP_METHOD(Debugger, Cmd_DebugFlagsList));
 	DCmd_Register("debugflag_enable",	WRAP_METHOD(Debugger, Cmd_DebugFlagEnable));
 	DCmd_Register("debugflag_disable",	WRAP_METHOD(Debugger, Cmd_DebugFlagDisable));
+
+	DCmd_Register("mempools",			WRAP_METHOD(Debugger, Cmd_MemPools));
 }
 
 Debugger::~Debugger() {
@@ -538,6 +541,24 @@ bool Debugger::Cmd_DebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::Cmd_MemPools(int argc, const char **argv) {
+	// Take a snapshot first: printing allocates Strings, which may need
+	// the pools we are looking at.
+	Common::SharedMemoryPool::Stats stats[64];
+	const uint total = Common::SharedMemoryPool::getAllStats(stats, ARRAYSIZE(stats));
+	const uint count = MIN<uint>(total, ARRAYSIZE(stats));
+
+	DebugPrintf("%-20s %6s %8s %8s %6s %10s\n", "Pool", "Chunk", "Live", "Peak", "Pages", "Allocs");
+	for (uint i = 0; i < count; ++i) {
+		DebugPrintf("%-20s %6d %8d %8d %6d %10d\n", stats[i].name, (int)stats[i].chunkSize,
+				stats[i].live, stats[i].peak, stats[i].pages, stats[i].allocations);
+	}
+	if (total > count)
+		DebugPrintf("(%d more pools not shown)\n", total - count);
+
+	return true;
+}
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
@@ -0,0 +1,187 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/rate.h"
+#include "audio/mixer.h"
+
+#include "helper.h"
+
+/**
+ * Endless stream of a constant value.
+ */
+class ConstantStream : public Audio::AudioStream {
+public:
+	ConstantStream(int rate, bool stereo, int16 value) : _rate(rate), _stereo(stereo), _value(value) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		for (int i = 0; i < numSamples; ++i)
+			buffer[i] = _value;
+		return numSamples;
+	}
+
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return false; }
+
+private:
+	const int _rate;
+	const bool _stereo;
+	const int16 _value;
+};
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	// Mixes a full scale sine with the given converter on top of a loud
+	// square wave, so that clamping happens regularly.
+	int16 *mixSine(bool simd, Audio::st_rate_t inRate, Audio::st_rate_t outRate, bool isStereo, bool reverseStereo,
+	               Audio::st_volume_t volL, Audio::st_volume_t volR, int outLen) {
+		Audio::setRateConverterSIMD(simd);
+		Audio::SeekableAudioStream *s = createSineStream<int16>(inRate, 1, 0, false, isStereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, isStereo, reverseStereo);
+		Audio::setRateConverterSIMD(true);
+
+		int16 *buffer = new int16[outLen * 2];
+		for (int i = 0; i < outLen * 2; ++i)
+			buffer[i] = ((i / 7) & 1) ? 20000 : -20000;
+
+		// Use odd chunk sizes to exercise the scalar tail handling
+		int pos = 0;
+		while (pos < outLen) {
+			const int chunk = MIN(outLen - pos, 333);
+			pos += chunk;
+			converter->flow(*s, buffer + (pos - chunk) * 2, chunk, volL, volR);
+		}
+
+		delete converter;
+		delete s;
+		return buffer;
+	}
+
+	void compareTemplate(Audio::st_rate_t inRate, Audio::st_rate_t outRate, bool isStereo, bool reverseStereo) {
+		static const Audio::st_volume_t volumes[][2] = {
+			{ Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume },
+			{ Audio::Mixer::kMaxMixerVolume, 0 },
+			{ 77, 200 },
+			{ 1, 255 }
+		};
+
+		const int outLen = outRate / 2;
+		for (int i = 0; i < ARRAYSIZE(volumes); ++i) {
+			int16 *plain = mixSine(false, inRate, outRate, isStereo, reverseStereo, volumes[i][0], volumes[i][1], outLen);
+			int16 *simd = mixSine(true, inRate, outRate, isStereo, reverseStereo, volumes[i][0], volumes[i][1], outLen);
+			TS_ASSERT_EQUALS(memcmp(plain, simd, outLen * 2 * sizeof(int16)), 0);
+			delete[] plain;
+			delete[] simd;
+		}
+	}
+
+public:
+	void test_copy_mono() {
+		compareTemplate(44100, 44100, false, false);
+	}
+
+	void test_copy_stereo() {
+		compareTemplate(44100, 44100, true, false);
+	}
+
+	void test_copy_stereo_reverse() {
+		compareTemplate(44100, 44100, true, true);
+	}
+
+	void test_simple_mono() {
+		compareTemplate(44100, 22050, false, false);
+	}
+
+	void test_simple_stereo_reverse() {
+		compareTemplate(44100, 22050, true, true);
+	}
+
+	void test_linear_mono() {
+		compareTemplate(22050, 48000, false, false);
+	}
+
+	void test_linear_stereo() {
+		compareTemplate(11025, 44100, true, false);
+	}
+
+	void test_linear_stereo_reverse() {
+		compareTemplate(32000, 44100, true, true);
+	}
+
+	void test_sinc_constant() {
+		// A constant signal must come out unchanged, once the filter has
+		// moved past the silence in front of the stream
+		static const Audio::st_rate_t rates[][2] = {
+			{ 22050, 44100 }, { 44100, 22050 }, { 11025, 48000 }, { 48000, 44100 }
+		};
+
+		for (int i = 0; i < ARRAYSIZE(rates); ++i) {
+			for (int type = Audio::kResamplerSinc; type <= Audio::kResamplerSincFloat; ++type) {
+				ConstantStream s(rates[i][0], true, -12345);
+				Audio::RateConverter *converter = Audio::makeRateConverter(rates[i][0], rates[i][1], true, false, (Audio::ResamplerType)type);
+
+				int16 buffer[2000 * 2];
+				memset(buffer, 0, sizeof(buffer));
+				TS_ASSERT_EQUALS(converter->flow(s, buffer, 2000, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), 2000);
+
+				for (int j = 500 * 2; j < 2000 * 2; ++j) {
+					TS_ASSERT_LESS_THAN_EQUALS(buffer[j], -12344);
+					TS_ASSERT_LESS_THAN_EQUALS(-12346, buffer[j]);
+				}
+
+				delete converter;
+			}
+		}
+	}
+
+	void test_sinc_fixed_float() {
+		// Both flavors of the sinc resampler compute the same filter
+		for (int reverse = 0; reverse < 2; ++reverse) {
+			Audio::SeekableAudioStream *sFixed = createSineStream<int16>(22050, 1, 0, false, true);
+			Audio::SeekableAudioStream *sFloat = createSineStream<int16>(22050, 1, 0, false, true);
+			Audio::RateConverter *fixed = Audio::makeRateConverter(22050, 44100, true, reverse, Audio::kResamplerSinc);
+			Audio::RateConverter *floating = Audio::makeRateConverter(22050, 44100, true, reverse, Audio::kResamplerSincFloat);
+
+			int16 *bufFixed = new int16[44100 * 2];
+			int16 *bufFloat = new int16[44100 * 2];
+			memset(bufFixed, 0, 44100 * 2 * sizeof(int16));
+			memset(bufFloat, 0, 44100 * 2 * sizeof(int16));
+
+			fixed->flow(*sFixed, bufFixed, 44100, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			floating->flow(*sFloat, bufFloat, 44100, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+
+			int maxDiff = 0;
+			for (int i = 0; i < 44100 * 2; ++i)
+				maxDiff = MAX(maxDiff, ABS(bufFixed[i] - bufFloat[i]));
+			TS_ASSERT_LESS_THAN_EQUALS(maxDiff, 8);
+
+			delete[] bufFixed;
+			delete[] bufFloat;
+			delete fixed;
+			delete floating;
+			delete sFixed;
+			delete sFloat;
+		}
+	}
+
+	void test_sinc_end_of_stream() {
+		// One second of input yields one second of output, minus the half
+		// filter length still in the history when the input runs out
+		Audio::SeekableAudioStream *s = createSineStream<int16>(22050, 1, 0, false, false);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 44100, false, false, Audio::kResamplerSinc);
+
+		int16 *buffer = new int16[50000 * 2];
+		memset(buffer, 0, 50000 * 2 * sizeof(int16));
+
+		int total = 0, len;
+		while ((len = converter->flow(*s, buffer + total * 2, MIN(50000 - total, 4000), 128, 128)) > 0)
+			total += len;
+
+		TS_ASSERT_LESS_THAN_EQUALS(total, 44100);
+		TS_ASSERT_LESS_THAN_EQUALS(44100 - 64, total);
+
+		delete[] buffer;
+		delete converter;
+		delete s;
+	}
+};
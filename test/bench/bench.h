@@ -0,0 +1,75 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef TEST_BENCH_BENCH_H
+#define TEST_BENCH_BENCH_H
+
+#include "common/scummsys.h"
+
+namespace Bench {
+
+/**
+ * Base class for benchmarks. Define a subclass and create one static
+ * instance of it; the runner (see main.cpp) picks up every instance and
+ * runs it. Use the 'bench' make target to build and run all benchmarks,
+ * or pass a part of a benchmark name to the runner to only run some.
+ */
+class Benchmark {
+public:
+	Benchmark(const char *name);
+	virtual ~Benchmark() {}
+
+	const char *getName() const { return _name; }
+	Benchmark *getNext() const { return _next; }
+
+	static Benchmark *getFirst() { return _first; }
+
+	virtual void run() = 0;
+
+private:
+	const char *_name;
+	Benchmark *_next;
+
+	static Benchmark *_first;
+};
+
+/**
+ * Returns a time stamp in microseconds. Only differences between two time
+ * stamps are meaningful.
+ */
+uint32 getMicros();
+
+/**
+ * Returns the number of times operator new (in any form) has been called
+ * so far. Only differences between two counts are meaningful.
+ */
+uint32 getAllocationCount();
+
+/**
+ * Prints one line of results, prefixed with the name of the benchmark
+ * which is currently running.
+ */
+void report(const char *format, ...) GCC_PRINTF(1, 2);
+
+} // End of namespace Bench
+
+#endif
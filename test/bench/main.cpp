@@ -0,0 +1,119 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// The runner talks to the host system directly
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "test/bench/bench.h"
+
+#include <new>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+namespace Bench {
+
+Benchmark *Benchmark::_first = 0;
+
+static const char *s_currentName = "";
+
+static uint32 s_allocationCount = 0;
+
+static void *countedAlloc(size_t size) {
+	++s_allocationCount;
+	void *ptr = malloc(size ? size : 1);
+	if (!ptr)
+		abort();
+	return ptr;
+}
+
+Benchmark::Benchmark(const char *name) : _name(name) {
+	// Keep the benchmarks in definition order, at least per file
+	Benchmark **last = &_first;
+	while (*last)
+		last = &(*last)->_next;
+	*last = this;
+	_next = 0;
+}
+
+uint32 getMicros() {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return (uint32)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+uint32 getAllocationCount() {
+	return s_allocationCount;
+}
+
+void report(const char *format, ...) {
+	va_list va;
+
+	printf("%-24s ", s_currentName);
+	va_start(va, format);
+	vprintf(format, va);
+	va_end(va);
+	printf("\n");
+	fflush(stdout);
+}
+
+} // End of namespace Bench
+
+// Count all allocations, see Bench::getAllocationCount()
+
+#if __cplusplus >= 201103L
+#define BENCH_THROW_BAD_ALLOC
+#define BENCH_THROW_NOTHING noexcept
+#else
+#define BENCH_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define BENCH_THROW_NOTHING throw()
+#endif
+
+void *operator new(size_t size) BENCH_THROW_BAD_ALLOC {
+	return Bench::countedAlloc(size);
+}
+
+void *operator new[](size_t size) BENCH_THROW_BAD_ALLOC {
+	return Bench::countedAlloc(size);
+}
+
+void operator delete(void *ptr) BENCH_THROW_NOTHING {
+	free(ptr);
+}
+
+void operator delete[](void *ptr) BENCH_THROW_NOTHING {
+	free(ptr);
+}
+
+int main(int argc, char *argv[]) {
+	for (Bench::Benchmark *b = Bench::Benchmark::getFirst(); b; b = b->getNext()) {
+		if (argc > 1 && !strstr(b->getName(), argv[1]))
+			continue;
+
+		Bench::s_currentName = b->getName();
+		b->run();
+	}
+
+	return 0;
+}
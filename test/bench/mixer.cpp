@@ -0,0 +1,356 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Sample files for the compressed formats are read from the host file system
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "test/bench/bench.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+#include "audio/decoders/adpcm.h"
+#include "audio/decoders/flac.h"
+#include "audio/decoders/mp3.h"
+#include "audio/decoders/raw.h"
+#include "audio/decoders/vorbis.h"
+
+#include "common/memstream.h"
+#include "common/system.h"
+#include "common/util.h"
+
+#include "graphics/pixelformat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace {
+
+/**
+ * Just enough of a backend for MixerImpl, along the lines of the null
+ * backend: no graphics, no events, mutexes which do nothing (everything
+ * runs on one thread here) and a real clock for the channel timing.
+ */
+class BenchSystem : public OSystem {
+public:
+	virtual const GraphicsMode *getSupportedGraphicsModes() const {
+		static const GraphicsMode noGraphicsModes[] = { { 0, 0, 0 } };
+		return noGraphicsModes;
+	}
+	virtual int getDefaultGraphicsMode() const { return 0; }
+	virtual bool setGraphicsMode(int mode) { return true; }
+	virtual int getGraphicsMode() const { return 0; }
+	virtual Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+	virtual Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format = NULL) {}
+	virtual int16 getHeight() { return 0; }
+	virtual int16 getWidth() { return 0; }
+	virtual PaletteManager *getPaletteManager() { return 0; }
+	virtual void copyRectToScreen(const byte *buf, int pitch, int x, int y, int w, int h) {}
+	virtual Graphics::Surface *lockScreen() { return 0; }
+	virtual void unlockScreen() {}
+	virtual void fillScreen(uint32 col) {}
+	virtual void updateScreen() {}
+	virtual void setShakePos(int shakeOffset) {}
+	virtual void showOverlay() {}
+	virtual void hideOverlay() {}
+	virtual Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat(); }
+	virtual void clearOverlay() {}
+	virtual void grabOverlay(OverlayColor *buf, int pitch) {}
+	virtual void copyRectToOverlay(const OverlayColor *buf, int pitch, int x, int y, int w, int h) {}
+	virtual int16 getOverlayHeight() { return 0; }
+	virtual int16 getOverlayWidth() { return 0; }
+	virtual bool showMouse(bool visible) { return false; }
+	virtual void warpMouse(int x, int y) {}
+	virtual void setMouseCursor(const byte *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, int cursorTargetScale = 1, const Graphics::PixelFormat *format = NULL) {}
+
+	virtual uint32 getMillis() { return Bench::getMicros() / 1000; }
+	virtual void delayMillis(uint msecs) {}
+	virtual void getTimeAndDate(TimeDate &t) const {}
+
+	virtual MutexRef createMutex() { return 0; }
+	virtual void lockMutex(MutexRef mutex) {}
+	virtual void unlockMutex(MutexRef mutex) {}
+	virtual void deleteMutex(MutexRef mutex) {}
+
+	virtual Audio::Mixer *getMixer() { return 0; }
+	virtual void quit() {}
+	virtual void displayMessageOnOSD(const char *msg) {}
+
+	virtual void logMessage(LogMessageType::Type type, const char *message) {
+		fputs(message, stderr);
+	}
+};
+
+/**
+ * Plays one kind of audio stream on all mixer channels at once and reports
+ * what one mixer callback costs: the throughput in mixed channel samples
+ * per second, the slowest callback, and how many times operator new was
+ * called from within the callbacks (which should be never, ideally).
+ *
+ * Raw, ADPCM, looping and queued streams are generated. Vorbis, FLAC and
+ * MP3 need sample files: they are read from bench.ogg, bench.flac and
+ * bench.mp3 in the directory named by the SCUMMVM_BENCH_DATA environment
+ * variable, if the respective decoder is compiled in.
+ */
+class MixerBenchmark : public Bench::Benchmark {
+public:
+	MixerBenchmark() : Bench::Benchmark("audio/mixer"), _system(0), _mixer(0) {}
+
+	void run();
+
+private:
+	enum {
+		OUTPUT_RATE = 44100,
+		NUM_CHANNELS = 16,
+		CALLBACK_SAMPLES = 1024,
+		CALLBACKS = 1000,
+		/** Frames of generated raw data, enough for the whole run at any input rate */
+		RAW_FRAMES = CALLBACKS * CALLBACK_SAMPLES + 4096,
+		/** Size of the buffers fed to queuing streams, in frames */
+		QUEUE_FRAMES = 2048
+	};
+
+	enum StreamKind {
+		kStreamRaw,
+		kStreamADPCM,
+		kStreamLooping,
+		kStreamQueued,
+		kStreamFile
+	};
+
+	/** Source formats of the generated streams, in rough proportion to what engines play */
+	struct Format {
+		int rate;
+		bool stereo;
+	};
+
+	static const Format _formats[];
+
+	BenchSystem *_system;
+	Audio::MixerImpl *_mixer;
+
+	int16 *_rawData;
+	byte *_adpcmData;
+	Audio::QueuingAudioStream *_queues[NUM_CHANNELS];
+
+	Audio::AudioStream *createStream(StreamKind kind, int channel, const byte *fileData, uint32 fileSize, Audio::SeekableAudioStream *(*fileDecoder)(Common::SeekableReadStream *, DisposeAfterUse::Flag));
+	void feedQueues();
+
+	void runStreams(const char *name, StreamKind kind, const byte *fileData = 0, uint32 fileSize = 0,
+	                Audio::SeekableAudioStream *(*fileDecoder)(Common::SeekableReadStream *, DisposeAfterUse::Flag) = 0);
+#if defined(USE_VORBIS) || defined(USE_FLAC) || defined(USE_MAD)
+	void runFile(const char *name, const char *fileName, Audio::SeekableAudioStream *(*fileDecoder)(Common::SeekableReadStream *, DisposeAfterUse::Flag));
+#endif
+};
+
+const MixerBenchmark::Format MixerBenchmark::_formats[] = {
+	{ 22050, false }, { 11025, false }, { 22050, true }, { 44100, true },
+	{ 44100, false }, { 22050, false }, { 8000, false }, { 32000, true }
+};
+
+void MixerBenchmark::run() {
+	OSystem *oldSystem = g_system;
+	_system = new BenchSystem();
+	g_system = _system;
+
+	// A triangle wave, distinct per channel through different start offsets
+	_rawData = new int16[RAW_FRAMES * 2];
+	int value = 0, step = 151;
+	for (int i = 0; i < RAW_FRAMES * 2; ++i) {
+		value += step;
+		if (value > 30000 || value < -30000)
+			step = -step;
+		_rawData[i] = value;
+	}
+
+	// Any data is valid IMA ADPCM; use noise, which is the worst case for
+	// nothing but the ears
+	_adpcmData = new byte[RAW_FRAMES];
+	uint32 seed = 0x12345678;
+	for (int i = 0; i < RAW_FRAMES; ++i) {
+		seed = seed * 1103515245 + 12345;
+		_adpcmData[i] = seed >> 24;
+	}
+
+	runStreams("raw", kStreamRaw);
+	runStreams("adpcm", kStreamADPCM);
+	runStreams("looping", kStreamLooping);
+	runStreams("queued", kStreamQueued);
+
+#ifdef USE_VORBIS
+	runFile("vorbis", "bench.ogg", Audio::makeVorbisStream);
+#else
+	Bench::report("%-8s skipped, Vorbis support not compiled in", "vorbis");
+#endif
+#ifdef USE_FLAC
+	runFile("flac", "bench.flac", Audio::makeFLACStream);
+#else
+	Bench::report("%-8s skipped, FLAC support not compiled in", "flac");
+#endif
+#ifdef USE_MAD
+	runFile("mp3", "bench.mp3", Audio::makeMP3Stream);
+#else
+	Bench::report("%-8s skipped, MP3 support not compiled in", "mp3");
+#endif
+
+	delete[] _rawData;
+	delete[] _adpcmData;
+
+	g_system = oldSystem;
+	delete _system;
+	_system = 0;
+}
+
+Audio::AudioStream *MixerBenchmark::createStream(StreamKind kind, int channel, const byte *fileData, uint32 fileSize, Audio::SeekableAudioStream *(*fileDecoder)(Common::SeekableReadStream *, DisposeAfterUse::Flag)) {
+	const Format &format = _formats[channel % ARRAYSIZE(_formats)];
+	const byte rawFlags = Audio::FLAG_16BITS | (format.stereo ? Audio::FLAG_STEREO : 0)
+#ifdef SCUMM_LITTLE_ENDIAN
+	                      | Audio::FLAG_LITTLE_ENDIAN
+#endif
+	                      ;
+	const int16 *rawStart = _rawData + (channel * 97) * 2;
+
+	switch (kind) {
+	case kStreamRaw:
+		return Audio::makeRawStream((const byte *)rawStart, CALLBACKS * CALLBACK_SAMPLES * (format.stereo ? 4 : 2),
+		                            format.rate, rawFlags, DisposeAfterUse::NO);
+
+	case kStreamADPCM: {
+		// Mono, since stereo MS IMA ADPCM reads block headers differently
+		Common::SeekableReadStream *data = new Common::MemoryReadStream(_adpcmData, RAW_FRAMES);
+		return Audio::makeADPCMStream(data, DisposeAfterUse::YES, 0, Audio::kADPCMMSIma, format.rate, 1, 512);
+	}
+
+	case kStreamLooping:
+		// A short loop, rewound more than once per callback
+		return Audio::makeLoopingAudioStream(Audio::makeRawStream((const byte *)rawStart, (format.rate / 100) * (format.stereo ? 4 : 2),
+		                                     format.rate, rawFlags, DisposeAfterUse::NO), 0);
+
+	case kStreamQueued:
+		_queues[channel] = Audio::makeQueuingAudioStream(format.rate, format.stereo);
+		return _queues[channel];
+
+	case kStreamFile: {
+		Audio::SeekableAudioStream *stream = fileDecoder(new Common::MemoryReadStream(fileData, fileSize), DisposeAfterUse::YES);
+		if (!stream)
+			return 0;
+		return Audio::makeLoopingAudioStream(stream, 0);
+	}
+	}
+
+	return 0;
+}
+
+void MixerBenchmark::feedQueues() {
+	// Keep a few buffers queued, like a video player would
+	for (int i = 0; i < NUM_CHANNELS; ++i) {
+		while (_queues[i]->numQueuedStreams() < 4) {
+			const Format &format = _formats[i % ARRAYSIZE(_formats)];
+			const byte flags = Audio::FLAG_16BITS | (format.stereo ? Audio::FLAG_STEREO : 0)
+#ifdef SCUMM_LITTLE_ENDIAN
+			                   | Audio::FLAG_LITTLE_ENDIAN
+#endif
+			                   ;
+			_queues[i]->queueBuffer((byte *)(_rawData + i * 97 * 2), QUEUE_FRAMES * (format.stereo ? 4 : 2), DisposeAfterUse::NO, flags);
+		}
+	}
+}
+
+void MixerBenchmark::runStreams(const char *name, StreamKind kind, const byte *fileData, uint32 fileSize,
+                                Audio::SeekableAudioStream *(*fileDecoder)(Common::SeekableReadStream *, DisposeAfterUse::Flag)) {
+	_mixer = new Audio::MixerImpl(_system, OUTPUT_RATE);
+	_mixer->setReady(true);
+
+	for (int i = 0; i < NUM_CHANNELS; ++i) {
+		Audio::AudioStream *stream = createStream(kind, i, fileData, fileSize, fileDecoder);
+		if (!stream) {
+			Bench::report("%-8s skipped, could not create stream", name);
+			delete _mixer;
+			return;
+		}
+
+		_mixer->playStream((i & 1) ? Audio::Mixer::kMusicSoundType : Audio::Mixer::kSFXSoundType,
+		                   0, stream, -1, Audio::Mixer::kMaxChannelVolume, (i % 3) * 40 - 40, DisposeAfterUse::YES, false, (i & 4) != 0);
+	}
+
+	byte *buffer = new byte[CALLBACK_SAMPLES * 4];
+	uint32 total = 0, worst = 0, allocations = 0;
+
+	for (int cb = 0; cb < CALLBACKS; ++cb) {
+		if (kind == kStreamQueued)
+			feedQueues();
+
+		const uint32 allocStart = Bench::getAllocationCount();
+		const uint32 cbStart = Bench::getMicros();
+		_mixer->mixCallback(buffer, CALLBACK_SAMPLES * 4);
+		const uint32 cbTime = Bench::getMicros() - cbStart;
+		allocations += Bench::getAllocationCount() - allocStart;
+
+		total += cbTime;
+		worst = MAX(worst, cbTime);
+	}
+
+	const double samplesPerSecond = (double)CALLBACKS * CALLBACK_SAMPLES * NUM_CHANNELS * 1000000.0 / MAX<uint32>(total, 1);
+	Bench::report("%-8s %2d channels: %6.1f Msamples/s, %7.1f us/callback (worst %5u us), %5.2f allocations/callback",
+	              name, (int)NUM_CHANNELS, samplesPerSecond / 1000000.0, (double)total / CALLBACKS, worst, (double)allocations / CALLBACKS);
+
+	delete[] buffer;
+	delete _mixer;
+	_mixer = 0;
+}
+
+#if defined(USE_VORBIS) || defined(USE_FLAC) || defined(USE_MAD)
+void MixerBenchmark::runFile(const char *name, const char *fileName, Audio::SeekableAudioStream *(*fileDecoder)(Common::SeekableReadStream *, DisposeAfterUse::Flag)) {
+	const char *dataPath = getenv("SCUMMVM_BENCH_DATA");
+	if (!dataPath) {
+		Bench::report("%-8s skipped, set SCUMMVM_BENCH_DATA to a directory containing %s", name, fileName);
+		return;
+	}
+
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/%s", dataPath, fileName);
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		Bench::report("%-8s skipped, could not open %s", name, path);
+		return;
+	}
+
+	fseek(file, 0, SEEK_END);
+	const long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	byte *data = new byte[size];
+	const bool ok = (fread(data, 1, size, file) == (size_t)size);
+	fclose(file);
+
+	if (ok)
+		runStreams(name, kStreamFile, data, size, fileDecoder);
+	else
+		Bench::report("%-8s skipped, could not read %s", name, path);
+
+	delete[] data;
+}
+#endif
+
+MixerBenchmark mixerBenchmark;
+
+} // End of anonymous namespace
@@ -0,0 +1,143 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "test/bench/bench.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/util.h"
+
+namespace {
+
+/**
+ * Endless triangle wave, cheap enough not to distort the measurement.
+ */
+class TriangleStream : public Audio::AudioStream {
+public:
+	TriangleStream(int rate, bool stereo, int step) : _rate(rate), _stereo(stereo), _step(step), _value(0) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		for (int i = 0; i < numSamples; ++i) {
+			_value += _step;
+			if (_value > 30000 || _value < -30000)
+				_step = -_step;
+			buffer[i] = _value;
+		}
+		return numSamples;
+	}
+
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return false; }
+
+private:
+	const int _rate;
+	const bool _stereo;
+	int _step;
+	int _value;
+};
+
+/**
+ * Mixes 32 channels of typical game audio formats through the rate
+ * converters, once with the plain C mixing code and once with the best
+ * SIMD code for this CPU, as well as through the sinc resamplers, and
+ * reports the cost of one mixer callback.
+ */
+class RateConverterBenchmark : public Bench::Benchmark {
+public:
+	RateConverterBenchmark() : Bench::Benchmark("audio/rate") {}
+
+	void run() {
+		static const uint outputRates[] = { 44100, 48000 };
+
+		for (int i = 0; i < ARRAYSIZE(outputRates); ++i) {
+			runWith(false, outputRates[i], Audio::kResamplerLinear);
+			runWith(true, outputRates[i], Audio::kResamplerLinear);
+			runWith(true, outputRates[i], Audio::kResamplerSinc);
+			runWith(true, outputRates[i], Audio::kResamplerSincFloat);
+		}
+	}
+
+private:
+	enum {
+		NUM_CHANNELS = 32,
+		CALLBACK_SAMPLES = 1024,
+		CALLBACKS = 2000
+	};
+
+	void runWith(bool simd, uint outputRate, Audio::ResamplerType type) {
+		static const char *const typeNames[] = { "linear", "sinc", "sinc_float" };
+
+		// Source formats in rough proportion to what engines play
+		static const struct {
+			int rate;
+			bool stereo;
+		} formats[] = {
+			{ 11025, false }, { 22050, false }, { 22050, true }, { 44100, false },
+			{ 44100, true }, { 48000, true }, { 8000, false }, { 32000, true }
+		};
+
+		Audio::setRateConverterSIMD(simd);
+
+		Audio::AudioStream *streams[NUM_CHANNELS];
+		Audio::RateConverter *converters[NUM_CHANNELS];
+		for (int i = 0; i < NUM_CHANNELS; ++i) {
+			const int f = i % ARRAYSIZE(formats);
+			streams[i] = new TriangleStream(formats[f].rate, formats[f].stereo, 97 + i * 13);
+			converters[i] = Audio::makeRateConverter(formats[f].rate, outputRate, formats[f].stereo, (i & 4) != 0, type);
+		}
+
+		const char *kernelName = Audio::getRateConverterKernelName();
+		Audio::setRateConverterSIMD(true);
+
+		int16 *buffer = new int16[CALLBACK_SAMPLES * 2];
+		uint32 worst = 0;
+		const uint32 start = Bench::getMicros();
+
+		for (int cb = 0; cb < CALLBACKS; ++cb) {
+			const uint32 cbStart = Bench::getMicros();
+			memset(buffer, 0, CALLBACK_SAMPLES * 2 * sizeof(int16));
+			for (int i = 0; i < NUM_CHANNELS; ++i)
+				converters[i]->flow(*streams[i], buffer, CALLBACK_SAMPLES, 200, 180);
+			worst = MAX(worst, Bench::getMicros() - cbStart);
+		}
+
+		const uint32 total = Bench::getMicros() - start;
+		const double perCallback = (double)total / CALLBACKS;
+		const double budget = 1000000.0 * CALLBACK_SAMPLES / outputRate;
+
+		Bench::report("%5u Hz %-10s %-6s %3d channels: %7.1f us/callback (worst %5u us), %5.2f%% of real time",
+		              outputRate, typeNames[type], kernelName, (int)NUM_CHANNELS, perCallback, worst, 100.0 * perCallback / budget);
+
+		delete[] buffer;
+		for (int i = 0; i < NUM_CHANNELS; ++i) {
+			delete converters[i];
+			delete streams[i];
+		}
+	}
+};
+
+RateConverterBenchmark rateConverterBenchmark;
+
+} // End of anonymous namespace
@@ -0,0 +1,554 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Resource files for the corpus are read from the host file system
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "test/bench/bench.h"
+
+#ifdef ENABLE_SCI
+
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/memstream.h"
+#include "common/str.h"
+#include "common/util.h"
+
+#include "engines/sci/decompressor.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef POSIX
+#include <dirent.h>
+#endif
+
+namespace {
+
+typedef Common::Array<byte> Blob;
+
+/** Collects codes of up to 32 bits, either MSB or LSB first. */
+class BitWriter {
+public:
+	BitWriter(bool msbFirst) : _msbFirst(msbFirst), _bits(0), _nBits(0) {}
+
+	void putBits(uint32 value, int n) {
+		for (int i = 0; i < n; i++) {
+			const uint32 bit = _msbFirst ? (value >> (n - 1 - i)) & 1 : (value >> i) & 1;
+			_bits |= _msbFirst ? bit << (7 - _nBits) : bit << _nBits;
+			if (++_nBits == 8) {
+				_data.push_back(_bits);
+				_bits = 0;
+				_nBits = 0;
+			}
+		}
+	}
+
+	void putByte(byte b) { _data.push_back(b); }
+
+	const Blob &finish() {
+		if (_nBits)
+			_data.push_back(_bits);
+		_nBits = 0;
+		return _data;
+	}
+
+private:
+	bool _msbFirst;
+	Blob _data;
+	byte _bits;
+	int _nBits;
+};
+
+/**
+ * Finds earlier occurrences of the data at a given position, for the LZ77
+ * style encoders.
+ */
+class MatchFinder {
+public:
+	MatchFinder(const Blob &data, uint32 window) : _data(data), _window(window) {
+		_prev.resize(data.size());
+		for (int i = 0; i < HASH_SIZE; i++)
+			_head[i] = -1;
+	}
+
+	/** Returns the length of the longest match found, and its distance. */
+	uint32 find(uint32 pos, uint32 maxLength, uint32 &distance) {
+		uint32 best = 0;
+		if (pos + 3 > _data.size())
+			return 0;
+		int candidate = _head[hash(pos)];
+		for (int chain = 0; chain < 16 && candidate >= 0 && pos - candidate <= _window; chain++) {
+			uint32 length = 0;
+			const uint32 limit = MIN<uint32>(maxLength, _data.size() - pos);
+			while (length < limit && _data[candidate + length] == _data[pos + length])
+				length++;
+			if (length > best) {
+				best = length;
+				distance = pos - candidate;
+			}
+			candidate = _prev[candidate];
+		}
+		return best;
+	}
+
+	/** Makes the data at pos available to later matches. */
+	void insert(uint32 pos) {
+		if (pos + 3 > _data.size())
+			return;
+		const uint32 h = hash(pos);
+		_prev[pos] = _head[h];
+		_head[h] = pos;
+	}
+
+private:
+	enum {
+		HASH_SIZE = 4096
+	};
+
+	uint32 hash(uint32 pos) const {
+		return ((_data[pos] << 8) ^ (_data[pos + 1] << 4) ^ _data[pos + 2]) & (HASH_SIZE - 1);
+	}
+
+	const Blob &_data;
+	const uint32 _window;
+	int _head[HASH_SIZE];
+	Common::Array<int> _prev;
+};
+
+#pragma mark -
+
+// Encoders, producing the formats the way the decompressors expect them
+
+/** SCI0 LZW (LSB first) or SCI01/SCI1 LZW1 (MSB first) */
+Blob encodeLZW(const Blob &data, bool lzw1) {
+	BitWriter out(lzw1);
+	Common::HashMap<uint32, uint16> dict;
+	int numBits = 9;
+	uint16 curToken = 0x102, endToken = 0x1ff;
+	int tokens = 0;
+
+	uint16 w = data[0];
+	for (uint32 i = 1; i <= data.size(); i++) {
+		if (i < data.size()) {
+			const uint32 key = (w << 8) | data[i];
+			if (dict.contains(key)) {
+				w = dict[key];
+				continue;
+			}
+		}
+
+		out.putBits(w, numBits);
+
+		// Follow the decompressor's token numbering and code size changes
+		// exactly; the two variants add tokens at different times
+		if (!lzw1) {
+			if (curToken > endToken && numBits < 12) {
+				numBits++;
+				endToken = (endToken << 1) + 1;
+			}
+			if (curToken <= endToken) {
+				if (i < data.size())
+					dict[(w << 8) | data[i]] = curToken;
+				curToken++;
+			}
+		} else {
+			if (tokens++ && curToken <= endToken) {
+				curToken++;
+				if (curToken == endToken && numBits < 12) {
+					numBits++;
+					endToken = (endToken << 1) + 1;
+				}
+			}
+			if (curToken <= endToken && i < data.size())
+				dict[(w << 8) | data[i]] = curToken;
+		}
+
+		if (i < data.size())
+			w = data[i];
+	}
+
+	out.putBits(0x101, numBits);
+	return out.finish();
+}
+
+/** SCI0 Huffman, with a fixed tree: 4 bit codes for the 8 most common bytes */
+Blob encodeHuffman(const Blob &data) {
+	uint32 counts[256];
+	memset(counts, 0, sizeof(counts));
+	for (uint32 i = 0; i < data.size(); i++)
+		counts[data[i]]++;
+
+	int symbols[8];
+	int code[256];
+	for (int i = 0; i < 256; i++)
+		code[i] = -1;
+	for (int s = 0; s < 8; s++) {
+		int best = 0;
+		for (int i = 1; i < 256; i++) {
+			if (code[i] < 0 && (code[best] >= 0 || counts[i] > counts[best]))
+				best = i;
+		}
+		symbols[s] = best;
+		code[best] = s;
+	}
+
+	// Node 0: 0 continues at node 1, 1 escapes to a literal byte. Nodes 1
+	// to 7 form a complete binary tree with the leaves in nodes 8 to 15.
+	static const byte children[8] = { 0x10, 0x12, 0x23, 0x34, 0x45, 0x56, 0x67, 0x78 };
+	BitWriter out(true);
+	out.putByte(16);
+	out.putByte(symbols[0]);	// terminator, as an escaped literal
+	for (int i = 0; i < 8; i++) {
+		out.putByte(0);
+		out.putByte(children[i]);
+	}
+	for (int i = 0; i < 8; i++) {
+		out.putByte(symbols[i]);
+		out.putByte(0);
+	}
+
+	for (uint32 i = 0; i < data.size(); i++) {
+		if (code[data[i]] >= 0)
+			out.putBits(code[data[i]], 4);
+		else
+			out.putBits(0x100 | data[i], 9);
+	}
+	out.putBits(0x100 | symbols[0], 9);
+	return out.finish();
+}
+
+/** STACpack/LZS, as used by SCI32 */
+Blob encodeLZS(const Blob &data) {
+	BitWriter out(true);
+	MatchFinder finder(data, 2047);
+
+	for (uint32 pos = 0; pos < data.size();) {
+		uint32 distance = 0;
+		const uint32 length = finder.find(pos, 255, distance);
+
+		if (length < 2) {
+			out.putBits(data[pos], 9);
+			finder.insert(pos++);
+			continue;
+		}
+
+		if (distance < 128)
+			out.putBits(0x180 | distance, 9);
+		else
+			out.putBits(0x1000 | distance, 13);
+
+		if (length < 5) {
+			out.putBits(length - 2, 2);
+		} else if (length < 8) {
+			out.putBits(0xc | (length - 5), 4);
+		} else {
+			out.putBits(0xf, 4);
+			uint32 rest = length - 8;
+			while (rest >= 15) {
+				out.putBits(0xf, 4);
+				rest -= 15;
+			}
+			out.putBits(rest, 4);
+		}
+
+		for (uint32 i = 0; i < length; i++)
+			finder.insert(pos++);
+	}
+
+	out.putBits(0x180, 9);
+	return out.finish();
+}
+
+/** PKWARE DCL in binary mode with a 4KB dictionary, as used by SCI1.1 */
+Blob encodeDCL(const Blob &data) {
+	// The codes of the length and distance trees in common/dcl.cpp, LSB first
+	static const byte lengthCodes[16][2] = {
+		{ 0x05, 3 }, { 0x03, 2 }, { 0x01, 3 }, { 0x06, 3 }, { 0x0a, 4 }, { 0x02, 4 }, { 0x0c, 4 }, { 0x14, 5 },
+		{ 0x04, 5 }, { 0x18, 5 }, { 0x08, 5 }, { 0x30, 6 }, { 0x10, 6 }, { 0x20, 6 }, { 0x40, 7 }, { 0x00, 7 }
+	};
+	static const byte distanceCodes[64][2] = {
+		{ 0x03, 2 }, { 0x0d, 4 }, { 0x05, 4 }, { 0x19, 5 }, { 0x09, 5 }, { 0x11, 5 }, { 0x01, 5 }, { 0x3e, 6 },
+		{ 0x1e, 6 }, { 0x2e, 6 }, { 0x0e, 6 }, { 0x36, 6 }, { 0x16, 6 }, { 0x26, 6 }, { 0x06, 6 }, { 0x3a, 6 },
+		{ 0x1a, 6 }, { 0x2a, 6 }, { 0x0a, 6 }, { 0x32, 6 }, { 0x12, 6 }, { 0x22, 6 }, { 0x42, 7 }, { 0x02, 7 },
+		{ 0x7c, 7 }, { 0x3c, 7 }, { 0x5c, 7 }, { 0x1c, 7 }, { 0x6c, 7 }, { 0x2c, 7 }, { 0x4c, 7 }, { 0x0c, 7 },
+		{ 0x74, 7 }, { 0x34, 7 }, { 0x54, 7 }, { 0x14, 7 }, { 0x64, 7 }, { 0x24, 7 }, { 0x44, 7 }, { 0x04, 7 },
+		{ 0x78, 7 }, { 0x38, 7 }, { 0x58, 7 }, { 0x18, 7 }, { 0x68, 7 }, { 0x28, 7 }, { 0x48, 7 }, { 0x08, 7 },
+		{ 0xf0, 8 }, { 0x70, 8 }, { 0xb0, 8 }, { 0x30, 8 }, { 0xd0, 8 }, { 0x50, 8 }, { 0x90, 8 }, { 0x10, 8 },
+		{ 0xe0, 8 }, { 0x60, 8 }, { 0xa0, 8 }, { 0x20, 8 }, { 0xc0, 8 }, { 0x40, 8 }, { 0x80, 8 }, { 0x00, 8 }
+	};
+	const int dictBits = 6;
+
+	BitWriter out(false);
+	out.putByte(0);	// binary mode
+	out.putByte(dictBits);
+	MatchFinder finder(data, 1 << (dictBits + 6));
+
+	for (uint32 pos = 0; pos < data.size();) {
+		uint32 distance = 0;
+		uint32 length = finder.find(pos, 518, distance);
+		if (length == 2 && distance > 256)
+			length = 0;
+
+		if (length < 2) {
+			out.putBits(data[pos] << 1, 9);
+			finder.insert(pos++);
+			continue;
+		}
+
+		out.putBits(1, 1);
+		if (length < 10) {
+			out.putBits(lengthCodes[length - 2][0], lengthCodes[length - 2][1]);
+		} else {
+			int value = 8;
+			while (length >= 8 + (2u << (value - 7)))
+				value++;
+			out.putBits(lengthCodes[value][0], lengthCodes[value][1]);
+			out.putBits(length - 8 - (1 << (value - 7)), value - 7);
+		}
+
+		const int lowBits = (length == 2) ? 2 : dictBits;
+		const uint32 d = distance - 1;
+		out.putBits(distanceCodes[d >> lowBits][0], distanceCodes[d >> lowBits][1]);
+		out.putBits(d & ((1 << lowBits) - 1), lowBits);
+
+		for (uint32 i = 0; i < length; i++)
+			finder.insert(pos++);
+	}
+
+	return out.finish();
+}
+
+#pragma mark -
+
+/**
+ * Measures the throughput of the SCI decompressors, in MB of unpacked data
+ * per second. The corpus consists of the files in $SCUMMVM_BENCH_DATA/sci
+ * (e.g. resources written by the diskdump console command), or of data
+ * generated to look like views, pics and scripts if there are none. Each
+ * blob is compressed with every format by the encoders above, then
+ * decompressed repeatedly.
+ */
+class SciDecompressorBenchmark : public Bench::Benchmark {
+public:
+	SciDecompressorBenchmark() : Bench::Benchmark("sci/decompressor") {}
+
+	void run() {
+		Common::Array<Blob> corpus;
+		const char *source = loadCorpus(corpus);
+		if (corpus.empty()) {
+			source = "generated";
+			generateCorpus(corpus);
+		}
+
+		uint32 total = 0;
+		for (uint i = 0; i < corpus.size(); i++)
+			total += corpus[i].size();
+		Bench::report("corpus: %d %s blobs, %d KB", corpus.size(), source, total / 1024);
+
+		runFormat("Huffman", corpus, encodeHuffman, Sci::kCompHuffman);
+		runFormat("LZW", corpus, encodeLZW0, Sci::kCompLZW);
+		runFormat("LZW1", corpus, encodeLZW1, Sci::kCompLZW1);
+		runFormat("DCL", corpus, encodeDCL, Sci::kCompDCL);
+#ifdef ENABLE_SCI32
+		runFormat("LZS", corpus, encodeLZS, Sci::kCompSTACpack);
+#endif
+	}
+
+private:
+	enum {
+		/** Number of bytes unpacked per format, at least */
+		UNPACKED_BYTES = 64 * 1024 * 1024
+	};
+
+	static Blob encodeLZW0(const Blob &data) { return encodeLZW(data, false); }
+	static Blob encodeLZW1(const Blob &data) { return encodeLZW(data, true); }
+
+	static Sci::Decompressor *createDecompressor(Sci::ResourceCompression compression) {
+		switch (compression) {
+		case Sci::kCompHuffman:
+			return new Sci::DecompressorHuffman;
+		case Sci::kCompLZW:
+		case Sci::kCompLZW1:
+			return new Sci::DecompressorLZW(compression);
+		case Sci::kCompDCL:
+			return new Sci::DecompressorDCL;
+#ifdef ENABLE_SCI32
+		case Sci::kCompSTACpack:
+			return new Sci::DecompressorLZS;
+#endif
+		default:
+			return 0;
+		}
+	}
+
+	void runFormat(const char *name, const Common::Array<Blob> &corpus, Blob (*encode)(const Blob &), Sci::ResourceCompression compression) {
+		Common::Array<Blob> packed;
+		uint32 packedSize = 0, unpackedSize = 0;
+		for (uint i = 0; i < corpus.size(); i++) {
+			packed.push_back(encode(corpus[i]));
+			packedSize += packed[i].size();
+			unpackedSize += corpus[i].size();
+		}
+
+		const uint rounds = MAX<uint>(1, UNPACKED_BYTES / MAX<uint32>(unpackedSize, 1));
+		byte *buffer = new byte[MAX<uint32>(unpackedSize, 1)];
+		bool ok = true;
+		uint32 time = 0;
+
+		for (uint r = 0; r < rounds; r++) {
+			for (uint i = 0; i < corpus.size(); i++) {
+				Common::MemoryReadStream stream(packed[i].begin(), packed[i].size());
+				Sci::Decompressor *decompressor = createDecompressor(compression);
+
+				const uint32 start = Bench::getMicros();
+				const int error = decompressor->unpack(&stream, buffer, packed[i].size(), corpus[i].size());
+				time += Bench::getMicros() - start;
+
+				if (r == 0 && (error || memcmp(buffer, corpus[i].begin(), corpus[i].size())))
+					ok = false;
+				delete decompressor;
+			}
+		}
+
+		const double megabytes = (double)rounds * unpackedSize / (1024 * 1024);
+		Bench::report("%-8s %7.1f MB/s, packed to %5.1f%%%s", name, megabytes * 1000000.0 / MAX<uint32>(time, 1),
+		              packedSize * 100.0 / MAX<uint32>(unpackedSize, 1), ok ? "" : ", OUTPUT MISMATCH");
+		delete[] buffer;
+	}
+
+	static const char *loadCorpus(Common::Array<Blob> &corpus) {
+#ifdef POSIX
+		const char *dataPath = getenv("SCUMMVM_BENCH_DATA");
+		if (!dataPath)
+			return 0;
+
+		const Common::String path = Common::String::format("%s/sci", dataPath);
+		DIR *dir = opendir(path.c_str());
+		if (!dir)
+			return 0;
+
+		struct dirent *entry;
+		while ((entry = readdir(dir)) != 0) {
+			const Common::String fileName = path + "/" + entry->d_name;
+			FILE *file = fopen(fileName.c_str(), "rb");
+			if (!file)
+				continue;
+
+			Blob blob;
+			byte buffer[4096];
+			size_t bytesRead;
+			while ((bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+				for (size_t i = 0; i < bytesRead; i++)
+					blob.push_back(buffer[i]);
+			}
+			fclose(file);
+
+			// The decompressors are limited to 64KB in SCI0 to SCI1.1
+			if (blob.size() > 2 && blob.size() <= 0xffff)
+				corpus.push_back(blob);
+		}
+		closedir(dir);
+		return "$SCUMMVM_BENCH_DATA/sci";
+#else
+		return 0;
+#endif
+	}
+
+	static void generateCorpus(Common::Array<Blob> &corpus) {
+		uint32 seed = 42;
+
+		// Views: rows of runs in a few colors, each row similar to the last
+		for (int v = 0; v < 8; v++) {
+			Blob view;
+			byte row[160];
+			memset(row, 0xff, sizeof(row));
+			for (int y = 0; y < 120; y++) {
+				for (int x = 0; x < 160;) {
+					seed = seed * 1103515245 + 12345;
+					const int run = 1 + (seed >> 16) % 12;
+					const bool change = ((seed >> 8) & 7) == 0;
+					for (int i = 0; i < run && x < 160; i++, x++) {
+						if (change)
+							row[x] = (seed >> 24) & 0x3f;
+						view.push_back(row[x]);
+					}
+				}
+			}
+			corpus.push_back(view);
+		}
+
+		// Pics: drawing opcodes with coordinates
+		for (int p = 0; p < 4; p++) {
+			Blob pic;
+			while (pic.size() < 24000) {
+				seed = seed * 1103515245 + 12345;
+				pic.push_back(0xf0 + ((seed >> 16) & 0x0e));
+				const int points = 2 + (seed >> 20) % 16;
+				int x = (seed >> 8) % 320, y = (seed >> 12) % 190;
+				for (int i = 0; i < points; i++) {
+					seed = seed * 1103515245 + 12345;
+					x = CLIP<int>(x + (int)((seed >> 16) % 9) - 4, 0, 319);
+					y = CLIP<int>(y + (int)((seed >> 20) % 9) - 4, 0, 189);
+					pic.push_back(((x >> 4) & 0xf0) | (y >> 4));
+					pic.push_back(x & 0xff);
+					pic.push_back(y & 0xff);
+				}
+			}
+			corpus.push_back(pic);
+		}
+
+		// Scripts: byte code and strings
+		static const char *const words[] = {
+			"the", "you", "door", "look", "open", "room", "can't", "Roger", "there", "is",
+			"nothing", "special", "about", "it", "Larry", "take", "key", "Graham", "a", "of"
+		};
+		for (int s = 0; s < 4; s++) {
+			Blob script;
+			while (script.size() < 16000) {
+				seed = seed * 1103515245 + 12345;
+				if ((seed >> 16) % 4) {
+					static const byte ops[] = { 0x39, 0x38, 0x76, 0x72, 0x4a, 0x43, 0x63, 0x35, 0x8b, 0x89 };
+					script.push_back(ops[(seed >> 20) % ARRAYSIZE(ops)]);
+					script.push_back((seed >> 8) & 0x1f);
+					if ((seed >> 24) & 1)
+						script.push_back(0);
+				} else {
+					for (int w = 2 + (seed >> 20) % 8; w > 0; w--) {
+						seed = seed * 1103515245 + 12345;
+						const char *word = words[(seed >> 16) % ARRAYSIZE(words)];
+						while (*word)
+							script.push_back(*word++);
+						script.push_back(w > 1 ? ' ' : 0);
+					}
+				}
+			}
+			corpus.push_back(script);
+		}
+	}
+};
+
+SciDecompressorBenchmark sciDecompressorBenchmark;
+
+} // End of anonymous namespace
+
+#endif
@@ -0,0 +1,268 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Polygon sets are read from the host file system
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "test/bench/bench.h"
+
+#ifdef ENABLE_SCI
+
+#include "common/array.h"
+#include "common/str.h"
+#include "common/util.h"
+
+#include "engines/sci/engine/pathfinding.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef POSIX
+#include <dirent.h>
+#endif
+
+namespace {
+
+typedef Common::Array<Sci::PathfindingQuery> QueryList;
+
+/**
+ * Measures how many paths per second kAvoidPath can find, with and without
+ * the visibility graph cache. The queries are read from the output of the
+ * avoidpath debug channel (e.g. "scummvm -d1 --debugflags=avoidpath"),
+ * stored in $SCUMMVM_BENCH_DATA/avoidpath, or generated to look like rooms
+ * with a walkable area and some obstacles if there are none.
+ */
+class SciPathfindingBenchmark : public Bench::Benchmark {
+public:
+	SciPathfindingBenchmark() : Bench::Benchmark("sci/pathfinding") {}
+
+	void run() {
+		QueryList queries;
+		if (loadQueries(queries)) {
+			runQueries("logged", queries);
+			return;
+		}
+
+		static const int obstacleCounts[] = { 4, 12, 24 };
+		for (int i = 0; i < ARRAYSIZE(obstacleCounts); i++) {
+			generateQueries(queries, obstacleCounts[i]);
+			runQueries(Common::String::format("%d obstacles", obstacleCounts[i]).c_str(), queries);
+		}
+	}
+
+private:
+	enum {
+		/** Number of paths searched per query set and mode, at least */
+		MIN_PATHS = 2000
+	};
+
+	void runQueries(const char *name, const QueryList &queries) {
+		if (queries.empty())
+			return;
+
+		uint vertices = 0;
+		for (uint i = 0; i < queries.size(); i++) {
+			for (uint j = 0; j < queries[i].polygons.size(); j++)
+				vertices += queries[i].polygons[j].points.size();
+		}
+
+		const uint rounds = MAX<uint>(1, MIN_PATHS / queries.size());
+		Common::Array<Common::Array<Common::Point> > uncachedPaths, cachedPaths;
+
+		const uint32 uncachedTime = searchPaths(queries, rounds, 0, uncachedPaths);
+
+		Sci::PathfindingCache cache;
+		const uint32 cachedTime = searchPaths(queries, rounds, &cache, cachedPaths);
+		const Sci::PathfindingCache::Statistics &stats = cache.getStatistics();
+
+		bool ok = true;
+		for (uint i = 0; i < queries.size(); i++) {
+			if (!(uncachedPaths[i] == cachedPaths[i]))
+				ok = false;
+		}
+
+		const double paths = (double)rounds * queries.size();
+		Bench::report("%-12s %4d queries, %5.1f vertices: %8.0f paths/s uncached, %8.0f paths/s cached, %3d%% hits%s",
+		              name, queries.size(), (double)vertices / queries.size(),
+		              paths * 1000000.0 / MAX<uint32>(uncachedTime, 1), paths * 1000000.0 / MAX<uint32>(cachedTime, 1),
+		              (int)(stats.hits * 100.0 / MAX<uint32>(stats.hits + stats.misses + stats.uncached, 1)),
+		              ok ? "" : ", PATH MISMATCH");
+	}
+
+	static uint32 searchPaths(const QueryList &queries, uint rounds, Sci::PathfindingCache *cache, Common::Array<Common::Array<Common::Point> > &paths) {
+		paths.resize(queries.size());
+		uint32 time = 0;
+
+		for (uint r = 0; r < rounds; r++) {
+			for (uint i = 0; i < queries.size(); i++) {
+				const uint32 start = Bench::getMicros();
+				if (!Sci::findPath(queries[i], cache, paths[i]))
+					paths[i].clear();
+				time += Bench::getMicros() - start;
+			}
+		}
+
+		return time;
+	}
+
+	/**
+	 * Parses the lines logged by print_input() in kpathing.cpp. Each query
+	 * starts with a "Start point" line.
+	 */
+	static void parseLine(const char *line, QueryList &queries) {
+		int x, y, value, width, height;
+
+		if (sscanf(line, "Start point: (%d, %d)", &x, &y) == 2) {
+			queries.push_back(Sci::PathfindingQuery());
+			queries.back().start = Common::Point(x, y);
+			return;
+		}
+
+		if (queries.empty())
+			return;
+
+		Sci::PathfindingQuery &query = queries.back();
+		if (sscanf(line, "End point: (%d, %d)", &x, &y) == 2) {
+			query.end = Common::Point(x, y);
+		} else if (sscanf(line, "Optimization level: %d", &value) == 1) {
+			query.opt = value;
+		} else if (sscanf(line, "Screen size: %dx%d", &width, &height) == 2) {
+			query.width = width;
+			query.height = height;
+		} else if (sscanf(line, "%d:", &value) == 1 && strchr(line, '(')) {
+			Sci::PathfindingPolygon polygon;
+			polygon.type = value;
+
+			const char *point = strchr(line, '(');
+			while (point && sscanf(point, "(%d, %d)", &x, &y) == 2) {
+				polygon.points.push_back(Common::Point(x, y));
+				point = strchr(point + 1, '(');
+			}
+
+			// The first point is repeated at the end
+			if (polygon.points.size() > 1)
+				polygon.points.pop_back();
+			query.polygons.push_back(polygon);
+		}
+	}
+
+	static bool loadQueries(QueryList &queries) {
+#ifdef POSIX
+		const char *dataPath = getenv("SCUMMVM_BENCH_DATA");
+		if (!dataPath)
+			return false;
+
+		const Common::String path = Common::String::format("%s/avoidpath", dataPath);
+		DIR *dir = opendir(path.c_str());
+		if (!dir)
+			return false;
+
+		struct dirent *entry;
+		while ((entry = readdir(dir)) != 0) {
+			const Common::String fileName = path + "/" + entry->d_name;
+			FILE *file = fopen(fileName.c_str(), "r");
+			if (!file)
+				continue;
+
+			char line[4096];
+			while (fgets(line, sizeof(line), file))
+				parseLine(line, queries);
+			fclose(file);
+		}
+		closedir(dir);
+		return !queries.empty();
+#else
+		return false;
+#endif
+	}
+
+	static int random(uint32 &seed, int max) {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 16) % max;
+	}
+
+	static void addPolygon(Sci::PathfindingPolygonSet &polygons, int type, int x, int y, int radiusX, int radiusY, int corners, uint32 &seed) {
+		Sci::PathfindingPolygon polygon;
+		polygon.type = type;
+
+		for (int i = 0; i < corners; i++) {
+			const double angle = 2 * M_PI * i / corners;
+			const int scale = 80 + random(seed, 21);
+			polygon.points.push_back(Common::Point(CLIP<int>(x + (int)(cos(angle) * radiusX * scale / 100), 0, 319),
+			                                       CLIP<int>(y + (int)(sin(angle) * radiusY * scale / 100), 0, 189)));
+		}
+
+		polygons.push_back(polygon);
+	}
+
+	/**
+	 * Generates a room with a walkable area and obstacles in it, and
+	 * random walks through it. The room stays the same for all queries,
+	 * as it does in the games.
+	 */
+	static void generateQueries(QueryList &queries, int obstacles) {
+		uint32 seed = 42 + obstacles;
+		queries.clear();
+
+		Sci::PathfindingPolygonSet polygons;
+		addPolygon(polygons, Sci::POLY_CONTAINED_ACCESS, 160, 110, 150, 75, 14, seed);
+
+		int centers[32][3];
+		int placed = 0;
+		for (int tries = 0; placed < obstacles && placed < ARRAYSIZE(centers) && tries < 1000; tries++) {
+			const int radius = 6 + random(seed, 12);
+			const int x = 40 + random(seed, 240);
+			const int y = 60 + random(seed, 100);
+
+			bool overlaps = false;
+			for (int i = 0; i < placed; i++) {
+				if (ABS(centers[i][0] - x) < centers[i][2] + radius + 4 && ABS(centers[i][1] - y) < centers[i][2] + radius + 4)
+					overlaps = true;
+			}
+			if (overlaps)
+				continue;
+
+			centers[placed][0] = x;
+			centers[placed][1] = y;
+			centers[placed][2] = radius;
+			placed++;
+
+			addPolygon(polygons, (placed % 4) ? Sci::POLY_BARRED_ACCESS : Sci::POLY_NEAREST_ACCESS,
+			           x, y, radius, radius, 4 + random(seed, 5), seed);
+		}
+
+		for (int i = 0; i < 100; i++) {
+			Sci::PathfindingQuery query;
+			query.polygons = polygons;
+			query.start = Common::Point(20 + random(seed, 280), 40 + random(seed, 140));
+			query.end = Common::Point(20 + random(seed, 280), 40 + random(seed, 140));
+			queries.push_back(query);
+		}
+	}
+};
+
+SciPathfindingBenchmark sciPathfindingBenchmark;
+
+} // End of anonymous namespace
+
+#endif
@@ -0,0 +1,391 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Wiz images are read from the host file system
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "test/bench/bench.h"
+
+#if defined(ENABLE_SCUMM) && defined(ENABLE_HE)
+
+#include "common/array.h"
+#include "common/endian.h"
+#include "common/str.h"
+#include "common/util.h"
+
+#include "engines/scumm/he/wiz_he.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef POSIX
+#include <dirent.h>
+#endif
+
+namespace {
+
+struct WizSample {
+	int width;
+	int height;
+	Common::Array<uint8> data;
+};
+
+typedef Common::Array<WizSample> WizSampleList;
+
+/**
+ * Measures how long it takes to draw a frame full of compressed Wiz images,
+ * decoding them from their RLE data each time, and drawing them from the
+ * decoded image cache. The images are read from files holding AWIZ blocks
+ * in $SCUMMVM_BENCH_DATA/wiz, or generated to look like sprites if there
+ * are none.
+ *
+ * The engine draws the RLE data with Wiz::decompressWizImage(), which can't
+ * be linked without the rest of the engine, so the "RLE" numbers come from a
+ * copy of its original per pixel loop.
+ */
+class ScummWizBenchmark : public Bench::Benchmark {
+public:
+	ScummWizBenchmark() : Bench::Benchmark("scumm/wiz") {}
+
+	void run() {
+		WizSampleList samples;
+		const char *name = "logged";
+		if (!loadSamples(samples)) {
+			generateSamples(samples);
+			name = "generated";
+		}
+
+		uint8 palette[256];
+		for (int i = 0; i < 256; i++)
+			palette[i] = 255 - i;
+
+		runFrames(name, samples, palette);
+	}
+
+private:
+	enum {
+		SCREEN_WIDTH = 640,
+		SCREEN_HEIGHT = 480,
+		SPRITES_PER_FRAME = 200,
+		FRAMES = 200
+	};
+
+	struct Placement {
+		int sample;
+		int x;
+		int y;
+		int flags;
+	};
+
+	static void runFrames(const char *name, const WizSampleList &samples, const uint8 *palette) {
+		if (samples.empty())
+			return;
+
+		uint32 seed = 3;
+		Common::Array<Placement> placements;
+		uint32 pixels = 0;
+		for (int i = 0; i < SPRITES_PER_FRAME * FRAMES; i++) {
+			Placement p;
+			p.sample = nextRandom(seed) % samples.size();
+			const WizSample &sample = samples[p.sample];
+			p.x = (int)(nextRandom(seed) % (SCREEN_WIDTH + sample.width)) - sample.width;
+			p.y = (int)(nextRandom(seed) % (SCREEN_HEIGHT + sample.height)) - sample.height;
+			p.flags = (nextRandom(seed) & 1) ? Scumm::kWIFFlipX : 0;
+			placements.push_back(p);
+			pixels += sample.width * sample.height;
+		}
+
+		Common::Array<uint8> rleScreen, cachedScreen;
+		rleScreen.resize(SCREEN_WIDTH * SCREEN_HEIGHT);
+		cachedScreen.resize(SCREEN_WIDTH * SCREEN_HEIGHT);
+
+		uint32 start = Bench::getMicros();
+		for (uint i = 0; i < placements.size(); i++) {
+			const Placement &p = placements[i];
+			const WizSample &sample = samples[p.sample];
+			drawRLE(&rleScreen[0], &sample.data[0], sample.width, sample.height, p.x, p.y, p.flags, palette);
+		}
+		const uint32 rleTime = Bench::getMicros() - start;
+
+		Scumm::WizImageCache cache;
+		start = Bench::getMicros();
+		for (uint i = 0; i < placements.size(); i++) {
+			const Placement &p = placements[i];
+			const WizSample &sample = samples[p.sample];
+			const Scumm::DecodedWizImage *image = cache.getImage(p.sample, 0, &sample.data[0], sample.width, sample.height, palette, 1);
+			if (image)
+				drawDecoded(&cachedScreen[0], *image, p.x, p.y, p.flags);
+			else
+				drawRLE(&cachedScreen[0], &sample.data[0], sample.width, sample.height, p.x, p.y, p.flags, palette);
+		}
+		const uint32 cachedTime = Bench::getMicros() - start;
+		const Scumm::WizImageCache::Statistics &stats = cache.getStatistics();
+
+		Bench::report("%-10s %3d images, %5.0f pixels/image: %7.1f us/frame RLE, %7.1f us/frame cached, %3d%% hits, %4d KB%s",
+		              name, samples.size(), (double)pixels / placements.size(),
+		              (double)rleTime / FRAMES, (double)cachedTime / FRAMES,
+		              (int)(stats.hits * 100.0 / MAX<uint32>(stats.hits + stats.misses, 1)), cache.getMemory() / 1024,
+		              rleScreen == cachedScreen ? "" : ", IMAGE MISMATCH");
+	}
+
+	/** Clips an image to the screen, like calcClipRects() in wiz_he.cpp */
+	static bool clip(int width, int height, int x, int y, int flags, Common::Rect &srcRect, Common::Rect &dstRect) {
+		Common::Rect r(x, y, x + width, y + height);
+		const Common::Rect screen(SCREEN_WIDTH, SCREEN_HEIGHT);
+		if (!r.intersects(screen))
+			return false;
+		r.clip(screen);
+
+		srcRect = Common::Rect(r.left - x, r.top - y, r.right - x, r.bottom - y);
+		dstRect = r;
+		if (flags & Scumm::kWIFFlipX) {
+			const int dx = (x < 0) ? x : (width - srcRect.width());
+			srcRect.translate(dx, 0);
+		}
+		return true;
+	}
+
+	static void drawDecoded(uint8 *screen, const Scumm::DecodedWizImage &image, int x, int y, int flags) {
+		Common::Rect srcRect, dstRect;
+		if (clip(image.width, image.height, x, y, flags, srcRect, dstRect))
+			Scumm::WizImageCache::drawImage(image, screen + dstRect.top * SCREEN_WIDTH + dstRect.left, SCREEN_WIDTH, Scumm::kDstScreen, srcRect, flags);
+	}
+
+	/** The remapping case of Wiz::decompressWizImage(), as it was before it wrote whole runs */
+	static void drawRLE(uint8 *screen, const uint8 *src, int width, int height, int x, int y, int flags, const uint8 *palPtr) {
+		Common::Rect srcRect, dstRect;
+		if (!clip(width, height, x, y, flags, srcRect, dstRect))
+			return;
+
+		const uint8 *dataPtr = src, *dataPtrNext;
+		uint8 code, *dstPtr = screen + dstRect.top * SCREEN_WIDTH + dstRect.left, *dstPtrNext;
+		int h, w, xoff, dstInc = 1;
+
+		h = srcRect.top;
+		while (h--)
+			dataPtr += READ_LE_UINT16(dataPtr) + 2;
+		h = srcRect.height();
+		w = srcRect.width();
+		if (flags & Scumm::kWIFFlipX) {
+			dstPtr += w - 1;
+			dstInc = -1;
+		}
+
+		while (h--) {
+			xoff = srcRect.left;
+			w = srcRect.width();
+			uint16 lineSize = READ_LE_UINT16(dataPtr); dataPtr += 2;
+			dstPtrNext = dstPtr + SCREEN_WIDTH;
+			dataPtrNext = dataPtr + lineSize;
+			if (lineSize != 0) {
+				while (w > 0) {
+					code = *dataPtr++;
+					if (code & 1) {
+						code >>= 1;
+						if (xoff > 0) {
+							xoff -= code;
+							if (xoff >= 0)
+								continue;
+							code = -xoff;
+						}
+						dstPtr += dstInc * code;
+						w -= code;
+					} else if (code & 2) {
+						code = (code >> 2) + 1;
+						if (xoff > 0) {
+							xoff -= code;
+							++dataPtr;
+							if (xoff >= 0)
+								continue;
+							code = -xoff;
+							--dataPtr;
+						}
+						w -= code;
+						if (w < 0)
+							code += w;
+						while (code--) {
+							*dstPtr = palPtr[*dataPtr];
+							dstPtr += dstInc;
+						}
+						dataPtr++;
+					} else {
+						code = (code >> 2) + 1;
+						if (xoff > 0) {
+							xoff -= code;
+							dataPtr += code;
+							if (xoff >= 0)
+								continue;
+							code = -xoff;
+							dataPtr += xoff;
+						}
+						w -= code;
+						if (w < 0)
+							code += w;
+						while (code--) {
+							*dstPtr = palPtr[*dataPtr];
+							dataPtr++;
+							dstPtr += dstInc;
+						}
+					}
+				}
+			}
+			dataPtr = dataPtrNext;
+			dstPtr = dstPtrNext;
+		}
+	}
+
+	static uint32 nextRandom(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 16;
+	}
+
+	/**
+	 * Generates sprites: ellipses with a few flat colored areas and some
+	 * noise, surrounded by transparent pixels, which compress like the
+	 * sprites of the HE games do.
+	 */
+	static void generateSamples(WizSampleList &samples) {
+		uint32 seed = 11;
+		for (int i = 0; i < 48; i++) {
+			WizSample sample;
+			sample.width = 16 + nextRandom(seed) % 112;
+			sample.height = 16 + nextRandom(seed) % 112;
+
+			Common::Array<uint8> pixels;
+			Common::Array<bool> opaque;
+			pixels.resize(sample.width * sample.height);
+			opaque.resize(sample.width * sample.height);
+			for (int y = 0; y < sample.height; y++) {
+				for (int x = 0; x < sample.width; x++) {
+					const int dx = 2 * x - sample.width, dy = 2 * y - sample.height;
+					opaque[y * sample.width + x] = dx * dx * sample.height * sample.height + dy * dy * sample.width * sample.width < sample.width * sample.width * sample.height * sample.height;
+					pixels[y * sample.width + x] = (nextRandom(seed) % 4) ? 16 + (y * 4 / sample.height) * 8 : nextRandom(seed) & 0xff;
+				}
+			}
+
+			compress(sample, pixels, opaque);
+			samples.push_back(sample);
+		}
+	}
+
+	/** Compresses an image the way the Wiz images of compression type 1 are */
+	static void compress(WizSample &sample, const Common::Array<uint8> &pixels, const Common::Array<bool> &opaque) {
+		for (int y = 0; y < sample.height; y++) {
+			Common::Array<uint8> line;
+			const uint8 *p = &pixels[y * sample.width];
+			const bool *o = &opaque[y * sample.width];
+
+			int x = 0;
+			while (x < sample.width) {
+				int n = 1;
+				if (!o[x]) {
+					while (x + n < sample.width && !o[x + n] && n < 127)
+						n++;
+					line.push_back((n << 1) | 1);
+				} else if (x + 1 < sample.width && o[x + 1] && p[x + 1] == p[x]) {
+					while (x + n < sample.width && o[x + n] && p[x + n] == p[x] && n < 64)
+						n++;
+					line.push_back(((n - 1) << 2) | 2);
+					line.push_back(p[x]);
+				} else {
+					while (x + n < sample.width && o[x + n] && n < 64 && !(x + n + 1 < sample.width && p[x + n + 1] == p[x + n]))
+						n++;
+					line.push_back((n - 1) << 2);
+					for (int i = 0; i < n; i++)
+						line.push_back(p[x + i]);
+				}
+				x += n;
+			}
+
+			sample.data.push_back(line.size() & 0xff);
+			sample.data.push_back(line.size() >> 8);
+			for (uint i = 0; i < line.size(); i++)
+				sample.data.push_back(line[i]);
+		}
+	}
+
+	/** Finds the WIZH and WIZD blocks of compressed images in a file */
+	static void parseFile(const Common::Array<uint8> &file, WizSampleList &samples) {
+		int width = 0, height = 0, comp = -1;
+		for (uint pos = 0; pos + 8 <= file.size(); pos++) {
+			const uint32 tag = READ_BE_UINT32(&file[pos]);
+			const uint32 size = READ_BE_UINT32(&file[pos + 4]);
+			if (size < 8 || pos + size > file.size())
+				continue;
+
+			if (tag == MKTAG('W','I','Z','H') && size >= 20) {
+				comp = READ_LE_UINT32(&file[pos + 8]);
+				width = READ_LE_UINT32(&file[pos + 12]);
+				height = READ_LE_UINT32(&file[pos + 16]);
+			} else if (tag == MKTAG('W','I','Z','D') && comp == 1 && width > 0 && height > 0) {
+				WizSample sample;
+				sample.width = width;
+				sample.height = height;
+				sample.data.resize(size - 8);
+				memcpy(&sample.data[0], &file[pos + 8], size - 8);
+				samples.push_back(sample);
+				comp = -1;
+			}
+		}
+	}
+
+	static bool loadSamples(WizSampleList &samples) {
+#ifdef POSIX
+		const char *dataPath = getenv("SCUMMVM_BENCH_DATA");
+		if (!dataPath)
+			return false;
+
+		const Common::String path = Common::String::format("%s/wiz", dataPath);
+		DIR *dir = opendir(path.c_str());
+		if (!dir)
+			return false;
+
+		struct dirent *entry;
+		while ((entry = readdir(dir)) != 0) {
+			const Common::String fileName = path + "/" + entry->d_name;
+			FILE *file = fopen(fileName.c_str(), "rb");
+			if (!file)
+				continue;
+
+			Common::Array<uint8> data;
+			uint8 buffer[4096];
+			size_t read;
+			while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+				for (size_t i = 0; i < read; i++)
+					data.push_back(buffer[i]);
+			}
+			fclose(file);
+			parseFile(data, samples);
+		}
+		closedir(dir);
+		return !samples.empty();
+#else
+		return false;
+#endif
+	}
+};
+
+ScummWizBenchmark scummWizBenchmark;
+
+} // End of anonymous namespace
+
+#endif
@@ -0,0 +1,134 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "test/bench/bench.h"
+
+#include "common/str.h"
+
+namespace {
+
+// The patterns measured below. Each returns the length of what it built,
+// so that the compiler cannot drop the work.
+
+const char *const kDirectory = "/home/user/games/space-quest-6";
+
+struct FormatShort {
+	uint operator()(int i) const {
+		return Common::String::format("resource.%03d", i % 1000).size();
+	}
+};
+
+struct FormatLong {
+	uint operator()(int i) const {
+		return Common::String::format("%s/%s.%03d", kDirectory, "resource", i % 1000).size();
+	}
+};
+
+struct JoinOperatorPlus {
+	uint operator()(int i) const {
+		const Common::String dir(kDirectory), name("resource");
+		return (dir + "/" + name + ".map").size();
+	}
+};
+
+struct JoinAppend {
+	uint operator()(int i) const {
+		const Common::String dir(kDirectory), name("resource");
+		Common::String path;
+		path.reserve(dir.size() + name.size() + 5);
+		path += dir;
+		path += '/';
+		path += name;
+		path += ".map";
+		return path.size();
+	}
+};
+
+struct BuildFormatConcat {
+	uint operator()(int i) const {
+		Common::String list;
+		for (int k = 0; k < 16; ++k)
+			list += Common::String::format("%d, ", i + k);
+		return list.size();
+	}
+};
+
+struct BuildAppendFormat {
+	uint operator()(int i) const {
+		Common::String list;
+		for (int k = 0; k < 16; ++k)
+			list.appendFormat("%d, ", i + k);
+		return list.size();
+	}
+};
+
+struct CopyShort {
+	uint operator()(int i) const {
+		static const Common::String str("Sierra On-Line presents");
+		const Common::String copy(str);
+		return copy.size();
+	}
+};
+
+/**
+ * Measures time and heap allocations per operation for common ways of
+ * building Strings: formatting, joining paths and accumulating a list,
+ * each with the temporary-heavy and with the in-place variant.
+ */
+class StringBenchmark : public Bench::Benchmark {
+public:
+	StringBenchmark() : Bench::Benchmark("common/string") {}
+
+	void run() {
+		measure("format short", FormatShort());
+		measure("format long", FormatLong());
+		measure("path join operator+", JoinOperatorPlus());
+		measure("path join append", JoinAppend());
+		measure("list += format()", BuildFormatConcat());
+		measure("list appendFormat()", BuildAppendFormat());
+		measure("copy short", CopyShort());
+	}
+
+private:
+	enum {
+		OPERATIONS = 200000
+	};
+
+	template<class Op>
+	void measure(const char *name, Op op) {
+		uint checksum = 0;
+
+		const uint32 allocations = Bench::getAllocationCount();
+		const uint32 start = Bench::getMicros();
+		for (int i = 0; i < OPERATIONS; ++i)
+			checksum += op(i);
+		const uint32 time = Bench::getMicros() - start;
+		const uint32 allocated = Bench::getAllocationCount() - allocations;
+
+		Bench::report("%-20s %7.1f ns, %5.2f allocations per operation (%u)",
+		              name, time * 1000.0 / OPERATIONS, (double)allocated / OPERATIONS, checksum & 1);
+	}
+};
+
+StringBenchmark stringBenchmark;
+
+} // End of anonymous namespace
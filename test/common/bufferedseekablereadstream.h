@@ -74,4 +74,32 @@ class BufferedSeekableReadStreamTestSuite : public CxxTest::TestSuite {
 
 		delete &ssrs;
 	}
+
+	void test_stream_buffer_fallback() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::SeekableReadStream &ssrs
+			= *Common::wrapBufferedSeekableReadStream(&ms, 4, DisposeAfterUse::NO);
+
+		// The buffered stream offers no direct access, so the data is copied
+		ssrs.seek(3);
+		{
+			Common::StreamBuffer buf(ssrs, 5);
+			TS_ASSERT(buf.isCopy());
+			TS_ASSERT_EQUALS(buf.size(), 5U);
+			TS_ASSERT_EQUALS(memcmp(buf.getData(), contents + 3, 5), 0);
+			TS_ASSERT_EQUALS(ssrs.pos(), 8);
+		}
+
+		// Near the end of the stream, we only get what is left
+		{
+			Common::StreamBuffer buf(ssrs, 5);
+			TS_ASSERT_EQUALS(buf.size(), 2U);
+			TS_ASSERT_EQUALS(buf.getData()[1], 9);
+			TS_ASSERT(ssrs.eos());
+		}
+
+		delete &ssrs;
+	}
 };
@@ -0,0 +1,84 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memorypool.h"
+
+class MemoryPoolTestSuite : public CxxTest::TestSuite {
+public:
+	void test_shared_pool_stats() {
+		Common::SharedMemoryPool pool("test", 12);
+		void *chunks[20];
+
+		for (int i = 0; i < 20; ++i) {
+			chunks[i] = pool.allocChunk();
+			TS_ASSERT(chunks[i] != 0);
+			memset(chunks[i], i, 12);
+		}
+
+		for (int i = 0; i < 10; ++i)
+			pool.freeChunk(chunks[i]);
+
+		Common::SharedMemoryPool::Stats stats = pool.getStats();
+		TS_ASSERT_EQUALS(stats.live, 10U);
+		TS_ASSERT_EQUALS(stats.peak, 20U);
+		TS_ASSERT_EQUALS(stats.allocations, 20U);
+		TS_ASSERT(stats.pages > 0);
+
+		// Freed chunks are reused before new pages are allocated
+		const uint32 pages = stats.pages;
+		for (int i = 0; i < 10; ++i)
+			chunks[i] = pool.allocChunk();
+		stats = pool.getStats();
+		TS_ASSERT_EQUALS(stats.live, 20U);
+		TS_ASSERT_EQUALS(stats.peak, 20U);
+		TS_ASSERT_EQUALS(stats.pages, pages);
+
+		for (int i = 0; i < 20; ++i)
+			pool.freeChunk(chunks[i]);
+		pool.freeUnusedPages();
+		stats = pool.getStats();
+		TS_ASSERT_EQUALS(stats.live, 0U);
+		TS_ASSERT_EQUALS(stats.pages, 0U);
+	}
+
+	void test_shared_pool_registry() {
+		Common::SharedMemoryPool::Stats stats[64];
+		const uint before = Common::SharedMemoryPool::getAllStats(stats, ARRAYSIZE(stats));
+
+		{
+			Common::SharedMemoryPool pool("registry test", 16);
+			const uint count = Common::SharedMemoryPool::getAllStats(stats, ARRAYSIZE(stats));
+			TS_ASSERT_EQUALS(count, before + 1);
+
+			bool found = false;
+			for (uint i = 0; i < MIN<uint>(count, ARRAYSIZE(stats)); ++i) {
+				if (!strcmp(stats[i].name, "registry test"))
+					found = true;
+			}
+			TS_ASSERT(found);
+		}
+
+		TS_ASSERT_EQUALS(Common::SharedMemoryPool::getAllStats(stats, ARRAYSIZE(stats)), before);
+	}
+
+	void test_small_chunks() {
+		static const size_t sizes[] = { 1, 4, 8, 9, 24, 33, 100, 256, 257, 1000 };
+		void *chunks[ARRAYSIZE(sizes)];
+
+		for (uint i = 0; i < ARRAYSIZE(sizes); ++i) {
+			chunks[i] = Common::allocSmallChunk(sizes[i]);
+			TS_ASSERT(chunks[i] != 0);
+			memset(chunks[i], 0xAA, sizes[i]);
+		}
+
+		for (uint i = 0; i < ARRAYSIZE(sizes); ++i) {
+			for (uint j = 0; j < i; ++j)
+				TS_ASSERT_DIFFERS(chunks[i], chunks[j]);
+		}
+
+		for (uint i = 0; i < ARRAYSIZE(sizes); ++i)
+			Common::freeSmallChunk(chunks[i], sizes[i]);
+
+		// Freeing a null pointer is allowed
+		Common::freeSmallChunk(0, 16);
+	}
+};
@@ -84,4 +84,22 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		TS_ASSERT_EQUALS(ms.pos(), 7);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_read_in_place() {
+		byte contents[] = { 1, 2, 3, 4, 5 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		ms.readByte();
+		const byte *data = ms.readInPlace(3);
+		TS_ASSERT_EQUALS(data, contents + 1);
+		TS_ASSERT_EQUALS(ms.pos(), 4);
+
+		// Not enough data left: nothing happens
+		TS_ASSERT(!ms.readInPlace(2));
+		TS_ASSERT_EQUALS(ms.pos(), 4);
+		TS_ASSERT(!ms.eos());
+
+		TS_ASSERT_EQUALS(ms.readInPlace(1), contents + 4);
+		TS_ASSERT_EQUALS(ms.pos(), 5);
+	}
 };
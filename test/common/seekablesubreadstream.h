@@ -70,4 +70,27 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	void test_read_in_place() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+		Common::SeekableSubReadStream ssrs(&ms, 2, 8);
+
+		ssrs.seek(1);
+		TS_ASSERT_EQUALS(ssrs.readInPlace(4), contents + 3);
+		TS_ASSERT_EQUALS(ssrs.pos(), 5);
+		TS_ASSERT_EQUALS(ssrs.readByte(), 7);
+
+		// Must not reach beyond the end of the substream
+		TS_ASSERT(!ssrs.readInPlace(1));
+		TS_ASSERT_EQUALS(ssrs.pos(), 6);
+
+		ssrs.seek(0);
+		{
+			Common::StreamBuffer buf(ssrs, 6);
+			TS_ASSERT(!buf.isCopy());
+			TS_ASSERT_EQUALS(buf.size(), 6U);
+			TS_ASSERT_EQUALS(buf.getData(), contents + 2);
+		}
+	}
 };
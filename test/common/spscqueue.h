@@ -0,0 +1,56 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/spsc-queue.h"
+
+class SPSCQueueTestSuite : public CxxTest::TestSuite {
+public:
+	void test_empty_full() {
+		Common::SPSCQueue<int, 4> queue;
+		TS_ASSERT(queue.empty());
+		TS_ASSERT(!queue.full());
+
+		TS_ASSERT(queue.push(1));
+		TS_ASSERT(!queue.empty());
+
+		TS_ASSERT(queue.push(2));
+		TS_ASSERT(queue.push(3));
+		TS_ASSERT(queue.full());
+
+		// One slot is always kept free
+		TS_ASSERT(!queue.push(4));
+	}
+
+	void test_push_pop_order() {
+		Common::SPSCQueue<int, 4> queue;
+		int value = -1;
+
+		TS_ASSERT(!queue.pop(value));
+		TS_ASSERT_EQUALS(value, -1);
+
+		queue.push(42);
+		queue.push(-23);
+
+		TS_ASSERT(queue.pop(value));
+		TS_ASSERT_EQUALS(value, 42);
+		TS_ASSERT(queue.pop(value));
+		TS_ASSERT_EQUALS(value, -23);
+		TS_ASSERT(queue.empty());
+	}
+
+	void test_wrap_around() {
+		Common::SPSCQueue<int, 3> queue;
+		int value;
+
+		for (int i = 0; i < 10; ++i) {
+			TS_ASSERT(queue.push(i));
+			TS_ASSERT(queue.push(i + 100));
+			TS_ASSERT(!queue.push(i + 200));
+
+			TS_ASSERT(queue.pop(value));
+			TS_ASSERT_EQUALS(value, i);
+			TS_ASSERT(queue.pop(value));
+			TS_ASSERT_EQUALS(value, i + 100);
+			TS_ASSERT(queue.empty());
+		}
+	}
+};
@@ -339,6 +339,76 @@ class StringTestSuite : public CxxTest::TestSuite
 		TS_ASSERT_EQUALS(s.size(), 7U);
 	}
 
+	void test_appendFormat() {
+		Common::String s("data");
+		s.appendFormat("/%s.%03d", "resource", 7);
+		TS_ASSERT_EQUALS(s, "data/resource.007");
+		TS_ASSERT_EQUALS(s.size(), 17U);
+
+		// Grow past the built-in capacity, one piece at a time
+		Common::String expected("data/resource.007");
+		for (int i = 0; i < 20; ++i) {
+			s.appendFormat(" %d", i);
+			expected += Common::String::format(" %d", i);
+			TS_ASSERT_EQUALS(s, expected);
+		}
+
+		// Appending must not modify strings sharing the storage
+		Common::String copy(s);
+		s.appendFormat("%s", "!");
+		TS_ASSERT_EQUALS(copy, expected);
+		TS_ASSERT_EQUALS(s, expected + "!");
+	}
+
+	void test_append() {
+		Common::String s;
+		s.append("abcdef", 3);
+		TS_ASSERT_EQUALS(s, "abc");
+
+		s.append("", 0);
+		TS_ASSERT_EQUALS(s, "abc");
+
+		// Appending a part of the string itself
+		s.append(s.c_str() + 1, 2);
+		TS_ASSERT_EQUALS(s, "abcbc");
+		TS_ASSERT_EQUALS(s.size(), 5U);
+	}
+
+	void test_reserve() {
+		Common::String s("path");
+		s.reserve(200);
+		TS_ASSERT_EQUALS(s, "path");
+
+		const char *storage = s.c_str();
+		for (int i = 0; i < 19; ++i)
+			s += "/component";
+		TS_ASSERT_EQUALS(s.size(), 194U);
+		TS_ASSERT_EQUALS(s.c_str(), storage);
+	}
+
+	void test_swap() {
+		Common::String shortStr("short");
+		Common::String longStr("a string which is too long for the built-in storage");
+		Common::String longCopy(longStr);
+
+		shortStr.swap(longStr);
+		TS_ASSERT_EQUALS(shortStr, "a string which is too long for the built-in storage");
+		TS_ASSERT_EQUALS(longStr, "short");
+		TS_ASSERT_EQUALS(shortStr.c_str(), longCopy.c_str());
+
+		// Modifying one of them must still unshare the storage
+		shortStr.setChar('A', 0);
+		TS_ASSERT_EQUALS(longCopy, "a string which is too long for the built-in storage");
+
+		Common::String a("a"), b("b");
+		a.swap(b);
+		TS_ASSERT_EQUALS(a, "b");
+		TS_ASSERT_EQUALS(b, "a");
+		a += "c";
+		TS_ASSERT_EQUALS(a, "bc");
+		TS_ASSERT_EQUALS(b, "a");
+	}
+
 	void test_strlcpy() {
 		static const char * const testString = "1234567890";
 
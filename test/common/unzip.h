@@ -0,0 +1,296 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/array.h"
+#include "common/memstream.h"
+#include "common/system.h"
+#include "common/unzip.h"
+
+#include "graphics/pixelformat.h"
+
+/**
+ * ZipArchive needs a backend for the mutex guarding its archive stream.
+ * This one has mutexes which do nothing, and nothing else.
+ */
+class UnzipTestSystem : public OSystem {
+public:
+	virtual const GraphicsMode *getSupportedGraphicsModes() const {
+		static const GraphicsMode noGraphicsModes[] = { { 0, 0, 0 } };
+		return noGraphicsModes;
+	}
+	virtual int getDefaultGraphicsMode() const { return 0; }
+	virtual bool setGraphicsMode(int mode) { return true; }
+	virtual int getGraphicsMode() const { return 0; }
+	virtual Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+	virtual Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format = NULL) {}
+	virtual int16 getHeight() { return 0; }
+	virtual int16 getWidth() { return 0; }
+	virtual PaletteManager *getPaletteManager() { return 0; }
+	virtual void copyRectToScreen(const byte *buf, int pitch, int x, int y, int w, int h) {}
+	virtual Graphics::Surface *lockScreen() { return 0; }
+	virtual void unlockScreen() {}
+	virtual void fillScreen(uint32 col) {}
+	virtual void updateScreen() {}
+	virtual void setShakePos(int shakeOffset) {}
+	virtual void showOverlay() {}
+	virtual void hideOverlay() {}
+	virtual Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat(); }
+	virtual void clearOverlay() {}
+	virtual void grabOverlay(OverlayColor *buf, int pitch) {}
+	virtual void copyRectToOverlay(const OverlayColor *buf, int pitch, int x, int y, int w, int h) {}
+	virtual int16 getOverlayHeight() { return 0; }
+	virtual int16 getOverlayWidth() { return 0; }
+	virtual bool showMouse(bool visible) { return false; }
+	virtual void warpMouse(int x, int y) {}
+	virtual void setMouseCursor(const byte *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, int cursorTargetScale = 1, const Graphics::PixelFormat *format = NULL) {}
+
+	virtual uint32 getMillis() { return 0; }
+	virtual void delayMillis(uint msecs) {}
+	virtual void getTimeAndDate(TimeDate &t) const {}
+
+	virtual MutexRef createMutex() { return 0; }
+	virtual void lockMutex(MutexRef mutex) {}
+	virtual void unlockMutex(MutexRef mutex) {}
+	virtual void deleteMutex(MutexRef mutex) {}
+
+	virtual Audio::Mixer *getMixer() { return 0; }
+	virtual void quit() {}
+	virtual void displayMessageOnOSD(const char *msg) {}
+	virtual void logMessage(LogMessageType::Type type, const char *message) {}
+};
+
+class UnzipTestSuite : public CxxTest::TestSuite {
+	enum {
+		SMALL_SIZE = 1000,
+		// Large enough to be read from the archive stream on demand
+		BIG_SIZE = 300000
+	};
+
+	struct Member {
+		const char *name;
+		uint16 method;
+		Common::Array<byte> data;
+		Common::Array<byte> stored;
+		uint32 offset;
+	};
+
+	static void put16(Common::Array<byte> &zip, uint16 value) {
+		zip.push_back(value & 0xFF);
+		zip.push_back(value >> 8);
+	}
+
+	static void put32(Common::Array<byte> &zip, uint32 value) {
+		put16(zip, value & 0xFFFF);
+		put16(zip, value >> 16);
+	}
+
+	static void putHeader(Common::Array<byte> &zip, const Member &member, bool central) {
+		put32(zip, central ? 0x02014b50 : 0x04034b50);
+		if (central)
+			put16(zip, 20);
+		put16(zip, 20);
+		put16(zip, 0);
+		put16(zip, member.method);
+		put32(zip, 0);
+		put32(zip, crc32(member.data));
+		put32(zip, member.stored.size());
+		put32(zip, member.data.size());
+		put16(zip, strlen(member.name));
+		put16(zip, 0);
+		if (central) {
+			put16(zip, 0);
+			put16(zip, 0);
+			put16(zip, 0);
+			put32(zip, 0);
+			put32(zip, member.offset);
+		}
+		for (const char *c = member.name; *c; ++c)
+			zip.push_back(*c);
+	}
+
+	static uint32 crc32(const Common::Array<byte> &data) {
+		uint32 crc = 0xFFFFFFFF;
+		for (uint i = 0; i < data.size(); ++i) {
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; ++bit)
+				crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+		}
+		return ~crc;
+	}
+
+	static byte contents(uint32 pos) {
+		return (pos * 7 + pos / 251) & 0xFF;
+	}
+
+	static Member makeMember(const char *name, uint32 size, bool compress) {
+		Member member;
+		member.name = name;
+		member.method = compress ? 8 : 0;
+		member.offset = 0;
+		member.data.resize(size);
+		for (uint32 i = 0; i < size; ++i)
+			member.data[i] = contents(i);
+
+		if (!compress) {
+			member.stored = member.data;
+			return member;
+		}
+
+		// Deflate the data as a series of stored blocks, which the
+		// archive still has to run through zlib
+		for (uint32 pos = 0; pos < size; pos += 0xFFFF) {
+			const uint16 length = MIN<uint32>(size - pos, 0xFFFF);
+			member.stored.push_back(pos + length == size ? 1 : 0);
+			put16(member.stored, length);
+			put16(member.stored, ~length);
+			for (uint32 i = 0; i < length; ++i)
+				member.stored.push_back(member.data[pos + i]);
+		}
+		return member;
+	}
+
+	static Common::Archive *makeArchive() {
+		Member members[3] = {
+			makeMember("small.txt", SMALL_SIZE, false),
+			makeMember("Big.bin", BIG_SIZE, false),
+			makeMember("big.z", BIG_SIZE, true)
+		};
+
+		Common::Array<byte> zip;
+		for (int i = 0; i < 3; ++i) {
+			members[i].offset = zip.size();
+			putHeader(zip, members[i], false);
+			for (uint j = 0; j < members[i].stored.size(); ++j)
+				zip.push_back(members[i].stored[j]);
+		}
+
+		const uint32 directory = zip.size();
+		for (int i = 0; i < 3; ++i)
+			putHeader(zip, members[i], true);
+		const uint32 directorySize = zip.size() - directory;
+
+		put32(zip, 0x06054b50);
+		put16(zip, 0);
+		put16(zip, 0);
+		put16(zip, 3);
+		put16(zip, 3);
+		put32(zip, directorySize);
+		put32(zip, directory);
+		put16(zip, 0);
+
+		byte *data = (byte *)malloc(zip.size());
+		memcpy(data, &zip[0], zip.size());
+		return Common::makeZipArchive(new Common::MemoryReadStream(data, zip.size(), DisposeAfterUse::YES));
+	}
+
+	static bool checkContents(Common::SeekableReadStream *stream, uint32 size) {
+		byte *buffer = new byte[size];
+		const bool ok = (stream->read(buffer, size) == size);
+		for (uint32 i = 0; ok && i < size; ++i) {
+			if (buffer[i] != contents(stream->pos() - size + i)) {
+				delete[] buffer;
+				return false;
+			}
+		}
+		delete[] buffer;
+		return ok;
+	}
+
+	OSystem *_oldSystem;
+	UnzipTestSystem _system;
+
+public:
+	void setUp() {
+		_oldSystem = g_system;
+		g_system = &_system;
+	}
+
+	void tearDown() {
+		g_system = _oldSystem;
+	}
+
+	void test_index() {
+		Common::Archive *archive = makeArchive();
+		TS_ASSERT(archive != 0);
+
+		// Names are looked up in the index of the central directory,
+		// ignoring case
+		TS_ASSERT(archive->hasFile("small.txt"));
+		TS_ASSERT(archive->hasFile("SMALL.TXT"));
+		TS_ASSERT(archive->hasFile("big.bin"));
+		TS_ASSERT(!archive->hasFile("missing"));
+		TS_ASSERT(!archive->getMember("missing"));
+		TS_ASSERT(archive->getMember("big.Z"));
+
+		Common::ArchiveMemberList list;
+		TS_ASSERT_EQUALS(archive->listMembers(list), 3);
+		TS_ASSERT_EQUALS(list.size(), 3U);
+		TS_ASSERT(archive->createReadStreamForMember("missing") == 0);
+
+		delete archive;
+	}
+
+	void test_small_member() {
+		Common::Archive *archive = makeArchive();
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("small.txt");
+		TS_ASSERT(stream != 0);
+		TS_ASSERT_EQUALS(stream->size(), SMALL_SIZE);
+		TS_ASSERT(checkContents(stream, SMALL_SIZE));
+		delete stream;
+		delete archive;
+	}
+
+	void test_streamed_member() {
+		Common::Archive *archive = makeArchive();
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("big.bin");
+		Common::SeekableReadStream *other = archive->createReadStreamForMember("big.bin");
+		TS_ASSERT(stream != 0);
+		TS_ASSERT(other != 0);
+		TS_ASSERT_EQUALS(stream->size(), BIG_SIZE);
+
+		// Both streams read from the archive stream
+		TS_ASSERT(checkContents(stream, 1000));
+		TS_ASSERT(other->seek(200000));
+		TS_ASSERT(checkContents(other, 1000));
+		TS_ASSERT(checkContents(stream, 1000));
+		TS_ASSERT_EQUALS(stream->pos(), 2000);
+		delete other;
+
+		// Seeks out of range fail and leave the position alone
+		TS_ASSERT(!stream->seek(-1, SEEK_SET));
+		TS_ASSERT(!stream->seek(1, SEEK_END));
+		TS_ASSERT(!stream->seek(-3000, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->pos(), 2000);
+
+		// The stream outlives the archive
+		delete archive;
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		TS_ASSERT(checkContents(stream, 10));
+		TS_ASSERT(!stream->eos());
+		byte b;
+		TS_ASSERT_EQUALS(stream->read(&b, 1), 0U);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+	}
+
+	void test_deflated_member() {
+#ifdef USE_ZLIB
+		Common::Archive *archive = makeArchive();
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("big.z");
+		TS_ASSERT(stream != 0);
+		TS_ASSERT_EQUALS(stream->size(), BIG_SIZE);
+		TS_ASSERT(checkContents(stream, 5000));
+		TS_ASSERT(stream->seek(250000));
+		TS_ASSERT(checkContents(stream, BIG_SIZE - 250000));
+
+		// Seeking backwards starts over
+		TS_ASSERT(stream->seek(100));
+		TS_ASSERT(checkContents(stream, 100));
+		delete stream;
+		delete archive;
+#endif
+	}
+};
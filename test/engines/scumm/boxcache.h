@@ -0,0 +1,117 @@
+#include <cxxtest/TestSuite.h>
+
+#include "engines/scumm/boxes.h"
+
+class BoxCacheTestSuite : public CxxTest::TestSuite {
+	static Scumm::BoxCoords makeBox(int left, int top, int right, int bottom) {
+		Scumm::BoxCoords box;
+		box.ul = Common::Point(left, top);
+		box.ur = Common::Point(right, top);
+		box.ll = Common::Point(left, bottom);
+		box.lr = Common::Point(right, bottom);
+		return box;
+	}
+
+	static Scumm::BoxGate makeGate(int x) {
+		Scumm::BoxGate gate;
+		gate.gateA[0] = gate.gateA[1] = Common::Point(x, 0);
+		gate.gateB[0] = gate.gateB[1] = Common::Point(x, 1);
+		return gate;
+	}
+
+public:
+	void test_grid() {
+		Common::Array<Scumm::BoxCoords> boxes;
+		boxes.push_back(makeBox(0, 0, 40, 40));
+		boxes.push_back(makeBox(100, 0, 140, 20));
+		boxes.push_back(makeBox(20, 20, 120, 60));
+
+		Scumm::BoxCache cache;
+		TS_ASSERT(!cache.isValid());
+		cache.setBoxes(boxes);
+		TS_ASSERT(cache.isValid());
+		TS_ASSERT_EQUALS(cache.getNumBoxes(), 3);
+		TS_ASSERT_EQUALS(cache.getCoords(1).lr, Common::Point(140, 20));
+
+		int count;
+		const byte *found = cache.getBoxesAt(10, 10, count);
+		TS_ASSERT_EQUALS(count, 2);
+		TS_ASSERT_EQUALS(found[0], 0);
+		TS_ASSERT_EQUALS(found[1], 2);
+
+		found = cache.getBoxesAt(110, 10, count);
+		TS_ASSERT_EQUALS(count, 2);
+		TS_ASSERT_EQUALS(found[0], 1);
+		TS_ASSERT_EQUALS(found[1], 2);
+
+		found = cache.getBoxesAt(130, 10, count);
+		TS_ASSERT_EQUALS(count, 1);
+		TS_ASSERT_EQUALS(found[0], 1);
+
+		// Outside of the grid
+		TS_ASSERT(cache.getBoxesAt(-1, 10, count) == 0);
+		TS_ASSERT_EQUALS(count, 0);
+		TS_ASSERT(cache.getBoxesAt(10, 100, count) == 0);
+		TS_ASSERT_EQUALS(count, 0);
+	}
+
+	void test_invalidate() {
+		Common::Array<Scumm::BoxCoords> boxes;
+		boxes.push_back(makeBox(0, 0, 40, 40));
+		boxes.push_back(makeBox(100, 0, 140, 20));
+
+		Scumm::BoxCache cache;
+		cache.setBoxes(boxes);
+		cache.addGate(0, 1, makeGate(7));
+		cache.getItineraryMatrix().resize(4);
+
+		const Scumm::BoxGate *gate = cache.findGate(0, 1);
+		TS_ASSERT(gate != 0);
+		TS_ASSERT_EQUALS(gate->gateA[0].x, 7);
+		TS_ASSERT(cache.findGate(1, 0) == 0);
+
+		cache.invalidate();
+		TS_ASSERT(!cache.isValid());
+		TS_ASSERT_EQUALS(cache.getNumBoxes(), 0);
+		TS_ASSERT(cache.findGate(0, 1) == 0);
+		TS_ASSERT(cache.getItineraryMatrix().empty());
+
+		int count;
+		TS_ASSERT(cache.getBoxesAt(10, 10, count) == 0);
+		TS_ASSERT_EQUALS(count, 0);
+	}
+
+	void test_set_boxes_again() {
+		Common::Array<Scumm::BoxCoords> boxes;
+		boxes.push_back(makeBox(0, 0, 40, 40));
+
+		Scumm::BoxCache cache;
+		cache.setBoxes(boxes);
+		cache.addGate(0, 0, makeGate(1));
+
+		// E.g. after a script moved a box; the gates are computed again
+		boxes[0] = makeBox(200, 100, 240, 140);
+		boxes.push_back(makeBox(0, 0, 10, 10));
+		cache.setBoxes(boxes);
+		TS_ASSERT(cache.isValid());
+		TS_ASSERT_EQUALS(cache.getNumBoxes(), 2);
+		TS_ASSERT(cache.findGate(0, 0) == 0);
+
+		int count;
+		const byte *found = cache.getBoxesAt(220, 120, count);
+		TS_ASSERT_EQUALS(count, 1);
+		TS_ASSERT_EQUALS(found[0], 0);
+
+		found = cache.getBoxesAt(5, 5, count);
+		TS_ASSERT_EQUALS(count, 1);
+		TS_ASSERT_EQUALS(found[0], 1);
+
+		TS_ASSERT(cache.getBoxesAt(100, 60, count) == 0);
+
+		// No boxes at all
+		cache.setBoxes(Common::Array<Scumm::BoxCoords>());
+		TS_ASSERT(cache.isValid());
+		TS_ASSERT(cache.getBoxesAt(5, 5, count) == 0);
+		TS_ASSERT_EQUALS(count, 0);
+	}
+};
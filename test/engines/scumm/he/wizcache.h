@@ -0,0 +1,175 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/endian.h"
+
+#include "engines/scumm/he/wiz_he.h"
+
+class WizImageCacheTestSuite : public CxxTest::TestSuite {
+	// A compressed 4x2 image. The first line is a literal run, the second
+	// one skips a pixel, repeats color 5 twice and skips the last pixel.
+	static const uint8 *getImageData() {
+		static const uint8 data[] = {
+			5, 0, 0x0C, 1, 2, 3, 4,
+			4, 0, 0x03, 0x06, 5, 0x03
+		};
+		return data;
+	}
+
+public:
+	void test_decode() {
+		uint8 palette[256];
+		for (int i = 0; i < 256; i++)
+			palette[i] = i + 100;
+
+		Scumm::WizImageCache cache;
+		const Scumm::DecodedWizImage *image = cache.getImage(1, 0, getImageData(), 4, 2, palette, 1);
+		TS_ASSERT(image != 0);
+		TS_ASSERT_EQUALS(image->pixels[0], 101);
+		TS_ASSERT_EQUALS(image->pixels[3], 104);
+		TS_ASSERT_EQUALS(image->pixels[5], 105);
+		TS_ASSERT_EQUALS(image->pixels[6], 105);
+
+		// One run on each line
+		TS_ASSERT_EQUALS(image->lines[1], 1U);
+		TS_ASSERT_EQUALS(image->lines[2], 2U);
+		TS_ASSERT_EQUALS(image->runs[1].x, 1);
+		TS_ASSERT_EQUALS(image->runs[1].length, 2);
+
+		TS_ASSERT_EQUALS(cache.getImage(1, 0, getImageData(), 4, 2, palette, 1), image);
+		TS_ASSERT_EQUALS(cache.getStatistics().hits, 1U);
+		TS_ASSERT_EQUALS(cache.getStatistics().misses, 1U);
+		TS_ASSERT_EQUALS(cache.getMemory(), image->getMemory());
+	}
+
+	void test_invalidate() {
+		Scumm::WizImageCache cache;
+		TS_ASSERT(cache.getImage(1, 0, getImageData(), 4, 2, 0, 1) != 0);
+		TS_ASSERT(cache.getImage(1, 1, getImageData(), 4, 2, 0, 1) != 0);
+		TS_ASSERT(cache.getImage(2, 0, getImageData(), 4, 2, 0, 1) != 0);
+		TS_ASSERT_EQUALS(cache.getStatistics().misses, 3U);
+
+		// All states of the image are dropped, other images are kept
+		cache.invalidate(1);
+		cache.getImage(2, 0, getImageData(), 4, 2, 0, 1);
+		TS_ASSERT_EQUALS(cache.getStatistics().hits, 1U);
+		cache.getImage(1, 0, getImageData(), 4, 2, 0, 1);
+		cache.getImage(1, 1, getImageData(), 4, 2, 0, 1);
+		TS_ASSERT_EQUALS(cache.getStatistics().misses, 5U);
+
+		cache.clear();
+		TS_ASSERT_EQUALS(cache.getMemory(), 0U);
+		cache.getImage(2, 0, getImageData(), 4, 2, 0, 1);
+		TS_ASSERT_EQUALS(cache.getStatistics().misses, 6U);
+	}
+
+	void test_changed_data() {
+		uint8 data[13];
+		memcpy(data, getImageData(), sizeof(data));
+
+		Scumm::WizImageCache cache;
+		TS_ASSERT(cache.getImage(1, 0, getImageData(), 4, 2, 0, 1) != 0);
+		const uint32 memory = cache.getMemory();
+
+		// A reloaded resource is somewhere else in memory
+		const Scumm::DecodedWizImage *image = cache.getImage(1, 0, data, 4, 2, 0, 1);
+		TS_ASSERT(image != 0);
+		TS_ASSERT_EQUALS(image->data, (const uint8 *)data);
+		TS_ASSERT_EQUALS(cache.getStatistics().misses, 2U);
+		TS_ASSERT_EQUALS(cache.getMemory(), memory);
+	}
+
+	void test_changed_palette() {
+		uint8 palette[256];
+		memset(palette, 7, sizeof(palette));
+
+		Scumm::WizImageCache cache;
+		const Scumm::DecodedWizImage *image = cache.getImage(1, 0, getImageData(), 4, 2, palette, 1);
+		TS_ASSERT(image != 0);
+		TS_ASSERT_EQUALS(image->pixels[0], 7);
+
+		// The palette is changed in place, e.g. by a script
+		palette[1] = 9;
+		image = cache.getImage(1, 0, getImageData(), 4, 2, palette, 1);
+		TS_ASSERT(image != 0);
+		TS_ASSERT_EQUALS(image->pixels[0], 9);
+		TS_ASSERT_EQUALS(cache.getStatistics().hits, 0U);
+		TS_ASSERT_EQUALS(cache.getStatistics().misses, 2U);
+	}
+
+	void test_copy_16bit_run() {
+		// Image data is little endian
+		static const uint8 src[] = { 0x34, 0x12, 0x78, 0x56 };
+		uint8 screen[4], memory[4];
+
+		// The screen uses the native byte order, other surfaces are little
+		// endian, whatever the host is
+		Scumm::copy16BitRun(screen, 2, src, 2, 2, false, Scumm::kDstScreen);
+		Scumm::copy16BitRun(memory, 2, src, 2, 2, false, Scumm::kDstMemory);
+		TS_ASSERT_EQUALS(READ_UINT16(screen), 0x1234);
+		TS_ASSERT_EQUALS(READ_UINT16(screen + 2), 0x5678);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory), 0x1234);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory + 2), 0x5678);
+
+		// Decoded images are in native byte order
+		uint8 native[4];
+		WRITE_UINT16(native, 0x1234);
+		WRITE_UINT16(native + 2, 0x5678);
+		Scumm::copy16BitRun(screen, 2, native, 2, 2, true, Scumm::kDstCursor);
+		Scumm::copy16BitRun(memory, 2, native, 2, 2, true, Scumm::kDstResource);
+		TS_ASSERT_EQUALS(READ_UINT16(screen), 0x1234);
+		TS_ASSERT_EQUALS(READ_UINT16(screen + 2), 0x5678);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory), 0x1234);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory + 2), 0x5678);
+
+		// Repeated pixels, written from right to left
+		Scumm::copy16BitRun(memory + 2, -2, src + 2, 0, 2, false, Scumm::kDstMemory);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory), 0x5678);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory + 2), 0x5678);
+	}
+
+	void test_draw_16bit() {
+		uint8 palette[256 * 2];
+		for (int i = 0; i < 256; i++)
+			WRITE_LE_UINT16(palette + i * 2, 0x1200 + i);
+
+		Scumm::WizImageCache cache;
+		const Scumm::DecodedWizImage *image = cache.getImage(1, 0, getImageData(), 4, 2, palette, 2);
+		TS_ASSERT(image != 0);
+
+		uint8 screen[4 * 2 * 2], memory[4 * 2 * 2];
+		memset(screen, 0, sizeof(screen));
+		memset(memory, 0, sizeof(memory));
+		const Common::Rect r(4, 2);
+		Scumm::WizImageCache::drawImage(*image, screen, 8, Scumm::kDstScreen, r, 0);
+		Scumm::WizImageCache::drawImage(*image, memory, 8, Scumm::kDstMemory, r, 0);
+
+		TS_ASSERT_EQUALS(READ_UINT16(screen), 0x1201);
+		TS_ASSERT_EQUALS(READ_UINT16(screen + 6), 0x1204);
+		TS_ASSERT_EQUALS(READ_UINT16(screen + 8), 0);
+		TS_ASSERT_EQUALS(READ_UINT16(screen + 10), 0x1205);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory), 0x1201);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory + 6), 0x1204);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory + 8), 0);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory + 10), 0x1205);
+
+		// Mirrored
+		Scumm::WizImageCache::drawImage(*image, memory, 8, Scumm::kDstMemory, r, Scumm::kWIFFlipX);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory), 0x1204);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory + 6), 0x1201);
+		TS_ASSERT_EQUALS(READ_LE_UINT16(memory + 12), 0x1205);
+	}
+
+	void test_budget() {
+		Scumm::WizImageCache cache;
+		cache.setBudget(1024);
+
+		// Images larger than a quarter of the budget are not cached
+		TS_ASSERT(cache.getImage(1, 0, getImageData(), 32, 9, 0, 1) == 0);
+		TS_ASSERT_EQUALS(cache.getMemory(), 0U);
+
+		TS_ASSERT(cache.getImage(1, 0, getImageData(), 4, 2, 0, 1) != 0);
+		cache.setBudget(0);
+		TS_ASSERT_EQUALS(cache.getMemory(), 0U);
+		TS_ASSERT_EQUALS(cache.getStatistics().evictions, 1U);
+	}
+};
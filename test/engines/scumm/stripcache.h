@@ -0,0 +1,128 @@
+#include <cxxtest/TestSuite.h>
+
+#include "engines/scumm/stripcache.h"
+
+class StripCacheTestSuite : public CxxTest::TestSuite {
+public:
+	void test_find_after_insert() {
+		Scumm::StripCache cache;
+		cache.reset(10, 64, 16);
+
+		TS_ASSERT(cache.find(3) == 0);
+		byte *data = cache.insert(3);
+		TS_ASSERT(data != 0);
+		memset(data, 0x42, 64 + 16);
+
+		const byte *found = cache.find(3);
+		TS_ASSERT_EQUALS(found, data);
+		TS_ASSERT_EQUALS(found[64 + 15], 0x42);
+		TS_ASSERT_EQUALS(cache.getMemory(), 80U);
+
+		// Strips outside of the room are never cached
+		TS_ASSERT(cache.insert(10) == 0);
+		TS_ASSERT(cache.insert(-1) == 0);
+
+		TS_ASSERT_EQUALS(cache.getStatistics().hits, 1U);
+		TS_ASSERT_EQUALS(cache.getStatistics().misses, 1U);
+	}
+
+	void test_clear_and_remove() {
+		Scumm::StripCache cache;
+		cache.reset(10, 64, 0);
+		for (int i = 0; i < 10; i++)
+			TS_ASSERT(cache.insert(i) != 0);
+
+		cache.remove(4);
+		TS_ASSERT(cache.find(4) == 0);
+		TS_ASSERT(cache.find(5) != 0);
+		TS_ASSERT_EQUALS(cache.getMemory(), 9U * 64);
+
+		cache.clear();
+		TS_ASSERT_EQUALS(cache.getMemory(), 0U);
+		for (int i = 0; i < 10; i++)
+			TS_ASSERT(cache.find(i) == 0);
+
+		// The layout survives clear(), but not reset()
+		TS_ASSERT_EQUALS(cache.getPixelSize(), 64U);
+		cache.reset(20, 128, 32);
+		TS_ASSERT_EQUALS(cache.getPixelSize(), 128U);
+		TS_ASSERT_EQUALS(cache.getMaskSize(), 32U);
+		TS_ASSERT(cache.insert(19) != 0);
+	}
+
+	void test_validate() {
+		static const byte smap1[1] = { 0 };
+		static const byte smap2[1] = { 0 };
+		byte palette[256];
+		for (int i = 0; i < 256; i++)
+			palette[i] = i;
+
+		Scumm::StripCache cache;
+		TS_ASSERT(!cache.validate(smap1, 144, 2, palette));
+		cache.reset(10, 8 * 144, 144);
+		TS_ASSERT(cache.insert(0) != 0);
+		TS_ASSERT(cache.validate(smap1, 144, 2, palette));
+		TS_ASSERT(cache.find(0) != 0);
+
+		// A different room image, height, number of z-planes or palette
+		// drops all strips
+		TS_ASSERT(!cache.validate(smap2, 144, 2, palette));
+		TS_ASSERT(cache.find(0) == 0);
+
+		TS_ASSERT(cache.insert(0) != 0);
+		TS_ASSERT(!cache.validate(smap2, 128, 2, palette));
+		TS_ASSERT(cache.find(0) == 0);
+
+		TS_ASSERT(cache.insert(0) != 0);
+		TS_ASSERT(!cache.validate(smap2, 128, 3, palette));
+		TS_ASSERT(cache.find(0) == 0);
+
+		TS_ASSERT(cache.insert(0) != 0);
+		palette[17] = 0;
+		TS_ASSERT(!cache.validate(smap2, 128, 3, palette));
+		TS_ASSERT(cache.find(0) == 0);
+		TS_ASSERT_EQUALS(cache.getMemory(), 0U);
+
+		// Changing the room forgets the room image, even if the next room
+		// happens to be loaded at the same address
+		TS_ASSERT(cache.insert(0) != 0);
+		TS_ASSERT(cache.validate(smap2, 128, 3, palette));
+		cache.invalidate();
+		TS_ASSERT(cache.find(0) == 0);
+		TS_ASSERT(!cache.validate(smap2, 128, 3, palette));
+	}
+
+	void test_eviction() {
+		Scumm::StripCache cache;
+		cache.reset(10, 100, 0);
+		cache.setBudget(300);
+
+		TS_ASSERT(cache.insert(0) != 0);
+		TS_ASSERT(cache.insert(1) != 0);
+		TS_ASSERT(cache.insert(2) != 0);
+		TS_ASSERT(cache.find(0) != 0);
+
+		// Strip 1 is the least recently used one
+		TS_ASSERT(cache.insert(3) != 0);
+		TS_ASSERT_EQUALS(cache.getMemory(), 300U);
+		TS_ASSERT_EQUALS(cache.getStatistics().evictions, 1U);
+		TS_ASSERT(cache.find(1) == 0);
+		TS_ASSERT(cache.find(0) != 0);
+		TS_ASSERT(cache.find(2) != 0);
+		TS_ASSERT(cache.find(3) != 0);
+
+		// Lowering the budget evicts right away
+		cache.setBudget(100);
+		TS_ASSERT_EQUALS(cache.getMemory(), 100U);
+		TS_ASSERT(cache.find(3) != 0);
+
+		// Strips larger than the budget are not cached at all
+		cache.setBudget(50);
+		TS_ASSERT(cache.insert(5) == 0);
+		TS_ASSERT_EQUALS(cache.getMemory(), 0U);
+
+		cache.resetStatistics();
+		TS_ASSERT_EQUALS(cache.getStatistics().hits, 0U);
+		TS_ASSERT_EQUALS(cache.getStatistics().evictions, 0U);
+	}
+};
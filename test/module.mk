@@ -8,6 +8,15 @@
 TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
 TEST_LIBS    := audio/libaudio.a common/libcommon.a
 
+ifdef ENABLE_SCUMM
+TESTS        += $(srcdir)/test/engines/scumm/*.h
+TEST_LIBS    := engines/scumm/boxcache.o engines/scumm/stripcache.o $(TEST_LIBS)
+ifdef ENABLE_HE
+TESTS        += $(srcdir)/test/engines/scumm/he/*.h
+TEST_LIBS    := engines/scumm/he/wizcache_he.o $(TEST_LIBS)
+endif
+endif
+
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
 TEST_CFLAGS  := -I$(srcdir)/test/cxxtest
@@ -35,8 +44,29 @@ test/runner.cpp: $(TESTS)
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
 
+
+######################################################################
+# Benchmarks. These are not run by the 'test' target, since their
+# results are only meaningful on an otherwise idle machine.
+# Use the 'bench' target to build and run them.
+#
+######################################################################
+
+BENCHMARKS   := $(srcdir)/test/bench/*.cpp
+BENCH_LIBS   := $(TEST_LIBS)
+
+ifdef ENABLE_SCI
+BENCH_LIBS   := engines/sci/decompressor.o engines/sci/engine/pathfinding.o $(BENCH_LIBS)
+endif
+
+bench: test/bench/runner
+	./test/bench/runner
+test/bench/runner: $(BENCHMARKS) $(BENCH_LIBS)
+	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+
+
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/bench/runner
 
-.PHONY: test clean-test
+.PHONY: test bench clean-test
@@ -772,9 +772,8 @@ void SmackerDecoder::unpackPalette() {
 	uint startPos = _fileStream->pos();
 	uint32 len = 4 * _fileStream->readByte();
 
-	byte *chunk = (byte *)malloc(len);
-	_fileStream->read(chunk, len);
-	byte *p = chunk;
+	Common::StreamBuffer chunk(*_fileStream, len);
+	const byte *p = chunk.getData();
 
 	byte oldPalette[3*256];
 	memcpy(oldPalette, _palette, 3 * 256);
@@ -816,7 +815,6 @@ void SmackerDecoder::unpackPalette() {
 	}
 
 	_fileStream->seek(startPos + len);
-	free(chunk);
 }
 
 } // End of namespace Video